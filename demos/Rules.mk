@@ -31,6 +31,15 @@ include $(dir)/Rules.mk
 dir := $(d)/painter_custom_brush_test
 include $(dir)/Rules.mk
 
+dir := $(d)/gl_trace_replay
+include $(dir)/Rules.mk
+
+dir := $(d)/glyph_atlas_churn
+include $(dir)/Rules.mk
+
+dir := $(d)/cpu_checks
+include $(dir)/Rules.mk
+
 dir := $(d)/tutorial
 include $(dir)/Rules.mk
 
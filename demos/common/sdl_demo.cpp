@@ -28,6 +28,7 @@
 #include <fastuidraw/util/vecN.hpp>
 #include <fastuidraw/util/fastuidraw_memory.hpp>
 #include <fastuidraw/gl_backend/gl_binding.hpp>
+#include <fastuidraw/gl_backend/gl_trace.hpp>
 #include <fastuidraw/gl_backend/gl_get.hpp>
 
 #ifdef __EMSCRIPTEN__
@@ -241,6 +242,9 @@ sdl_demo(const std::string &about_text, bool dimensions_must_match_default_value
                     "WGL_EXT_swap_control_tear. STRONG REMINDER: the value is "
                     "only passed to SDL_GL_SetSwapInterval if the value is set "
                     "at command line", *this),
+    m_capture_gl("", "capture_gl", "if non-empty, all GL calls and the data they read "
+                 "are captured to the named file, which can be replayed with "
+                 "gl_trace_replay", *this),
     #ifdef FASTUIDRAW_GL_USE_GLES
       m_gl_major(3, "gles_major", "GLES major version", *this),
       m_gl_minor(0, "gles_minor", "GLES minor version", *this),
@@ -281,6 +285,7 @@ sdl_demo::
     {
       if (m_ctx)
         {
+          fastuidraw::gl_binding::end_capture();
           SDL_GL_MakeCurrent(m_window, nullptr);
           SDL_GL_DeleteContext(m_ctx);
         }
@@ -505,6 +510,13 @@ init_sdl(void)
        */
       fastuidraw::gl_binding::get_proc_function(get_proc);
 
+      if (!m_capture_gl.value().empty()
+          && !fastuidraw::gl_binding::begin_capture(m_capture_gl.value().c_str()))
+        {
+          std::cerr << "Warning unable to capture GL calls to \""
+                    << m_capture_gl.value() << "\"\n";
+        }
+
       if (m_swap_interval.set_by_command_line())
         {
           if (SDL_GL_SetSwapInterval(m_swap_interval.value()) != 0)
@@ -584,6 +596,7 @@ swap_buffers(unsigned int count)
   for(unsigned int i = 0; i < count; ++i)
     {
       SDL_GL_SwapWindow(m_window);
+      fastuidraw::gl_binding::capture_frame_marker();
     }
 }
 
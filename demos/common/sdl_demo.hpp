@@ -155,6 +155,7 @@ private:
   command_line_argument_value<bool> m_print_gl_info;
 #ifndef __EMSCRIPTEN__
   command_line_argument_value<int> m_swap_interval;
+  command_line_argument_value<std::string> m_capture_gl;
   command_line_argument_value<int> m_gl_major, m_gl_minor;
 #else
   command_line_argument_value<int> m_emscripten_fps;
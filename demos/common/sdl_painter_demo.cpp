@@ -370,6 +370,21 @@ sdl_painter_demo(const std::string &about_text,
                                    "painter_break_on_shader_change",
                                    "If true, different shadings are placed into different "
                                    "entries of a call to glMultiDrawElements", *this),
+  m_painter_use_indirect_draw(m_painter_params.use_indirect_draw(),
+                              "painter_use_indirect_draw",
+                              "If true, issue draws with glMultiDrawElementsIndirect "
+                              "sourcing the draw ranges from a GL_DRAW_INDIRECT_BUFFER", *this),
+  m_painter_reorder_opaque_draws(m_painter_params.reorder_opaque_draws(),
+                                 "painter_reorder_opaque_draws",
+                                 "If true, draw opaque content front to back before "
+                                 "the translucent content so that the depth test "
+                                 "culls hidden fragments", *this),
+  m_painter_draw_reorder_window(m_painter_params.draw_reorder_window(),
+                                "painter_draw_reorder_window",
+                                "Number of consecutive draws that may be regrouped "
+                                "by shader to reduce state changes; draws whose "
+                                "bounding boxes intersect keep their order. A value "
+                                "of 0 or 1 disables the regrouping", *this),
   m_uber_vert_use_switch(m_painter_params.vert_shader_use_switch(),
                          "painter_uber_vert_use_switch",
                          "If true, use a switch statement in uber vertex shader dispatch",
@@ -614,6 +629,9 @@ init_gl(int w, int h)
   APPLY_PARAM(data_blocks_per_store_buffer, m_painter_data_blocks_per_buffer);
   APPLY_PARAM(number_pools, m_painter_number_pools);
   APPLY_PARAM(break_on_shader_change, m_painter_break_on_shader_change);
+  APPLY_PARAM(use_indirect_draw, m_painter_use_indirect_draw);
+  APPLY_PARAM(reorder_opaque_draws, m_painter_reorder_opaque_draws);
+  APPLY_PARAM(draw_reorder_window, m_painter_draw_reorder_window);
   APPLY_PARAM(clipping_type, m_use_hw_clip_planes);
   APPLY_PARAM(buffer_streaming_type, m_buffer_streaming_type);
   APPLY_PARAM(vert_shader_use_switch, m_uber_vert_use_switch);
@@ -816,6 +834,9 @@ init_gl(int w, int h)
       LAZY_PARAM(number_pools, m_painter_number_pools);
       LAZY_PARAM_ENUM(buffer_streaming_type, m_buffer_streaming_type);
       LAZY_PARAM_ENUM(break_on_shader_change, m_painter_break_on_shader_change);
+      LAZY_PARAM_ENUM(use_indirect_draw, m_painter_use_indirect_draw);
+      LAZY_PARAM_ENUM(reorder_opaque_draws, m_painter_reorder_opaque_draws);
+      LAZY_PARAM(draw_reorder_window, m_painter_draw_reorder_window);
       LAZY_PARAM_ENUM(clipping_type, m_use_hw_clip_planes);
       LAZY_PARAM_ENUM(vert_shader_use_switch, m_uber_vert_use_switch);
       LAZY_PARAM_ENUM(frag_shader_use_switch, m_uber_frag_use_switch);
@@ -148,6 +148,9 @@ private:
   command_line_argument_value<int> m_painter_indices_per_buffer;
   command_line_argument_value<int> m_painter_number_pools;
   command_line_argument_value<bool> m_painter_break_on_shader_change;
+  command_line_argument_value<bool> m_painter_use_indirect_draw;
+  command_line_argument_value<bool> m_painter_reorder_opaque_draws;
+  command_line_argument_value<unsigned int> m_painter_draw_reorder_window;
   command_line_argument_value<bool> m_uber_vert_use_switch;
   command_line_argument_value<bool> m_uber_frag_use_switch;
   command_line_argument_value<bool> m_use_uber_item_shader;
@@ -119,7 +119,8 @@ namespace
       m_mutex.lock();
       if (!m_buffer)
         {
-          m_buffer = FASTUIDRAWnew fastuidraw::DataBuffer(m_filename.c_str());
+          m_buffer = FASTUIDRAWnew fastuidraw::MappedDataBuffer(m_filename.c_str(),
+                                                                fastuidraw::MappedDataBuffer::access_random);
         }
       R = m_buffer;
       m_mutex.unlock();
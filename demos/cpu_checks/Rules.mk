@@ -0,0 +1,18 @@
+# Begin standard header
+sp 		:= $(sp).x
+dirstack_$(sp)	:= $(d)
+d		:= $(dir)
+# End standard header
+
+DEMOS += cpu-checks
+cpu-checks_SOURCES := $(call filelist, main.cpp)
+
+# the private painter_opaque_draws.cpp is not exported by the library
+# and so is compiled into the demo directly
+cpu-checks_SOURCES += src/fastuidraw/internal/private/painter_backend/painter_opaque_draws.cpp
+cpu-checks_CFLAGS := -Isrc/fastuidraw/internal
+
+# Begin standard footer
+d		:= $(dirstack_$(sp))
+sp		:= $(basename $(sp))
+# End standard footer
@@ -0,0 +1,594 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <random>
+#include <cmath>
+
+#include <fastuidraw/painter/shader_data/painter_dashed_stroke_params.hpp>
+#include <fastuidraw/painter/shader_data/painter_gradient_brush_shader_data.hpp>
+#include <fastuidraw/colorstop_atlas.hpp>
+#include <fastuidraw/painter/painter_brush.hpp>
+#include <private/painter_backend/painter_opaque_draws.hpp>
+#include "sdl_demo.hpp"
+#include "cast_c_array.hpp"
+#include "ostream_utility.hpp"
+
+/* Checks the CPU implementations of computations that the GLSL
+ * shaders also perform against simple reference implementations;
+ * each check prints the number of values checked and the number
+ * of mismatches, and the demo exits with -1 if any check fails.
+ *  - PainterDashedStrokeParams::compute_interval(), which walks the
+ *    packed search tree as the shaders do, against a linear scan of
+ *    the dash pattern at the boundaries, just before them and at the
+ *    middle of each interval over a few repeats of the pattern.
+ *  - PainterGradientBrushShaderData::compute_color(), which walks the
+ *    packed search tree of analytic color stops as the shaders do,
+ *    against a linear scan of the color stops at each stop, just
+ *    before it, between stops and outside of the stops.
+ *  - detail::OpaqueChunkReverser::reverse_chunks(), which reorders
+ *    the index data of opaque draws front to back, against a simple
+ *    reordering of the chunks of each segment, and
+ *    detail::OpaqueDrawClassifier::brush_is_opaque() on a few brushes.
+ */
+class NullColorStopBackingStore:public fastuidraw::ColorStopBackingStore
+{
+public:
+  NullColorStopBackingStore(void):
+    fastuidraw::ColorStopBackingStore(1024, 1)
+  {}
+
+  virtual
+  void
+  set_data(int, int, int, fastuidraw::c_array<const fastuidraw::u8vec4>)
+  {}
+
+protected:
+  virtual
+  void
+  resize_implement(int)
+  {}
+};
+
+class cpu_checks:public sdl_demo
+{
+public:
+  cpu_checks(void);
+
+protected:
+  void
+  init_gl(int w, int h);
+
+  void
+  draw_frame(void);
+
+  void
+  handle_event(const SDL_Event &ev);
+
+private:
+  unsigned int
+  check_dash_pattern(const std::vector<fastuidraw::PainterDashedStrokeParams::DashPatternElement> &pattern,
+                     unsigned int &num_checked);
+
+  bool
+  check_dash_patterns(void);
+
+  unsigned int
+  check_color_stops(const std::vector<fastuidraw::ColorStop> &values,
+                    unsigned int &num_checked);
+
+  bool
+  check_analytic_color_stops(void);
+
+  unsigned int
+  check_reverse_chunks(unsigned int num_indices,
+                       const std::vector<fastuidraw::detail::OpaqueChunkReverser::Chunk> &chunks,
+                       const std::vector<unsigned int> &segment_begins,
+                       const std::vector<fastuidraw::PainterIndex> &expected);
+
+  bool
+  check_opaque_draws(void);
+
+  command_line_argument_value<unsigned int> m_seed;
+  command_line_argument_value<unsigned int> m_num_random;
+  command_line_argument_value<float> m_tolerance;
+
+  std::mt19937 m_rand;
+  fastuidraw::reference_counted_ptr<fastuidraw::ColorStopAtlas> m_color_stop_atlas;
+  fastuidraw::detail::OpaqueChunkReverser m_chunk_reverser;
+};
+
+cpu_checks::
+cpu_checks(void):
+  sdl_demo("Check CPU implementations of shader computations"),
+  m_seed(1, "seed", "seed of the random generator of the random cases", *this),
+  m_num_random(200, "num_random", "number of random cases per check", *this),
+  m_tolerance(1e-5f, "tolerance", "relative tolerance of the comparisons", *this)
+{}
+
+void
+cpu_checks::
+init_gl(int w, int h)
+{
+  FASTUIDRAWunused(w);
+  FASTUIDRAWunused(h);
+}
+
+unsigned int
+cpu_checks::
+check_dash_pattern(const std::vector<fastuidraw::PainterDashedStrokeParams::DashPatternElement> &pattern,
+                   unsigned int &num_checked)
+{
+  using namespace fastuidraw;
+
+  PainterDashedStrokeParams params;
+  std::vector<float> boundaries, samples;
+  float total(0.0f), first_interval_start;
+  unsigned int num_failed(0);
+
+  params.dash_pattern(cast_c_array(pattern));
+  for (const auto &e : pattern)
+    {
+      total += e.m_draw_length;
+      boundaries.push_back(total);
+      total += e.m_space_length;
+      boundaries.push_back(total);
+    }
+
+  if (boundaries.empty() || total <= 0.0f)
+    {
+      return 0;
+    }
+
+  first_interval_start = (pattern.front().m_draw_length > 0.0f) ?
+    -pattern.front().m_draw_length :
+    0.0f;
+
+  for (int k = 0; k < 3; ++k)
+    {
+      float ff(total * float(k)), prev(first_interval_start);
+
+      /* just before a repeat, the reduction of the distance
+       * by the total length rounds to the total length
+       */
+      samples.push_back(ff);
+      samples.push_back(ff - total * 1e-8f);
+      for (float b : boundaries)
+        {
+          samples.push_back(ff + b);
+          samples.push_back(std::nextafter(ff + b, -1.0f));
+          samples.push_back(ff + 0.5f * (prev + b));
+          prev = b;
+        }
+    }
+
+  for (float distance : samples)
+    {
+      range_type<float> interval, ref_interval;
+      int id, ref_id, N(boundaries.size());
+      bool draw, ok;
+      float fd, ff, r, tol;
+      unsigned int idx(0);
+
+      draw = params.compute_interval(distance, &interval, &id);
+
+      fd = std::floor(distance / total);
+      ff = total * fd;
+      r = distance - ff;
+      if (r >= total)
+        {
+          fd += 1.0f;
+          ff += total;
+          r -= total;
+        }
+
+      while (idx + 1 < boundaries.size() && r >= boundaries[idx])
+        {
+          ++idx;
+        }
+
+      ref_id = int(idx) + int(fd) * N;
+      ref_interval.m_end = ff + boundaries[idx];
+      ref_interval.m_begin = ff + ((idx > 0) ? boundaries[idx - 1] : first_interval_start);
+      tol = m_tolerance.value() * t_max(total, std::abs(distance));
+
+      /* a distance within the tolerance of a boundary may
+       * land in the interval on either side of it.
+       */
+      if (id == ref_id)
+        {
+          ok = std::abs(interval.m_begin - ref_interval.m_begin) <= tol
+            && std::abs(interval.m_end - ref_interval.m_end) <= tol;
+        }
+      else if (id == ref_id + 1)
+        {
+          ok = std::abs(distance - ref_interval.m_end) <= tol
+            && std::abs(interval.m_begin - ref_interval.m_end) <= tol;
+        }
+      else if (id == ref_id - 1)
+        {
+          ok = std::abs(distance - ref_interval.m_begin) <= tol
+            && std::abs(interval.m_end - ref_interval.m_begin) <= tol;
+        }
+      else
+        {
+          ok = false;
+        }
+      ok = ok && (draw == (((id % N) + N) % N % 2 == 0));
+
+      ++num_checked;
+      if (!ok)
+        {
+          ++num_failed;
+          std::cout << "\tdistance " << distance << ": got interval #" << id
+                    << " [" << interval.m_begin << ", " << interval.m_end
+                    << "], draw = " << draw << "; expected interval #" << ref_id
+                    << " [" << ref_interval.m_begin << ", " << ref_interval.m_end
+                    << "]\n";
+        }
+    }
+  return num_failed;
+}
+
+bool
+cpu_checks::
+check_dash_patterns(void)
+{
+  typedef fastuidraw::PainterDashedStrokeParams::DashPatternElement E;
+
+  std::vector<std::vector<E> > patterns;
+  std::uniform_int_distribution<int> num_elements(1, 40);
+  std::uniform_real_distribution<float> length(0.25f, 40.0f);
+  unsigned int num_checked(0), num_failed(0);
+
+  patterns.push_back({ E(10.0f, 5.0f) });
+  patterns.push_back({ E(0.0f, 5.0f), E(3.0f, 2.0f) });
+  patterns.push_back({ E(1.0f, 1.0f), E(2.0f, 2.0f), E(3.0f, 3.0f) });
+  patterns.push_back({ E(20.0f, 0.5f), E(0.5f, 20.0f), E(7.0f, 7.0f), E(1.0f, 9.0f) });
+  for (unsigned int i = 0; i < m_num_random.value(); ++i)
+    {
+      std::vector<E> pattern(num_elements(m_rand));
+      for (E &e : pattern)
+        {
+          e.m_draw_length = length(m_rand);
+          e.m_space_length = length(m_rand);
+        }
+      patterns.push_back(pattern);
+    }
+
+  for (const auto &pattern : patterns)
+    {
+      num_failed += check_dash_pattern(pattern, num_checked);
+    }
+
+  std::cout << "Dash patterns: " << patterns.size() << " patterns, "
+            << num_checked << " distances checked, "
+            << num_failed << " failed\n";
+  return num_failed == 0;
+}
+
+unsigned int
+cpu_checks::
+check_color_stops(const std::vector<fastuidraw::ColorStop> &values,
+                  unsigned int &num_checked)
+{
+  using namespace fastuidraw;
+
+  ColorStopArray color_stops;
+  reference_counted_ptr<ColorStopSequence> cs;
+  PainterGradientBrushShaderData brush;
+  c_array<const ColorStop> stops;
+  std::vector<float> samples;
+  unsigned int num_failed(0);
+
+  for (const ColorStop &c : values)
+    {
+      color_stops.add(c);
+    }
+  cs = m_color_stop_atlas->create_analytic(color_stops, 64);
+  brush.linear_gradient(cs, vec2(0.0f, 0.0f), vec2(1.0f, 0.0f));
+  stops = cs->color_stops();
+  if (!brush.analytic_color_stops())
+    {
+      std::cout << "\t" << stops.size() << " color stops are not analytic\n";
+      return 1;
+    }
+
+  for (unsigned int i = 0; i < stops.size(); ++i)
+    {
+      samples.push_back(stops[i].m_place);
+      samples.push_back(std::nextafter(stops[i].m_place, -1.0f));
+      if (i + 1 < stops.size())
+        {
+          samples.push_back(0.5f * (stops[i].m_place + stops[i + 1].m_place));
+        }
+    }
+  samples.push_back(-1.0f);
+  samples.push_back(2.0f);
+
+  for (float t : samples)
+    {
+      vec4 color, ref_color;
+      unsigned int n(0);
+      bool ok(true);
+
+      color = brush.compute_color(t);
+      while (n < stops.size() && t >= stops[n].m_place)
+        {
+          ++n;
+        }
+
+      if (n == 0 || n == stops.size())
+        {
+          ref_color = vec4(stops[(n == 0) ? 0 : n - 1].m_color) / 255.0f;
+        }
+      else
+        {
+          vec4 c0(stops[n - 1].m_color), c1(stops[n].m_color);
+          float s;
+
+          s = (t - stops[n - 1].m_place) / (stops[n].m_place - stops[n - 1].m_place);
+          ref_color = (c0 + s * (c1 - c0)) / 255.0f;
+        }
+
+      for (unsigned int k = 0; k < 4; ++k)
+        {
+          ok = ok && std::abs(color[k] - ref_color[k]) <= 1e-4f;
+        }
+
+      ++num_checked;
+      if (!ok)
+        {
+          ++num_failed;
+          std::cout << "\t" << stops.size() << " color stops at t = " << t
+                    << ": got " << color << ", expected " << ref_color << "\n";
+        }
+    }
+  return num_failed;
+}
+
+bool
+cpu_checks::
+check_analytic_color_stops(void)
+{
+  using namespace fastuidraw;
+
+  std::vector<std::vector<ColorStop> > color_stops;
+  std::uniform_int_distribution<int> num_stops(1, ColorStopAtlas::max_analytic_color_stops);
+  std::uniform_int_distribution<int> channel(0, 255), place(0, 20);
+  unsigned int num_checked(0), num_failed(0);
+  u8vec4 red(255, 0, 0, 255), blue(0, 0, 255, 255), clear(0, 0, 0, 0);
+
+  m_color_stop_atlas = FASTUIDRAWnew ColorStopAtlas(FASTUIDRAWnew NullColorStopBackingStore());
+
+  /* a single stop, a hard stop and a hard stop at each end */
+  color_stops.push_back({ ColorStop(red, 0.5f) });
+  color_stops.push_back({ ColorStop(red, 0.0f), ColorStop(red, 0.5f),
+                          ColorStop(blue, 0.5f), ColorStop(blue, 1.0f) });
+  color_stops.push_back({ ColorStop(clear, 0.0f), ColorStop(red, 0.0f),
+                          ColorStop(blue, 1.0f), ColorStop(clear, 1.0f) });
+
+  /* random stops, the places drawn from a small set so
+   * that there are many stops at the same place
+   */
+  for (unsigned int i = 0; i < m_num_random.value(); ++i)
+    {
+      color_stops.push_back(std::vector<ColorStop>(num_stops(m_rand)));
+      for (ColorStop &c : color_stops.back())
+        {
+          c.m_color = u8vec4(channel(m_rand), channel(m_rand), channel(m_rand), channel(m_rand));
+          c.m_place = float(place(m_rand)) / 20.0f;
+        }
+    }
+
+  for (const auto &stops : color_stops)
+    {
+      num_failed += check_color_stops(stops, num_checked);
+    }
+  m_color_stop_atlas.clear();
+
+  std::cout << "Analytic color stops: " << color_stops.size() << " sequences, "
+            << num_checked << " interpolates checked, "
+            << num_failed << " failed\n";
+  return num_failed == 0;
+}
+
+unsigned int
+cpu_checks::
+check_reverse_chunks(unsigned int num_indices,
+                     const std::vector<fastuidraw::detail::OpaqueChunkReverser::Chunk> &chunks,
+                     const std::vector<unsigned int> &segment_begins,
+                     const std::vector<fastuidraw::PainterIndex> &expected)
+{
+  using namespace fastuidraw;
+
+  std::vector<PainterIndex> indices(num_indices), ref(num_indices);
+  std::vector<unsigned int> bounds;
+  unsigned int segment_begin(0), c(0);
+
+  for (unsigned int i = 0; i < num_indices; ++i)
+    {
+      indices[i] = i;
+    }
+
+  /* reference: within each segment, the data before the first
+   * chunk that starts in the segment stays in place and the
+   * runs of consecutive chunks with the same z-value are copied
+   * in reverse order
+   */
+  bounds = segment_begins;
+  bounds.push_back(num_indices);
+  for (unsigned int b : bounds)
+    {
+      unsigned int segment_end(t_min(b, num_indices)), dst(segment_begin);
+      std::vector<unsigned int> groups;
+
+      if (segment_end <= segment_begin)
+        {
+          continue;
+        }
+
+      for (; c < chunks.size() && chunks[c].m_begin < segment_end; ++c)
+        {
+          if (groups.empty() || chunks[c].m_z != chunks[c - 1].m_z)
+            {
+              groups.push_back(chunks[c].m_begin);
+            }
+        }
+
+      if (groups.empty())
+        {
+          groups.push_back(segment_end);
+        }
+      for (unsigned int i = segment_begin; i < groups.front(); ++i)
+        {
+          ref[dst++] = i;
+        }
+      groups.push_back(segment_end);
+      for (unsigned int g = groups.size() - 1; g > 0; --g)
+        {
+          for (unsigned int i = groups[g - 1]; i < groups[g]; ++i)
+            {
+              ref[dst++] = i;
+            }
+        }
+      segment_begin = segment_end;
+    }
+
+  m_chunk_reverser.reverse_chunks(cast_c_array(indices),
+                                  cast_c_array(chunks),
+                                  cast_c_array(segment_begins));
+
+  if (indices != ref || (!expected.empty() && expected != ref))
+    {
+      std::cout << "\treverse_chunks() of " << num_indices << " indices, "
+                << chunks.size() << " chunks, " << segment_begins.size()
+                << " segments:\n\t\tgot      " << print_range(indices.begin(), indices.end())
+                << "\n\t\texpected " << print_range(ref.begin(), ref.end()) << "\n";
+      return 1;
+    }
+  return 0;
+}
+
+bool
+cpu_checks::
+check_opaque_draws(void)
+{
+  using namespace fastuidraw;
+
+  typedef detail::OpaqueChunkReverser::Chunk C;
+  std::uniform_int_distribution<int> num_chunks(0, 30), chunk_size(1, 12);
+  std::uniform_int_distribution<int> num_segments(0, 4), same_z(0, 2);
+  unsigned int num_checked(0), num_failed(0);
+
+  /* no draw breaks */
+  num_failed += check_reverse_chunks(12, { C{0, 1}, C{3, 2}, C{6, 2}, C{9, 3} }, {},
+                                     { 9, 10, 11, 3, 4, 5, 6, 7, 8, 0, 1, 2 });
+
+  /* a draw break between two chunks of the same z-value */
+  num_failed += check_reverse_chunks(12, { C{0, 1}, C{3, 2}, C{6, 2}, C{9, 3} }, { 6 },
+                                     { 3, 4, 5, 0, 1, 2, 9, 10, 11, 6, 7, 8 });
+
+  /* data before the first chunk stays in place */
+  num_failed += check_reverse_chunks(8, { C{2, 1}, C{5, 2} }, {},
+                                     { 0, 1, 5, 6, 7, 2, 3, 4 });
+
+  /* a draw break within a chunk, the tail of the chunk
+   * is data before the first chunk of the next segment
+   */
+  num_failed += check_reverse_chunks(10, { C{0, 1}, C{4, 2} }, { 6 },
+                                     { 4, 5, 0, 1, 2, 3, 6, 7, 8, 9 });
+
+  /* all chunks with the same z-value, and empty or
+   * out of range segments
+   */
+  num_failed += check_reverse_chunks(9, { C{0, 5}, C{3, 5}, C{6, 5} }, { 0, 0, 4, 20 },
+                                     { 0, 1, 2, 3, 4, 5, 6, 7, 8 });
+  num_checked += 5;
+
+  for (unsigned int i = 0; i < m_num_random.value(); ++i)
+    {
+      std::vector<C> chunks(num_chunks(m_rand));
+      std::vector<unsigned int> segment_begins(num_segments(m_rand));
+      unsigned int num_indices(chunk_size(m_rand) / 4);
+      int z(0);
+
+      /* runs of equal z-values as made by the Painter */
+      for (C &chunk : chunks)
+        {
+          chunk.m_begin = num_indices;
+          chunk.m_z = (same_z(m_rand) == 0) ? z : ++z;
+          num_indices += chunk_size(m_rand);
+        }
+
+      std::uniform_int_distribution<unsigned int> segment_begin(0, num_indices + 2);
+      for (unsigned int &s : segment_begins)
+        {
+          s = segment_begin(m_rand);
+        }
+      std::sort(segment_begins.begin(), segment_begins.end());
+
+      num_failed += check_reverse_chunks(num_indices, chunks, segment_begins,
+                                         std::vector<PainterIndex>());
+      ++num_checked;
+    }
+
+  /* only an opaque color brush is recognized as opaque */
+  reference_counted_ptr<ColorStopAtlas> atlas;
+  reference_counted_ptr<ColorStopSequence> cs;
+  ColorStopArray stops;
+  PainterBrush opaque, translucent, gradient;
+
+  atlas = FASTUIDRAWnew ColorStopAtlas(FASTUIDRAWnew NullColorStopBackingStore());
+  stops.add(ColorStop(u8vec4(255, 0, 0, 255), 0.0f));
+  stops.add(ColorStop(u8vec4(0, 0, 255, 255), 1.0f));
+  cs = atlas->create_analytic(stops, 64);
+
+  opaque.color(1.0f, 0.5f, 0.0f, 1.0f);
+  translucent.color(1.0f, 0.5f, 0.0f, 0.5f);
+  gradient.color(1.0f, 0.5f, 0.0f, 1.0f).linear_gradient(cs, vec2(0.0f, 0.0f), vec2(1.0f, 0.0f),
+                                                          PainterEnums::spread_clamp);
+  if (!detail::OpaqueDrawClassifier::brush_is_opaque(&opaque)
+      || detail::OpaqueDrawClassifier::brush_is_opaque(&translucent)
+      || detail::OpaqueDrawClassifier::brush_is_opaque(&gradient)
+      || detail::OpaqueDrawClassifier::brush_is_opaque(PainterData::brush_value()))
+    {
+      std::cout << "\tbrush_is_opaque() misclassifies a brush\n";
+      ++num_failed;
+    }
+  ++num_checked;
+
+  std::cout << "Opaque draws: " << num_checked << " cases checked, "
+            << num_failed << " failed\n";
+  return num_failed == 0;
+}
+
+void
+cpu_checks::
+draw_frame(void)
+{
+  bool passed(true);
+
+  m_rand.seed(m_seed.value());
+  passed = check_dash_patterns() && passed;
+  passed = check_analytic_color_stops() && passed;
+  passed = check_opaque_draws() && passed;
+
+  end_demo(passed ? 0 : -1);
+}
+
+void
+cpu_checks::
+handle_event(const SDL_Event &ev)
+{
+  if (ev.type == SDL_QUIT)
+    {
+      end_demo(0);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+  cpu_checks G;
+  return G.main(argc, argv);
+}
@@ -0,0 +1,169 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+#include <fastuidraw/gl_backend/gl_trace.hpp>
+#include "sdl_demo.hpp"
+#include "print_utils.hpp"
+
+/* Replays a trace captured with the capture_gl option of the
+ * demos and reports the time it took. To replay against Mesa's
+ * software renderer (llvmpipe) run with the environment variable
+ * LIBGL_ALWAYS_SOFTWARE=1.
+ */
+class gl_trace_replay:public sdl_demo
+{
+public:
+  gl_trace_replay(void);
+
+protected:
+  void
+  init_gl(int w, int h);
+
+  void
+  draw_frame(void);
+
+  void
+  handle_event(const SDL_Event &ev);
+
+private:
+  class by_calls
+  {
+  public:
+    explicit
+    by_calls(const fastuidraw::gl_binding::TraceReplay &R):
+      m_R(R)
+    {}
+
+    bool
+    operator()(unsigned int a, unsigned int b) const
+    {
+      return m_R.function_calls(a) > m_R.function_calls(b);
+    }
+
+  private:
+    const fastuidraw::gl_binding::TraceReplay &m_R;
+  };
+
+  void
+  print_stats(fastuidraw::gl_binding::TraceReplay &R);
+
+  command_line_argument_value<std::string> m_trace;
+  command_line_argument_value<bool> m_null_replay;
+  command_line_argument_value<unsigned int> m_num_null_replays;
+  command_line_argument_value<bool> m_print_functions;
+};
+
+gl_trace_replay::
+gl_trace_replay(void):
+  sdl_demo("Replay a GL trace captured with the option capture_gl"),
+  m_trace("", "trace", "trace file to replay", *this),
+  m_null_replay(false, "null_replay",
+                "if true, do not issue the GL calls of the trace, only "
+                "decode them; this measures the cost of the replay itself",
+                *this),
+  m_num_null_replays(1, "num_null_replays",
+                     "number of times to replay when null_replay is true; "
+                     "a trace is replayed to GL only once because it expects "
+                     "a freshly created GL context", *this),
+  m_print_functions(true, "print_functions",
+                    "if true, print the number of calls and bytes of "
+                    "each GL function of the trace", *this)
+{}
+
+void
+gl_trace_replay::
+init_gl(int w, int h)
+{
+  FASTUIDRAWunused(w);
+  FASTUIDRAWunused(h);
+}
+
+void
+gl_trace_replay::
+print_stats(fastuidraw::gl_binding::TraceReplay &R)
+{
+  std::cout << "Trace \"" << m_trace.value() << "\":\n"
+            << "\tcalls: " << R.number_calls() << "\n"
+            << "\tbytes: " << PrintBytes(R.number_bytes()) << "\n"
+            << "\tframes: " << R.number_frames() << "\n"
+            << "\tunhandled pointers: " << R.number_unhandled_pointers() << "\n";
+
+  if (m_print_functions.value())
+    {
+      std::vector<unsigned int> order(R.number_functions());
+
+      for (unsigned int i = 0; i < order.size(); ++i)
+        {
+          order[i] = i;
+        }
+      std::sort(order.begin(), order.end(), by_calls(R));
+
+      for (unsigned int F : order)
+        {
+          std::cout << "\t\t" << std::setw(40) << std::left << R.function_name(F)
+                    << std::setw(10) << std::right << R.function_calls(F)
+                    << "  " << PrintBytes(R.function_bytes(F)) << "\n";
+        }
+    }
+}
+
+void
+gl_trace_replay::
+draw_frame(void)
+{
+  fastuidraw::gl_binding::TraceReplay R(m_trace.value().c_str());
+
+  end_demo(0);
+  if (!R.valid())
+    {
+      std::cerr << "Unable to load trace \"" << m_trace.value() << "\"\n";
+      end_demo(-1);
+      return;
+    }
+
+  print_stats(R);
+  if (m_null_replay.value())
+    {
+      for (unsigned int i = 0; i < m_num_null_replays.value(); ++i)
+        {
+          uint64_t ns;
+
+          ns = R.replay(fastuidraw::gl_binding::TraceReplay::replay_null);
+          std::cout << "Null replay " << i << ": "
+                    << static_cast<double>(ns) / 1e6 << " ms\n";
+        }
+    }
+  else
+    {
+      uint64_t ns;
+
+      ns = R.replay(fastuidraw::gl_binding::TraceReplay::replay_gl);
+      std::cout << "GL replay: " << static_cast<double>(ns) / 1e6 << " ms"
+                << " (" << fastuidraw_glGetString(GL_RENDERER) << ")\n"
+                << "Divergences: " << R.number_divergences() << "\n";
+      if (R.number_divergences() != 0)
+        {
+          std::cout << "Warning: GL object names generated by the replay differ "
+                    << "from the capture, the replay is not faithful\n";
+        }
+    }
+}
+
+void
+gl_trace_replay::
+handle_event(const SDL_Event &ev)
+{
+  if (ev.type == SDL_QUIT)
+    {
+      end_demo(0);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+  gl_trace_replay G;
+  return G.main(argc, argv);
+}
@@ -0,0 +1,285 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <random>
+
+#include <fastuidraw/text/glyph_atlas.hpp>
+#include "sdl_demo.hpp"
+#include "simple_time.hpp"
+#include "print_utils.hpp"
+
+/* Replays a trace of allocations and deallocations against a
+ * GlyphAtlas whose store holds no data, so that only the cost of
+ * the allocator is measured, and reports the time taken and the
+ * fragmentation of the store at the end. A trace is a text file
+ * with one operation per line:
+ *   a ID SIZE  -- allocate SIZE uint32_t values, refered to by ID
+ *   f ID       -- free the allocation refered to by ID
+ * If no trace is given, a trace of glyph-like churn is generated;
+ * the generated trace can be saved with record_trace.
+ */
+class NullGlyphAtlasStore:public fastuidraw::GlyphAtlasBackingStoreBase
+{
+public:
+  explicit
+  NullGlyphAtlasStore(unsigned int psize):
+    fastuidraw::GlyphAtlasBackingStoreBase(psize)
+  {}
+
+  virtual
+  void
+  set_values(unsigned int, fastuidraw::c_array<const uint32_t>)
+  {}
+
+  virtual
+  void
+  flush(void)
+  {}
+
+protected:
+  virtual
+  void
+  resize_implement(unsigned int)
+  {}
+};
+
+class trace_op
+{
+public:
+  bool m_allocate;
+  unsigned int m_id;
+  unsigned int m_size;
+};
+
+class glyph_atlas_churn:public sdl_demo
+{
+public:
+  glyph_atlas_churn(void);
+
+protected:
+  void
+  init_gl(int w, int h);
+
+  void
+  draw_frame(void);
+
+  void
+  handle_event(const SDL_Event &ev);
+
+private:
+  bool
+  load_trace(std::vector<trace_op> &ops);
+
+  void
+  generate_trace(std::vector<trace_op> &ops);
+
+  void
+  save_trace(const std::vector<trace_op> &ops);
+
+  command_line_argument_value<std::string> m_trace;
+  command_line_argument_value<std::string> m_record_trace;
+  command_line_argument_value<unsigned int> m_num_ops;
+  command_line_argument_value<unsigned int> m_num_live;
+  command_line_argument_value<unsigned int> m_seed;
+  command_line_argument_value<unsigned int> m_initial_size;
+  command_line_argument_value<unsigned int> m_num_replays;
+};
+
+glyph_atlas_churn::
+glyph_atlas_churn(void):
+  sdl_demo("Replay an allocation trace against a GlyphAtlas"),
+  m_trace("", "trace", "trace file to replay, if empty a trace is generated", *this),
+  m_record_trace("", "record_trace", "if non-empty, file to which to save the replayed trace", *this),
+  m_num_ops(1000000, "num_ops", "number of operations of a generated trace", *this),
+  m_num_live(4000, "num_live", "number of allocations a generated trace keeps alive on average", *this),
+  m_seed(1, "seed", "seed of the random generator of a generated trace", *this),
+  m_initial_size(1024 * 1024, "initial_size", "initial size of the GlyphAtlas store", *this),
+  m_num_replays(5, "num_replays", "number of times to replay the trace", *this)
+{}
+
+void
+glyph_atlas_churn::
+init_gl(int w, int h)
+{
+  FASTUIDRAWunused(w);
+  FASTUIDRAWunused(h);
+}
+
+bool
+glyph_atlas_churn::
+load_trace(std::vector<trace_op> &ops)
+{
+  std::ifstream file(m_trace.value().c_str());
+  char c;
+
+  if (!file)
+    {
+      return false;
+    }
+
+  while (file >> c)
+    {
+      trace_op op;
+
+      op.m_allocate = (c == 'a');
+      op.m_size = 0;
+      file >> op.m_id;
+      if (op.m_allocate)
+        {
+          file >> op.m_size;
+        }
+      ops.push_back(op);
+    }
+  return true;
+}
+
+void
+glyph_atlas_churn::
+generate_trace(std::vector<trace_op> &ops)
+{
+  std::mt19937 generator(m_seed.value());
+  std::uniform_int_distribution<unsigned int> small_glyph(16, 256), large_glyph(256, 4096);
+  std::uniform_int_distribution<unsigned int> percent(0, 99);
+  std::vector<unsigned int> live;
+  unsigned int next_id(0);
+
+  /* mostly small glyphs with a tail of large ones, the
+   * number of live allocations wanders around num_live
+   */
+  for (unsigned int i = 0; i < m_num_ops.value(); ++i)
+    {
+      trace_op op;
+      unsigned int p(percent(generator));
+
+      op.m_allocate = live.empty() || (live.size() < m_num_live.value() && p < 60)
+        || (live.size() >= m_num_live.value() && p < 40);
+      if (op.m_allocate)
+        {
+          op.m_id = next_id++;
+          op.m_size = (percent(generator) < 90) ?
+            small_glyph(generator) :
+            large_glyph(generator);
+          live.push_back(op.m_id);
+        }
+      else
+        {
+          std::uniform_int_distribution<unsigned int> pick(0, live.size() - 1);
+          unsigned int k(pick(generator));
+
+          op.m_id = live[k];
+          op.m_size = 0;
+          live[k] = live.back();
+          live.pop_back();
+        }
+      ops.push_back(op);
+    }
+}
+
+void
+glyph_atlas_churn::
+save_trace(const std::vector<trace_op> &ops)
+{
+  std::ofstream file(m_record_trace.value().c_str());
+
+  for (const trace_op &op : ops)
+    {
+      if (op.m_allocate)
+        {
+          file << "a " << op.m_id << " " << op.m_size << "\n";
+        }
+      else
+        {
+          file << "f " << op.m_id << "\n";
+        }
+    }
+}
+
+void
+glyph_atlas_churn::
+draw_frame(void)
+{
+  std::vector<trace_op> ops;
+  unsigned int max_id(0), max_size(0);
+
+  end_demo(0);
+  if (!m_trace.value().empty())
+    {
+      if (!load_trace(ops))
+        {
+          std::cerr << "Unable to load trace \"" << m_trace.value() << "\"\n";
+          end_demo(-1);
+          return;
+        }
+    }
+  else
+    {
+      generate_trace(ops);
+    }
+
+  if (!m_record_trace.value().empty())
+    {
+      save_trace(ops);
+    }
+
+  for (const trace_op &op : ops)
+    {
+      max_id = fastuidraw::t_max(max_id, op.m_id);
+      max_size = fastuidraw::t_max(max_size, op.m_size);
+    }
+
+  std::vector<uint32_t> data(max_size, 0u);
+  std::vector<fastuidraw::range_type<int> > locations(max_id + 1);
+
+  std::cout << "Trace: " << ops.size() << " operations\n";
+  for (unsigned int replay = 0; replay < m_num_replays.value(); ++replay)
+    {
+      fastuidraw::reference_counted_ptr<NullGlyphAtlasStore> store;
+      fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlas> atlas;
+      simple_time timer;
+      int64_t us;
+
+      store = FASTUIDRAWnew NullGlyphAtlasStore(m_initial_size.value());
+      atlas = FASTUIDRAWnew fastuidraw::GlyphAtlas(store);
+      for (const trace_op &op : ops)
+        {
+          fastuidraw::range_type<int> &R(locations[op.m_id]);
+          if (op.m_allocate)
+            {
+              fastuidraw::c_array<const uint32_t> values(&data[0], op.m_size);
+
+              R.m_begin = atlas->allocate_data(values);
+              R.m_end = R.m_begin + op.m_size;
+            }
+          else
+            {
+              atlas->deallocate_data(R.m_begin, R.m_end - R.m_begin);
+            }
+        }
+      us = timer.elapsed_us();
+
+      std::cout << "Replay " << replay << ": " << static_cast<double>(us) / 1000.0
+                << " ms (" << 1000.0 * static_cast<double>(us) / static_cast<double>(ops.size())
+                << " ns per operation)\n"
+                << "\tstore size: " << PrintBytes(4u * store->size()) << "\n"
+                << "\tallocated: " << PrintBytes(4u * atlas->data_allocated()) << "\n"
+                << "\tfree blocks: " << atlas->number_free_data_blocks() << "\n"
+                << "\tlargest free block: " << PrintBytes(4u * atlas->largest_free_data_block()) << "\n";
+    }
+}
+
+void
+glyph_atlas_churn::
+handle_event(const SDL_Event &ev)
+{
+  if (ev.type == SDL_QUIT)
+    {
+      end_demo(0);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+  glyph_atlas_churn G;
+  return G.main(argc, argv);
+}
@@ -193,11 +193,33 @@ class ColorStopAtlas;
     ColorStopAtlas&
     atlas(void) const;
 
+    /*!
+     * Returns false if the ColorStopSequence was created by
+     * ColorStopAtlas::create_analytic() and its color stops are
+     * not placed on the atlas; in that case texel_location()
+     * and width() are both zero and the color stops are instead
+     * packed directly into the data of a gradient brush, see
+     * \ref PainterGradientBrushShaderData.
+     */
+    bool
+    on_atlas(void) const;
+
+    /*!
+     * Returns the ColorStop values, sorted by ColorStop::m_place,
+     * from which the ColorStopSequence was created.
+     */
+    c_array<const ColorStop>
+    color_stops(void) const;
+
   private:
     friend class ColorStopAtlas;
 
     ColorStopSequence(const ColorStopArray &color_stops,
-                      ColorStopAtlas& atlas, unsigned int pwidth);
+                      ColorStopAtlas& atlas, unsigned int pwidth,
+                      bool shared);
+
+    ColorStopSequence(const ColorStopArray &color_stops,
+                      ColorStopAtlas& atlas);
     void *m_d;
   };
 
@@ -132,6 +132,16 @@ namespace fastuidraw
     public reference_counted<ColorStopAtlas>::concurrent
   {
   public:
+    enum
+      {
+        /*!
+         * The maximum number of ColorStop values a \ref
+         * ColorStopSequence made by create_analytic() may
+         * have to not be placed on the atlas.
+         */
+        max_analytic_color_stops = 16
+      };
+
     /*!
      * Ctor.
      * \param pbacking_store handle to the ColorStopBackingStore
@@ -154,6 +164,82 @@ namespace fastuidraw
     reference_counted_ptr<ColorStopSequence>
     create(const ColorStopArray &color_stops, unsigned int pwidth);
 
+    /*!
+     * Create a \ref ColorStopSequence onto this \ref ColorStopAtlas
+     * whose texels are shared with every other \ref ColorStopSequence
+     * created by create_shared() whose discretized color values are
+     * the same. The first such call allocates and uploads the texels,
+     * later calls only increment a reference count on the interval.
+     * When the last \ref ColorStopSequence of an interval goes out of
+     * scope, the interval stays on the atlas (so that a later call with
+     * the same values does not upload again) until the atlas needs the
+     * room: when no layer has room for an allocation, the least recently
+     * used of these unused intervals are freed first and the backing
+     * store is only resized if that does not make enough room. Intervals
+     * released while resources are locked (see lock_resources()) are not
+     * freed for that purpose until the resources are unlocked.
+     * \param color_stops source color stops to use
+     * \param pwidth specifies number of texels to occupy on the ColorStopAtlas.
+     *               The discretization of the color stop values is specified by
+     *               the width. Additionally, the width is clamped to \ref
+     *               max_width().
+     */
+    reference_counted_ptr<ColorStopSequence>
+    create_shared(const ColorStopArray &color_stops, unsigned int pwidth);
+
+    /*!
+     * Create a \ref ColorStopSequence whose color is evaluated
+     * exactly from its ColorStop values by the gradient brush
+     * shaders instead of being sampled from the atlas. If
+     * color_stops has no more than \ref max_analytic_color_stops
+     * values, the returned ColorStopSequence is not placed on the
+     * atlas (see ColorStopSequence::on_atlas()) and the stops are
+     * packed into the data of the gradient brush, so that hard
+     * color stops (two stops at the same place) are exact. If
+     * there are more stops, the return value is the same as
+     * create(color_stops, pwidth). Returns nullptr if color_stops
+     * is empty.
+     * \param color_stops source color stops to use
+     * \param pwidth width passed to create() if there are more
+     *               than \ref max_analytic_color_stops color stops
+     */
+    reference_counted_ptr<ColorStopSequence>
+    create_analytic(const ColorStopArray &color_stops, unsigned int pwidth);
+
+    /*!
+     * Returns the number of intervals made by create_shared()
+     * that are not used by any \ref ColorStopSequence but are
+     * kept on the atlas for later calls to create_shared().
+     */
+    unsigned int
+    number_unused_shared(void) const;
+
+    /*!
+     * Free all the intervals made by create_shared() that are
+     * not used by any \ref ColorStopSequence, see create_shared().
+     * If the resources are locked (see lock_resources()) the
+     * intervals released while locked are not freed.
+     */
+    void
+    clear_unused_shared(void);
+
+    /*!
+     * Returns the largest width that can be allocated on
+     * the atlas without resizing the ColorStopBackingStore,
+     * i.e. the largest free interval over all the layers.
+     */
+    int
+    largest_free_interval(void) const;
+
+    /*!
+     * Returns the number of free intervals summed over all
+     * the layers; with largest_free_interval() and
+     * total_available() this gives a measure of the
+     * fragmentation of the atlas.
+     */
+    int
+    number_free_intervals(void) const;
+
     /*!
      * Returns the width of the ColorStopBackingStore
      * of the atlas.
@@ -211,18 +297,23 @@ namespace fastuidraw
      * the offset into the layer in ivec2::x() and the which
      * layer in ivec2::y().
      * \param data data to place on atlas
+     * \param shared if true, the texels are shared with those
+     *               of any other shared allocation with the same
+     *               values, see create_shared()
      */
     ivec2
-    allocate(c_array<const u8vec4> data);
+    allocate(c_array<const u8vec4> data, bool shared);
 
     /*!
      * Mark a region to be free on the atlas
      * \param location .x() gives the offset into the layer to
      *                 mark as free and .y() gives the layer
      * \param width number of elements to mark as free
+     * \param shared if true, the region was allocated by
+     *               allocate() with shared as true
      */
     void
-    deallocate(ivec2 location, int width);
+    deallocate(ivec2 location, int width, bool shared);
 
     /*!
      * Returns the total number of color stops that are available
@@ -538,6 +538,75 @@ private:
   void *m_d;
 };
 
+/*!
+ * \brief
+ * A ProgramBinaryCache stores the program binaries (as returned
+ * by glGetProgramBinary()) of linked \ref Program objects in a
+ * directory so that later runs can skip compiling and linking.
+ * An entry is keyed by the source code of each shader of the
+ * \ref Program together with the GL vendor, renderer, version
+ * and shading language version strings and the version of
+ * FastUIDraw (see \ref FASTUIDRAW_VERSION_MINOR). If the GL
+ * implementation rejects a stored binary, the \ref Program is
+ * compiled and linked from source and the entry is replaced. A ProgramBinaryCache may
+ * be shared between threads and \ref Program objects.
+ */
+class ProgramBinaryCache:
+  public reference_counted<ProgramBinaryCache>::concurrent
+{
+public:
+  /*!
+   * Ctor.
+   * \param directory directory in which to store the program
+   *                  binaries; the directory must already exist.
+   */
+  explicit
+  ProgramBinaryCache(c_string directory);
+
+  ~ProgramBinaryCache();
+
+  /*!
+   * Returns the directory in which program binaries are stored.
+   */
+  c_string
+  directory(void) const;
+
+  /*!
+   * Returns the number of \ref Program objects that were
+   * assembled from a stored program binary.
+   */
+  unsigned int
+  number_hits(void) const;
+
+  /*!
+   * Returns the number of \ref Program objects for which
+   * no stored program binary was found.
+   */
+  unsigned int
+  number_misses(void) const;
+
+  /*!
+   * Returns the number of \ref Program objects for which a
+   * stored program binary was found but could not be used,
+   * either because the GL implementation rejected it or
+   * because the file was not valid.
+   */
+  unsigned int
+  number_rejected(void) const;
+
+  /*!
+   * Returns the sum, in seconds, over all hits of the time it
+   * took to originally build the \ref Program from source minus
+   * the time it took to load the program binary.
+   */
+  float
+  time_saved(void) const;
+
+private:
+  friend class Program;
+  void *m_d;
+};
+
 /*!
  * \brief
  * Class for creating and using GLSL programs.
@@ -1112,6 +1181,27 @@ public:
           const PreLinkActionArray &action = PreLinkActionArray(),
           const ProgramInitializerArray &initers = ProgramInitializerArray());
 
+  /*!
+   * Ctor. The Program will first try to assemble from a program
+   * binary stored in a \ref ProgramBinaryCache and, if it builds
+   * from source, store its program binary in the cache.
+   * \param vert_shader pointer to vertex shader to use for the Program
+   * \param frag_shader pointer to fragment shader to use for the Program
+   * \param action specifies actions to perform before and
+   *               after linking of the Program. The actions must
+   *               be the same for all Program objects built with
+   *               the same shader source code.
+   * \param initers one-time initialization actions to perform at GLSL
+   *                program creation
+   * \param binary_cache \ref ProgramBinaryCache to use; a null
+   *                     value indicates to not use a cache
+   */
+  Program(const glsl::ShaderSource &vert_shader,
+          const glsl::ShaderSource &frag_shader,
+          const PreLinkActionArray &action,
+          const ProgramInitializerArray &initers,
+          const reference_counted_ptr<ProgramBinaryCache> &binary_cache);
+
   /*!
    * Ctor. Create a \ref Program from a previously linked GL shader.
    * \param pname GL ID of previously linked shader
@@ -1130,6 +1220,34 @@ public:
   void
   use_program(void);
 
+  /*!
+   * Issue the GL commands to compile the shaders and link
+   * the Program without waiting for GL to complete them.
+   * If the GL implementation supports GL_KHR_parallel_shader_compile
+   * (or GL_ARB_parallel_shader_compile), the work may then proceed
+   * in the background; use build_complete() to query if it has
+   * finished. The GL context must be current. Calling any method
+   * that requires the Program to be linked (for example
+   * use_program()) before build_complete() returns true blocks
+   * until GL has finished the work.
+   */
+  void
+  begin_build(void);
+
+  /*!
+   * Returns true if the Program has been built or if the
+   * work issued by begin_build() has completed, i.e. if
+   * use_program() will not block waiting for the GLSL
+   * compiler. If the GL implementation does not support
+   * GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile
+   * then returns true as soon as begin_build() has been called.
+   * Returns false if begin_build() has not been called and
+   * the Program has not yet been built. The GL context must
+   * be current.
+   */
+  bool
+  build_complete(void);
+
   /*!
    * Returns the GL name (i.e. ID assigned by GL,
    * for use in glUseProgram) of this Program.
@@ -1159,6 +1277,15 @@ public:
   float
   program_build_time(void);
 
+  /*!
+   * Returns true if the Program was assembled from a
+   * program binary of a \ref ProgramBinaryCache. This
+   * function should only be called either after use_program()
+   * has been called or only when the GL context is current.
+   */
+  bool
+  from_binary_cache(void);
+
   /*!
    * Returns true if and only if this Program
    * successfully linked. This function should
@@ -0,0 +1,206 @@
+/*!
+ * \file gl_trace.hpp
+ * \brief file gl_trace.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+
+#ifndef FASTUIDRAW_GL_TRACE_HPP
+#define FASTUIDRAW_GL_TRACE_HPP
+
+#include <stdint.h>
+#include <fastuidraw/util/util.hpp>
+
+namespace fastuidraw {
+
+namespace gl_binding {
+/*!\addtogroup GLUtility
+ * @{
+ */
+
+/*!
+ * Start capturing all GL calls made through the gl_binding
+ * function pointers to a binary trace file. A trace holds
+ * every call with its arguments together with the data that
+ * the call reads from client memory (buffer and texture data,
+ * shader sources, uniform values and so on) and the data
+ * written through buffers mapped with glMapBufferRange. The
+ * trace can be replayed with \ref TraceReplay. Capturing
+ * requires that get_proc_function() has been called and that
+ * the GL calls are made from a single thread. Returns false
+ * if the file could not be opened, if capturing is not
+ * supported (e.g. under Emscripten) or if already capturing.
+ * \param filename file to which to write the trace
+ */
+bool
+begin_capture(c_string filename);
+
+/*!
+ * Stop capturing started with begin_capture()
+ * and close the trace file.
+ */
+void
+end_capture(void);
+
+/*!
+ * Returns true if GL calls are being captured.
+ */
+bool
+capturing(void);
+
+/*!
+ * Add a frame marker to the trace being captured,
+ * typically called on each buffer swap. Does nothing
+ * if not capturing.
+ */
+void
+capture_frame_marker(void);
+
+/*!
+ * \brief
+ * A TraceReplay loads a trace written by begin_capture()
+ * and re-issues its GL calls. Replaying requires that the
+ * GL context is current, that get_proc_function() has been
+ * called and, for the trace to replay faithfully, that the
+ * context is freshly created: GL object names are not
+ * remapped and are assumed to be generated in the same
+ * order as when the trace was captured. GLsync objects
+ * and bindless texture handles returned by GL are remapped.
+ */
+class TraceReplay:noncopyable
+{
+public:
+  /*!
+   * Enumeration to specify how to replay a trace
+   */
+  enum mode_t
+    {
+      /*!
+       * Issue the GL calls to the current GL context
+       * and wait for GL to finish them.
+       */
+      replay_gl,
+
+      /*!
+       * Decode the calls and their data as for \ref
+       * replay_gl, but do not issue them to GL; this
+       * measures the cost of the replay itself.
+       */
+      replay_null,
+    };
+
+  /*!
+   * Ctor.
+   * \param filename file from which to load the trace
+   */
+  explicit
+  TraceReplay(c_string filename);
+
+  ~TraceReplay();
+
+  /*!
+   * Returns true if the trace file was read
+   * and decoded successfully.
+   */
+  bool
+  valid(void) const;
+
+  /*!
+   * Replay the trace and return the time, in nanoseconds,
+   * that the replay took.
+   * \param mode how to replay the trace
+   */
+  uint64_t
+  replay(enum mode_t mode);
+
+  /*!
+   * Returns the number of GL calls in the trace.
+   */
+  unsigned int
+  number_calls(void) const;
+
+  /*!
+   * Returns the number of bytes of data the GL calls
+   * of the trace read from client memory or from
+   * mapped buffers.
+   */
+  uint64_t
+  number_bytes(void) const;
+
+  /*!
+   * Returns the number of frame markers in the trace,
+   * see capture_frame_marker().
+   */
+  unsigned int
+  number_frames(void) const;
+
+  /*!
+   * Returns the number of different GL functions
+   * called in the trace.
+   */
+  unsigned int
+  number_functions(void) const;
+
+  /*!
+   * Returns the name of a GL function called in the trace.
+   * \param F which function with 0 <= F < number_functions()
+   */
+  c_string
+  function_name(unsigned int F) const;
+
+  /*!
+   * Returns the number of times a GL function is called in the trace.
+   * \param F which function with 0 <= F < number_functions()
+   */
+  unsigned int
+  function_calls(unsigned int F) const;
+
+  /*!
+   * Returns the number of bytes of data the calls to a GL function
+   * read, see number_bytes().
+   * \param F which function with 0 <= F < number_functions()
+   */
+  uint64_t
+  function_bytes(unsigned int F) const;
+
+  /*!
+   * Returns the number of pointer arguments in the trace
+   * whose data the capture did not know how to size; such
+   * arguments are replayed with the pointer value of the
+   * capture, which is only correct if it is an offset into
+   * a bound buffer object.
+   */
+  unsigned int
+  number_unhandled_pointers(void) const;
+
+  /*!
+   * Returns the number of GL object names generated by the
+   * last call to replay() with \ref replay_gl that differed
+   * from the names generated when the trace was captured. If
+   * non-zero, the replay did not reproduce the captured GL
+   * calls faithfully.
+   */
+  unsigned int
+  number_divergences(void) const;
+
+private:
+  void *m_d;
+};
+/*! @} */
+}
+
+}
+
+#endif
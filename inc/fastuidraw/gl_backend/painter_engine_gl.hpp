@@ -694,6 +694,30 @@ namespace fastuidraw
         ConfigurationGL&
         blend_shader_use_switch(bool v);
 
+        /*!
+         * If true, the if-else chains of the uber shaders test the
+         * item shaders in order of decreasing usage as recorded by
+         * PainterShaderRegistrar::item_shader_usage(), see
+         * glsl::PainterShaderRegistrarGLSL::UberShaderParams::order_item_shaders_by_usage().
+         * If true, \ref Painter records item shader usage, see
+         * PainterShaderRegistrar::record_item_shader_usage(). The
+         * order is fixed when the uber shaders are built, which
+         * only happens when shaders have been registered since the
+         * last build; changes to the usage counts alone do not cause
+         * the uber shaders to be rebuilt. An application can restore
+         * usage counts from an earlier run with
+         * PainterShaderRegistrar::add_item_shader_usage() before the
+         * first frame. Default value is false.
+         */
+        bool
+        order_item_shaders_by_usage(void) const;
+
+        /*!
+         * Set the value for order_item_shaders_by_usage(void) const
+         */
+        ConfigurationGL&
+        order_item_shaders_by_usage(bool v);
+
         /*!
          * A PainterBackend for the GL/GLES backend has a set of pools
          * for the buffer objects to which to data to send to GL. Whenever
@@ -730,6 +754,59 @@ namespace fastuidraw
         ConfigurationGL&
         break_on_shader_change(bool v);
 
+        /*!
+         * If true, the draw ranges of each \ref PainterDraw are
+         * written to a GL_DRAW_INDIRECT_BUFFER when the \ref
+         * PainterDraw is unmapped and each run of draws sharing
+         * the same GLSL program and blend state is issued with a
+         * single glMultiDrawElementsIndirect() call, instead of
+         * passing arrays of counts and offsets to GL with each
+         * glMultiDrawElements() call (or a loop of glDrawElements()
+         * when glMultiDrawElements() is not available). Requires
+         * GL 4.3 or the extension GL_ARB_multi_draw_indirect; not
+         * supported in GLES. Default value is false.
+         */
+        bool
+        use_indirect_draw(void) const;
+
+        /*!
+         * Set the value for use_indirect_draw(void) const
+         */
+        ConfigurationGL&
+        use_indirect_draw(bool v);
+
+        /*!
+         * If true, opaque draws are drawn front to back before
+         * the other draws so that the depth test (which is always
+         * on with depth writes enabled) culls the fragments they
+         * hide, see PainterEngine::ConfigurationBase::reorder_opaque_draws().
+         * Default value is false.
+         */
+        bool
+        reorder_opaque_draws(void) const;
+
+        /*!
+         * Set the value for reorder_opaque_draws(void) const
+         */
+        ConfigurationGL&
+        reorder_opaque_draws(bool v);
+
+        /*!
+         * Number of consecutive draws that may be regrouped by
+         * shader state to reduce the number of GL state changes,
+         * see PainterEngine::ConfigurationBase::draw_reorder_window().
+         * A value of 0 or 1 disables the reordering. Default value
+         * is 0.
+         */
+        unsigned int
+        draw_reorder_window(void) const;
+
+        /*!
+         * Set the value for draw_reorder_window(void) const
+         */
+        ConfigurationGL&
+        draw_reorder_window(unsigned int v);
+
         /*!
          * If false, each differen item shader (including sub-shaders) is
          * realized as a separate GLSL program. This means that a GLSL
@@ -745,6 +822,32 @@ namespace fastuidraw
         ConfigurationGL&
         use_uber_item_shader(bool);
 
+        /*!
+         * Only has effect if use_uber_item_shader() is false. If true,
+         * the GLSL program for an item shader is compiled asynchronously
+         * (see \ref Program::begin_build()) on its first use. The
+         * uber-shader programs are also built asynchronously, started
+         * at the beginning of each Painter::begin() after shaders have
+         * been registered. Until the program of an item shader has
+         * finished building, draws with it use the uber-shader program
+         * if that has finished building and includes the item shader;
+         * otherwise the draw waits for the program of the item shader,
+         * which is much smaller than the uber-shader. The uber-shader is
+         * never compiled synchronously as the fallback. Requires
+         * GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile,
+         * adjust_for_context() sets the value to false if neither is
+         * supported. Costs the GL implementation the (background) work
+         * of building the uber-shader programs. Default value is false.
+         */
+        bool
+        async_item_program_build(void) const;
+
+        /*!
+         * Set the value for async_item_program_build(void) const
+         */
+        ConfigurationGL&
+        async_item_program_build(bool);
+
         /*!
          * If true, the vertex shader inputs should be qualified
          * with a layout(location=) specifier. Default value is
@@ -920,6 +1023,20 @@ namespace fastuidraw
         ConfigurationGL&
         glsl_version_override(c_string);
 
+        /*!
+         * If non-null, the GLSL programs built by the PainterEngineGL
+         * first attempt to load from, and if that fails are stored to,
+         * the returned \ref ProgramBinaryCache. Default value is null.
+         */
+        const reference_counted_ptr<ProgramBinaryCache>&
+        program_binary_cache(void) const;
+
+        /*!
+         * Set the value returned by program_binary_cache(void) const.
+         */
+        ConfigurationGL&
+        program_binary_cache(const reference_counted_ptr<ProgramBinaryCache> &v);
+
         /*!
          * Set the values for optimal performance or rendering quality
          * by quering the GL context.
@@ -409,6 +409,28 @@ namespace fastuidraw
         UberShaderParams&
         blend_shader_use_switch(bool);
 
+        /*!
+         * If true, the if/else chain that dispatches to the item
+         * shaders in the uber-shaders tests the item shaders in
+         * order of decreasing PainterShaderRegistrar::item_shader_usage()
+         * (summed over the sub-shaders of each item shader). The
+         * order is taken from the usage counts at the time the
+         * uber-shader is constructed; changes to the usage counts
+         * after that do not cause the uber-shader to be constructed
+         * again. Has no effect on dispatch done
+         * by switch(), see vert_shader_use_switch() and
+         * frag_shader_use_switch().
+         */
+        bool
+        order_item_shaders_by_usage(void) const;
+
+        /*!
+         * Set the value returned by order_item_shaders_by_usage(void) const.
+         * Default value is false.
+         */
+        UberShaderParams&
+        order_item_shaders_by_usage(bool);
+
         /*!
          * Specify how to access the data in PainterDraw::m_store
          * from the GLSL shader.
@@ -865,6 +887,46 @@ namespace fastuidraw
         bool
         use_shader(const reference_counted_ptr<ShaderType> &shader) const = 0;
       };
+
+      /*!
+       * \brief
+       * An ItemShaderUsageFilter is a \ref ShaderFilter that only
+       * accepts those item shaders that have a non-zero
+       * PainterShaderRegistrar::item_shader_usage() for at least
+       * one of their sub-shaders. Passing it to
+       * PainterShaderRegistrarGLSL::construct_item_uber_shader()
+       * gives a reduced uber-shader that only contains the item
+       * shaders that have been observed; it is the responsibility
+       * of the backend to draw with the full uber-shader those
+       * items whose shader is not in the reduced uber-shader.
+       */
+      class ItemShaderUsageFilter:public ShaderFilter<PainterItemShaderGLSL>
+      {
+      public:
+        /*!
+         * Ctor.
+         * \param registrar PainterShaderRegistrar from which to
+         *                  fetch the usage counts; the object
+         *                  must stay alive for the lifetime of
+         *                  the ItemShaderUsageFilter
+         * \param filter if non-null, an item shader must also be
+         *               accepted by this filter to be accepted
+         */
+        explicit
+        ItemShaderUsageFilter(const PainterShaderRegistrar &registrar,
+                              const ShaderFilter<PainterItemShaderGLSL> *filter = nullptr):
+          m_registrar(registrar),
+          m_filter(filter)
+        {}
+
+        virtual
+        bool
+        use_shader(const reference_counted_ptr<PainterItemShaderGLSL> &shader) const override;
+
+      private:
+        const PainterShaderRegistrar &m_registrar;
+        const ShaderFilter<PainterItemShaderGLSL> *m_filter;
+      };
     };
 
     /*!
@@ -447,6 +447,17 @@ public:
   c_string
   assembled_code(bool code_only = false) const;
 
+  /*!
+   * Returns a 64-bit hash of the string returned by
+   * assembled_code(). The hash depends only on the
+   * assembled GLSL text, so it is stable across runs of
+   * an application and two ShaderSource objects that
+   * assemble to the same GLSL have the same hash.
+   * \param code_only same meaning as in assembled_code()
+   */
+  uint64_t
+  content_hash(bool code_only = false) const;
+
 private:
   void *m_d;
 };
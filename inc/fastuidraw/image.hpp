@@ -23,6 +23,7 @@
 #include <fastuidraw/util/util.hpp>
 #include <fastuidraw/util/vecN.hpp>
 #include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/util/rect.hpp>
 
 namespace fastuidraw
 {
@@ -194,6 +195,39 @@ class ImageAtlas;
     enum format_t
     format(void) const;
 
+    /*!
+     * Returns true if the Image was created with
+     * ImageAtlas::create_sparse(), i.e. its color tiles are
+     * only made resident on the ImageAtlas on demand, see
+     * request_residency().
+     */
+    bool
+    sparse(void) const;
+
+    /*!
+     * For a sparse Image (see sparse()), request that the color
+     * tiles covering a region of the Image are made resident. A
+     * color tile is resident until it is evicted to make room for
+     * another color tile; color tiles are evicted least recently
+     * requested first once ImageAtlas::sparse_color_tile_budget()
+     * color tiles of sparse images are resident. A color tile
+     * that is not resident is sampled from a low resolution
+     * version of the image, of at most 8x8 texels, that is always
+     * resident; each of its texels is the average color of a block
+     * of color tiles. If the region is sampled at a level of detail
+     * where such a block covers no more than a pixel, no color
+     * tile is made resident. Returns
+     * false if not all of the color tiles could be made resident
+     * because every resident color tile was requested since the
+     * last call to ImageAtlas::lock_resources(). For an Image that
+     * is not sparse, does nothing and returns true.
+     * \param texel_rect region of the Image in texels of LOD 0
+     * \param texels_per_pixel number of texels of LOD 0 that a
+     *                         pixel covers
+     */
+    bool
+    request_residency(const Rect &texel_rect, float texels_per_pixel) const;
+
   protected:
     /*!
      * Protected ctor for creating an Image backed by a bindless texture;
@@ -254,7 +288,9 @@ class ImageAtlas;
     /*!
      * To be implemented by a derived class to return the number of
      * levels (including the base-image) of image source has, i.e.
-     * if the image is to have no mipmapping, return 1.
+     * if the image is to have no mipmapping, return 1. An \ref
+     * ImageSourceMipmapGenerator can wrap a source to generate the
+     * levels it does not have.
      */
     virtual
     unsigned int
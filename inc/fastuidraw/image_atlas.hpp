@@ -25,6 +25,7 @@
 #include <fastuidraw/util/util.hpp>
 #include <fastuidraw/util/vecN.hpp>
 #include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/util/worker_pool.hpp>
 #include <fastuidraw/image.hpp>
 
 namespace fastuidraw
@@ -75,6 +76,24 @@ namespace fastuidraw
     void
     set_data(int mimap_level, ivec2 dst_xy, int dst_l, unsigned int size, u8vec4 color_value) = 0;
 
+    /*!
+     * To be implemented by a derived class to copy color data from one
+     * region of the backing store to another region of the backing store
+     * that does not overlap it; used by ImageAtlas::compact() to move color
+     * tiles. The copy must see the data of all previous calls to set_data()
+     * and resize().
+     * \param mimap_level what mipmap level
+     * \param src_xy x and y coordinates of location of the data to copy
+     * \param src_l layer of location of the data to copy
+     * \param dst_xy x and y coordinates of location to which to copy the data
+     * \param dst_l layer of location to which to copy the data
+     * \param size width and height of region to copy
+     */
+    virtual
+    void
+    copy_data(int mimap_level, ivec2 src_xy, int src_l,
+              ivec2 dst_xy, int dst_l, unsigned int size) = 0;
+
     /*!
      * To be implemented by a derived class
      * to flush set_data() to the backing
@@ -92,7 +111,9 @@ namespace fastuidraw
     dimensions(void) const;
 
     /*!
-     * Resize the object by increasing the number of layers.
+     * Resize the object by changing the number of layers;
+     * when the number of layers decreases, the data of the
+     * removed layers is lost.
      */
     void
     resize(int new_num_layers);
@@ -116,9 +137,11 @@ namespace fastuidraw
     /*!
      * To be implemented by a derived class to resize the
      * object. The resize changes ONLY the number of layers
-     * of the object and only increases the value as well.
-     * When called, the return value of dimensions() is
-     * the size before the resize completes.
+     * of the object; the number of layers is decreased only
+     * by ImageAtlas::compact() after it moved all the data
+     * out of the removed layers. When called, the return
+     * value of dimensions() is the size before the resize
+     * completes.
      * \param new_num_layers new number of layers to which
      *                       to resize the underlying store.
      */
@@ -179,7 +202,9 @@ namespace fastuidraw
     dimensions(void) const;
 
     /*!
-     * Resize the object by increasing the number of layers.
+     * Resize the object by changing the number of layers;
+     * when the number of layers decreases, the data of the
+     * removed layers is lost.
      */
     void
     resize(int new_num_layers);
@@ -203,9 +228,11 @@ namespace fastuidraw
     /*!
      * To be implemented by a derived class to resize the
      * object. The resize changes ONLY the number of layers
-     * of the object and only increases the value as well.
-     * When called, the return value of dimensions() is
-     * the size before the resize completes.
+     * of the object; the number of layers is decreased only
+     * by ImageAtlas::compact() after it moved all the data
+     * out of the removed layers. When called, the return
+     * value of dimensions() is the size before the resize
+     * completes.
      * \param new_num_layers new number of layers to which
      *                       to resize the underlying store.
      */
@@ -265,6 +292,143 @@ namespace fastuidraw
     reference_counted_ptr<Image>
     create_non_atlas(int w, int h, const ImageSourceBase &image_data);
 
+    /*!
+     * Construct a batch of \ref Image objects whose Image::type() is
+     * \ref Image::on_atlas. The tiles of all the images are allocated
+     * in a single locked section of the ImageAtlas; fetching the texels,
+     * detecting the color tiles of a single color and computing the index
+     * tiles are done without holding the lock (in parallel across the
+     * images if pool is non-null) and the results are uploaded in short
+     * locked sections. Thus creating many images from several threads, or
+     * in a batch, does not serialize on the ImageAtlas. An element whose
+     * image cannot be on the atlas is created with create().
+     * \param dimensions width and height of each image
+     * \param image_data image data of each image, each \ref ImageSourceBase
+     *                   is only accessed by one thread at a time; must
+     *                   be the same size as dimensions
+     * \param out_images location to which to write the created images;
+     *                   must be the same size as dimensions
+     * \param pool if non-null, \ref WorkerPool used to create the images
+     *             in parallel; the calling thread also takes part
+     */
+    void
+    create_batch(c_array<const ivec2> dimensions,
+                 c_array<const ImageSourceBase* const> image_data,
+                 c_array<reference_counted_ptr<Image> > out_images,
+                 const reference_counted_ptr<WorkerPool> &pool =
+                 reference_counted_ptr<WorkerPool>());
+
+    /*!
+     * Construct a sparse \ref Image (see Image::sparse()) whose
+     * Image::type() is \ref Image::on_atlas. Only the index tiles
+     * of the image are created; each color tile is uploaded from
+     * image_data when the color tile is requested with
+     * Image::request_residency(). Hence, the image data is NOT
+     * copied and image_data must stay alive until the returned
+     * \ref Image is destroyed. If the ImageAtlas does not support
+     * images on the atlas, returns the same as create().
+     * \param w width of the image
+     * \param h height of the image
+     * \param image_data image data from which to source the image
+     */
+    reference_counted_ptr<Image>
+    create_sparse(int w, int h, const ImageSourceBase &image_data);
+
+    /*!
+     * Returns the maximum number of color tiles of sparse images
+     * (see create_sparse()) that are resident at any time. Default
+     * value is the number of color tiles of the color store (see
+     * color_store()) when the ImageAtlas is constructed.
+     */
+    int
+    sparse_color_tile_budget(void) const;
+
+    /*!
+     * Set the value returned by sparse_color_tile_budget(void) const.
+     * If more color tiles than the new budget are resident, the least
+     * recently requested are evicted.
+     */
+    ImageAtlas&
+    sparse_color_tile_budget(int v);
+
+    /*!
+     * Returns the number of color tiles of sparse images
+     * (see create_sparse()) that are resident.
+     */
+    int
+    number_sparse_resident_color_tiles(void) const;
+
+    /*!
+     * If true, the color tiles of images created afterwards (with
+     * create() or create_image_on_atlas(), but not create_sparse())
+     * are shared by content: the texels of all mipmap levels of a
+     * color tile are hashed and images whose tiles have the same
+     * texels share a single color tile, which is freed when the
+     * last image using it is deleted. This saves room in the color
+     * store for images that repeat tiles (icon sets, nine-patch
+     * skins, repeated thumbnails) at the cost of fetching and hashing
+     * the texels of every tile. Default value is false.
+     */
+    bool
+    deduplicate_color_tiles(void) const;
+
+    /*!
+     * Set the value returned by deduplicate_color_tiles(void) const.
+     * Changing the value does not affect images already created.
+     */
+    ImageAtlas&
+    deduplicate_color_tiles(bool v);
+
+    /*!
+     * Returns the number of bytes of the color store (across all
+     * mipmap levels) currently saved by sharing color tiles, see
+     * deduplicate_color_tiles(void) const.
+     */
+    uint64_t
+    deduplicated_color_tile_bytes(void) const;
+
+    /*!
+     * Move the color and index tiles of the images on the ImageAtlas
+     * to the lowest layers of the backing stores and decrease the number
+     * of layers of the backing stores to what the tiles need (but not
+     * below the number of layers of the backing stores when the ImageAtlas
+     * was constructed). The index tiles that reference moved tiles are
+     * rewritten. Because color tiles are moved with
+     * AtlasColorBackingStoreBase::copy_data(), this method must be called
+     * where the backing stores can execute commands (for example, for
+     * the GL backend, with the GL context current). The index tiles
+     * returned by Image::master_index_tile() are never moved (the layers
+     * of the index backing store holding them are kept), thus values
+     * packed from an Image before the call (for example a cached
+     * packed PainterBrush) remain valid after the call. Does nothing and
+     * returns false if resources are locked (see lock_resources()) or
+     * an Image of the ImageAtlas is being created by another thread.
+     * Returns true if the number of layers of a backing store decreased.
+     */
+    bool
+    compact(void);
+
+    /*!
+     * If positive, when unlock_resources() unlocks the resources,
+     * compact() is called if a backing store could lose a layer
+     * and the ratio of the tiles of the backing store that are
+     * used is below the threshold. Default value is 0, i.e. the
+     * ImageAtlas is only compacted by calling compact() directly.
+     * As with compact(), automatic compaction does not move the
+     * master index tile of any Image, so packed values made from
+     * an Image stay valid; it must only be enabled where the
+     * backing stores can execute commands when unlock_resources()
+     * is called.
+     */
+    float
+    compaction_threshold(void) const;
+
+    /*!
+     * Set the value returned by compaction_threshold(void) const.
+     */
+    ImageAtlas&
+    compaction_threshold(float v);
+
     /*!
      * Returns the size (in texels) used for the index tiles.
      */
@@ -358,9 +522,11 @@ namespace fastuidraw
      * \param w width of the image
      * \param h height of the image
      * \param image_data image data to which to initialize the image
+     * \param sparse if true, create a sparse image, see create_sparse()
      */
     reference_counted_ptr<Image>
-    create_image_on_atlas(int w, int h, const ImageSourceBase &image_data);
+    create_image_on_atlas(int w, int h, const ImageSourceBase &image_data,
+                          bool sparse);
 
     /*!
      * To be implemented by a derived class to create an Image whose
@@ -0,0 +1,166 @@
+/*!
+ * \file image_source_mipmap_generator.hpp
+ * \brief file image_source_mipmap_generator.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+
+#ifndef FASTUIDRAW_IMAGE_SOURCE_MIPMAP_GENERATOR_HPP
+#define FASTUIDRAW_IMAGE_SOURCE_MIPMAP_GENERATOR_HPP
+
+#include <fastuidraw/image.hpp>
+#include <fastuidraw/util/worker_pool.hpp>
+
+namespace fastuidraw
+{
+/*!\addtogroup Imaging
+ * @{
+ */
+
+  /*!
+   * \brief
+   * An ImageSourceMipmapGenerator is an \ref ImageSourceBase that
+   * wraps another \ref ImageSourceBase and generates the mipmap
+   * levels that the wrapped source does not provide, down to the
+   * level whose larger dimension is one texel.
+   *
+   * The levels are generated lazily: a request for texels of a
+   * generated level only computes the texels of the coarser levels
+   * that the request depends on. The computation is done in square
+   * cells of texels that are cached (least recently used cells are
+   * dropped), so the mipmap levels of neighbouring tiles of an \ref
+   * ImageAtlas share their work and the tiles of an Image that are
+   * never uploaded cost nothing. The filtering is done with floating
+   * point values in linear, pre-multiplied by alpha, color and, if
+   * a \ref WorkerPool is given, the cells needed by a request are
+   * computed in parallel.
+   */
+  class ImageSourceMipmapGenerator:
+    public ImageSourceBase,
+    noncopyable
+  {
+  public:
+    /*!
+     * Enumeration to specify the filter used to
+     * compute a mipmap level from the previous level.
+     */
+    enum filter_t
+      {
+        /*!
+         * Each texel is the average of the 2x2 block
+         * of texels of the previous level.
+         */
+        box_filter,
+
+        /*!
+         * Each texel is computed with a separable 8-tap
+         * Kaiser windowed sinc filter of the previous level;
+         * sharper than \ref box_filter at the cost of
+         * reading a margin of texels around each cell.
+         */
+        kaiser_filter,
+      };
+
+    /*!
+     * Enumeration to specify how the RGB channels
+     * of the texels of the source are encoded.
+     */
+    enum color_space_t
+      {
+        /*!
+         * The RGB channels are linear, they are
+         * filtered as they are.
+         */
+        linear_color_space,
+
+        /*!
+         * The RGB channels are sRGB encoded (as is the
+         * case for most image files), they are decoded to
+         * linear before filtering and encoded again after.
+         */
+        srgb_color_space,
+      };
+
+    /*!
+     * Ctor.
+     * \param dimensions width and height of the LOD level 0 of src;
+     *                   the LOD level n is then of size
+     *                   (max(1, dimensions.x() >> n), max(1, dimensions.y() >> n))
+     * \param src source of the texels, the object is NOT copied, thus
+     *            it must stay alive until the ImageSourceMipmapGenerator
+     *            goes out of scope. The levels of src are used as they
+     *            are, the levels after the last level of src are generated.
+     *            The format of the texels (see Image::format_t) is that
+     *            of ImageSourceBase::format() of src.
+     * \param filter filter with which to generate the levels
+     * \param color_space how the RGB channels of src are encoded
+     * \param pool if non-null, \ref WorkerPool used to compute the cells
+     *             of texels needed by a request in parallel
+     */
+    ImageSourceMipmapGenerator(uvec2 dimensions,
+                               const ImageSourceBase &src,
+                               enum filter_t filter = box_filter,
+                               enum color_space_t color_space = srgb_color_space,
+                               const reference_counted_ptr<WorkerPool> &pool =
+                               reference_counted_ptr<WorkerPool>());
+
+    virtual
+    ~ImageSourceMipmapGenerator();
+
+    /*!
+     * Returns the filter used to generate the levels.
+     */
+    enum filter_t
+    filter(void) const;
+
+    /*!
+     * Returns how the RGB channels of the source are encoded.
+     */
+    enum color_space_t
+    color_space(void) const;
+
+    /*!
+     * Drop all the cached texels of the generated levels.
+     */
+    void
+    clear_cache(void);
+
+    virtual
+    bool
+    all_same_color(ivec2 location, int square_size, u8vec4 *dst) const;
+
+    virtual
+    unsigned int
+    number_levels(void) const;
+
+    virtual
+    void
+    fetch_texels(unsigned int level, ivec2 location,
+                 unsigned int w, unsigned int h,
+                 c_array<u8vec4> dst) const;
+
+    virtual
+    enum Image::format_t
+    format(void) const;
+
+  private:
+    void *m_d;
+  };
+
+/*! @} */
+
+} //namespace
+
+#endif
@@ -238,6 +238,17 @@ public:
 
   ~StrokedPath();
 
+  /*!
+   * Construct the join and cap \ref PainterAttributeData
+   * specified by a \ref TessellatedPath::StrokingPreparationParams
+   * so that the first
+   * draw that uses them does not need to construct them.
+   * \param params specifies what join and cap data to
+   *               construct
+   */
+  void
+  prepare(const TessellatedPath::StrokingPreparationParams &params) const;
+
   /*!
    * Returns true if the \ref StrokedPath has arc.
    * If the stroked path has arcs, ALL of the attribute
@@ -423,8 +434,8 @@ private:
   friend class TessellatedPath;
 
   // only a TessellatedPath can construct a StrokedPath
-  explicit
-  StrokedPath(const TessellatedPath &P);
+  StrokedPath(const TessellatedPath &P,
+              const PartitionedTessellatedPath &partitioned);
 
   void *m_d;
 };
@@ -28,6 +28,7 @@
 #include <fastuidraw/painter/backend/painter_draw.hpp>
 #include <fastuidraw/painter/backend/painter_shader_registrar.hpp>
 #include <fastuidraw/painter/backend/painter_surface.hpp>
+#include <fastuidraw/painter/painter_profiler.hpp>
 
 
 namespace fastuidraw
@@ -164,6 +165,22 @@ namespace fastuidraw
     virtual
     void
     on_painter_begin(void) = 0;
+
+    /*!
+     * Called by a \ref Painter when the \ref PainterProfiler
+     * of the Painter is set. A derived class that supports
+     * timing the draws on the GPU reimplements this to add
+     * a GPU event to the profiler for each draw break while
+     * PainterProfiler::gpu_timing() is true. Default
+     * implementation is to do nothing.
+     * \param p profiler to which to report, may be nullptr
+     */
+    virtual
+    void
+    profiler(const reference_counted_ptr<PainterProfiler> &p)
+    {
+      FASTUIDRAWunused(p);
+    }
   };
 /*! @} */
 
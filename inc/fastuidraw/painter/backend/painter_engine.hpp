@@ -105,6 +105,47 @@ namespace fastuidraw
       ConfigurationBase&
       number_context_textures(unsigned int);
 
+      /*!
+       * If true, the draws of a \ref Painter that are opaque
+       * (solid color brush with alpha 1, filled without
+       * anti-aliasing, blended with Porter-Duff src-over or
+       * src) are sent to the \ref PainterBackend front to back
+       * before the remaining draws, which are sent afterwards
+       * in the order they were issued. The depth test then
+       * rejects the fragments of content hidden behind opaque
+       * draws before they are shaded. Default value is false.
+       */
+      bool
+      reorder_opaque_draws(void) const;
+
+      /*!
+       * Specify the return value to reorder_opaque_draws() const.
+       * Default value is false.
+       */
+      ConfigurationBase&
+      reorder_opaque_draws(bool);
+
+      /*!
+       * The number of consecutive draws a \ref PainterPacker may
+       * regroup by shader state before sending them to the
+       * \ref PainterBackend. Within the window, a draw is only
+       * moved in front of earlier draws whose screen bounding
+       * boxes do not intersect its own, so that the rendered
+       * output is unchanged while the number of state changes
+       * (and thus calls to PainterDraw::draw_break()) is reduced.
+       * A value of 0 or 1 disables the reordering. Default value
+       * is 0.
+       */
+      unsigned int
+      draw_reorder_window(void) const;
+
+      /*!
+       * Specify the return value to draw_reorder_window() const.
+       * Default value is 0.
+       */
+      ConfigurationBase&
+      draw_reorder_window(unsigned int);
+
     private:
       void *m_d;
     };
@@ -163,6 +163,59 @@ namespace fastuidraw
     void
     register_shader(const PainterShaderSet &p);
 
+    /*!
+     * Set if \ref Painter is to record item shader usage, see
+     * add_item_shader_usage(). A backend that makes use of the
+     * usage counts sets this to true. Default value is false.
+     */
+    void
+    record_item_shader_usage(bool v);
+
+    /*!
+     * Returns the value set by record_item_shader_usage(bool).
+     */
+    bool
+    record_item_shader_usage(void) const;
+
+    /*!
+     * Add to the usage counts of item shaders. If
+     * record_item_shader_usage() is true, the \ref Painter adds,
+     * for each item shader that it draws with to a color buffer,
+     * the number of indices drawn with it. An application can
+     * also use this to restore usage counts recorded in an
+     * earlier run. A backend may use the usage counts to order
+     * how its shaders are dispatched when it (re)builds its
+     * shaders; changing the counts alone does not trigger a
+     * rebuild.
+     * \param counts the element at index I is added to the usage
+     *               count of the item shader whose PainterItemShader::ID()
+     *               is I
+     */
+    void
+    add_item_shader_usage(c_array<const uint64_t> counts);
+
+    /*!
+     * Returns the usage count of the item shader whose
+     * PainterItemShader::ID() is the passed value, see
+     * add_item_shader_usage().
+     * \param shader_id PainterItemShader::ID() of the item shader
+     */
+    uint64_t
+    item_shader_usage(unsigned int shader_id) const;
+
+    /*!
+     * Returns one more than the largest PainterItemShader::ID()
+     * that has a usage count recorded.
+     */
+    unsigned int
+    item_shader_usage_size(void) const;
+
+    /*!
+     * Sets the usage count of all item shaders to zero.
+     */
+    void
+    clear_item_shader_usage(void);
+
   protected:
 
     /*!
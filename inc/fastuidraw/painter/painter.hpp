@@ -34,6 +34,7 @@
 
 #include <fastuidraw/painter/painter_brush.hpp>
 #include <fastuidraw/painter/painter_enums.hpp>
+#include <fastuidraw/painter/painter_profiler.hpp>
 #include <fastuidraw/painter/stroking_style.hpp>
 #include <fastuidraw/painter/fill_rule.hpp>
 #include <fastuidraw/painter/shader_data/painter_stroke_params.hpp>
@@ -711,6 +712,32 @@ namespace fastuidraw
     float
     curve_flatness(void);
 
+    /*!
+     * Set the duty cycle (see PainterDashedStrokeParams::duty_cycle())
+     * below which stroke_dashed_path() realizes the dash pattern on
+     * the CPU with a \ref PathDashEffect and strokes only the draw
+     * intervals (with caps at the dash boundaries) instead of having
+     * the GPU discard the fragments of the skip intervals. If
+     * StrokingStyle::m_cache_path_effect is true, the dash results
+     * are cached per dash pattern on the \ref PartitionedTessellatedPath
+     * of the stroked \ref TessellatedPath, see
+     * PartitionedTessellatedPath::SubsetSelection::apply_cached_path_effect().
+     * CPU dashing is only used by the overload of stroke_dashed_path()
+     * taking a \ref PainterDashedStrokeParams directly, and only when
+     * no \ref PathEffect is passed. CPU dashing changes how the
+     * dashes are rasterized (the ends of the dashes are caps instead
+     * of fragments discarded by the shader); a value of 0 disables
+     * it so that all dashing is done by the GPU. Default value is 0.2.
+     */
+    void
+    cpu_dashing_duty_cycle(float v);
+
+    /*!
+     * Returns the value set by cpu_dashing_duty_cycle(float).
+     */
+    float
+    cpu_dashing_duty_cycle(void) const;
+
     /*!
      * Save the current state of this Painter onto the save state stack.
      * The state is restored (and the stack popped) by called restore().
@@ -1345,6 +1372,8 @@ namespace fastuidraw
      *                    stroke_style, apply_shader_anti_aliasing,
      *                    stroking_method, effect);
      * \endcode
+     * except that, as the dash pattern is known, the dash pattern
+     * may be realized on the CPU, see cpu_dashing_duty_cycle(float).
      * \param brush brush to apply to stroking
      * \param stroking_params stroking parameters to apply to stroking
      * \param path Path to stroke
@@ -1359,12 +1388,7 @@ namespace fastuidraw
                        const Path &path, const StrokingStyle &stroke_style = StrokingStyle(),
                        bool apply_shader_anti_aliasing = true,
                        enum stroking_method_t stroking_method = stroking_method_fastest,
-                       const PathEffect *effect = nullptr)
-    {
-      stroke_dashed_path(PainterData(&brush, &stroking_params), path,
-                         stroke_style, apply_shader_anti_aliasing,
-                         stroking_method, effect);
-    }
+                       const PathEffect *effect = nullptr);
 
     /*!
      * Fill a path.
@@ -1760,6 +1784,25 @@ namespace fastuidraw
     unsigned int
     number_stats(void);
 
+    /*!
+     * Set the \ref PainterProfiler to which the Painter reports
+     * the CPU time of its drawing, clipping and layer methods and
+     * the packing of each draw. The profiler is also handed to
+     * the \ref PainterBackend to record GPU time, see
+     * PainterBackend::profiler(). Profiling adds overhead to each
+     * draw, so only set a profiler when profiling. Default value
+     * is nullptr, i.e. no profiling.
+     * \param p profiler to which to report, may be nullptr
+     */
+    void
+    profiler(const reference_counted_ptr<PainterProfiler> &p);
+
+    /*!
+     * Returns the value set by profiler(const reference_counted_ptr<PainterProfiler>&).
+     */
+    const reference_counted_ptr<PainterProfiler>&
+    profiler(void) const;
+
   private:
 
     void *m_d;
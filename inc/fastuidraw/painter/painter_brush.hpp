@@ -87,7 +87,7 @@ namespace fastuidraw
          * Number of bits used to encode the gradient type,
          * see \ref PainterBrushEnums::gradient_type_t
          */
-        gradient_num_bits = 4,
+        gradient_num_bits = PainterGradientBrushShader::number_bits,
 
         /*!
          * First bit to encode if and how the brush sources
@@ -859,6 +859,15 @@ namespace fastuidraw
       return m_data.m_image.bind_images();
     }
 
+    bool
+    samples_sparse_image(void) const override
+    {
+      return (features() & image_mask) && m_data.m_image.samples_sparse_image();
+    }
+
+    void
+    request_residency(const Rect &rect, float pixels_per_unit) const override;
+
   private:
     class brush_data
     {
@@ -887,7 +896,8 @@ namespace fastuidraw
       uint32_t gradient_bits;
 
       gradient_bits = (m_data.m_gradient.type() != gradient_non) ?
-        PainterGradientBrushShader::sub_shader_id(spread, m_data.m_gradient.type()) :
+        PainterGradientBrushShader::sub_shader_id(spread, m_data.m_gradient.type(),
+                                                  m_data.m_gradient.analytic_color_stops()) :
         0u;
       gradient_bits = pack_bits(gradient_bit0,
                                 gradient_num_bits,
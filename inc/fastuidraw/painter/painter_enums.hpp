@@ -827,6 +827,13 @@ namespace fastuidraw
          * Number of begin_coverage_buffer()/end_coverage_buffer() pairs called
          */
         num_deferred_coverages,
+
+        /*!
+         * Number of state changes (i.e. calls to PainterDraw::draw_break())
+         * avoided by regrouping draws, see
+         * PainterEngine::ConfigurationBase::draw_reorder_window().
+         */
+        num_draw_breaks_saved,
       };
 
     /*!
@@ -0,0 +1,328 @@
+/*!
+ * \file painter_profiler.hpp
+ * \brief file painter_profiler.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+
+#ifndef FASTUIDRAW_PAINTER_PROFILER_HPP
+#define FASTUIDRAW_PAINTER_PROFILER_HPP
+
+#include <stdint.h>
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/util/reference_counted.hpp>
+#include <fastuidraw/painter/shader/painter_shader.hpp>
+
+namespace fastuidraw
+{
+/*!\addtogroup Painter
+ * @{
+ */
+
+  /*!
+   * \brief
+   * A PainterProfiler records where the time of drawing with a
+   * \ref Painter goes. When a PainterProfiler is set on a \ref
+   * Painter with Painter::profiler(), it records
+   *  - a CPU event for each call to a drawing, clipping or layer
+   *    method of the Painter (nested calls give nested events),
+   *  - for each item shader and brush shader, how many draws,
+   *    headers and indices used the shader and the CPU time spent
+   *    packing them, and
+   *  - if gpu_timing() is true and the \ref PainterBackend supports
+   *    it, a GPU event for each draw break giving the GPU time of
+   *    the draw calls issued between consecutive draw breaks.
+   *
+   * Recording is cumulative; the events are kept until clear()
+   * is called. All times are in nanoseconds; CPU events are timed
+   * relative to when the PainterProfiler was constructed or last
+   * cleared.
+   */
+  class PainterProfiler:public reference_counted<PainterProfiler>::concurrent
+  {
+  public:
+    /*!
+     * Enumeration to specify the source of an \ref Event
+     */
+    enum event_type_t
+      {
+        /*!
+         * Event is a time interval of the CPU
+         */
+        cpu_event,
+
+        /*!
+         * Event is a time interval of the GPU
+         */
+        gpu_event,
+      };
+
+    /*!
+     * \brief
+     * An Event is a named interval of time.
+     */
+    class Event
+    {
+    public:
+      /*!
+       * Name of the event, the string is not copied and
+       * must stay alive for the lifetime of the profiler.
+       */
+      c_string m_name;
+
+      /*!
+       * Source of the event
+       */
+      enum event_type_t m_type;
+
+      /*!
+       * Start of the event. For a \ref gpu_event the GPU does not
+       * give a start time, so the GPU events of a submission are
+       * placed back to back starting at the time the submission
+       * started on the CPU.
+       */
+      uint64_t m_begin;
+
+      /*!
+       * Duration of the event
+       */
+      uint64_t m_duration;
+
+      /*!
+       * For a \ref cpu_event, the number of events that were
+       * open when the event started; 0 for a \ref gpu_event.
+       */
+      unsigned int m_depth;
+
+      /*!
+       * For a \ref gpu_event, the item shader group (see
+       * PainterShader::group(const PainterShaderRegistrar&) const)
+       * of the draws the event times; 0 for a \ref cpu_event.
+       */
+      uint32_t m_item_group;
+    };
+
+    /*!
+     * \brief
+     * The amount of packing work done with a single shader.
+     */
+    class ShaderStats
+    {
+    public:
+      ShaderStats(void):
+        m_item_group(0),
+        m_number_draws(0),
+        m_number_headers(0),
+        m_number_indices(0),
+        m_pack_time(0)
+      {}
+
+      /*!
+       * The shader
+       */
+      reference_counted_ptr<const PainterShader> m_shader;
+
+      /*!
+       * For an item shader, the value of PainterShader::group(const
+       * PainterShaderRegistrar&) const of the shader, to join against
+       * GroupStats::m_item_group.
+       */
+      uint32_t m_item_group;
+
+      /*!
+       * Number of draws that used the shader
+       */
+      unsigned int m_number_draws;
+
+      /*!
+       * Number of headers packed with the shader
+       */
+      unsigned int m_number_headers;
+
+      /*!
+       * Number of indices packed with the shader
+       */
+      unsigned int m_number_indices;
+
+      /*!
+       * CPU time spent packing the draws that used the shader
+       */
+      uint64_t m_pack_time;
+    };
+
+    /*!
+     * \brief
+     * The GPU time of a single item shader group. Note that
+     * a backend may only break draws (and thus only time them)
+     * when the GPU program changes; for example the GL backend
+     * with the uber-shader reports only the bits of the group
+     * that select the GPU program.
+     */
+    class GroupStats
+    {
+    public:
+      GroupStats(void):
+        m_item_group(0),
+        m_number_draw_breaks(0),
+        m_gpu_time(0)
+      {}
+
+      /*!
+       * The item shader group
+       */
+      uint32_t m_item_group;
+
+      /*!
+       * Number of GPU events with the item shader group
+       */
+      unsigned int m_number_draw_breaks;
+
+      /*!
+       * Total GPU time of the GPU events
+       */
+      uint64_t m_gpu_time;
+    };
+
+    /*!
+     * Ctor.
+     */
+    PainterProfiler(void);
+
+    ~PainterProfiler();
+
+    /*!
+     * If true, a \ref PainterBackend that supports GPU
+     * timing queries times each draw break on the GPU.
+     * Default value is false.
+     */
+    bool
+    gpu_timing(void) const;
+
+    /*!
+     * Set the value returned by gpu_timing(void) const.
+     */
+    PainterProfiler&
+    gpu_timing(bool v);
+
+    /*!
+     * Clear all recorded events and statistics and restart
+     * the time at 0. It is an error to call clear() while a
+     * CPU event is open.
+     */
+    void
+    clear(void);
+
+    /*!
+     * Returns the time, relative to the last clear()
+     * (or construction), in nanoseconds.
+     */
+    uint64_t
+    time_now(void) const;
+
+    /*!
+     * Open a CPU event starting now. Each call to
+     * begin_cpu_event() must be matched by a call
+     * to end_cpu_event().
+     * \param name name of the event, the string is not copied
+     */
+    void
+    begin_cpu_event(c_string name);
+
+    /*!
+     * Close the last opened CPU event.
+     */
+    void
+    end_cpu_event(void);
+
+    /*!
+     * Add a GPU event, called by a \ref PainterBackend.
+     * \param name name of the event, the string is not copied
+     * \param begin start time of the event
+     * \param duration GPU time of the event
+     * \param item_group item shader group of the draws of the event
+     */
+    void
+    add_gpu_event(c_string name, uint64_t begin,
+                  uint64_t duration, uint32_t item_group);
+
+    /*!
+     * Record the packing of a draw, called by the \ref Painter.
+     * \param item_shader item shader of the draw
+     * \param item_group group of item_shader, see
+     *                   PainterShader::group(const PainterShaderRegistrar&) const
+     * \param brush_shader brush shader of the draw, may be nullptr
+     * \param number_headers number of headers packed for the draw
+     * \param number_indices number of indices packed for the draw
+     * \param pack_time CPU time spent packing the draw
+     */
+    void
+    add_pack_sample(const PainterShader *item_shader,
+                    uint32_t item_group,
+                    const PainterShader *brush_shader,
+                    unsigned int number_headers,
+                    unsigned int number_indices,
+                    uint64_t pack_time);
+
+    /*!
+     * Returns the recorded events sorted by Event::m_type and
+     * then in the order in which they were started. The return
+     * value is invalidated by any call that records or clears.
+     */
+    c_array<const Event>
+    events(void) const;
+
+    /*!
+     * Returns the statistics for each item shader used.
+     * The return value is invalidated by any call that
+     * records or clears.
+     */
+    c_array<const ShaderStats>
+    item_shader_stats(void) const;
+
+    /*!
+     * Returns the statistics for each brush shader used.
+     * The return value is invalidated by any call that
+     * records or clears.
+     */
+    c_array<const ShaderStats>
+    brush_shader_stats(void) const;
+
+    /*!
+     * Returns the GPU time for each item shader group that
+     * had a GPU event. The return value is invalidated by any
+     * call that records or clears.
+     */
+    c_array<const GroupStats>
+    group_stats(void) const;
+
+    /*!
+     * Returns the recorded events as a JSON string in the Chrome
+     * trace event format (loadable by chrome://tracing and by
+     * Perfetto). CPU events are on thread 0 and GPU events on
+     * thread 1. The returned string stays valid until the next
+     * call to chrome_trace_json() or until the PainterProfiler
+     * is destroyed.
+     */
+    c_string
+    chrome_trace_json(void) const;
+
+  private:
+    void *m_d;
+  };
+/*! @} */
+}
+
+#endif
@@ -68,10 +68,18 @@ namespace fastuidraw
          */
         spread_type_bit0 = 0,
 
+        /*!
+         * bit up if the color stops are packed into the data of
+         * the brush and evaluated exactly instead of sampled from
+         * the \ref ColorStopAtlas, i.e. ColorStopSequence::on_atlas()
+         * is false
+         */
+        analytic_color_stops_bit = spread_type_bit0 + spread_type_num_bits,
+
         /*!
          * first bit used to encode the \ref PainterBrushEnums::gradient_type_t
          */
-        gradient_type_bit0 = spread_type_bit0 + spread_type_num_bits,
+        gradient_type_bit0 = analytic_color_stops_bit + 1,
 
         /*!
          * The total number of bits needed to specify the sub-shader IDs.
@@ -88,7 +96,7 @@ namespace fastuidraw
          * the total number of sub-shaders that a parent shader for
          * a specific gradient type has.
          */
-        number_sub_shaders_of_specific_gradient = 1u << spread_type_num_bits
+        number_sub_shaders_of_specific_gradient = 1u << (spread_type_num_bits + 1)
       };
 
     /*!
@@ -101,6 +109,11 @@ namespace fastuidraw
          */
         gradient_spread_type_mask = FASTUIDRAW_MASK(spread_type_bit0, spread_type_num_bits),
 
+        /*!
+         * mask generated from \ref analytic_color_stops_bit
+         */
+        analytic_color_stops_mask = FASTUIDRAW_MASK(analytic_color_stops_bit, 1),
+
         /*!
          * mask generated from \ref gradient_type_bit0 and \ref gradient_type_num_bits
          */
@@ -111,16 +124,16 @@ namespace fastuidraw
      * Ctor.
      * \param generic \ref PainterBrushShader that supports all gradient and
      *                sweep types via its sub-shaders which are indexed by \ref
-     *                sub_shader_id(enum spread_type_t, enum gradient_type_t)
+     *                sub_shader_id(enum spread_type_t, enum gradient_type_t, bool)
      * \param linear \ref PainterBrushShader that performs linear gradient
      *               that supports all sweep types via its sub-shaders which
-     *               are indexed by \ref sub_shader_id(enum spread_type_t)
+     *               are indexed by \ref sub_shader_id(enum spread_type_t, bool)
      * \param radial \ref PainterBrushShader that performs radial gradient
      *               that supports all sweep types via its sub-shaders which
-     *               are indexed by \ref sub_shader_id(enum spread_type_t)
+     *               are indexed by \ref sub_shader_id(enum spread_type_t, bool)
      * \param sweep \ref PainterBrushShader that performs sweep gradient
      *               that supports all sweep types via its sub-shaders which
-     *               are indexed by \ref sub_shader_id(enum spread_type_t)
+     *               are indexed by \ref sub_shader_id(enum spread_type_t, bool)
      * \param white \ref PainterBrushShader that applied solid white for the brush
      */
     PainterGradientBrushShader(const reference_counted_ptr<PainterBrushShader> &generic,
@@ -135,30 +148,46 @@ namespace fastuidraw
      * Returns the sub-shader of the generic parent shader for
      * specified \ref gradient_type_t and \ref spread_type_t
      * values.
+     * \param analytic_color_stops if true, the sub-shader
+     *                             evaluates the color stops
+     *                             packed in the brush data
      */
     const reference_counted_ptr<PainterBrushShader>&
-    sub_shader(enum spread_type_t, enum gradient_type_t) const;
+    sub_shader(enum spread_type_t, enum gradient_type_t,
+               bool analytic_color_stops = false) const;
 
     /*!
      * Returns the sub-shader of the linear gradient parent shader
      * for a specified \ref spread_type_t value.
+     * \param analytic_color_stops if true, the sub-shader
+     *                             evaluates the color stops
+     *                             packed in the brush data
      */
     const reference_counted_ptr<PainterBrushShader>&
-    linear_sub_shader(enum spread_type_t) const;
+    linear_sub_shader(enum spread_type_t,
+                      bool analytic_color_stops = false) const;
 
     /*!
      * Returns the sub-shader of the radial gradient parent shader
      * for a specified \ref spread_type_t value.
+     * \param analytic_color_stops if true, the sub-shader
+     *                             evaluates the color stops
+     *                             packed in the brush data
      */
     const reference_counted_ptr<PainterBrushShader>&
-    radial_sub_shader(enum spread_type_t) const;
+    radial_sub_shader(enum spread_type_t,
+                      bool analytic_color_stops = false) const;
 
     /*!
      * Returns the sub-shader of the sweep gradient parent shader
      * for a specified \ref spread_type_t value.
+     * \param analytic_color_stops if true, the sub-shader
+     *                             evaluates the color stops
+     *                             packed in the brush data
      */
     const reference_counted_ptr<PainterBrushShader>&
-    sweep_sub_shader(enum spread_type_t) const;
+    sweep_sub_shader(enum spread_type_t,
+                     bool analytic_color_stops = false) const;
 
     /*!
      * Returns the white shader, i.e. the shader that is
@@ -183,18 +212,26 @@ namespace fastuidraw
      * The sub-shader to take from the generic parent shader
      * for specified \ref gradient_type_t and \ref spread_type_t
      * values.
+     * \param analytic_color_stops if true, the sub-shader
+     *                             evaluates the color stops
+     *                             packed in the brush data
      */
     static
     uint32_t
-    sub_shader_id(enum spread_type_t, enum gradient_type_t);
+    sub_shader_id(enum spread_type_t, enum gradient_type_t,
+                  bool analytic_color_stops = false);
 
     /*!
      * The sub-shader to take from the linear, radial or sweep
      * parent shader for a specified \ref spread_type_t value.
+     * \param analytic_color_stops if true, the sub-shader
+     *                             evaluates the color stops
+     *                             packed in the brush data
      */
     static
     uint32_t
-    sub_shader_id(enum spread_type_t);
+    sub_shader_id(enum spread_type_t,
+                  bool analytic_color_stops = false);
 
   private:
     void *m_d;
@@ -22,6 +22,7 @@
 
 #include <fastuidraw/util/c_array.hpp>
 #include <fastuidraw/util/util.hpp>
+#include <fastuidraw/util/rect.hpp>
 #include <fastuidraw/image.hpp>
 
 namespace fastuidraw
@@ -100,6 +101,39 @@ namespace fastuidraw
     {
       return c_array<const reference_counted_ptr<const Image> >();
     }
+
+    /*!
+     * To be optionally implemented by a derived class to return
+     * true if the brush samples from an \ref Image for which
+     * Image::sparse() is true. For each draw whose brush data
+     * is not packed and for which this returns true, \ref Painter
+     * calls request_residency(). Default implementation is to
+     * return false.
+     */
+    virtual
+    bool
+    samples_sparse_image(void) const
+    {
+      return false;
+    }
+
+    /*!
+     * To be optionally implemented by a derived class to call
+     * Image::request_residency() on the sparse images the brush
+     * samples. Default implementation does nothing.
+     * \param rect bounding box of the visible region of a draw
+     *             in the coordinates fed to the brush
+     * \param pixels_per_unit maximum number of pixels that a
+     *                        unit in the coordinates fed to the
+     *                        brush covers
+     */
+    virtual
+    void
+    request_residency(const Rect &rect, float pixels_per_unit) const
+    {
+      FASTUIDRAWunused(rect);
+      FASTUIDRAWunused(pixels_per_unit);
+    }
   };
 
 /*! @} */
@@ -33,7 +33,16 @@ namespace fastuidraw
    * \brief
    * Class to specify dashed stroking parameters, data is packed
    * as according to PainterDashedStrokeParams::stroke_data_offset_t.
-   * Data for dashing is packed [TODO describe].
+   * The dash pattern is packed in the blocks following the static
+   * data as a 4-ary search tree, root level first. The leaves are
+   * the cumulative boundaries of the dash pattern (i.e. the end of
+   * each draw and each space interval, 4 per block) and each entry
+   * of an internal block is the largest boundary of the subtree of
+   * the matching child. Unused entries hold a value larger than the
+   * total length of the pattern. The shape of the tree is determined
+   * solely by the value at \ref stroke_number_intervals_offset, so
+   * that a shader locates the interval of a distance with a single
+   * fetch per level of the tree, see compute_interval().
    */
   class PainterDashedStrokeParams:public PainterItemShaderData
   {
@@ -208,6 +217,34 @@ namespace fastuidraw
     PainterDashedStrokeParams&
     dash_pattern(c_array<const DashPatternElement> v);
 
+    /*!
+     * Returns the duty cycle of the dash pattern, i.e. the ratio
+     * of the sum of the draw lengths of dash_pattern() to the total
+     * length of dash_pattern(). An empty dash pattern has a duty
+     * cycle of 1.
+     */
+    float
+    duty_cycle(void) const;
+
+    /*!
+     * CPU reference implementation of the dash pattern evaluation
+     * performed by the GLSL shaders; it walks the search tree packed
+     * by pack_data() in exactly the same way as the shaders do.
+     * Returns true if the named distance is within a draw interval
+     * of the dash pattern and false if it is within a space interval.
+     * \param distance distance along the contour, the value of
+     *                 dash_offset() is NOT added to the value
+     * \param out_interval location to which to write the start and
+     *                     end of the interval containing distance
+     * \param out_interval_id location to which to write the ID of
+     *                        the interval containing distance; the
+     *                        ID is unique across repeats of the dash
+     *                        pattern.
+     */
+    bool
+    compute_interval(float distance, range_type<float> *out_interval,
+                     int *out_interval_id) const;
+
     /*!
      * Returns a StrokingDataSelectorBase suitable for PainterDashedStrokeParams.
      * \param pixel_arc_stroking_possible if true, will inform that arc-stroking width
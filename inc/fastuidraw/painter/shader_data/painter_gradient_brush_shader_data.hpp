@@ -38,6 +38,19 @@ namespace fastuidraw
    * PainterGradientBrushShader consume. It specifies what
    * \ref ColorStopSequence to use together with the
    * geometric properties of the gradient.
+   *
+   * If the \ref ColorStopSequence is not on its atlas (see
+   * ColorStopSequence::on_atlas()), the value at \ref
+   * color_stop_length_offset is the number N of color stops
+   * and the color stops are packed after the gradient data
+   * (which is padded to a multiple of 4): first the places
+   * of the stops as the leaves of a 4-ary search tree with
+   * each level starting on a multiple of 4 and the root
+   * level first (each entry of an internal level is the
+   * largest place of the subtree of the entry, entries past
+   * the end are the largest float value), then the N colors
+   * packed as uint32 values as according to \ref
+   * analytic_color_stop_encoding.
    */
   class PainterGradientBrushShaderData:
     public PainterBrushShaderData,
@@ -57,6 +70,19 @@ namespace fastuidraw
         color_stop_y_bit0 = color_stop_x_num_bits /*!< where ColorStopSequence::texel_location().y() is encoded */
       };
 
+    /*!
+     * \brief
+     * Bit encoding for packing the colors of the color stops
+     * when ColorStopSequence::on_atlas() is false
+     */
+    enum analytic_color_stop_encoding
+      {
+        analytic_color_stop_red_bit0 = 0, /*!< where the red channel (8-bits) is encoded */
+        analytic_color_stop_green_bit0 = 8, /*!< where the green channel (8-bits) is encoded */
+        analytic_color_stop_blue_bit0 = 16, /*!< where the blue channel (8-bits) is encoded */
+        analytic_color_stop_alpha_bit0 = 24, /*!< where the alpha channel (8-bits) is encoded */
+      };
+
     /*!
      * \brief
      * Enumeration that provides offset, in units of
@@ -97,7 +123,9 @@ namespace fastuidraw
 
         /*!
          * Offset to the length of the color stop in -texels-, i.e.
-         * ColorStopSequence::width(), packed as a uint32
+         * ColorStopSequence::width(), packed as a uint32; if the
+         * color stops are not on the atlas, gives instead the
+         * number of color stops
          */
         color_stop_length_offset,
 
@@ -209,6 +237,32 @@ namespace fastuidraw
       return m_data.m_cs;
     }
 
+    /*!
+     * Returns true if the brush has a gradient whose color
+     * stops are packed into the data of the brush and
+     * evaluated exactly by the shader, i.e. if
+     * ColorStopSequence::on_atlas() is false.
+     */
+    bool
+    analytic_color_stops(void) const
+    {
+      return m_data.m_type != gradient_non
+        && m_data.m_cs
+        && !m_data.m_cs->on_atlas();
+    }
+
+    /*!
+     * Reference evaluation of the color of the color stops at an
+     * interpolate, the spread having been applied to the interpolate
+     * already. Mirrors the evaluation done by the shader when \ref
+     * analytic_color_stops() is true; the shader sampling from the
+     * \ref ColorStopAtlas otherwise approximates the same value.
+     * Returns a color with each channel normalized to [0, 1].
+     * \param t interpolate at which to evaluate the color stops
+     */
+    vec4
+    compute_color(float t) const;
+
     /*!
      * Sets the brush to have a linear gradient.
      * \param cs color stops for gradient. If handle is invalid,
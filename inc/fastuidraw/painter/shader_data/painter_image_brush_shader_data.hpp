@@ -208,6 +208,12 @@ namespace fastuidraw
     c_array<const reference_counted_ptr<const Image> >
     bind_images(void) const override;
 
+    bool
+    samples_sparse_image(void) const override;
+
+    void
+    request_residency(const Rect &rect, float pixels_per_unit) const override;
+
   private:
     reference_counted_ptr<const Image> m_image;
     uvec2 m_image_xy, m_image_wh;
@@ -38,7 +38,8 @@ namespace fastuidraw
   public:
     StrokingStyle(void):
       m_cap_style(PainterEnums::square_caps),
-      m_join_style(PainterEnums::miter_clip_joins)
+      m_join_style(PainterEnums::miter_clip_joins),
+      m_cache_path_effect(false)
     {}
 
     /*!
@@ -62,6 +63,16 @@ namespace fastuidraw
       return *this;
     }
 
+    /*!
+     * Set \ref m_cache_path_effect to the specified value.
+     */
+    StrokingStyle&
+    cache_path_effect(bool v)
+    {
+      m_cache_path_effect = v;
+      return *this;
+    }
+
     /*!
      * Specifies the what cap-style to use when stroking
      * the path. Default value is PainterEnums::square_caps.
@@ -73,6 +84,19 @@ namespace fastuidraw
      * path. Default value is PainterEnums::miter_clip_joins
      */
     enum PainterEnums::join_style m_join_style;
+
+    /*!
+     * If true, the results of applying a \ref PathEffect when
+     * stroking are cached on the path, see
+     * PartitionedTessellatedPath::SubsetSelection::apply_cached_path_effect().
+     * Only set this when the same \ref PathEffect, unchanged, is
+     * used to stroke the same path across many frames; an effect
+     * whose parameters change every frame only fills the cache
+     * with results that are never used again. Applies also to
+     * the \ref PathDashEffect used when dashing on the CPU, see
+     * Painter::cpu_dashing_duty_cycle(float). Default value is false.
+     */
+    bool m_cache_path_effect;
   };
 /*! @} */
 }
@@ -48,7 +48,7 @@ namespace fastuidraw  {
    * TessellatedPath::segment values.
    */
   class PartitionedTessellatedPath:
-    public reference_counted<PartitionedTessellatedPath>::non_concurrent
+    public reference_counted<PartitionedTessellatedPath>::concurrent
   {
   public:
     /*!
@@ -222,6 +222,27 @@ namespace fastuidraw  {
       void
       apply_path_effect(const PathEffect &effect, PathEffect::Storage &dst) const;
 
+      /*!
+       * Apply a \ref PathEffect to the segments, joins and caps of the
+       * \ref Subset values within this \ref SubsetSelection, using a
+       * cache of source() for the results. The results of applying the
+       * effect to each \ref Subset are cached keyed by PathEffect::ID()
+       * and PathEffect::version(); results for an older version() of
+       * the effect are discarded. Thus drawing the same path repeatedly
+       * with an unchanged \ref PathEffect only processes each \ref
+       * Subset once. The cache holds results for at most a small number
+       * of effects per path and the memory of the caches of all paths
+       * together is bounded by effect_cache_budget(); the least recently
+       * used effect results are dropped first. Only use this for an
+       * effect that is drawn repeatedly without changing, and whose
+       * class calls PathEffect::increment_version() whenever a change
+       * to its parameters changes its results.
+       * \param effect \ref PathEffect to apply
+       * \param dst \ref PathEffect::Storage to which to add results
+       */
+      void
+      apply_cached_path_effect(const PathEffect &effect, PathEffect::Storage &dst) const;
+
     private:
       friend class PartitionedTessellatedPath;
 
@@ -308,6 +329,39 @@ namespace fastuidraw  {
                    c_array<const float> geometry_inflation,
                    bool select_miter_joins,
                    SubsetSelection &dst) const;
+
+    /*!
+     * Set the maximum number of bytes used, summed across ALL
+     * PartitionedTessellatedPath objects of the process, by the
+     * results cached by SubsetSelection::apply_cached_path_effect().
+     * When the budget is exceeded, the least recently used results,
+     * regardless of which PartitionedTessellatedPath they belong
+     * to, are dropped. The results in use by the current call to
+     * SubsetSelection::apply_cached_path_effect() are never dropped,
+     * so a single large path may exceed the budget transiently.
+     * Default value is 32MB.
+     * \param v maximum number of bytes
+     */
+    static
+    void
+    effect_cache_budget(size_t v);
+
+    /*!
+     * Returns the value set by effect_cache_budget(size_t).
+     */
+    static
+    size_t
+    effect_cache_budget(void);
+
+    /*!
+     * Returns the number of bytes currently used, summed across
+     * all PartitionedTessellatedPath objects, by the results
+     * cached by SubsetSelection::apply_cached_path_effect().
+     */
+    static
+    size_t
+    effect_cache_bytes(void);
+
   private:
     friend class TessellatedPath;
 
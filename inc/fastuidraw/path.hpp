@@ -451,6 +451,34 @@ public:
     arc(PathContour &contour,
         float angle, const vec2 &end, enum PathEnums::edge_type_t tp);
 
+    /*!
+     * Ctor that specifies the arc as in the W3C canvas arc() method,
+     * i.e. by its center, radius and the starting and ending angles.
+     * The current end point of the \ref PathContour (i.e. the start
+     * point of the arc) must be the point on the circle at start_angle;
+     * Path::arc_centered() handles adding the line segment to the
+     * start of the arc. The sweep of the arc is computed as in the
+     * W3C canvas specification, i.e. it is clamped to 2 * FASTUIDRAW_PI
+     * in absolute value and otherwise is reduced modulo 2 * FASTUIDRAW_PI
+     * to go in the direction requested.
+     * \param contour \ref PathContour to which to add the interpolator.
+     * \param center center of the circle of the arc
+     * \param radius radius of the circle of the arc
+     * \param start_angle angle in radians where the arc starts
+     * \param end_angle angle in radians where the arc ends
+     * \param counter_clockwise if true, the angle increases from start_angle
+     *                          to end_angle, i.e. the arc goes counter-clockwise
+     *                          in a coordinate system where y increases upwards.
+     *                          Note that in a coordinate system where y increases
+     *                          downwards (such as that of W3C canvas), the arc
+     *                          then goes clockwise.
+     * \param tp nature the edge represented by this interpolator_base
+     */
+    arc(PathContour &contour,
+        const vec2 &center, float radius,
+        float start_angle, float end_angle,
+        bool counter_clockwise, enum PathEnums::edge_type_t tp);
+
     ~arc();
 
     /*!
@@ -494,6 +522,98 @@ public:
     void *m_d;
   };
 
+  /*!
+   * \brief
+   * An ellipse is for connecting one point to the next via an
+   * arc of an ellipse. The ellipse is tessellated directly into
+   * arcs of circles (see \ref TessellatedPath), i.e. it is not
+   * first approximated by Bezier curves.
+   */
+  class ellipse:public interpolator_generic
+  {
+  public:
+    /*!
+     * Ctor that specifies the ellipse arc as in the W3C canvas
+     * ellipse() method. The current end point of the \ref PathContour
+     * (i.e. the start point of the arc) must be the point on the
+     * ellipse at start_angle; Path::ellipse() handles adding the line
+     * segment to the start of the arc. The sweep of the arc is computed
+     * in the same way as for \ref arc.
+     * \param contour \ref PathContour to which to add the interpolator.
+     * \param center center of the ellipse
+     * \param radii radii of the ellipse along its major and minor axes
+     * \param x_axis_rotation rotation in radians of the ellipse's first
+     *                        axis relative to the x-axis
+     * \param start_angle parametric angle in radians where the arc starts
+     * \param end_angle parametric angle in radians where the arc ends
+     * \param counter_clockwise if true, the parametric angle increases from
+     *                          start_angle to end_angle, see \ref arc
+     * \param tp nature the edge represented by this interpolator_base
+     */
+    ellipse(PathContour &contour,
+            const vec2 &center, const vec2 &radii, float x_axis_rotation,
+            float start_angle, float end_angle,
+            bool counter_clockwise, enum PathEnums::edge_type_t tp);
+
+    ~ellipse();
+
+    /*!
+     * Returns the center of the ellipse.
+     */
+    vec2
+    center(void) const;
+
+    /*!
+     * Returns the radii of the ellipse.
+     */
+    vec2
+    radii(void) const;
+
+    /*!
+     * Returns the rotation in radians of the ellipse.
+     */
+    float
+    x_axis_rotation(void) const;
+
+    /*!
+     * Returns the starting and ending parametric angle
+     * of the arc each in radians.
+     */
+    range_type<float>
+    angle(void) const;
+
+    virtual
+    bool
+    is_flat(void) const;
+
+    virtual
+    void
+    tessellate(reference_counted_ptr<tessellated_region> in_region,
+               reference_counted_ptr<tessellated_region> *out_regionA,
+               reference_counted_ptr<tessellated_region> *out_regionB,
+               vec2 *out_p) const;
+    virtual
+    void
+    approximate_bounding_box(Rect *out_bb) const;
+
+    virtual
+    reference_counted_ptr<interpolator_base>
+    deep_copy(PathContour &contour) const;
+
+    virtual
+    unsigned int
+    minimum_tessellation_recursion(void) const;
+
+    virtual
+    enum return_code
+    add_to_builder(ShaderFilledPath::Builder *builder, float tol) const;
+
+  private:
+    ellipse(const ellipse &q, PathContour &contour);
+
+    void *m_d;
+  };
+
   /*!
    * Ctor.
    */
@@ -960,6 +1080,81 @@ public:
   arc_to(float angle, const vec2 &pt,
          enum PathEnums::edge_type_t etp = PathEnums::starts_new_edge);
 
+  /*!
+   * Append an arc as in the W3C canvas arcTo() method. Let L be the
+   * ray from the current point to pt1 and M the ray from pt1 to pt2;
+   * let C be the circle of the given radius tangent to both L and M.
+   * A line segment is added from the current point to where C touches
+   * L followed by the arc of C to where C touches M. If the current
+   * point, pt1 and pt2 are collinear or if radius is zero, only a line
+   * segment to pt1 is added. If the current contour is ended (or there
+   * is no contour), a new contour is started at pt1. A negative radius
+   * is an error (canvas raises IndexSizeError); the path is left
+   * unchanged.
+   * \param pt1 corner point of the arc
+   * \param pt2 point giving the direction of the edge leaving the arc
+   * \param radius radius of the arc
+   * \param etp the edge type of the first edge made; if this is the first
+   *            edge of the current contour, the value of etp is ignored
+   *            and the value \ref PathEnums::starts_new_edge is used.
+   */
+  Path&
+  arc_to(const vec2 &pt1, const vec2 &pt2, float radius,
+         enum PathEnums::edge_type_t etp = PathEnums::starts_new_edge);
+
+  /*!
+   * Append an arc as in the W3C canvas arc() method. A line segment
+   * is added from the current point to the start of the arc; if the
+   * current contour is ended (or there is no contour), a new contour
+   * is started at the start of the arc instead. The arc is added as
+   * one or two \ref PathContour::arc interpolators, i.e. it is not
+   * approximated by Bezier curves. A radius of zero adds only the
+   * line segment to the start of the arc, i.e. to center. A negative
+   * radius is an error (canvas raises IndexSizeError); the path is
+   * left unchanged.
+   * \param center center of the circle of the arc
+   * \param radius radius of the circle of the arc
+   * \param start_angle angle in radians where the arc starts
+   * \param end_angle angle in radians where the arc ends
+   * \param counter_clockwise if true, the angle increases from start_angle
+   *                          to end_angle, see PathContour::arc
+   * \param etp the edge type of the first edge made, the edges after it
+   *            continue it; if this is the first edge of the current
+   *            contour, the value of etp is ignored and the value
+   *            \ref PathEnums::starts_new_edge is used.
+   */
+  Path&
+  arc_centered(const vec2 &center, float radius,
+               float start_angle, float end_angle, bool counter_clockwise,
+               enum PathEnums::edge_type_t etp = PathEnums::starts_new_edge);
+
+  /*!
+   * Append an arc of an ellipse as in the W3C canvas ellipse() method.
+   * A line segment is added from the current point to the start of the
+   * arc; if the current contour is ended (or there is no contour), a new
+   * contour is started at the start of the arc instead. If the radii are
+   * equal, the arc is added as by arc_centered(), so that if both radii
+   * are zero only the line segment to center is added; otherwise it is
+   * added as one or two \ref PathContour::ellipse interpolators. A
+   * negative radius is an error (canvas raises IndexSizeError); the path
+   * is left unchanged.
+   * \param center center of the ellipse
+   * \param radii radii of the ellipse
+   * \param x_axis_rotation rotation in radians of the ellipse
+   * \param start_angle parametric angle in radians where the arc starts
+   * \param end_angle parametric angle in radians where the arc ends
+   * \param counter_clockwise if true, the parametric angle increases from
+   *                          start_angle to end_angle, see PathContour::arc
+   * \param etp the edge type of the first edge made, the edges after it
+   *            continue it; if this is the first edge of the current
+   *            contour, the value of etp is ignored and the value
+   *            \ref PathEnums::starts_new_edge is used.
+   */
+  Path&
+  ellipse(const vec2 &center, const vec2 &radii, float x_axis_rotation,
+          float start_angle, float end_angle, bool counter_clockwise,
+          enum PathEnums::edge_type_t etp = PathEnums::starts_new_edge);
+
   /*!
    * Begin a new contour.
    * \param pt point at which the contour begins
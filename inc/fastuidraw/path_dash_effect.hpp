@@ -46,6 +46,10 @@ namespace fastuidraw
    * directly from the source data. Only the value \ref
    * TessellatedPath::segment::m_length is adjusted (because
    * a given segment might be split into multiple segments).
+   * A PathDashEffect increments its PathEffect::version()
+   * whenever its dash pattern or dash offset changes, thus
+   * its results may be cached, see
+   * PartitionedTessellatedPath::SubsetSelection::apply_cached_path_effect().
    */
   class PathDashEffect:public PathEffect
   {
@@ -77,6 +81,22 @@ namespace fastuidraw
     PathDashEffect&
     dash_offset(float v);
 
+    /*!
+     * Returns the value set by dash_offset(float).
+     */
+    float
+    dash_offset(void) const;
+
+    /*!
+     * Returns the dash pattern as added by add_dash(); the
+     * x-coordinate of each element is the length to draw and
+     * the y-coordinate is the length to skip. Consecutive
+     * elements added by add_dash() where the first element
+     * has a skip length of zero are merged into one element.
+     */
+    c_array<const vec2>
+    dash_pattern(void) const;
+
     virtual
     void
     process_chain(const segment_chain &chain, Storage &dst) const override;
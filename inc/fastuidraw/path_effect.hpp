@@ -107,6 +107,16 @@ namespace fastuidraw
       Storage&
       add_cap(const cap &cap);
 
+      /*!
+       * Add the chains, joins and caps of another \ref Storage
+       * to this \ref Storage; the chains of src are added as new
+       * chains.
+       * \param src \ref Storage from which to copy; it is an
+       *            error if src is this \ref Storage.
+       */
+      Storage&
+      add_storage(const Storage &src);
+
       /*!
        * returns the number of \ref segment_chain the
        * \ref Storage has.
@@ -143,10 +153,41 @@ namespace fastuidraw
       void *m_d;
     };
 
+    /*!
+     * Ctor, gives the PathEffect a unique value for ID()
+     * and initializes version() as 0.
+     */
+    PathEffect(void);
+
     virtual
     ~PathEffect()
     {}
 
+    /*!
+     * Returns a value unique to this PathEffect for the
+     * lifetime of the process; together with version()
+     * it identifies the results of the PathEffect, see
+     * PartitionedTessellatedPath::SubsetSelection::apply_cached_path_effect().
+     */
+    unsigned int
+    ID(void) const
+    {
+      return m_ID;
+    }
+
+    /*!
+     * Returns the version of the parameters of this
+     * PathEffect; the version is incremented by
+     * increment_version(), which a derived class is to
+     * call whenever a change of its parameters changes
+     * the results of the PathEffect.
+     */
+    unsigned int
+    version(void) const
+    {
+      return m_version;
+    }
+
     /*!
      * Provided as a template conveniance, equivalent to
      * \code
@@ -245,6 +286,22 @@ namespace fastuidraw
     virtual
     void
     process_cap(const TessellatedPath::cap &cap, Storage &dst) const = 0;
+
+  protected:
+    /*!
+     * To be called by a derived class whenever its parameters
+     * change, so that any results cached for a previous version()
+     * are no longer used.
+     */
+    void
+    increment_version(void)
+    {
+      ++m_version;
+    }
+
+  private:
+    unsigned int m_ID;
+    unsigned int m_version;
   };
 
 /*! @} */
@@ -26,7 +26,9 @@
 #include <fastuidraw/util/vecN.hpp>
 #include <fastuidraw/util/c_array.hpp>
 #include <fastuidraw/util/reference_counted.hpp>
+#include <fastuidraw/util/worker_pool.hpp>
 #include <fastuidraw/path_enums.hpp>
+#include <fastuidraw/painter/painter_enums.hpp>
 
 namespace fastuidraw  {
 
@@ -672,6 +674,131 @@ public:
     void *m_d;
   };
 
+  /*!
+   * \brief
+   * A StrokingPreparationParams specifies what join and cap data
+   * of a \ref StrokedPath to construct ahead of time, see \ref
+   * prepare_stroked() and \ref StrokedPath::prepare().
+   */
+  class StrokingPreparationParams
+  {
+  public:
+    /*!
+     * Ctor, initializes as to prepare no join or cap data.
+     */
+    StrokingPreparationParams(void);
+
+    /*!
+     * Copy ctor.
+     * \param obj value from which to copy
+     */
+    StrokingPreparationParams(const StrokingPreparationParams &obj);
+
+    ~StrokingPreparationParams();
+
+    /*!
+     * Assignment operator
+     * \param obj value from which to copy
+     */
+    StrokingPreparationParams&
+    operator=(const StrokingPreparationParams &obj);
+
+    /*!
+     * Swap operation
+     * \param obj object with which to swap
+     */
+    void
+    swap(StrokingPreparationParams &obj);
+
+    /*!
+     * Returns true if the join data for the named join
+     * style is to be prepared.
+     * \param js join style to query
+     */
+    bool
+    join_style(enum PainterEnums::join_style js) const;
+
+    /*!
+     * Set if the join data for the named join style is to be
+     * prepared. If the path has arcs, the join data for \ref
+     * PainterEnums::rounded_joins is \ref
+     * StrokedPath::arc_rounded_joins(), otherwise it is \ref
+     * StrokedPath::rounded_joins() for each value of \ref
+     * rounding_thresholds(). Default value is false for all
+     * join styles.
+     * \param js join style to set
+     * \param v value
+     */
+    StrokingPreparationParams&
+    join_style(enum PainterEnums::join_style js, bool v);
+
+    /*!
+     * Returns true if the cap data for the named cap
+     * style is to be prepared.
+     * \param cp cap style to query
+     */
+    bool
+    cap_style(enum PainterEnums::cap_style cp) const;
+
+    /*!
+     * Set if the cap data for the named cap style is to be
+     * prepared. If the path has arcs, the cap data for \ref
+     * PainterEnums::rounded_caps is \ref
+     * StrokedPath::arc_rounded_caps(), otherwise it is \ref
+     * StrokedPath::rounded_caps() for each value of \ref
+     * rounding_thresholds(). Default value is false for all
+     * cap styles.
+     * \param cp cap style to set
+     * \param v value
+     */
+    StrokingPreparationParams&
+    cap_style(enum PainterEnums::cap_style cp, bool v);
+
+    /*!
+     * Returns true if the data of \ref StrokedPath::adjustable_caps(),
+     * used by dashed stroking, is to be prepared.
+     */
+    bool
+    adjustable_caps(void) const;
+
+    /*!
+     * Set if the data of \ref StrokedPath::adjustable_caps(),
+     * used by dashed stroking, is to be prepared. Default value
+     * is false.
+     * \param v value
+     */
+    StrokingPreparationParams&
+    adjustable_caps(bool v);
+
+    /*!
+     * Returns the thresholds for which to prepare the data
+     * of \ref StrokedPath::rounded_joins() and \ref
+     * StrokedPath::rounded_caps().
+     */
+    c_array<const float>
+    rounding_thresholds(void) const;
+
+    /*!
+     * Add a threshold for which to prepare the data of
+     * \ref StrokedPath::rounded_joins() and \ref
+     * StrokedPath::rounded_caps().
+     * \param thresh threshold value to pass to \ref
+     *               StrokedPath::rounded_joins() and \ref
+     *               StrokedPath::rounded_caps()
+     */
+    StrokingPreparationParams&
+    add_rounding_threshold(float thresh);
+
+    /*!
+     * Clear the values added by \ref add_rounding_threshold().
+     */
+    StrokingPreparationParams&
+    clear_rounding_thresholds(void);
+
+  private:
+    void *m_d;
+  };
+
   /*!
    * A Refiner is stateful object that creates new TessellatedPath
    * objects from a starting TessellatedPath where the tessellation
@@ -910,6 +1037,41 @@ public:
   const StrokedPath&
   stroked(void) const;
 
+  /*!
+   * Request that the \ref StrokedPath returned by stroked()
+   * and the join and cap data specified by a \ref
+   * StrokingPreparationParams are constructed by a thread of
+   * a \ref WorkerPool. The returned \ref WorkerPool::Task acts
+   * as a future; once it has finished, the \ref StrokedPath
+   * it constructed is the value returned by stroked().
+   *
+   * While the task is unfinished, stroked() and partitioned()
+   * return the objects that already exist without waiting: if
+   * the \ref StrokedPath had already been constructed, the task
+   * constructs a new one (sharing the partitioning) with the
+   * join and cap data of params and stroked() returns the old
+   * one until the task has finished. The replaced \ref StrokedPath
+   * is kept alive until it is replaced again (i.e. until the task
+   * of the next prepare_stroked() has finished and is seen by
+   * stroked()) so that references returned by earlier calls stay
+   * valid until then; to use a \ref StrokedPath beyond that, hold
+   * a reference_counted_ptr to it. Only when
+   * there is no existing object to return does a call wait; in
+   * that case a task that has not yet started is executed on the
+   * calling thread instead.
+   *
+   * Calling prepare_stroked() while a previous task is pending
+   * completes the previous task first. The TessellatedPath must
+   * not be accessed from other threads while the task is pending;
+   * dropping the last reference to the TessellatedPath cancels
+   * the task if it has not yet started and waits for it otherwise.
+   * \param pool \ref WorkerPool to which to add the task
+   * \param params specifies what join and cap data to construct
+   */
+  reference_counted_ptr<WorkerPool::Task>
+  prepare_stroked(WorkerPool &pool,
+                  const StrokingPreparationParams &params) const;
+
   /*!
    * Returns this \ref TessellatedPath filled. If this
    * \ref TessellatedPath has arcs will return
@@ -941,6 +1103,8 @@ public:
   partitioned(void) const;
 
 private:
+  class StrokingPreparationTask;
+
   TessellatedPath(Refiner *p, float threshhold,
                   unsigned int additional_recursion_count);
 
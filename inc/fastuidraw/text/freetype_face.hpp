@@ -25,6 +25,7 @@
 #include FT_GLYPH_H
 
 #include <fastuidraw/util/data_buffer.hpp>
+#include <fastuidraw/util/mapped_data_buffer.hpp>
 #include <fastuidraw/text/freetype_lib.hpp>
 
 namespace fastuidraw
@@ -138,8 +139,10 @@ namespace fastuidraw
                       int face_index);
 
       /*!
-       * Ctor. Provided as a convenience, a DataBuffer object is created
-       * from the named file and used as the memory source.
+       * Ctor. Provided as a convenience, a MappedDataBuffer object is
+       * created from the named file and used as the memory source; the
+       * pages of the file are then only read when FreeType touches them
+       * and are shared by all the faces of the file.
        * \param filename name of file from which to source the created
        *                 FT_Face objects
        * \param face_index face index of file
@@ -140,6 +140,22 @@ namespace fastuidraw
     unsigned int
     data_allocated(void);
 
+    /*!
+     * Returns the size of the largest free block of the
+     * store, i.e. the largest allocation that allocate_data()
+     * can make without resizing the store.
+     */
+    unsigned int
+    largest_free_data_block(void) const;
+
+    /*!
+     * Returns the number of free blocks of the store; with
+     * largest_free_data_block() and data_allocated() this
+     * gives a measure of the fragmentation of the store.
+     */
+    unsigned int
+    number_free_data_blocks(void) const;
+
     /*!
      * Frees all allocated regions of this GlyphAtlas;
      */
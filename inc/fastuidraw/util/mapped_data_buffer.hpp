@@ -0,0 +1,131 @@
+/*!
+ * \file mapped_data_buffer.hpp
+ * \brief file mapped_data_buffer.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+#ifndef FASTUIDRAW_MAPPED_DATA_BUFFER_HPP
+#define FASTUIDRAW_MAPPED_DATA_BUFFER_HPP
+
+#include <fastuidraw/util/data_buffer_base.hpp>
+#include <fastuidraw/util/util.hpp>
+
+namespace fastuidraw {
+/*!\addtogroup Utility
+ * @{
+ */
+  /*!
+   * \brief
+   * Represents the read-only contents of a file, memory mapped
+   * when possible.
+   *
+   * A regular file is mapped read-only and shared, so its pages
+   * are only read from disk when first touched and are shared with
+   * any other mapping of the same file, in this or other processes.
+   * If the file cannot be mapped (for example it is not a regular
+   * file or the platform does not support mapping), its contents
+   * are read into memory instead.
+   */
+  class MappedDataBufferBackingStore:noncopyable
+  {
+  public:
+    /*!
+     * Enumeration to describe how the contents will be accessed;
+     * passed to the system as a hint for how to read ahead.
+     */
+    enum access_hint_t
+      {
+        /*!
+         * No particular access pattern
+         */
+        access_normal,
+
+        /*!
+         * The contents are accessed at random places,
+         * as is the case for the glyphs of a font; the
+         * system does not read ahead of accesses.
+         */
+        access_random,
+
+        /*!
+         * The contents are accessed in order.
+         */
+        access_sequential,
+
+        /*!
+         * The contents are all to be accessed soon;
+         * the system starts reading them right away.
+         */
+        access_will_need,
+      };
+
+    /*!
+     * Ctor.
+     * \param filename name of file to map
+     * \param hint how the contents will be accessed
+     */
+    explicit
+    MappedDataBufferBackingStore(c_string filename,
+                                 enum access_hint_t hint = access_normal);
+
+    ~MappedDataBufferBackingStore();
+
+    /*!
+     * Returns the contents of the file; the array is empty
+     * if the file could not be opened.
+     */
+    c_array<const uint8_t>
+    data(void) const;
+
+    /*!
+     * Returns true if the contents are memory mapped and
+     * false if they were read into memory.
+     */
+    bool
+    mapped(void) const;
+
+  private:
+    void *m_d;
+  };
+
+  /*!
+   * \brief
+   * MappedDataBuffer is an implementation of DataBufferBase where
+   * the data is the contents of a file, memory mapped when possible,
+   * see \ref MappedDataBufferBackingStore. The data is read-only,
+   * DataBufferBase::data_rw() returns an empty array.
+   */
+  class MappedDataBuffer:
+    public MappedDataBufferBackingStore,
+    public DataBufferBase
+  {
+  public:
+    /*!
+     * Ctor.
+     * \param filename name of file to map
+     * \param hint how the contents will be accessed
+     */
+    explicit
+    MappedDataBuffer(c_string filename,
+                     enum access_hint_t hint = access_normal):
+      MappedDataBufferBackingStore(filename, hint),
+      DataBufferBase(data(), c_array<uint8_t>())
+    {}
+  };
+
+/*! @} */
+} //namespace fastuidraw
+
+#endif
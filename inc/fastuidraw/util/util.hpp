@@ -29,6 +29,23 @@
  * @{
  */
 
+/*!\def FASTUIDRAW_VERSION_MAJOR
+ * Major version of FastUIDraw.
+ */
+#define FASTUIDRAW_VERSION_MAJOR 1
+
+/*!\def FASTUIDRAW_VERSION_MINOR
+ * Minor version of FastUIDraw; incremented by any change
+ * that invalidates data the library persists between runs,
+ * for example gl::ProgramBinaryCache entries.
+ */
+#define FASTUIDRAW_VERSION_MINOR 0
+
+/*!\def FASTUIDRAW_VERSION_PATCH
+ * Patch version of FastUIDraw.
+ */
+#define FASTUIDRAW_VERSION_PATCH 0
+
 /*!
  * Macro to round up an uint32_t to a multiple or 4
  */
@@ -0,0 +1,186 @@
+/*!
+ * \file worker_pool.hpp
+ * \brief file worker_pool.hpp
+ *
+ * Copyright 2019 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+
+#ifndef FASTUIDRAW_WORKER_POOL_HPP
+#define FASTUIDRAW_WORKER_POOL_HPP
+
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/util/reference_counted.hpp>
+
+namespace fastuidraw
+{
+/*!\addtogroup Utility
+ * @{
+ */
+
+  /*!
+   * \brief
+   * A WorkerPool represents a set of threads that execute
+   * \ref Task objects in the order in which they were
+   * added to the WorkerPool.
+   */
+  class WorkerPool:public reference_counted<WorkerPool>::concurrent
+  {
+  public:
+    /*!
+     * Enumeration to describe the status of a \ref Task.
+     */
+    enum task_status_t
+      {
+        /*!
+         * Task has been created or added to a WorkerPool,
+         * but has not yet started executing.
+         */
+        task_queued,
+
+        /*!
+         * Task is currently executing.
+         */
+        task_running,
+
+        /*!
+         * Task has finished executing.
+         */
+        task_finished,
+
+        /*!
+         * Task was cancelled before it started to
+         * execute, it will never execute.
+         */
+        task_cancelled,
+      };
+
+    /*!
+     * \brief
+     * A Task represents a job to be executed by a \ref WorkerPool.
+     * A Task also acts as a future, i.e. a caller can query if
+     * the Task has finished or wait for it to finish.
+     */
+    class Task:public reference_counted<Task>::concurrent
+    {
+    public:
+      /*!
+       * Ctor, the task is initialized with the status
+       * \ref task_queued.
+       */
+      Task(void);
+
+      virtual
+      ~Task();
+
+      /*!
+       * Returns the status of the Task.
+       */
+      enum task_status_t
+      status(void) const;
+
+      /*!
+       * Returns true if the Task has finished or
+       * has been cancelled.
+       */
+      bool
+      done(void) const;
+
+      /*!
+       * Block until the Task has finished or has
+       * been cancelled.
+       */
+      void
+      wait(void) const;
+
+      /*!
+       * If the Task has not yet started, execute the
+       * Task on the calling thread and return true.
+       * If the task has already started (or was cancelled),
+       * return false immediately without waiting.
+       */
+      bool
+      execute(void);
+
+      /*!
+       * If the Task has not yet started, mark it as cancelled
+       * so that it will never run and return true. Otherwise
+       * return false.
+       */
+      bool
+      cancel(void);
+
+    protected:
+      /*!
+       * To be implemented by a derived class to perform the
+       * work of the Task. The method is called at most once
+       * and may be called from any thread.
+       */
+      virtual
+      void
+      run(void) = 0;
+
+    private:
+      void *m_d;
+    };
+
+    /*!
+     * Ctor.
+     * \param number_threads number of threads of the WorkerPool;
+     *                       a value of 0 indicates to use the
+     *                       number of hardware threads available.
+     */
+    explicit
+    WorkerPool(unsigned int number_threads = 0);
+
+    /*!
+     * Dtor. Any \ref Task that has not yet started executing
+     * is cancelled and the dtor blocks until the threads of
+     * the WorkerPool have finished the tasks they are running.
+     * If the last reference to the WorkerPool is released by
+     * one of its own tasks, the thread running that task is
+     * not waited on; it exits once the task has returned.
+     */
+    ~WorkerPool();
+
+    /*!
+     * Returns the number of threads of the WorkerPool.
+     */
+    unsigned int
+    number_threads(void) const;
+
+    /*!
+     * Add a \ref Task to be executed by the WorkerPool.
+     * It is an error to add a \ref Task that has already
+     * been added to a WorkerPool.
+     * \param task \ref Task to execute
+     */
+    void
+    add_task(const reference_counted_ptr<Task> &task);
+
+    /*!
+     * Block until all tasks added to the WorkerPool
+     * have finished or have been cancelled.
+     */
+    void
+    wait_all(void);
+
+  private:
+    void *m_d;
+  };
+
+/*! @} */
+}
+
+#endif
@@ -31,7 +31,7 @@ build/demo/$(2)/$(1)/%.resource_string.o: build/string_resources_cpp/%.resource_
 
 build/demo/$(2)/$(1)/%.o: %.cpp $$(NGL_$(1)_HPP) build/demo/$(2)/$(1)/%.d fastuidraw-config.nodir
 	@mkdir -p $$(dir $$@)
-	$(CXX) $$(DEMO_$(2)_CFLAGS_$(1)) -MT $$@ -MMD -MP -MF build/demo/$(2)/$(1)/$$*.d  -c $$< -o $$@
+	$(CXX) $$(DEMO_$(2)_CFLAGS_$(1)) $$(DEMO_EXTRA_CFLAGS) -MT $$@ -MMD -MP -MF build/demo/$(2)/$(1)/$$*.d  -c $$< -o $$@
 
 build/demo/$(2)/$(1)/%.d: ;
 .PRECIOUS: build/demo/$(2)/$(1)/%.d
@@ -52,6 +52,7 @@ THISDEMO_$(1)_$(2)_$(3)_DEPS_RAW = $$(patsubst %.cpp, %.d, $$($(1)_SOURCES) $$(C
 THISDEMO_$(1)_$(2)_$(3)_OBJS_RAW = $$(patsubst %.cpp, %.o, $$(THISDEMO_$(1)_$(2)_$(3)_SOURCES))
 THISDEMO_$(1)_$(2)_$(3)_DEPS = $$(addprefix build/demo/$(3)/$(2)/, $$(THISDEMO_$(1)_$(2)_$(3)_DEPS_RAW))
 THISDEMO_$(1)_$(2)_$(3)_OBJS = $$(addprefix build/demo/$(3)/$(2)/, $$(THISDEMO_$(1)_$(2)_$(3)_OBJS_RAW))
+THISDEMO_$(1)_$(2)_$(3)_OWN_OBJS = $$(addprefix build/demo/$(3)/$(2)/, $$(patsubst %.cpp, %.o, $$($(1)_SOURCES)))
 THISDEMO_$(1)_$(2)_$(3)_ALL_OBJS = $$(THISDEMO_$(1)_$(2)_$(3)_OBJS) $$(THISDEMO_$(1)_$(2)_$(3)_RESOURCE_OBJS)
 CLEAN_FILES += $$(THISDEMO_$(1)_$(2)_$(3)_ALL_OBJS)  $$(THISDEMO_$(1)_RESOURCE_STRING_SRCS)
 CLEAN_FILES += $(1)-$(2)-$(3) $(1)-$(2)-$(3).exe
@@ -59,6 +60,7 @@ CLEAN_FILES += $(1)-$(2)-$(3)-static $(1)-$(2)-$(3)-static.exe
 SUPER_CLEAN_FILES += $$(THISDEMO_$(1)_$(2)_$(3)_DEPS)
 ifeq ($(4),1)
 -include $$(THISDEMO_$(1)_$(2)_$(3)_DEPS)
+$$(THISDEMO_$(1)_$(2)_$(3)_OWN_OBJS): DEMO_EXTRA_CFLAGS := $$($(1)_CFLAGS)
 demos-$(2)-$(3): $(1)-$(2)-$(3)
 .PHONY: demos-$(2)-$(3)
 $(1)-$(2): $(1)-$(2)-$(3)
@@ -7,10 +7,13 @@
 #     to get path correct
 #  4. Set (using :=) foo_RESOURCE_STRING the string resources of the demo,
 #     using filelist to get path correct
-#  5. Place the "standard footer" at the end of the Rules.mk, this
+#  5. Optionally set (using :=) foo_CFLAGS to additional flags with
+#     which to compile the sources of foo_SOURCES (but not the common
+#     demo sources)
+#  6. Place the "standard footer" at the end of the Rules.mk, this
 #     restores Make variable(s) correctly so that the functor filelist
 #     will function correctly.
-#  6. Add to demos/Rules.mk your Rules.mk (follow the form in the file)
+#  7. Add to demos/Rules.mk your Rules.mk (follow the form in the file)
 #
 # Example Rules.mk:
 #
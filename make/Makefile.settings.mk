@@ -7,6 +7,9 @@ STRING_RESOURCE_CC = shell_scripts/fastuidraw-create-resource-cpp-file.sh
 ifeq ($(MINGW_BUILD),1)
   FASTUIDRAW_DEPS_LIBS += -lmingw32
   FASTUIDRAW_DEPS_STATIC_LIBS += -lmingw32
+else
+  FASTUIDRAW_DEPS_LIBS += -lpthread
+  FASTUIDRAW_DEPS_STATIC_LIBS += -lpthread
 endif
 
 #############################################
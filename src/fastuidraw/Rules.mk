@@ -4,7 +4,8 @@ dirstack_$(sp)	:= $(d)
 d		:= $(dir)
 # End standard header
 
-FASTUIDRAW_SOURCES += $(call filelist, image.cpp colorstop.cpp \
+FASTUIDRAW_SOURCES += $(call filelist, image.cpp image_source_mipmap_generator.cpp \
+	colorstop.cpp \
 	colorstop_atlas.cpp path.cpp tessellated_path.cpp \
 	partitioned_tessellated_path.cpp path_effect.cpp \
 	path_dash_effect.cpp)
@@ -18,6 +18,9 @@
 
 
 #include <vector>
+#include <list>
+#include <map>
+#include <set>
 #include <algorithm>
 #include <mutex>
 #include <fastuidraw/colorstop_atlas.hpp>
@@ -58,6 +61,74 @@ namespace
 
   typedef std::pair<fastuidraw::ivec2, int> delayed_free_entry;
 
+  /* Key of an interval shared by the ColorStopSequence objects made
+   * by ColorStopAtlas::create_shared(): the discretized texels
+   * (including the slack texels) together with a hash of them so
+   * that comparing keys of different values rarely needs to walk
+   * the texels.
+   */
+  class SharedIntervalKey
+  {
+  public:
+    explicit
+    SharedIntervalKey(fastuidraw::c_array<const fastuidraw::u8vec4> texels):
+      m_hash(fastuidraw::FNV1aHash().add(texels.flatten_array()).value()),
+      m_texels(texels.size())
+    {
+      for (unsigned int i = 0; i < texels.size(); ++i)
+        {
+          const fastuidraw::u8vec4 &t(texels[i]);
+
+          m_texels[i] = uint32_t(t.x()) | (uint32_t(t.y()) << 8u)
+            | (uint32_t(t.z()) << 16u) | (uint32_t(t.w()) << 24u);
+        }
+    }
+
+    bool
+    operator<(const SharedIntervalKey &rhs) const
+    {
+      if (m_hash != rhs.m_hash)
+        {
+          return m_hash < rhs.m_hash;
+        }
+      return m_texels < rhs.m_texels;
+    }
+
+    uint64_t m_hash;
+    std::vector<uint32_t> m_texels;
+  };
+
+  class SharedInterval;
+  typedef std::map<SharedIntervalKey, SharedInterval> SharedIntervalMap;
+
+  class SharedInterval
+  {
+  public:
+    SharedInterval(fastuidraw::ivec2 location, int width):
+      m_location(location),
+      m_width(width),
+      m_count(0),
+      m_release_generation(0)
+    {}
+
+    /* location and width of the interval including slack */
+    fastuidraw::ivec2 m_location;
+    int m_width;
+
+    /* number of ColorStopSequence objects using the interval */
+    unsigned int m_count;
+
+    /* value of ColorStopAtlasPrivate::m_lock_generation when
+     * m_count last became zero
+     */
+    unsigned int m_release_generation;
+
+    /* location in ColorStopAtlasPrivate::m_unused_shared,
+     * only valid when m_count is zero.
+     */
+    std::list<SharedIntervalMap::iterator>::iterator m_lru_location;
+  };
+
   class ColorStopAtlasPrivate
   {
   public:
@@ -73,10 +144,46 @@ namespace
     void
     deallocate_implement(fastuidraw::ivec2 location, int width);
 
+    void
+    free_interval_implement(fastuidraw::ivec2 location, int width);
+
+    fastuidraw::ivec2
+    allocate_implement(fastuidraw::c_array<const fastuidraw::u8vec4> data);
+
+    fastuidraw::ivec2
+    allocate_shared_implement(fastuidraw::c_array<const fastuidraw::u8vec4> data);
+
+    void
+    deallocate_shared_implement(fastuidraw::ivec2 location);
+
+    /* free the least recently used unused shared interval that
+     * is not possibly referenced by commands buffered while the
+     * resources are locked; returns false if there is none.
+     */
+    bool
+    free_unused_shared_implement(void);
+
     mutable std::mutex m_mutex;
     int m_delayed_interval_freeing_counter;
     std::vector<delayed_free_entry> m_delayed_freed_intervals;
 
+    /* incremented each time the resources go from unlocked
+     * to locked; a shared interval released while locked
+     * has its m_release_generation equal to this value and
+     * may be referenced by buffered commands until the
+     * resources are unlocked.
+     */
+    unsigned int m_lock_generation;
+
+    /* intervals made by create_shared(), m_shared_locations
+     * maps the location of an interval to its entry and
+     * m_unused_shared lists those entries whose m_count is
+     * zero, most recently released first.
+     */
+    SharedIntervalMap m_shared;
+    std::map<fastuidraw::ivec2, SharedIntervalMap::iterator> m_shared_locations;
+    std::list<SharedIntervalMap::iterator> m_unused_shared;
+
     fastuidraw::reference_counted_ptr<fastuidraw::ColorStopBackingStore> m_backing_store;
     int m_allocated;
 
@@ -111,6 +218,8 @@ namespace
     fastuidraw::ivec2 m_texel_location;
     int m_width;
     int m_start_slack, m_end_slack;
+    bool m_shared, m_on_atlas;
+    std::vector<fastuidraw::ColorStop> m_color_stops;
   };
 }
 
@@ -119,6 +228,7 @@ namespace
 ColorStopAtlasPrivate::
 ColorStopAtlasPrivate(fastuidraw::reference_counted_ptr<fastuidraw::ColorStopBackingStore> pbacking_store):
   m_delayed_interval_freeing_counter(0),
+  m_lock_generation(0),
   m_backing_store(pbacking_store),
   m_allocated(0)
 {
@@ -162,10 +272,17 @@ add_bookkeeping(int new_size)
 void
 ColorStopAtlasPrivate::
 deallocate_implement(fastuidraw::ivec2 location, int width)
+{
+  FASTUIDRAWassert(m_delayed_interval_freeing_counter == 0);
+  free_interval_implement(location, width);
+}
+
+void
+ColorStopAtlasPrivate::
+free_interval_implement(fastuidraw::ivec2 location, int width)
 {
   int y(location.y());
   FASTUIDRAWassert(m_layer_allocator[y]);
-  FASTUIDRAWassert(m_delayed_interval_freeing_counter == 0);
 
   int old_max, new_max;
 
@@ -184,6 +301,138 @@ deallocate_implement(fastuidraw::ivec2 location, int width)
   m_allocated -= width;
 }
 
+fastuidraw::ivec2
+ColorStopAtlasPrivate::
+allocate_implement(fastuidraw::c_array<const fastuidraw::u8vec4> data)
+{
+  std::map<int, std::set<int> >::iterator iter;
+  fastuidraw::ivec2 return_value;
+  int width(data.size());
+
+  iter = m_available_layers.lower_bound(width);
+  while (iter == m_available_layers.end() && free_unused_shared_implement())
+    {
+      iter = m_available_layers.lower_bound(width);
+    }
+
+  if (iter == m_available_layers.end())
+    {
+      /* TODO: what should the resize algorithm be?
+       * Right now we double the size, but that might
+       * be excessive.
+       */
+      int new_size, old_size;
+      old_size = m_backing_store->dimensions().y();
+      new_size = std::max(1, old_size * 2);
+      m_backing_store->resize(new_size);
+      add_bookkeeping(new_size);
+
+      iter = m_available_layers.lower_bound(width);
+      FASTUIDRAWassert(iter != m_available_layers.end());
+    }
+
+  FASTUIDRAWassert(!iter->second.empty());
+
+  int y(*iter->second.begin());
+  int old_max, new_max;
+
+  old_max = m_layer_allocator[y]->largest_free_interval();
+  return_value.x() = m_layer_allocator[y]->allocate_interval(width);
+  FASTUIDRAWassert(return_value.x() >= 0);
+  new_max = m_layer_allocator[y]->largest_free_interval();
+
+  if (old_max != new_max)
+    {
+      remove_entry_from_available_layers(iter, y);
+      m_available_layers[new_max].insert(y);
+    }
+  return_value.y() = y;
+
+  m_backing_store->set_data(return_value.x(), return_value.y(),
+                            width, data);
+  m_allocated += width;
+  return return_value;
+}
+
+fastuidraw::ivec2
+ColorStopAtlasPrivate::
+allocate_shared_implement(fastuidraw::c_array<const fastuidraw::u8vec4> data)
+{
+  SharedIntervalKey key(data);
+  SharedIntervalMap::iterator iter;
+
+  iter = m_shared.find(key);
+  if (iter == m_shared.end())
+    {
+      fastuidraw::ivec2 location;
+
+      location = allocate_implement(data);
+      iter = m_shared.insert(std::make_pair(key, SharedInterval(location, data.size()))).first;
+      m_shared_locations[location] = iter;
+    }
+  else if (iter->second.m_count == 0)
+    {
+      m_unused_shared.erase(iter->second.m_lru_location);
+    }
+
+  ++iter->second.m_count;
+  return iter->second.m_location;
+}
+
+void
+ColorStopAtlasPrivate::
+deallocate_shared_implement(fastuidraw::ivec2 location)
+{
+  std::map<fastuidraw::ivec2, SharedIntervalMap::iterator>::iterator loc_iter;
+  SharedIntervalMap::iterator iter;
+
+  loc_iter = m_shared_locations.find(location);
+  FASTUIDRAWassert(loc_iter != m_shared_locations.end());
+  iter = loc_iter->second;
+
+  FASTUIDRAWassert(iter->second.m_count > 0);
+  --iter->second.m_count;
+  if (iter->second.m_count == 0)
+    {
+      /* the interval is kept on the atlas, it is only
+       * freed when the room is needed or on
+       * ColorStopAtlas::clear_unused_shared().
+       */
+      iter->second.m_release_generation = m_lock_generation;
+      m_unused_shared.push_front(iter);
+      iter->second.m_lru_location = m_unused_shared.begin();
+    }
+}
+
+bool
+ColorStopAtlasPrivate::
+free_unused_shared_implement(void)
+{
+  SharedIntervalMap::iterator iter;
+
+  if (m_unused_shared.empty())
+    {
+      return false;
+    }
+
+  /* the list is ordered by release, thus if the least recently
+   * released interval was released while the resources are
+   * locked then so were all the others.
+   */
+  iter = m_unused_shared.back();
+  if (m_delayed_interval_freeing_counter != 0
+      && iter->second.m_release_generation == m_lock_generation)
+    {
+      return false;
+    }
+
+  m_unused_shared.pop_back();
+  free_interval_implement(iter->second.m_location, iter->second.m_width);
+  m_shared_locations.erase(iter->second.m_location);
+  m_shared.erase(iter);
+  return true;
+}
+
 /////////////////////////////////////
 // fastuidraw::ColorStopBackingStore methods
 fastuidraw::ColorStopBackingStore::
@@ -252,6 +501,9 @@ fastuidraw::ColorStopAtlas::
   d = static_cast<ColorStopAtlasPrivate*>(m_d);
 
   FASTUIDRAWassert(d->m_delayed_interval_freeing_counter == 0);
+  while (d->free_unused_shared_implement())
+    {}
+  FASTUIDRAWassert(d->m_shared.empty());
   FASTUIDRAWassert(d->m_allocated == 0);
   for(interval_allocator *q : d->m_layer_allocator)
     {
@@ -270,7 +522,60 @@ create(const ColorStopArray &color_stops, unsigned int pwidth)
     {
       return nullptr;
     }
-  return FASTUIDRAWnew ColorStopSequence(color_stops, *this, pwidth);
+  return FASTUIDRAWnew ColorStopSequence(color_stops, *this, pwidth, false);
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::ColorStopSequence>
+fastuidraw::ColorStopAtlas::
+create_shared(const ColorStopArray &color_stops, unsigned int pwidth)
+{
+  pwidth = t_min(pwidth, max_width());
+  if (pwidth == 0)
+    {
+      return nullptr;
+    }
+  return FASTUIDRAWnew ColorStopSequence(color_stops, *this, pwidth, true);
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::ColorStopSequence>
+fastuidraw::ColorStopAtlas::
+create_analytic(const ColorStopArray &color_stops, unsigned int pwidth)
+{
+  unsigned int num_stops(color_stops.values().size());
+
+  if (num_stops == 0)
+    {
+      return nullptr;
+    }
+
+  if (num_stops > max_analytic_color_stops)
+    {
+      return create(color_stops, pwidth);
+    }
+  return FASTUIDRAWnew ColorStopSequence(color_stops, *this);
+}
+
+unsigned int
+fastuidraw::ColorStopAtlas::
+number_unused_shared(void) const
+{
+  ColorStopAtlasPrivate *d;
+  d = static_cast<ColorStopAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> m(d->m_mutex);
+  return d->m_unused_shared.size();
+}
+
+void
+fastuidraw::ColorStopAtlas::
+clear_unused_shared(void)
+{
+  ColorStopAtlasPrivate *d;
+  d = static_cast<ColorStopAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> m(d->m_mutex);
+  while (d->free_unused_shared_implement())
+    {}
 }
 
 void
@@ -281,6 +586,10 @@ lock_resources(void)
   d = static_cast<ColorStopAtlasPrivate*>(m_d);
 
   std::lock_guard<std::mutex> m(d->m_mutex);
+  if (d->m_delayed_interval_freeing_counter == 0)
+    {
+      ++d->m_lock_generation;
+    }
   ++d->m_delayed_interval_freeing_counter;
 }
 
@@ -307,13 +616,17 @@ unlock_resources(void)
 
 void
 fastuidraw::ColorStopAtlas::
-deallocate(ivec2 location, int width)
+deallocate(ivec2 location, int width, bool shared)
 {
   ColorStopAtlasPrivate *d;
   d = static_cast<ColorStopAtlasPrivate*>(m_d);
 
   std::lock_guard<std::mutex> m(d->m_mutex);
-  if (d->m_delayed_interval_freeing_counter == 0)
+  if (shared)
+    {
+      d->deallocate_shared_implement(location);
+    }
+  else if (d->m_delayed_interval_freeing_counter == 0)
     {
       d->deallocate_implement(location, width);
     }
@@ -345,60 +658,49 @@ total_available(void) const
   return d->m_backing_store->width_times_height() - d->m_allocated;
 }
 
-fastuidraw::ivec2
+int
 fastuidraw::ColorStopAtlas::
-allocate(c_array<const u8vec4> data)
+largest_free_interval(void) const
 {
   ColorStopAtlasPrivate *d;
   d = static_cast<ColorStopAtlasPrivate*>(m_d);
 
   std::lock_guard<std::mutex> m(d->m_mutex);
+  return d->m_available_layers.empty() ?
+    0 :
+    d->m_available_layers.rbegin()->first;
+}
 
-  std::map<int, std::set<int> >::iterator iter;
-  ivec2 return_value;
-  unsigned int width(data.size());
-
-  FASTUIDRAWassert(width > 0);
-  FASTUIDRAWassert(width <= max_width());
+int
+fastuidraw::ColorStopAtlas::
+number_free_intervals(void) const
+{
+  ColorStopAtlasPrivate *d;
+  d = static_cast<ColorStopAtlasPrivate*>(m_d);
 
-  iter = d->m_available_layers.lower_bound(width);
-  if (iter == d->m_available_layers.end())
+  std::lock_guard<std::mutex> m(d->m_mutex);
+  int return_value(0);
+  for (const interval_allocator *q : d->m_layer_allocator)
     {
-      /* TODO: what should the resize algorithm be?
-       * Right now we double the size, but that might
-       * be excessive.
-       */
-      int new_size, old_size;
-      old_size = d->m_backing_store->dimensions().y();
-      new_size = std::max(1, old_size * 2);
-      d->m_backing_store->resize(new_size);
-      d->add_bookkeeping(new_size);
-
-      iter = d->m_available_layers.lower_bound(width);
-      FASTUIDRAWassert(iter != d->m_available_layers.end());
+      return_value += q->number_free_intervals();
     }
+  return return_value;
+}
 
-  FASTUIDRAWassert(!iter->second.empty());
-
-  int y(*iter->second.begin());
-  int old_max, new_max;
-
-  old_max = d->m_layer_allocator[y]->largest_free_interval();
-  return_value.x() = d->m_layer_allocator[y]->allocate_interval(width);
-  FASTUIDRAWassert(return_value.x() >= 0);
-  new_max = d->m_layer_allocator[y]->largest_free_interval();
+fastuidraw::ivec2
+fastuidraw::ColorStopAtlas::
+allocate(c_array<const u8vec4> data, bool shared)
+{
+  ColorStopAtlasPrivate *d;
+  d = static_cast<ColorStopAtlasPrivate*>(m_d);
 
-  if (old_max != new_max)
-    {
-      d->remove_entry_from_available_layers(iter, y);
-      d->m_available_layers[new_max].insert(y);
-    }
-  return_value.y() = y;
+  FASTUIDRAWassert(data.size() > 0);
+  FASTUIDRAWassert(data.size() <= max_width());
 
-  d->m_backing_store->set_data(return_value.x(), return_value.y(),
-                               width, data);
-  d->m_allocated += width;
-  return return_value;
+  std::lock_guard<std::mutex> m(d->m_mutex);
+  return (shared) ?
+    d->allocate_shared_implement(data) :
+    d->allocate_implement(data);
 }
 
 unsigned int
@@ -423,7 +725,8 @@ backing_store(void) const
 // fastuidraw::ColorStopSequence methods
 fastuidraw::ColorStopSequence::
 ColorStopSequence(const ColorStopArray &pcolor_stops,
-                  ColorStopAtlas &atlas, unsigned int pwidth)
+                  ColorStopAtlas &atlas, unsigned int pwidth,
+                  bool shared)
 {
   ColorStopSequencePrivate *d;
   d = FASTUIDRAWnew ColorStopSequencePrivate();
@@ -431,8 +734,11 @@ ColorStopSequence(const ColorStopArray &pcolor_stops,
 
   d->m_atlas = &atlas;
   d->m_width = pwidth;
+  d->m_shared = shared;
+  d->m_on_atlas = true;
 
   c_array<const ColorStop> color_stops(pcolor_stops.values());
+  d->m_color_stops.assign(color_stops.begin(), color_stops.end());
   FASTUIDRAWassert(d->m_atlas);
   FASTUIDRAWassert(pwidth>0);
 
@@ -516,23 +822,47 @@ ColorStopSequence(const ColorStopArray &pcolor_stops,
   }
 
 
-  d->m_texel_location = d->m_atlas->allocate(make_c_array(data));
+  d->m_texel_location = d->m_atlas->allocate(make_c_array(data), d->m_shared);
 
   /* Adjust m_texel_location to remove the start slack
    */
   d->m_texel_location.x() += d->m_start_slack;
 }
 
+fastuidraw::ColorStopSequence::
+ColorStopSequence(const ColorStopArray &pcolor_stops,
+                  ColorStopAtlas &atlas)
+{
+  ColorStopSequencePrivate *d;
+  d = FASTUIDRAWnew ColorStopSequencePrivate();
+  m_d = d;
+
+  c_array<const ColorStop> color_stops(pcolor_stops.values());
+
+  d->m_atlas = &atlas;
+  d->m_texel_location = ivec2(0, 0);
+  d->m_width = 0;
+  d->m_start_slack = 0;
+  d->m_end_slack = 0;
+  d->m_shared = false;
+  d->m_on_atlas = false;
+  d->m_color_stops.assign(color_stops.begin(), color_stops.end());
+}
+
 fastuidraw::ColorStopSequence::
 ~ColorStopSequence(void)
 {
   ColorStopSequencePrivate *d;
   d = static_cast<ColorStopSequencePrivate*>(m_d);
 
-  ivec2 loc(d->m_texel_location);
+  if (d->m_on_atlas)
+    {
+      ivec2 loc(d->m_texel_location);
 
-  loc.x() -= d->m_start_slack;
-  d->m_atlas->deallocate(loc, d->m_width + d->m_start_slack + d->m_end_slack);
+      loc.x() -= d->m_start_slack;
+      d->m_atlas->deallocate(loc, d->m_width + d->m_start_slack + d->m_end_slack,
+                             d->m_shared);
+    }
   FASTUIDRAWdelete(d);
   m_d = nullptr;
 }
@@ -563,3 +893,21 @@ atlas(void) const
   d = static_cast<ColorStopSequencePrivate*>(m_d);
   return *d->m_atlas;
 }
+
+bool
+fastuidraw::ColorStopSequence::
+on_atlas(void) const
+{
+  ColorStopSequencePrivate *d;
+  d = static_cast<ColorStopSequencePrivate*>(m_d);
+  return d->m_on_atlas;
+}
+
+fastuidraw::c_array<const fastuidraw::ColorStop>
+fastuidraw::ColorStopSequence::
+color_stops(void) const
+{
+  ColorStopSequencePrivate *d;
+  d = static_cast<ColorStopSequencePrivate*>(m_d);
+  return make_c_array(d->m_color_stops);
+}
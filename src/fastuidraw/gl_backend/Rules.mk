@@ -16,7 +16,7 @@ FASTUIDRAW_GL_SOURCES += $(call filelist, gl_get.cpp \
 	texture_image_gl.cpp \
 	painter_engine_gl.cpp)
 
-NGL_COMMON_SRCS += $(call filelist, gl_binding.cpp)
+NGL_COMMON_SRCS += $(call filelist, gl_binding.cpp gl_trace.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
@@ -33,13 +33,24 @@
 #include <cctype>
 #include <ciso646>
 #include <chrono>
+#include <cstdio>
+#include <atomic>
+#include <unistd.h>
 
 #include <fastuidraw/util/static_resource.hpp>
+#include <fastuidraw/util/mutex.hpp>
 #include <fastuidraw/gl_backend/ngl_header.hpp>
 #include <fastuidraw/gl_backend/gl_get.hpp>
 #include <fastuidraw/gl_backend/gl_context_properties.hpp>
 #include <fastuidraw/gl_backend/gl_program.hpp>
 
+#include <private/util_private.hpp>
+
+/* GL_COMPLETION_STATUS_KHR and GL_COMPLETION_STATUS_ARB share
+ * the same value, but not all GL/GLES headers define them.
+ */
+#define FASTUIDRAW_GL_COMPLETION_STATUS 0x91B1
+
 namespace
 {
   class ShaderPrivate
@@ -51,7 +62,10 @@ namespace
     void
     compile(void);
 
-    bool m_shader_ready;
+    void
+    begin_compile(void);
+
+    bool m_shader_ready, m_compile_status_ready;
     GLuint m_name;
     GLenum m_shader_type;
 
@@ -661,6 +675,71 @@ namespace
     std::vector<AtomicBufferInfo> m_abo_buffers;
   };
 
+  class ProgramBinaryCachePrivate:fastuidraw::noncopyable
+  {
+  public:
+    explicit
+    ProgramBinaryCachePrivate(fastuidraw::c_string directory):
+      m_directory((directory) ? directory : "."),
+      m_number_hits(0),
+      m_number_misses(0),
+      m_number_rejected(0),
+      m_time_saved(0.0f)
+    {}
+
+    static
+    std::string
+    compute_key(const std::vector<fastuidraw::reference_counted_ptr<fastuidraw::gl::Shader> > &shaders);
+
+    /* Returns true if an entry for the key is found; if the
+     * entry is found but not valid, records a rejection.
+     */
+    bool
+    fetch(const std::string &key, GLenum *out_format,
+          float *out_build_time, std::vector<uint8_t> *out_data);
+
+    void
+    store(const std::string &key, GLenum format, float build_time,
+          const std::vector<uint8_t> &data);
+
+    void
+    note_hit(float time_saved)
+    {
+      fastuidraw::Mutex::Guard m(m_mutex);
+      ++m_number_hits;
+      m_time_saved += fastuidraw::t_max(0.0f, time_saved);
+    }
+
+    void
+    note_miss(void)
+    {
+      fastuidraw::Mutex::Guard m(m_mutex);
+      ++m_number_misses;
+    }
+
+    void
+    note_rejected(void)
+    {
+      fastuidraw::Mutex::Guard m(m_mutex);
+      ++m_number_rejected;
+    }
+
+    std::string m_directory;
+    mutable fastuidraw::Mutex m_mutex;
+    unsigned int m_number_hits, m_number_misses, m_number_rejected;
+    float m_time_saved;
+
+  private:
+    enum
+      {
+        file_magic = 0x50445546u,
+        file_version = 1u
+      };
+
+    std::string
+    filename(const std::string &key) const;
+  };
+
   class ShaderData
   {
   public:
@@ -684,10 +763,14 @@ namespace
       m_shaders(pshaders.begin(), pshaders.end()),
       m_name(0),
       m_delete_program(true),
+      m_link_issued(false),
       m_assembled(false),
+      m_parallel_compile(false),
       m_initializers(initers),
       m_pre_link_actions(action),
-      m_p(p)
+      m_p(p),
+      m_binary_cache_d(nullptr),
+      m_from_binary_cache(false)
     {
       for(const ShaderRef &R : m_shaders)
         {
@@ -703,10 +786,14 @@ namespace
                    fastuidraw::gl::Program *p):
       m_name(0),
       m_delete_program(true),
+      m_link_issued(false),
       m_assembled(false),
+      m_parallel_compile(false),
       m_initializers(initers),
       m_pre_link_actions(action),
-      m_p(p)
+      m_p(p),
+      m_binary_cache_d(nullptr),
+      m_from_binary_cache(false)
     {
       FASTUIDRAWassert(vert_shader && vert_shader->shader_type() == GL_VERTEX_SHADER);
       FASTUIDRAWassert(frag_shader && frag_shader->shader_type() == GL_FRAGMENT_SHADER);
@@ -718,13 +805,20 @@ namespace
                    const fastuidraw::glsl::ShaderSource &frag_shader,
                    const fastuidraw::gl::PreLinkActionArray &action,
                    const fastuidraw::gl::ProgramInitializerArray &initers,
-                   fastuidraw::gl::Program *p):
+                   fastuidraw::gl::Program *p,
+                   const fastuidraw::reference_counted_ptr<fastuidraw::gl::ProgramBinaryCache> &binary_cache,
+                   ProgramBinaryCachePrivate *binary_cache_d):
       m_name(0),
       m_delete_program(true),
+      m_link_issued(false),
       m_assembled(false),
+      m_parallel_compile(false),
       m_initializers(initers),
       m_pre_link_actions(action),
-      m_p(p)
+      m_p(p),
+      m_binary_cache(binary_cache),
+      m_binary_cache_d(binary_cache_d),
+      m_from_binary_cache(false)
     {
       m_shaders.push_back(FASTUIDRAWnew fastuidraw::gl::Shader(vert_shader, GL_VERTEX_SHADER));
       m_shaders.push_back(FASTUIDRAWnew fastuidraw::gl::Shader(frag_shader, GL_FRAGMENT_SHADER));
@@ -735,12 +829,27 @@ namespace
     void
     assemble(void);
 
+    void
+    begin_assemble(void);
+
+    bool
+    assemble_complete(void);
+
     void
     populate_info(void);
 
     void
     clear_shaders_and_save_shader_data(void);
 
+    void
+    clear_shaders_and_save_shader_source(void);
+
+    bool
+    assemble_from_binary_cache(const std::string &key);
+
+    void
+    store_to_binary_cache(const std::string &key);
+
     void
     generate_log(void);
 
@@ -750,10 +859,13 @@ namespace
 
     GLuint m_name;
     bool m_delete_program;
-    bool m_link_success, m_assembled;
+    bool m_link_success, m_link_issued, m_assembled;
+    bool m_parallel_compile;
     std::string m_link_log;
     std::string m_log;
     float m_assemble_time;
+    std::chrono::steady_clock::time_point m_assemble_start_time;
+    std::string m_binary_cache_key;
 
     std::set<std::string> m_binded_attributes;
     AttributeInfo m_attribute_list;
@@ -763,6 +875,10 @@ namespace
     fastuidraw::gl::ProgramInitializerArray m_initializers;
     fastuidraw::gl::PreLinkActionArray m_pre_link_actions;
     fastuidraw::gl::Program *m_p;
+
+    fastuidraw::reference_counted_ptr<fastuidraw::gl::ProgramBinaryCache> m_binary_cache;
+    ProgramBinaryCachePrivate *m_binary_cache_d;
+    bool m_from_binary_cache;
   };
 }
 
@@ -772,6 +888,7 @@ ShaderPrivate::
 ShaderPrivate(const fastuidraw::glsl::ShaderSource &src,
               GLenum pshader_type):
   m_shader_ready(false),
+  m_compile_status_ready(false),
   m_name(0),
   m_shader_type(pshader_type),
   m_compile_success(false)
@@ -781,7 +898,7 @@ ShaderPrivate(const fastuidraw::glsl::ShaderSource &src,
 
 void
 ShaderPrivate::
-compile(void)
+begin_compile(void)
 {
   if (m_shader_ready)
     {
@@ -803,6 +920,19 @@ compile(void)
                             nullptr); //lengths of each string or nullptr implies each is 0-terminated
 
   fastuidraw_glCompileShader(m_name);
+}
+
+void
+ShaderPrivate::
+compile(void)
+{
+  begin_compile();
+  if (m_compile_status_ready)
+    {
+      return;
+    }
+
+  m_compile_status_ready = true;
 
   GLint logSize(0), shaderOK;
   std::vector<char> raw_log;
@@ -1872,7 +2002,7 @@ name(void)
 {
   ShaderPrivate *d;
   d = static_cast<ShaderPrivate*>(m_d);
-  d->compile();
+  d->begin_compile();
   return d->m_name;
 }
 
@@ -2501,6 +2631,161 @@ variable(c_string name,
 }
 
 
+/////////////////////////////////////////////////////////
+// ProgramBinaryCachePrivate methods
+std::string
+ProgramBinaryCachePrivate::
+compute_key(const std::vector<fastuidraw::reference_counted_ptr<fastuidraw::gl::Shader> > &shaders)
+{
+  std::ostringstream str;
+  const GLenum gl_strings[] =
+    {
+      GL_VENDOR,
+      GL_RENDERER,
+      GL_VERSION,
+      GL_SHADING_LANGUAGE_VERSION,
+    };
+
+  /* A program binary is only valid for the GL implementation
+   * that created it, so key by the GL strings as well as the
+   * shader source codes. The library version is part of the
+   * key as well, since a program binary also bakes in the
+   * pre-link actions (attribute and binding locations) of the
+   * library that created it.
+   */
+  str << "fastuidraw_program_binary_cache_v" << file_version << "\n"
+      << "fastuidraw_" << FASTUIDRAW_VERSION_MAJOR << "." << FASTUIDRAW_VERSION_MINOR
+      << "." << FASTUIDRAW_VERSION_PATCH << "\n";
+  for (GLenum e : gl_strings)
+    {
+      const GLubyte *v;
+
+      v = fastuidraw_glGetString(e);
+      str << ((v) ? reinterpret_cast<fastuidraw::c_string>(v) : "") << "\n";
+    }
+
+  for (const auto &sh : shaders)
+    {
+      str << fastuidraw::gl::Shader::gl_shader_type_label(sh->shader_type()) << "\n"
+          << sh->source_code() << "\n";
+    }
+  return str.str();
+}
+
+std::string
+ProgramBinaryCachePrivate::
+filename(const std::string &key) const
+{
+  std::ostringstream str;
+
+  str << m_directory << "/" << std::hex << std::setfill('0') << std::setw(16)
+      << fastuidraw::FNV1aHash().add(key).value() << ".bin";
+  return str.str();
+}
+
+bool
+ProgramBinaryCachePrivate::
+fetch(const std::string &key, GLenum *out_format,
+      float *out_build_time, std::vector<uint8_t> *out_data)
+{
+  std::ifstream file(filename(key).c_str(), std::ios::binary);
+  uint32_t magic(0), version(0), format(0), size(0);
+  uint64_t key_length(0), key_hash(0);
+  float build_time(0.0f);
+
+  if (!file)
+    {
+      note_miss();
+      return false;
+    }
+
+  file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+  file.read(reinterpret_cast<char*>(&version), sizeof(version));
+  file.read(reinterpret_cast<char*>(&key_length), sizeof(key_length));
+  file.read(reinterpret_cast<char*>(&key_hash), sizeof(key_hash));
+  file.read(reinterpret_cast<char*>(&format), sizeof(format));
+  file.read(reinterpret_cast<char*>(&build_time), sizeof(build_time));
+  file.read(reinterpret_cast<char*>(&size), sizeof(size));
+
+  /* the file name only stores one hash of the key, guard
+   * against collisions by also checking the length of the
+   * key and a hash of it with a different seed.
+   */
+  if (!file || magic != file_magic || version != file_version
+      || key_length != key.length()
+      || key_hash != fastuidraw::FNV1aHash(0x84222325cbf29ce4ull).add(key).value()
+      || size == 0)
+    {
+      note_rejected();
+      return false;
+    }
+
+  out_data->resize(size);
+  file.read(reinterpret_cast<char*>(&(*out_data)[0]), size);
+  if (!file)
+    {
+      note_rejected();
+      return false;
+    }
+
+  *out_format = format;
+  *out_build_time = build_time;
+  return true;
+}
+
+void
+ProgramBinaryCachePrivate::
+store(const std::string &key, GLenum format, float build_time,
+      const std::vector<uint8_t> &data)
+{
+  std::string name(filename(key)), tmp_name;
+  uint32_t magic(file_magic), version(file_version), fmt(format), size(data.size());
+  uint64_t key_length(key.length()), key_hash(fastuidraw::FNV1aHash(0x84222325cbf29ce4ull).add(key).value());
+
+  FASTUIDRAWassert(!data.empty());
+
+  /* write to a temporary file and then rename so that
+   * another process never sees a partially written entry;
+   * the temporary file name is unique to this process and
+   * call so that concurrent writers (threads or processes)
+   * never write to the same temporary file.
+   */
+  {
+    static std::atomic<unsigned int> counter(0u);
+    std::ostringstream str;
+
+    str << name << "." << getpid() << "."
+        << counter.fetch_add(1u, std::memory_order_relaxed) << ".tmp";
+    tmp_name = str.str();
+  }
+  {
+    std::ofstream file(tmp_name.c_str(), std::ios::binary | std::ios::trunc);
+
+    file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&key_length), sizeof(key_length));
+    file.write(reinterpret_cast<const char*>(&key_hash), sizeof(key_hash));
+    file.write(reinterpret_cast<const char*>(&fmt), sizeof(fmt));
+    file.write(reinterpret_cast<const char*>(&build_time), sizeof(build_time));
+    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    file.write(reinterpret_cast<const char*>(&data[0]), data.size());
+    if (!file)
+      {
+        file.close();
+        std::remove(tmp_name.c_str());
+        return;
+      }
+  }
+
+  /* rename() atomically replaces an existing entry; if it
+   * fails, the existing entry (if any) is kept.
+   */
+  if (std::rename(tmp_name.c_str(), name.c_str()) != 0)
+    {
+      std::remove(tmp_name.c_str());
+    }
+}
+
 /////////////////////////////////////////////////////////
 //ProgramPrivate methods
 ProgramPrivate::
@@ -2508,9 +2793,13 @@ ProgramPrivate(GLuint pname, bool take_ownership, fastuidraw::gl::Program *p):
   m_name(pname),
   m_delete_program(take_ownership),
   m_link_success(true),
+  m_link_issued(true),
   m_assembled(true),
+  m_parallel_compile(false),
   m_assemble_time(0.0f),
-  m_p(p)
+  m_p(p),
+  m_binary_cache_d(nullptr),
+  m_from_binary_cache(false)
 {
   populate_info();
 }
@@ -2579,52 +2868,126 @@ populate_info(void)
 
 void
 ProgramPrivate::
-assemble(void)
+begin_assemble(void)
 {
-  if (m_assembled)
+  if (m_link_issued)
     {
       return;
     }
 
-  auto start_time = std::chrono::steady_clock::now();
+  if (m_binary_cache_d)
+    {
+      m_binary_cache_key = ProgramBinaryCachePrivate::compute_key(m_shaders);
+      if (assemble_from_binary_cache(m_binary_cache_key))
+        {
+          return;
+        }
+    }
 
-  std::ostringstream error_ostr;
+  fastuidraw::gl::ContextProperties ctx_props;
 
-  m_assembled = true;
+  m_parallel_compile = ctx_props.has_extension("GL_KHR_parallel_shader_compile")
+    || ctx_props.has_extension("GL_ARB_parallel_shader_compile");
+  m_assemble_start_time = std::chrono::steady_clock::now();
+  m_link_issued = true;
   FASTUIDRAWassert(m_name == 0);
   m_name = fastuidraw_glCreateProgram();
-  m_link_success = true;
 
-  /* attatch the shaders, attaching a bad shader makes
-   * m_link_success become false
+  /* only issue the compile commands; querying the compile
+   * status is deferred to assemble() so that a GL implementation
+   * that compiles in parallel is not forced to finish now. A shader
+   * that fails to compile makes the link fail.
    */
   for(const auto &sh : m_shaders)
     {
-      if (sh->compile_success())
-        {
-          fastuidraw_glAttachShader(m_name, sh->name());
-        }
-      else
-        {
-          m_link_success = false;
-        }
+      fastuidraw_glAttachShader(m_name, sh->name());
     }
 
   //perform any pre-link actions and then clear them
   m_pre_link_actions.execute_actions(m_name);
   m_pre_link_actions = fastuidraw::gl::PreLinkActionArray();
 
+  #ifndef __EMSCRIPTEN__
+    {
+      if (m_binary_cache_d)
+        {
+          fastuidraw_glProgramParameteri(m_name, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+    }
+  #endif
+
   //now finally link!
   fastuidraw_glLinkProgram(m_name);
+}
+
+bool
+ProgramPrivate::
+assemble_complete(void)
+{
+  if (m_assembled)
+    {
+      return true;
+    }
+
+  if (!m_link_issued)
+    {
+      return false;
+    }
+
+  /* Without GL_{KHR,ARB}_parallel_shader_compile there is
+   * no way to ask GL without blocking, so report the program
+   * as complete; the GL implementation may still have done
+   * (some of) the work asynchronously after the link was issued.
+   */
+  if (!m_parallel_compile)
+    {
+      return true;
+    }
+
+  GLint status(GL_FALSE);
+  fastuidraw_glGetProgramiv(m_name, FASTUIDRAW_GL_COMPLETION_STATUS, &status);
+  return status == GL_TRUE;
+}
+
+void
+ProgramPrivate::
+assemble(void)
+{
+  if (m_assembled)
+    {
+      return;
+    }
+
+  begin_assemble();
+  if (m_assembled)
+    {
+      /* program came from the binary cache */
+      return;
+    }
+
+  m_assembled = true;
+  m_link_success = true;
+  for(const auto &sh : m_shaders)
+    {
+      if (!sh->compile_success())
+        {
+          m_link_success = false;
+        }
+    }
 
   //we no longer need the GL shaders.
   clear_shaders_and_save_shader_data();
 
   auto end_time = std::chrono::steady_clock::now();
-  m_assemble_time = std::chrono::duration<float>(end_time - start_time).count();
+  m_assemble_time = std::chrono::duration<float>(end_time - m_assemble_start_time).count();
 
   populate_info();
 
+  if (m_binary_cache_d && m_link_success)
+    {
+      store_to_binary_cache(m_binary_cache_key);
+    }
+
   if (!m_link_success)
     {
       std::ostringstream oo;
@@ -2645,6 +3008,100 @@ assemble(void)
   generate_log();
 }
 
+bool
+ProgramPrivate::
+assemble_from_binary_cache(const std::string &key)
+{
+  #ifdef __EMSCRIPTEN__
+    {
+      FASTUIDRAWunused(key);
+      return false;
+    }
+  #else
+    {
+      std::vector<uint8_t> data;
+      GLenum format;
+      float build_time;
+      GLint link_ok;
+
+      auto start_time = std::chrono::steady_clock::now();
+      if (!m_binary_cache_d->fetch(key, &format, &build_time, &data))
+        {
+          return false;
+        }
+
+      FASTUIDRAWassert(m_name == 0);
+      m_name = fastuidraw_glCreateProgram();
+      fastuidraw_glProgramBinary(m_name, format, &data[0], data.size());
+      fastuidraw_glGetProgramiv(m_name, GL_LINK_STATUS, &link_ok);
+      if (link_ok != GL_TRUE)
+        {
+          /* the GL implementation rejected the binary (for example
+           * after a driver update), fall back to building from source.
+           */
+          fastuidraw_glDeleteProgram(m_name);
+          m_name = 0;
+          m_binary_cache_d->note_rejected();
+          return false;
+        }
+
+      m_link_issued = true;
+      m_assembled = true;
+      m_link_success = true;
+      m_from_binary_cache = true;
+      m_pre_link_actions = fastuidraw::gl::PreLinkActionArray();
+      clear_shaders_and_save_shader_source();
+
+      auto end_time = std::chrono::steady_clock::now();
+      m_assemble_time = std::chrono::duration<float>(end_time - start_time).count();
+      m_binary_cache_d->note_hit(build_time - m_assemble_time);
+
+      populate_info();
+      generate_log();
+      return true;
+    }
+  #endif
+}
+
+void
+ProgramPrivate::
+store_to_binary_cache(const std::string &key)
+{
+  #ifdef __EMSCRIPTEN__
+    {
+      FASTUIDRAWunused(key);
+    }
+  #else
+    {
+      GLint num_formats, length(0);
+      GLsizei written(0);
+      GLenum format(GL_NONE);
+      std::vector<uint8_t> data;
+
+      num_formats = fastuidraw::gl::context_get<GLint>(GL_NUM_PROGRAM_BINARY_FORMATS);
+      if (num_formats <= 0)
+        {
+          return;
+        }
+
+      fastuidraw_glGetProgramiv(m_name, GL_PROGRAM_BINARY_LENGTH, &length);
+      if (length <= 0)
+        {
+          return;
+        }
+
+      data.resize(length);
+      fastuidraw_glGetProgramBinary(m_name, length, &written, &format, &data[0]);
+      if (written <= 0)
+        {
+          return;
+        }
+      data.resize(written);
+      m_binary_cache_d->store(key, format, m_assemble_time, data);
+    }
+  #endif
+}
+
 void
 ProgramPrivate::
 clear_shaders_and_save_shader_data(void)
@@ -2663,6 +3120,25 @@ clear_shaders_and_save_shader_data(void)
   m_shaders.clear();
 }
 
+void
+ProgramPrivate::
+clear_shaders_and_save_shader_source(void)
+{
+  /* used when the program comes from a binary; the shaders
+   * were never compiled, so only record their source.
+   */
+  m_shader_data.resize(m_shaders.size());
+  for(unsigned int i = 0, endi = m_shaders.size(); i<endi; ++i)
+    {
+      m_shader_data[i].m_source_code = m_shaders[i]->source_code();
+      m_shader_data[i].m_name = 0;
+      m_shader_data[i].m_shader_type = m_shaders[i]->shader_type();
+      m_shader_data[i].m_compile_success = true;
+      m_shader_data_sorted_by_type[m_shader_data[i].m_shader_type].push_back(i);
+    }
+  m_shaders.clear();
+}
+
 void
 ProgramPrivate::
 generate_log(void)
@@ -2880,6 +3356,76 @@ generate_log(void)
   m_log = ostr.str();
 }
 
+////////////////////////////////////////////////////////
+// fastuidraw::gl::ProgramBinaryCache methods
+fastuidraw::gl::ProgramBinaryCache::
+ProgramBinaryCache(c_string directory)
+{
+  m_d = FASTUIDRAWnew ProgramBinaryCachePrivate(directory);
+}
+
+fastuidraw::gl::ProgramBinaryCache::
+~ProgramBinaryCache()
+{
+  ProgramBinaryCachePrivate *d;
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+fastuidraw::c_string
+fastuidraw::gl::ProgramBinaryCache::
+directory(void) const
+{
+  ProgramBinaryCachePrivate *d;
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+  return d->m_directory.c_str();
+}
+
+unsigned int
+fastuidraw::gl::ProgramBinaryCache::
+number_hits(void) const
+{
+  ProgramBinaryCachePrivate *d;
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+
+  Mutex::Guard m(d->m_mutex);
+  return d->m_number_hits;
+}
+
+unsigned int
+fastuidraw::gl::ProgramBinaryCache::
+number_misses(void) const
+{
+  ProgramBinaryCachePrivate *d;
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+
+  Mutex::Guard m(d->m_mutex);
+  return d->m_number_misses;
+}
+
+unsigned int
+fastuidraw::gl::ProgramBinaryCache::
+number_rejected(void) const
+{
+  ProgramBinaryCachePrivate *d;
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+
+  Mutex::Guard m(d->m_mutex);
+  return d->m_number_rejected;
+}
+
+float
+fastuidraw::gl::ProgramBinaryCache::
+time_saved(void) const
+{
+  ProgramBinaryCachePrivate *d;
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+
+  Mutex::Guard m(d->m_mutex);
+  return d->m_time_saved;
+}
+
 ////////////////////////////////////////////////////////
 //fastuidraw::gl::Program methods
 fastuidraw::gl::Program::
@@ -2905,7 +3451,24 @@ Program(const glsl::ShaderSource &vert_shader,
         const PreLinkActionArray &action,
         const ProgramInitializerArray &initers)
 {
-  m_d = FASTUIDRAWnew ProgramPrivate(vert_shader, frag_shader, action, initers, this);
+  m_d = FASTUIDRAWnew ProgramPrivate(vert_shader, frag_shader, action, initers, this,
+                                     nullptr, nullptr);
+}
+
+fastuidraw::gl::Program::
+Program(const glsl::ShaderSource &vert_shader,
+        const glsl::ShaderSource &frag_shader,
+        const PreLinkActionArray &action,
+        const ProgramInitializerArray &initers,
+        const reference_counted_ptr<ProgramBinaryCache> &binary_cache)
+{
+  ProgramBinaryCachePrivate *binary_cache_d;
+
+  binary_cache_d = (binary_cache) ?
+    static_cast<ProgramBinaryCachePrivate*>(binary_cache->m_d) :
+    nullptr;
+  m_d = FASTUIDRAWnew ProgramPrivate(vert_shader, frag_shader, action, initers, this,
+                                     binary_cache, binary_cache_d);
 }
 
 fastuidraw::gl::Program::
@@ -2941,6 +3504,24 @@ use_program(void)
   fastuidraw_glUseProgram(d->m_name);
 }
 
+void
+fastuidraw::gl::Program::
+begin_build(void)
+{
+  ProgramPrivate *d;
+  d = static_cast<ProgramPrivate*>(m_d);
+  d->begin_assemble();
+}
+
+bool
+fastuidraw::gl::Program::
+build_complete(void)
+{
+  ProgramPrivate *d;
+  d = static_cast<ProgramPrivate*>(m_d);
+  return d->assemble_complete();
+}
+
 GLuint
 fastuidraw::gl::Program::
 name(void)
@@ -2971,6 +3552,16 @@ program_build_time(void)
   return d->m_assemble_time;
 }
 
+bool
+fastuidraw::gl::Program::
+from_binary_cache(void)
+{
+  ProgramPrivate *d;
+  d = static_cast<ProgramPrivate*>(m_d);
+  d->assemble();
+  return d->m_from_binary_cache;
+}
+
 bool
 fastuidraw::gl::Program::
 link_success(void)
@@ -0,0 +1,1982 @@
+/*!
+ * \file gl_trace.cpp
+ * \brief file gl_trace.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <map>
+#include <chrono>
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/util/math.hpp>
+#include <fastuidraw/util/fastuidraw_memory.hpp>
+#include <fastuidraw/gl_backend/ngl_header.hpp>
+#include <fastuidraw/gl_backend/gl_trace.hpp>
+
+namespace fastuidraw
+{
+  namespace gl_binding
+  {
+    typedef uint64_t (*replay_function_type)(const uint64_t *args, void *const *ptrs);
+    void capture_pre_call(const char *function_name, const char *signature, const uint64_t *args, unsigned int number_args);
+    void capture_post_call(uint64_t return_value);
+    bool capture_install_functions(bool install);
+    replay_function_type replay_function(const char *name);
+  }
+}
+
+/* A trace is the 8 bytes of trace_magic followed by records;
+ * all integers are written as LEB128 varints. Each record
+ * starts with its record_tag_t:
+ *  - tag_function: function id, name and signature, written
+ *    before the first call to the function. The signature
+ *    is the character for the return value followed by
+ *    a character for each argument (see arg_signature()
+ *    of the ngl generator).
+ *  - tag_call: function id, the bits of each argument, then
+ *    for each pointer argument its payload_kind_t followed
+ *    by its payload and, if the function returns a value,
+ *    the bits of the return value.
+ *  - tag_mapped_write: bytes written by the application
+ *    to a buffer mapped with glMapBufferRange, written
+ *    before the call that flushes or unmaps the range.
+ *  - tag_frame: a frame marker.
+ */
+namespace
+{
+  const char trace_magic[8] = { 'F', 'U', 'I', 'D', 'T', 'R', 'C', '1' };
+
+  enum
+    {
+      max_arguments = 16,
+      default_scratch_size = 1024 * 1024
+    };
+
+  enum record_tag_t
+    {
+      tag_function = 0,
+      tag_call = 1,
+      tag_mapped_write = 2,
+      tag_frame = 3,
+    };
+
+  enum payload_kind_t
+    {
+      /* the pointer value (e.g. an offset into a bound buffer) */
+      payload_raw = 0,
+
+      /* bytes read by the call; varint length and the bytes */
+      payload_data = 1,
+
+      /* memory written by the call; varint size (0 if unknown) */
+      payload_scratch = 2,
+
+      /* array of strings; varint count and for each string a
+       * varint length (including the terminator) and the bytes
+       */
+      payload_strings = 3,
+
+      /* GL object names written by the call; varint length
+       * and the bytes the call wrote when captured
+       */
+      payload_generated_names = 4,
+
+      /* a pointer whose data the capture cannot size; replayed
+       * as payload_raw
+       */
+      payload_unhandled = 5,
+    };
+
+  enum rule_t
+    {
+      rule_none,
+
+      /* bytes given by argument m_args[0] */
+      rule_bytes,
+
+      /* as rule_bytes, unless a pixel unpack buffer is bound */
+      rule_unpack_bytes,
+
+      /* m_args[0] gives count of elements of m_args[1] bytes */
+      rule_elements,
+
+      /* a C-string */
+      rule_c_string,
+
+      /* m_args[0] gives the count of strings, m_args[1] (if not -1)
+       * is the argument of the lengths of the strings
+       */
+      rule_strings,
+
+      /* pixel data of width, height, depth at m_args[0],
+       * m_args[1], m_args[2] (-1 for 1) with format and
+       * type at m_args[3] and m_args[4]
+       */
+      rule_image,
+
+      /* pixel data written by GL of unknown size */
+      rule_pack_scratch,
+
+      /* parameters of the pname at m_args[0], each of
+       * m_args[1] bytes
+       */
+      rule_pname_params,
+
+      /* the value of glClearBuffer*v for the buffer at m_args[0],
+       * each component of m_args[1] bytes
+       */
+      rule_clear_buffer,
+
+      /* the pointer value is an offset into a bound buffer */
+      rule_raw,
+
+      /* m_args[0] gives the count of GL object names written */
+      rule_generated_names,
+    };
+
+  enum special_t
+    {
+      special_none,
+      special_bind_buffer,
+      special_pixel_store_i,
+      special_pixel_store_f,
+      special_map_range,
+      special_map_named_range,
+      special_unmap,
+      special_unmap_named,
+      special_flush,
+      special_flush_named,
+      special_delete_sync,
+      special_get_handle,
+      special_skip_on_replay,
+    };
+
+  class PayloadRule
+  {
+  public:
+    const char *m_name;
+    unsigned int m_pointer;
+    enum rule_t m_rule;
+    int m_args[5];
+  };
+
+  const PayloadRule payload_rules[] =
+    {
+      { "glBufferData", 2, rule_bytes, { 1 } },
+      { "glBufferSubData", 3, rule_bytes, { 2 } },
+      { "glBufferStorage", 2, rule_bytes, { 1 } },
+      { "glNamedBufferData", 2, rule_bytes, { 1 } },
+      { "glNamedBufferSubData", 3, rule_bytes, { 2 } },
+      { "glNamedBufferStorage", 2, rule_bytes, { 1 } },
+      { "glGetBufferSubData", 3, rule_bytes, { 2 } },
+      { "glProgramBinary", 2, rule_bytes, { 3 } },
+
+      { "glCompressedTexImage1D", 6, rule_unpack_bytes, { 5 } },
+      { "glCompressedTexImage2D", 7, rule_unpack_bytes, { 6 } },
+      { "glCompressedTexImage3D", 8, rule_unpack_bytes, { 7 } },
+      { "glCompressedTexSubImage1D", 6, rule_unpack_bytes, { 5 } },
+      { "glCompressedTexSubImage2D", 8, rule_unpack_bytes, { 7 } },
+      { "glCompressedTexSubImage3D", 10, rule_unpack_bytes, { 9 } },
+
+      { "glTexImage1D", 7, rule_image, { 3, -1, -1, 5, 6 } },
+      { "glTexImage2D", 8, rule_image, { 3, 4, -1, 6, 7 } },
+      { "glTexImage3D", 9, rule_image, { 3, 4, 5, 7, 8 } },
+      { "glTexSubImage1D", 6, rule_image, { 3, -1, -1, 4, 5 } },
+      { "glTexSubImage2D", 8, rule_image, { 4, 5, -1, 6, 7 } },
+      { "glTexSubImage3D", 10, rule_image, { 5, 6, 7, 8, 9 } },
+      { "glTextureSubImage1D", 6, rule_image, { 3, -1, -1, 4, 5 } },
+      { "glTextureSubImage2D", 8, rule_image, { 4, 5, -1, 6, 7 } },
+      { "glTextureSubImage3D", 10, rule_image, { 5, 6, 7, 8, 9 } },
+      { "glClearTexImage", 4, rule_image, { -1, -1, -1, 2, 3 } },
+      { "glClearTexSubImage", 10, rule_image, { -1, -1, -1, 8, 9 } },
+      { "glReadPixels", 6, rule_image, { 2, 3, -1, 4, 5 } },
+      { "glGetTexImage", 4, rule_pack_scratch, { -1 } },
+      { "glGetCompressedTexImage", 2, rule_pack_scratch, { -1 } },
+
+      { "glShaderSource", 2, rule_strings, { 1, 3 } },
+      { "glShaderSource", 3, rule_elements, { 1, 4 } },
+      { "glCreateShaderProgramv", 2, rule_strings, { 1, -1 } },
+      { "glTransformFeedbackVaryings", 2, rule_strings, { 1, -1 } },
+      { "glGetUniformIndices", 2, rule_strings, { 1, -1 } },
+
+      { "glBindAttribLocation", 2, rule_c_string, { -1 } },
+      { "glBindFragDataLocation", 2, rule_c_string, { -1 } },
+      { "glBindFragDataLocationIndexed", 3, rule_c_string, { -1 } },
+      { "glGetAttribLocation", 1, rule_c_string, { -1 } },
+      { "glGetFragDataLocation", 1, rule_c_string, { -1 } },
+      { "glGetFragDataIndex", 1, rule_c_string, { -1 } },
+      { "glGetUniformLocation", 1, rule_c_string, { -1 } },
+      { "glGetUniformBlockIndex", 1, rule_c_string, { -1 } },
+      { "glGetProgramResourceIndex", 2, rule_c_string, { -1 } },
+      { "glGetProgramResourceLocation", 2, rule_c_string, { -1 } },
+      { "glGetProgramResourceLocationIndex", 2, rule_c_string, { -1 } },
+      { "glGetSubroutineIndex", 2, rule_c_string, { -1 } },
+      { "glGetSubroutineUniformLocation", 2, rule_c_string, { -1 } },
+      { "glDebugMessageInsert", 5, rule_c_string, { -1 } },
+      { "glObjectLabel", 3, rule_c_string, { -1 } },
+      { "glPushDebugGroup", 3, rule_c_string, { -1 } },
+
+      { "glDeleteBuffers", 1, rule_elements, { 0, 4 } },
+      { "glDeleteTextures", 1, rule_elements, { 0, 4 } },
+      { "glDeleteVertexArrays", 1, rule_elements, { 0, 4 } },
+      { "glDeleteFramebuffers", 1, rule_elements, { 0, 4 } },
+      { "glDeleteRenderbuffers", 1, rule_elements, { 0, 4 } },
+      { "glDeleteQueries", 1, rule_elements, { 0, 4 } },
+      { "glDeleteSamplers", 1, rule_elements, { 0, 4 } },
+      { "glDeleteProgramPipelines", 1, rule_elements, { 0, 4 } },
+      { "glDeleteTransformFeedbacks", 1, rule_elements, { 0, 4 } },
+      { "glDrawBuffers", 1, rule_elements, { 0, 4 } },
+      { "glInvalidateFramebuffer", 2, rule_elements, { 1, 4 } },
+      { "glInvalidateSubFramebuffer", 2, rule_elements, { 1, 4 } },
+      { "glGetActiveUniformsiv", 2, rule_elements, { 1, 4 } },
+      { "glGetProgramResourceiv", 4, rule_elements, { 3, 4 } },
+      { "glBindBuffersBase", 3, rule_elements, { 2, 4 } },
+      { "glBindBuffersRange", 3, rule_elements, { 2, 4 } },
+      { "glBindBuffersRange", 4, rule_elements, { 2, sizeof(GLintptr) } },
+      { "glBindBuffersRange", 5, rule_elements, { 2, sizeof(GLsizeiptr) } },
+      { "glBindTextures", 2, rule_elements, { 1, 4 } },
+      { "glBindSamplers", 2, rule_elements, { 1, 4 } },
+      { "glBindImageTextures", 2, rule_elements, { 1, 4 } },
+      { "glBindVertexBuffers", 2, rule_elements, { 1, 4 } },
+      { "glBindVertexBuffers", 3, rule_elements, { 1, sizeof(GLintptr) } },
+      { "glBindVertexBuffers", 4, rule_elements, { 1, 4 } },
+      { "glMultiDrawArrays", 1, rule_elements, { 3, 4 } },
+      { "glMultiDrawArrays", 2, rule_elements, { 3, 4 } },
+      { "glMultiDrawElements", 1, rule_elements, { 4, 4 } },
+      { "glMultiDrawElements", 3, rule_elements, { 4, sizeof(void*) } },
+      { "glMultiDrawElementsBaseVertex", 1, rule_elements, { 4, 4 } },
+      { "glMultiDrawElementsBaseVertex", 3, rule_elements, { 4, sizeof(void*) } },
+      { "glMultiDrawElementsBaseVertex", 5, rule_elements, { 4, 4 } },
+
+      { "glTexParameteriv", 2, rule_pname_params, { 1, 4 } },
+      { "glTexParameterfv", 2, rule_pname_params, { 1, 4 } },
+      { "glTexParameterIiv", 2, rule_pname_params, { 1, 4 } },
+      { "glTexParameterIuiv", 2, rule_pname_params, { 1, 4 } },
+      { "glTextureParameteriv", 2, rule_pname_params, { 1, 4 } },
+      { "glTextureParameterfv", 2, rule_pname_params, { 1, 4 } },
+      { "glTextureParameterIiv", 2, rule_pname_params, { 1, 4 } },
+      { "glTextureParameterIuiv", 2, rule_pname_params, { 1, 4 } },
+      { "glSamplerParameteriv", 2, rule_pname_params, { 1, 4 } },
+      { "glSamplerParameterfv", 2, rule_pname_params, { 1, 4 } },
+      { "glSamplerParameterIiv", 2, rule_pname_params, { 1, 4 } },
+      { "glSamplerParameterIuiv", 2, rule_pname_params, { 1, 4 } },
+
+      { "glClearBufferiv", 2, rule_clear_buffer, { 0, 4 } },
+      { "glClearBufferuiv", 2, rule_clear_buffer, { 0, 4 } },
+      { "glClearBufferfv", 2, rule_clear_buffer, { 0, 4 } },
+      { "glClearNamedFramebufferiv", 3, rule_clear_buffer, { 1, 4 } },
+      { "glClearNamedFramebufferuiv", 3, rule_clear_buffer, { 1, 4 } },
+      { "glClearNamedFramebufferfv", 3, rule_clear_buffer, { 1, 4 } },
+
+      { "glDrawElements", 3, rule_raw, { -1 } },
+      { "glDrawElementsBaseVertex", 3, rule_raw, { -1 } },
+      { "glDrawElementsInstanced", 3, rule_raw, { -1 } },
+      { "glDrawElementsInstancedBaseVertex", 3, rule_raw, { -1 } },
+      { "glDrawElementsInstancedBaseInstance", 3, rule_raw, { -1 } },
+      { "glDrawElementsInstancedBaseVertexBaseInstance", 3, rule_raw, { -1 } },
+      { "glDrawRangeElements", 5, rule_raw, { -1 } },
+      { "glDrawRangeElementsBaseVertex", 5, rule_raw, { -1 } },
+      { "glDrawArraysIndirect", 1, rule_raw, { -1 } },
+      { "glDrawElementsIndirect", 2, rule_raw, { -1 } },
+      { "glMultiDrawArraysIndirect", 1, rule_raw, { -1 } },
+      { "glMultiDrawElementsIndirect", 2, rule_raw, { -1 } },
+      { "glVertexAttribPointer", 5, rule_raw, { -1 } },
+      { "glVertexAttribIPointer", 4, rule_raw, { -1 } },
+      { "glVertexAttribLPointer", 4, rule_raw, { -1 } },
+      { "glDebugMessageCallback", 1, rule_raw, { -1 } },
+
+      { "glGenBuffers", 1, rule_generated_names, { 0 } },
+      { "glGenTextures", 1, rule_generated_names, { 0 } },
+      { "glGenVertexArrays", 1, rule_generated_names, { 0 } },
+      { "glGenFramebuffers", 1, rule_generated_names, { 0 } },
+      { "glGenRenderbuffers", 1, rule_generated_names, { 0 } },
+      { "glGenQueries", 1, rule_generated_names, { 0 } },
+      { "glGenSamplers", 1, rule_generated_names, { 0 } },
+      { "glGenProgramPipelines", 1, rule_generated_names, { 0 } },
+      { "glGenTransformFeedbacks", 1, rule_generated_names, { 0 } },
+      { "glCreateBuffers", 1, rule_generated_names, { 0 } },
+      { "glCreateTextures", 2, rule_generated_names, { 1 } },
+      { "glCreateVertexArrays", 1, rule_generated_names, { 0 } },
+      { "glCreateFramebuffers", 1, rule_generated_names, { 0 } },
+      { "glCreateRenderbuffers", 1, rule_generated_names, { 0 } },
+      { "glCreateQueries", 2, rule_generated_names, { 1 } },
+      { "glCreateSamplers", 1, rule_generated_names, { 0 } },
+      { "glCreateProgramPipelines", 1, rule_generated_names, { 0 } },
+      { "glCreateTransformFeedbacks", 1, rule_generated_names, { 0 } },
+    };
+
+  bool
+  begins_with(const std::string &str, const char *prefix)
+  {
+    return str.compare(0, std::strlen(prefix), prefix) == 0;
+  }
+
+  bool
+  ends_with(const std::string &str, const char *suffix)
+  {
+    std::size_t len(std::strlen(suffix));
+    return str.size() >= len && str.compare(str.size() - len, len, suffix) == 0;
+  }
+
+  int32_t
+  as_int(uint64_t v)
+  {
+    return static_cast<int32_t>(static_cast<uint32_t>(v));
+  }
+
+  uint64_t
+  as_size(uint64_t v)
+  {
+    /* a size is either a GLsizei (32-bits) or a GLsizeiptr (as
+     * wide as a pointer); the signature does not say which, so
+     * a value whose upper bits are zero is taken as 32-bit.
+     */
+    if ((v >> 32u) == 0u)
+      {
+        int32_t s(as_int(v));
+        return (s < 0) ? 0u : static_cast<uint64_t>(s);
+      }
+    return (static_cast<int64_t>(v) < 0) ? 0u : v;
+  }
+
+  const uint8_t*
+  as_pointer(uint64_t v)
+  {
+    return reinterpret_cast<const uint8_t*>(static_cast<uintptr_t>(v));
+  }
+
+  /* The rules for sizing the pointer arguments of a function
+   * and what the capture and replay need to do specially for
+   * the function.
+   */
+  class FunctionRules
+  {
+  public:
+    explicit
+    FunctionRules(const std::string &name, const std::string &signature);
+
+    PayloadRule m_rules[max_arguments];
+    enum special_t m_special;
+
+    /* if true, the return value is a GL object name
+     * or location that a faithful replay reproduces
+     */
+    bool m_check_return;
+
+    /* if true, the function takes bindless handles */
+    bool m_remap_handles;
+
+  private:
+    void
+    uniform_rule(const std::string &name, const std::string &signature);
+  };
+
+  class PixelStore
+  {
+  public:
+    PixelStore(void):
+      m_alignment(4),
+      m_row_length(0),
+      m_image_height(0),
+      m_skip_pixels(0),
+      m_skip_rows(0),
+      m_skip_images(0)
+    {}
+
+    /* number of bytes of pixel data read (or written)
+     * by a transfer of w x h x d pixels; returns 0 if
+     * the format or type is not known.
+     */
+    uint64_t
+    image_bytes(int32_t w, int32_t h, int32_t d, bool is_3d,
+                GLenum format, GLenum type) const;
+
+    int32_t m_alignment, m_row_length, m_image_height;
+    int32_t m_skip_pixels, m_skip_rows, m_skip_images;
+  };
+
+  class Mapping
+  {
+  public:
+    Mapping(void):
+      m_pointer(nullptr),
+      m_length(0),
+      m_access(0)
+    {}
+
+    uint8_t *m_pointer;
+    uint64_t m_length;
+    uint32_t m_access;
+  };
+
+  /* key of a mapping: if the buffer is mapped by name
+   * and the binding point or the name of the buffer
+   */
+  typedef std::pair<bool, uint32_t> MappingKey;
+
+  class CaptureFunction
+  {
+  public:
+    CaptureFunction(unsigned int id, const char *name, const char *signature):
+      m_id(id),
+      m_name(name),
+      m_signature(signature),
+      m_rules(m_name, m_signature)
+    {}
+
+    unsigned int m_id;
+    std::string m_name, m_signature;
+    FunctionRules m_rules;
+  };
+
+  class Capture:fastuidraw::noncopyable
+  {
+  public:
+    Capture(void):
+      m_file(nullptr),
+      m_current(0),
+      m_number_args(0),
+      m_unpack_buffer(0),
+      m_pack_buffer(0)
+    {}
+
+    bool
+    begin(const char *filename);
+
+    void
+    end(void);
+
+    void
+    frame_marker(void);
+
+    void
+    pre_call(const char *function_name, const char *signature,
+             const uint64_t *args, unsigned int number_args);
+
+    void
+    post_call(uint64_t return_value);
+
+    bool
+    capturing(void) const
+    {
+      return m_file != nullptr;
+    }
+
+  private:
+    static
+    void
+    write_varint(std::vector<uint8_t> &dst, uint64_t v);
+
+    static
+    void
+    write_bytes(std::vector<uint8_t> &dst, const void *p, uint64_t length);
+
+    void
+    write_record(void);
+
+    void
+    write_pointer(const CaptureFunction &F, unsigned int arg);
+
+    void
+    write_mapped(const MappingKey &key, uint64_t offset, uint64_t length);
+
+    void
+    track_state(const CaptureFunction &F, uint64_t return_value);
+
+    std::FILE *m_file;
+    std::map<const char*, unsigned int> m_function_lookup;
+    std::vector<CaptureFunction> m_functions;
+    std::vector<uint8_t> m_record;
+
+    unsigned int m_current;
+    uint64_t m_args[max_arguments];
+    unsigned int m_number_args;
+
+    PixelStore m_unpack, m_pack;
+    uint32_t m_unpack_buffer, m_pack_buffer;
+    std::map<MappingKey, Mapping> m_mappings;
+  };
+
+  class ReplayFunction
+  {
+  public:
+    ReplayFunction(const std::string &name, const std::string &signature):
+      m_name(name),
+      m_signature(signature),
+      m_rules(name, signature),
+      m_function(fastuidraw::gl_binding::replay_function(name.c_str())),
+      m_number_args(signature.size() - 1),
+      m_calls(0),
+      m_bytes(0)
+    {}
+
+    std::string m_name, m_signature;
+    FunctionRules m_rules;
+    fastuidraw::gl_binding::replay_function_type m_function;
+    unsigned int m_number_args;
+    unsigned int m_calls;
+    uint64_t m_bytes;
+  };
+
+  class ReplayPointer
+  {
+  public:
+    enum payload_kind_t m_kind;
+
+    /* for payload_data and payload_generated_names the offset
+     * into the trace of the bytes, for payload_strings the index
+     * into TraceReplayPrivate::m_strings of the first string
+     */
+    uint64_t m_location;
+
+    /* size of the data */
+    uint64_t m_length;
+  };
+
+  class ReplayRecord
+  {
+  public:
+    enum record_tag_t m_tag;
+
+    /* for tag_call, the function */
+    unsigned int m_function;
+
+    /* index into TraceReplayPrivate::m_args of the arguments;
+     * for tag_mapped_write the arguments are if the buffer is
+     * mapped by name, the binding point or buffer name and the
+     * offset into the mapping
+     */
+    unsigned int m_args;
+
+    /* index into TraceReplayPrivate::m_pointers */
+    unsigned int m_pointers;
+
+    uint64_t m_return_value;
+  };
+
+  class TraceReader
+  {
+  public:
+    TraceReader(const uint8_t *begin, const uint8_t *end):
+      m_begin(begin),
+      m_pos(begin),
+      m_end(end),
+      m_error(false)
+    {}
+
+    bool
+    done(void) const
+    {
+      return m_error || m_pos == m_end;
+    }
+
+    uint64_t
+    varint(void);
+
+    /* skips length bytes and returns the offset to them */
+    uint64_t
+    skip(uint64_t length);
+
+    std::string
+    string(void);
+
+    const uint8_t *m_begin, *m_pos, *m_end;
+    bool m_error;
+  };
+
+  class TraceReplayPrivate
+  {
+  public:
+    explicit
+    TraceReplayPrivate(const char *filename);
+
+    uint64_t
+    replay(bool issue_gl);
+
+    bool m_valid;
+    std::vector<uint8_t> m_trace;
+    std::vector<ReplayFunction> m_functions;
+    std::vector<ReplayRecord> m_records;
+    std::vector<uint64_t> m_args;
+    std::vector<ReplayPointer> m_pointers;
+    std::vector<const char*> m_strings;
+    unsigned int m_number_calls, m_number_frames;
+    unsigned int m_number_unhandled_pointers, m_number_divergences;
+    uint64_t m_number_bytes;
+
+  private:
+    bool
+    load(void);
+
+    bool
+    load_call(TraceReader &reader, uint64_t &pending_bytes);
+
+    bool
+    load_mapped_write(TraceReader &reader, uint64_t &pending_bytes);
+
+    void*
+    resolve_pointer(const ReplayPointer &P, unsigned int arg, uint64_t bits);
+
+    std::vector<uint8_t> m_scratch[max_arguments];
+    std::map<uint64_t, uint64_t> m_syncs, m_handles;
+    std::map<MappingKey, uint8_t*> m_mappings;
+  };
+
+  Capture&
+  capture(void)
+  {
+    static Capture C;
+    return C;
+  }
+}
+
+///////////////////////////////////
+// FunctionRules methods
+FunctionRules::
+FunctionRules(const std::string &name, const std::string &signature):
+  m_special(special_none),
+  m_check_return(false),
+  m_remap_handles(false)
+{
+  for (unsigned int i = 0; i < max_arguments; ++i)
+    {
+      m_rules[i].m_name = nullptr;
+      m_rules[i].m_pointer = i;
+      m_rules[i].m_rule = rule_none;
+    }
+
+  for (const PayloadRule &R : payload_rules)
+    {
+      if (name == R.m_name && R.m_pointer < max_arguments)
+        {
+          m_rules[R.m_pointer] = R;
+        }
+    }
+
+  if (begins_with(name, "glUniform") || begins_with(name, "glProgramUniform"))
+    {
+      uniform_rule(name, signature);
+    }
+
+  if (name == "glBindBuffer")
+    {
+      m_special = special_bind_buffer;
+    }
+  else if (name == "glPixelStorei")
+    {
+      m_special = special_pixel_store_i;
+    }
+  else if (name == "glPixelStoref")
+    {
+      m_special = special_pixel_store_f;
+    }
+  else if (name == "glMapBufferRange")
+    {
+      m_special = special_map_range;
+    }
+  else if (name == "glMapNamedBufferRange")
+    {
+      m_special = special_map_named_range;
+    }
+  else if (name == "glUnmapBuffer")
+    {
+      m_special = special_unmap;
+    }
+  else if (name == "glUnmapNamedBuffer")
+    {
+      m_special = special_unmap_named;
+    }
+  else if (name == "glFlushMappedBufferRange")
+    {
+      m_special = special_flush;
+    }
+  else if (name == "glFlushMappedNamedBufferRange")
+    {
+      m_special = special_flush_named;
+    }
+  else if (name == "glDeleteSync")
+    {
+      m_special = special_delete_sync;
+    }
+  else if (begins_with(name, "glDebugMessageCallback"))
+    {
+      /* the callback is a function of the captured process */
+      m_special = special_skip_on_replay;
+    }
+  else if (begins_with(name, "glGetTextureHandle")
+           || begins_with(name, "glGetTextureSamplerHandle")
+           || begins_with(name, "glGetImageHandle"))
+    {
+      m_special = special_get_handle;
+    }
+  else if (name.find("Handle") != std::string::npos)
+    {
+      m_remap_handles = true;
+    }
+
+  m_check_return = (signature[0] == 'v')
+    && (begins_with(name, "glCreate")
+        || (begins_with(name, "glGet")
+            && (ends_with(name, "Location") || ends_with(name, "Index"))));
+}
+
+void
+FunctionRules::
+uniform_rule(const std::string &name, const std::string &signature)
+{
+  std::string::size_type p;
+  unsigned int components(1), element_size(4), pointer;
+  bool program;
+
+  /* glUniform*v and glProgramUniform*v: the number of components
+   * is given by the name as is the size of each component.
+   */
+  if (!ends_with(name, "v") || signature.size() < 4 || signature.back() != 'p')
+    {
+      return;
+    }
+
+  program = begins_with(name, "glProgramUniform");
+  pointer = signature.size() - 2;
+  if (pointer >= max_arguments)
+    {
+      return;
+    }
+
+  p = name.find("Matrix");
+  if (p != std::string::npos)
+    {
+      p += 6;
+      if (p < name.size() && name[p] >= '2' && name[p] <= '4')
+        {
+          unsigned int c(name[p] - '0'), r(c);
+          if (p + 2 < name.size() && name[p + 1] == 'x')
+            {
+              r = name[p + 2] - '0';
+            }
+          components = c * r;
+        }
+    }
+  else
+    {
+      p = program ? 16 : 9;
+      if (p < name.size() && name[p] >= '1' && name[p] <= '4')
+        {
+          components = name[p] - '0';
+        }
+    }
+
+  if (ends_with(name, "dv") || ends_with(name, "64v"))
+    {
+      element_size = 8;
+    }
+
+  m_rules[pointer].m_name = nullptr;
+  m_rules[pointer].m_pointer = pointer;
+  m_rules[pointer].m_rule = rule_elements;
+  m_rules[pointer].m_args[0] = program ? 2 : 1;
+  m_rules[pointer].m_args[1] = components * element_size;
+}
+
+///////////////////////////////////
+// PixelStore methods
+uint64_t
+PixelStore::
+image_bytes(int32_t w, int32_t h, int32_t d, bool is_3d,
+            GLenum format, GLenum type) const
+{
+  unsigned int components, element_size, pixel_size;
+  uint64_t row_length, row_stride, image_height, image_stride;
+
+  switch (format)
+    {
+    case GL_RED:
+    case GL_RED_INTEGER:
+    case GL_ALPHA:
+    case GL_DEPTH_COMPONENT:
+    #ifndef FASTUIDRAW_GL_USE_GLES
+    case GL_STENCIL_INDEX:
+    #endif
+      components = 1;
+      break;
+    case GL_RG:
+    case GL_RG_INTEGER:
+    case GL_DEPTH_STENCIL:
+      components = 2;
+      break;
+    case GL_RGB:
+    case GL_RGB_INTEGER:
+    #ifndef FASTUIDRAW_GL_USE_GLES
+    case GL_BGR:
+    case GL_BGR_INTEGER:
+    #endif
+      components = 3;
+      break;
+    case GL_RGBA:
+    case GL_RGBA_INTEGER:
+    #ifndef FASTUIDRAW_GL_USE_GLES
+    case GL_BGRA:
+    case GL_BGRA_INTEGER:
+    #endif
+      components = 4;
+      break;
+    default:
+      return 0;
+    }
+
+  switch (type)
+    {
+    case GL_UNSIGNED_BYTE:
+    case GL_BYTE:
+      element_size = 1;
+      pixel_size = components;
+      break;
+    case GL_UNSIGNED_SHORT:
+    case GL_SHORT:
+    case GL_HALF_FLOAT:
+      element_size = 2;
+      pixel_size = 2 * components;
+      break;
+    case GL_UNSIGNED_INT:
+    case GL_INT:
+    case GL_FLOAT:
+      element_size = 4;
+      pixel_size = 4 * components;
+      break;
+    case GL_UNSIGNED_SHORT_5_6_5:
+    case GL_UNSIGNED_SHORT_4_4_4_4:
+    case GL_UNSIGNED_SHORT_5_5_5_1:
+    #ifndef FASTUIDRAW_GL_USE_GLES
+    case GL_UNSIGNED_SHORT_5_6_5_REV:
+    case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+    case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+    #endif
+      element_size = 2;
+      pixel_size = 2;
+      break;
+    case GL_UNSIGNED_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_10F_11F_11F_REV:
+    case GL_UNSIGNED_INT_5_9_9_9_REV:
+    case GL_UNSIGNED_INT_24_8:
+    #ifndef FASTUIDRAW_GL_USE_GLES
+    case GL_UNSIGNED_INT_8_8_8_8:
+    case GL_UNSIGNED_INT_8_8_8_8_REV:
+    case GL_UNSIGNED_INT_10_10_10_2:
+    #endif
+      element_size = 4;
+      pixel_size = 4;
+      break;
+    case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+      element_size = 4;
+      pixel_size = 8;
+      break;
+    #ifndef FASTUIDRAW_GL_USE_GLES
+    case GL_UNSIGNED_BYTE_3_3_2:
+    case GL_UNSIGNED_BYTE_2_3_3_REV:
+      element_size = 1;
+      pixel_size = 1;
+      break;
+    #endif
+    default:
+      return 0;
+    }
+
+  if (w <= 0 || h <= 0 || d <= 0)
+    {
+      return 0;
+    }
+
+  /* the layout of pixel data in client memory as
+   * specified by the GL specification (section 8.4.4.1
+   * of the GL 4.5 core specification)
+   */
+  row_length = (m_row_length > 0) ? m_row_length : w;
+  row_stride = row_length * pixel_size;
+  if (element_size < static_cast<unsigned int>(m_alignment) && m_alignment > 0)
+    {
+      uint64_t a(m_alignment);
+      row_stride = a * ((row_stride + a - 1) / a);
+    }
+
+  image_height = (is_3d && m_image_height > 0) ? m_image_height : h;
+  image_stride = image_height * row_stride;
+
+  return (is_3d ? (m_skip_images + d - 1) * image_stride : 0u)
+    + (m_skip_rows + h - 1) * row_stride
+    + (m_skip_pixels + w) * pixel_size;
+}
+
+///////////////////////////////////
+// Capture methods
+void
+Capture::
+write_varint(std::vector<uint8_t> &dst, uint64_t v)
+{
+  while (v >= 0x80u)
+    {
+      dst.push_back(static_cast<uint8_t>(v | 0x80u));
+      v >>= 7u;
+    }
+  dst.push_back(static_cast<uint8_t>(v));
+}
+
+void
+Capture::
+write_bytes(std::vector<uint8_t> &dst, const void *p, uint64_t length)
+{
+  const uint8_t *b(static_cast<const uint8_t*>(p));
+  dst.insert(dst.end(), b, b + length);
+}
+
+void
+Capture::
+write_record(void)
+{
+  std::fwrite(m_record.data(), 1, m_record.size(), m_file);
+  m_record.clear();
+}
+
+bool
+Capture::
+begin(const char *filename)
+{
+  if (m_file)
+    {
+      return false;
+    }
+
+  m_file = std::fopen(filename, "wb");
+  if (!m_file)
+    {
+      return false;
+    }
+
+  m_function_lookup.clear();
+  m_functions.clear();
+  m_unpack = PixelStore();
+  m_pack = PixelStore();
+  m_unpack_buffer = m_pack_buffer = 0;
+  m_mappings.clear();
+
+  std::fwrite(trace_magic, 1, sizeof(trace_magic), m_file);
+  if (!fastuidraw::gl_binding::capture_install_functions(true))
+    {
+      std::fclose(m_file);
+      m_file = nullptr;
+      return false;
+    }
+  return true;
+}
+
+void
+Capture::
+end(void)
+{
+  if (m_file)
+    {
+      fastuidraw::gl_binding::capture_install_functions(false);
+      std::fclose(m_file);
+      m_file = nullptr;
+    }
+}
+
+void
+Capture::
+frame_marker(void)
+{
+  if (m_file)
+    {
+      write_varint(m_record, tag_frame);
+      write_record();
+      std::fflush(m_file);
+    }
+}
+
+void
+Capture::
+write_mapped(const MappingKey &key, uint64_t offset, uint64_t length)
+{
+  std::map<MappingKey, Mapping>::const_iterator iter;
+
+  iter = m_mappings.find(key);
+  if (iter == m_mappings.end()
+      || !iter->second.m_pointer
+      || (iter->second.m_access & GL_MAP_WRITE_BIT) == 0u
+      || offset >= iter->second.m_length)
+    {
+      return;
+    }
+
+  length = fastuidraw::t_min(length, iter->second.m_length - offset);
+  write_varint(m_record, tag_mapped_write);
+  write_varint(m_record, key.first ? 1u : 0u);
+  write_varint(m_record, key.second);
+  write_varint(m_record, offset);
+  write_varint(m_record, length);
+  write_bytes(m_record, iter->second.m_pointer + offset, length);
+  write_record();
+}
+
+void
+Capture::
+pre_call(const char *function_name, const char *signature,
+         const uint64_t *args, unsigned int number_args)
+{
+  std::map<const char*, unsigned int>::iterator iter;
+
+  if (!m_file)
+    {
+      return;
+    }
+
+  iter = m_function_lookup.find(function_name);
+  if (iter == m_function_lookup.end())
+    {
+      unsigned int id(m_functions.size());
+
+      iter = m_function_lookup.insert(std::make_pair(function_name, id)).first;
+      m_functions.push_back(CaptureFunction(id, function_name, signature));
+
+      write_varint(m_record, tag_function);
+      write_varint(m_record, id);
+      write_varint(m_record, m_functions.back().m_name.size());
+      write_bytes(m_record, function_name, m_functions.back().m_name.size());
+      write_varint(m_record, m_functions.back().m_signature.size());
+      write_bytes(m_record, signature, m_functions.back().m_signature.size());
+      write_record();
+    }
+
+  m_current = iter->second;
+  m_number_args = fastuidraw::t_min(number_args, static_cast<unsigned int>(max_arguments));
+  std::copy(args, args + m_number_args, m_args);
+
+  /* the data written to a mapped range must be recorded
+   * before the range is flushed or unmapped.
+   */
+  const CaptureFunction &F(m_functions[m_current]);
+  switch (F.m_rules.m_special)
+    {
+    case special_flush:
+    case special_flush_named:
+      write_mapped(MappingKey(F.m_rules.m_special == special_flush_named, m_args[0]),
+                   m_args[1], m_args[2]);
+      break;
+
+    case special_unmap:
+    case special_unmap_named:
+      {
+        MappingKey key(F.m_rules.m_special == special_unmap_named, m_args[0]);
+        std::map<MappingKey, Mapping>::const_iterator m;
+
+        m = m_mappings.find(key);
+        if (m != m_mappings.end() && (m->second.m_access & GL_MAP_FLUSH_EXPLICIT_BIT) == 0u)
+          {
+            write_mapped(key, 0, m->second.m_length);
+          }
+      }
+      break;
+
+    default:
+      break;
+    }
+}
+
+void
+Capture::
+write_pointer(const CaptureFunction &F, unsigned int arg)
+{
+  const PayloadRule &R(F.m_rules.m_rules[arg]);
+  const uint8_t *p(as_pointer(m_args[arg]));
+  bool is_output(F.m_signature[arg + 1] == 'o');
+  uint64_t length(0);
+
+  if (!p || R.m_rule == rule_raw)
+    {
+      write_varint(m_record, payload_raw);
+      return;
+    }
+
+  switch (R.m_rule)
+    {
+    case rule_bytes:
+      length = as_size(m_args[R.m_args[0]]);
+      break;
+
+    case rule_unpack_bytes:
+      if (m_unpack_buffer != 0)
+        {
+          write_varint(m_record, payload_raw);
+          return;
+        }
+      length = as_size(m_args[R.m_args[0]]);
+      break;
+
+    case rule_elements:
+    case rule_generated_names:
+      {
+        int32_t count(as_int(m_args[R.m_args[0]]));
+        unsigned int element_size((R.m_rule == rule_elements) ? R.m_args[1] : 4u);
+
+        length = (count > 0) ? static_cast<uint64_t>(count) * element_size : 0u;
+      }
+      break;
+
+    case rule_c_string:
+      length = std::strlen(reinterpret_cast<const char*>(p)) + 1;
+      break;
+
+    case rule_strings:
+      {
+        int32_t count(as_int(m_args[R.m_args[0]]));
+        const char *const *strings(reinterpret_cast<const char *const*>(p));
+        const GLint *lengths(nullptr);
+
+        if (R.m_args[1] >= 0)
+          {
+            lengths = reinterpret_cast<const GLint*>(as_pointer(m_args[R.m_args[1]]));
+          }
+
+        count = fastuidraw::t_max(count, 0);
+        write_varint(m_record, payload_strings);
+        write_varint(m_record, count);
+        for (int32_t i = 0; i < count; ++i)
+          {
+            uint64_t len;
+
+            len = (lengths && lengths[i] >= 0) ?
+              static_cast<uint64_t>(lengths[i]) :
+              std::strlen(strings[i]);
+            write_varint(m_record, len + 1);
+            write_bytes(m_record, strings[i], len);
+            m_record.push_back(0);
+          }
+      }
+      return;
+
+    case rule_image:
+      {
+        const PixelStore &S(is_output ? m_pack : m_unpack);
+        uint32_t bound(is_output ? m_pack_buffer : m_unpack_buffer);
+        int32_t dims[3];
+
+        if (bound != 0)
+          {
+            write_varint(m_record, payload_raw);
+            return;
+          }
+
+        for (unsigned int i = 0; i < 3; ++i)
+          {
+            dims[i] = (R.m_args[i] >= 0) ? as_int(m_args[R.m_args[i]]) : 1;
+          }
+        length = S.image_bytes(dims[0], dims[1], dims[2], R.m_args[2] >= 0,
+                               static_cast<GLenum>(m_args[R.m_args[3]]),
+                               static_cast<GLenum>(m_args[R.m_args[4]]));
+        if (length == 0 && !is_output)
+          {
+            write_varint(m_record, payload_unhandled);
+            return;
+          }
+      }
+      break;
+
+    case rule_pack_scratch:
+      if (m_pack_buffer != 0)
+        {
+          write_varint(m_record, payload_raw);
+          return;
+        }
+      break;
+
+    case rule_pname_params:
+      {
+        GLenum pname(static_cast<GLenum>(m_args[R.m_args[0]]));
+        unsigned int count(1);
+
+        if (pname == GL_TEXTURE_BORDER_COLOR
+            #ifndef FASTUIDRAW_GL_USE_GLES
+            || pname == GL_TEXTURE_SWIZZLE_RGBA
+            #endif
+            )
+          {
+            count = 4;
+          }
+        length = count * R.m_args[1];
+      }
+      break;
+
+    case rule_clear_buffer:
+      length = (static_cast<GLenum>(m_args[R.m_args[0]]) == GL_COLOR) ?
+        4u * R.m_args[1] :
+        R.m_args[1];
+      break;
+
+    default:
+      if (!is_output)
+        {
+          write_varint(m_record, payload_unhandled);
+          return;
+        }
+    }
+
+  if (R.m_rule == rule_generated_names)
+    {
+      /* written after the call, so that the names GL
+       * generated are recorded
+       */
+      write_varint(m_record, payload_generated_names);
+      write_varint(m_record, length);
+      write_bytes(m_record, p, length);
+    }
+  else if (is_output)
+    {
+      write_varint(m_record, payload_scratch);
+      write_varint(m_record, length);
+    }
+  else
+    {
+      write_varint(m_record, payload_data);
+      write_varint(m_record, length);
+      write_bytes(m_record, p, length);
+    }
+}
+
+void
+Capture::
+track_state(const CaptureFunction &F, uint64_t return_value)
+{
+  switch (F.m_rules.m_special)
+    {
+    case special_bind_buffer:
+      if (static_cast<GLenum>(m_args[0]) == GL_PIXEL_UNPACK_BUFFER)
+        {
+          m_unpack_buffer = static_cast<uint32_t>(m_args[1]);
+        }
+      else if (static_cast<GLenum>(m_args[0]) == GL_PIXEL_PACK_BUFFER)
+        {
+          m_pack_buffer = static_cast<uint32_t>(m_args[1]);
+        }
+      break;
+
+    case special_pixel_store_i:
+    case special_pixel_store_f:
+      {
+        int32_t value;
+
+        if (F.m_rules.m_special == special_pixel_store_i)
+          {
+            value = as_int(m_args[1]);
+          }
+        else
+          {
+            float f;
+            uint32_t bits(static_cast<uint32_t>(m_args[1]));
+
+            std::memcpy(&f, &bits, sizeof(f));
+            value = static_cast<int32_t>(f);
+          }
+
+        switch (static_cast<GLenum>(m_args[0]))
+          {
+          case GL_UNPACK_ALIGNMENT: m_unpack.m_alignment = value; break;
+          case GL_UNPACK_ROW_LENGTH: m_unpack.m_row_length = value; break;
+          case GL_UNPACK_IMAGE_HEIGHT: m_unpack.m_image_height = value; break;
+          case GL_UNPACK_SKIP_PIXELS: m_unpack.m_skip_pixels = value; break;
+          case GL_UNPACK_SKIP_ROWS: m_unpack.m_skip_rows = value; break;
+          case GL_UNPACK_SKIP_IMAGES: m_unpack.m_skip_images = value; break;
+          case GL_PACK_ALIGNMENT: m_pack.m_alignment = value; break;
+          case GL_PACK_ROW_LENGTH: m_pack.m_row_length = value; break;
+          case GL_PACK_SKIP_PIXELS: m_pack.m_skip_pixels = value; break;
+          case GL_PACK_SKIP_ROWS: m_pack.m_skip_rows = value; break;
+          #ifndef FASTUIDRAW_GL_USE_GLES
+          case GL_PACK_IMAGE_HEIGHT: m_pack.m_image_height = value; break;
+          case GL_PACK_SKIP_IMAGES: m_pack.m_skip_images = value; break;
+          #endif
+          default: break;
+          }
+      }
+      break;
+
+    case special_map_range:
+    case special_map_named_range:
+      {
+        Mapping &M(m_mappings[MappingKey(F.m_rules.m_special == special_map_named_range, m_args[0])]);
+
+        M.m_pointer = const_cast<uint8_t*>(as_pointer(return_value));
+        M.m_length = m_args[2];
+        M.m_access = static_cast<uint32_t>(m_args[3]);
+      }
+      break;
+
+    case special_unmap:
+    case special_unmap_named:
+      m_mappings.erase(MappingKey(F.m_rules.m_special == special_unmap_named, m_args[0]));
+      break;
+
+    default:
+      break;
+    }
+}
+
+void
+Capture::
+post_call(uint64_t return_value)
+{
+  if (!m_file)
+    {
+      return;
+    }
+
+  const CaptureFunction &F(m_functions[m_current]);
+
+  write_varint(m_record, tag_call);
+  write_varint(m_record, F.m_id);
+  for (unsigned int i = 0; i < m_number_args; ++i)
+    {
+      write_varint(m_record, m_args[i]);
+    }
+
+  for (unsigned int i = 0; i < m_number_args; ++i)
+    {
+      char c(F.m_signature[i + 1]);
+      if (c == 'p' || c == 'o')
+        {
+          write_pointer(F, i);
+        }
+    }
+
+  if (F.m_signature[0] != 'n')
+    {
+      write_varint(m_record, return_value);
+    }
+  write_record();
+  track_state(F, return_value);
+}
+
+///////////////////////////////////
+// TraceReader methods
+uint64_t
+TraceReader::
+varint(void)
+{
+  uint64_t v(0);
+  unsigned int shift(0);
+
+  while (m_pos != m_end && shift < 64)
+    {
+      uint8_t b(*m_pos++);
+
+      v |= static_cast<uint64_t>(b & 0x7Fu) << shift;
+      if ((b & 0x80u) == 0u)
+        {
+          return v;
+        }
+      shift += 7;
+    }
+
+  m_error = true;
+  return 0;
+}
+
+uint64_t
+TraceReader::
+skip(uint64_t length)
+{
+  uint64_t offset(m_pos - m_begin);
+
+  if (length > static_cast<uint64_t>(m_end - m_pos))
+    {
+      m_error = true;
+      return offset;
+    }
+  m_pos += length;
+  return offset;
+}
+
+std::string
+TraceReader::
+string(void)
+{
+  uint64_t length(varint());
+  uint64_t offset(skip(length));
+
+  if (m_error)
+    {
+      return std::string();
+    }
+  return std::string(reinterpret_cast<const char*>(m_begin + offset), length);
+}
+
+///////////////////////////////////
+// TraceReplayPrivate methods
+TraceReplayPrivate::
+TraceReplayPrivate(const char *filename):
+  m_valid(false),
+  m_number_calls(0),
+  m_number_frames(0),
+  m_number_unhandled_pointers(0),
+  m_number_divergences(0),
+  m_number_bytes(0)
+{
+  std::ifstream file(filename, std::ios::binary);
+
+  if (file)
+    {
+      m_trace.assign(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+      m_valid = load();
+    }
+}
+
+bool
+TraceReplayPrivate::
+load(void)
+{
+  uint64_t pending_bytes(0);
+
+  if (m_trace.size() < sizeof(trace_magic)
+      || std::memcmp(m_trace.data(), trace_magic, sizeof(trace_magic)) != 0)
+    {
+      return false;
+    }
+
+  TraceReader reader(m_trace.data(), m_trace.data() + m_trace.size());
+  reader.skip(sizeof(trace_magic));
+  while (!reader.done())
+    {
+      switch (reader.varint())
+        {
+        case tag_function:
+          {
+            uint64_t id(reader.varint());
+            std::string name(reader.string());
+            std::string signature(reader.string());
+
+            if (reader.m_error
+                || id != m_functions.size()
+                || signature.empty()
+                || signature.size() > max_arguments + 1)
+              {
+                return false;
+              }
+            m_functions.push_back(ReplayFunction(name, signature));
+          }
+          break;
+
+        case tag_call:
+          if (!load_call(reader, pending_bytes))
+            {
+              return false;
+            }
+          break;
+
+        case tag_mapped_write:
+          if (!load_mapped_write(reader, pending_bytes))
+            {
+              return false;
+            }
+          break;
+
+        case tag_frame:
+          {
+            ReplayRecord R;
+
+            R.m_tag = tag_frame;
+            m_records.push_back(R);
+            ++m_number_frames;
+          }
+          break;
+
+        default:
+          return false;
+        }
+    }
+
+  return !reader.m_error;
+}
+
+bool
+TraceReplayPrivate::
+load_call(TraceReader &reader, uint64_t &pending_bytes)
+{
+  ReplayRecord R;
+  uint64_t id(reader.varint());
+
+  if (id >= m_functions.size())
+    {
+      return false;
+    }
+
+  ReplayFunction &F(m_functions[id]);
+  R.m_tag = tag_call;
+  R.m_function = id;
+  R.m_args = m_args.size();
+  R.m_pointers = m_pointers.size();
+  R.m_return_value = 0;
+
+  for (unsigned int i = 0; i < F.m_number_args; ++i)
+    {
+      m_args.push_back(reader.varint());
+    }
+
+  /* the mapped writes that precede the call are
+   * accounted to the call that flushes them
+   */
+  F.m_bytes += pending_bytes;
+  m_number_bytes += pending_bytes;
+  pending_bytes = 0;
+
+  for (unsigned int i = 0; i < F.m_number_args; ++i)
+    {
+      char c(F.m_signature[i + 1]);
+      ReplayPointer P;
+
+      if (c != 'p' && c != 'o')
+        {
+          continue;
+        }
+
+      P.m_kind = static_cast<enum payload_kind_t>(reader.varint());
+      P.m_location = 0;
+      P.m_length = 0;
+      switch (P.m_kind)
+        {
+        case payload_raw:
+          break;
+
+        case payload_unhandled:
+          ++m_number_unhandled_pointers;
+          break;
+
+        case payload_scratch:
+          P.m_length = reader.varint();
+          break;
+
+        case payload_data:
+        case payload_generated_names:
+          P.m_length = reader.varint();
+          P.m_location = reader.skip(P.m_length);
+          if (P.m_kind == payload_data)
+            {
+              F.m_bytes += P.m_length;
+              m_number_bytes += P.m_length;
+            }
+          break;
+
+        case payload_strings:
+          {
+            uint64_t count(reader.varint());
+
+            P.m_location = m_strings.size();
+            for (uint64_t s = 0; s < count && !reader.m_error; ++s)
+              {
+                uint64_t len(reader.varint());
+                uint64_t offset(reader.skip(len));
+
+                m_strings.push_back(reinterpret_cast<const char*>(m_trace.data() + offset));
+                P.m_length += len;
+              }
+            F.m_bytes += P.m_length;
+            m_number_bytes += P.m_length;
+          }
+          break;
+
+        default:
+          return false;
+        }
+      m_pointers.push_back(P);
+    }
+
+  if (F.m_signature[0] != 'n')
+    {
+      R.m_return_value = reader.varint();
+    }
+
+  ++F.m_calls;
+  ++m_number_calls;
+  m_records.push_back(R);
+  return !reader.m_error;
+}
+
+bool
+TraceReplayPrivate::
+load_mapped_write(TraceReader &reader, uint64_t &pending_bytes)
+{
+  ReplayRecord R;
+  ReplayPointer P;
+
+  R.m_tag = tag_mapped_write;
+  R.m_function = 0;
+  R.m_args = m_args.size();
+  R.m_pointers = m_pointers.size();
+  R.m_return_value = 0;
+
+  m_args.push_back(reader.varint());
+  m_args.push_back(reader.varint());
+  m_args.push_back(reader.varint());
+
+  P.m_kind = payload_data;
+  P.m_length = reader.varint();
+  P.m_location = reader.skip(P.m_length);
+  m_pointers.push_back(P);
+  m_records.push_back(R);
+
+  pending_bytes += P.m_length;
+  return !reader.m_error;
+}
+
+void*
+TraceReplayPrivate::
+resolve_pointer(const ReplayPointer &P, unsigned int arg, uint64_t bits)
+{
+  switch (P.m_kind)
+    {
+    case payload_data:
+      return m_trace.data() + P.m_location;
+
+    case payload_strings:
+      return m_strings.data() + P.m_location;
+
+    case payload_scratch:
+    case payload_generated_names:
+      {
+        uint64_t sz(P.m_length != 0 ? P.m_length : uint64_t(default_scratch_size));
+        if (m_scratch[arg].size() < sz)
+          {
+            m_scratch[arg].resize(sz);
+          }
+        return m_scratch[arg].data();
+      }
+
+    default:
+      return const_cast<uint8_t*>(as_pointer(bits));
+    }
+}
+
+uint64_t
+TraceReplayPrivate::
+replay(bool issue_gl)
+{
+  std::chrono::steady_clock::time_point start;
+  std::chrono::nanoseconds duration;
+  uint64_t args[max_arguments];
+  void *ptrs[max_arguments];
+
+  m_number_divergences = 0;
+  m_syncs.clear();
+  m_handles.clear();
+  m_mappings.clear();
+
+  start = std::chrono::steady_clock::now();
+  for (const ReplayRecord &R : m_records)
+    {
+      if (R.m_tag == tag_mapped_write)
+        {
+          std::map<MappingKey, uint8_t*>::const_iterator iter;
+          const ReplayPointer &P(m_pointers[R.m_pointers]);
+          const uint64_t *a(&m_args[R.m_args]);
+
+          iter = m_mappings.find(MappingKey(a[0] != 0u, static_cast<uint32_t>(a[1])));
+          if (iter != m_mappings.end() && iter->second)
+            {
+              std::memcpy(iter->second + a[2], m_trace.data() + P.m_location, P.m_length);
+            }
+          continue;
+        }
+
+      if (R.m_tag != tag_call)
+        {
+          continue;
+        }
+
+      const ReplayFunction &F(m_functions[R.m_function]);
+      const uint64_t *a(&m_args[R.m_args]);
+      const ReplayPointer *P(&m_pointers[R.m_pointers]);
+
+      for (unsigned int i = 0; i < F.m_number_args; ++i)
+        {
+          char c(F.m_signature[i + 1]);
+
+          args[i] = a[i];
+          ptrs[i] = nullptr;
+          if (c == 'p' || c == 'o')
+            {
+              ptrs[i] = resolve_pointer(*P, i, a[i]);
+              ++P;
+            }
+          else if (c == 's')
+            {
+              std::map<uint64_t, uint64_t>::const_iterator iter;
+
+              iter = m_syncs.find(a[i]);
+              args[i] = (iter != m_syncs.end()) ? iter->second : 0u;
+            }
+          else if (F.m_rules.m_remap_handles)
+            {
+              std::map<uint64_t, uint64_t>::const_iterator iter;
+
+              iter = m_handles.find(a[i]);
+              if (iter != m_handles.end())
+                {
+                  args[i] = iter->second;
+                }
+            }
+        }
+
+      if (!issue_gl || !F.m_function || F.m_rules.m_special == special_skip_on_replay)
+        {
+          continue;
+        }
+
+      uint64_t return_value;
+      return_value = F.m_function(args, ptrs);
+
+      switch (F.m_rules.m_special)
+        {
+        case special_map_range:
+        case special_map_named_range:
+          m_mappings[MappingKey(F.m_rules.m_special == special_map_named_range,
+                                static_cast<uint32_t>(args[0]))] =
+            const_cast<uint8_t*>(as_pointer(return_value));
+          break;
+
+        case special_unmap:
+        case special_unmap_named:
+          m_mappings.erase(MappingKey(F.m_rules.m_special == special_unmap_named,
+                                      static_cast<uint32_t>(args[0])));
+          break;
+
+        case special_delete_sync:
+          m_syncs.erase(a[0]);
+          break;
+
+        case special_get_handle:
+          m_handles[R.m_return_value] = return_value;
+          break;
+
+        default:
+          break;
+        }
+
+      if (F.m_signature[0] == 's')
+        {
+          m_syncs[R.m_return_value] = return_value;
+        }
+      else if (F.m_rules.m_check_return && return_value != R.m_return_value)
+        {
+          ++m_number_divergences;
+        }
+
+      P = &m_pointers[R.m_pointers];
+      for (unsigned int i = 0; i < F.m_number_args; ++i)
+        {
+          char c(F.m_signature[i + 1]);
+          if (c == 'p' || c == 'o')
+            {
+              if (P->m_kind == payload_generated_names
+                  && std::memcmp(ptrs[i], m_trace.data() + P->m_location, P->m_length) != 0)
+                {
+                  ++m_number_divergences;
+                }
+              ++P;
+            }
+        }
+    }
+
+  if (issue_gl)
+    {
+      fastuidraw::gl_binding::replay_function_type finish;
+
+      finish = fastuidraw::gl_binding::replay_function("glFinish");
+      if (finish)
+        {
+          finish(nullptr, nullptr);
+        }
+    }
+
+  duration = std::chrono::steady_clock::now() - start;
+  return duration.count();
+}
+
+///////////////////////////////////
+// capture hooks called by the ngl capture functions
+void
+fastuidraw::gl_binding::
+capture_pre_call(const char *function_name, const char *signature,
+                 const uint64_t *args, unsigned int number_args)
+{
+  capture().pre_call(function_name, signature, args, number_args);
+}
+
+void
+fastuidraw::gl_binding::
+capture_post_call(uint64_t return_value)
+{
+  capture().post_call(return_value);
+}
+
+///////////////////////////////////
+// gl_binding capture methods
+bool
+fastuidraw::gl_binding::
+begin_capture(c_string filename)
+{
+  return capture().begin(filename);
+}
+
+void
+fastuidraw::gl_binding::
+end_capture(void)
+{
+  capture().end();
+}
+
+bool
+fastuidraw::gl_binding::
+capturing(void)
+{
+  return capture().capturing();
+}
+
+void
+fastuidraw::gl_binding::
+capture_frame_marker(void)
+{
+  capture().frame_marker();
+}
+
+///////////////////////////////////
+// fastuidraw::gl_binding::TraceReplay methods
+fastuidraw::gl_binding::TraceReplay::
+TraceReplay(c_string filename)
+{
+  m_d = FASTUIDRAWnew TraceReplayPrivate(filename);
+}
+
+fastuidraw::gl_binding::TraceReplay::
+~TraceReplay()
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+bool
+fastuidraw::gl_binding::TraceReplay::
+valid(void) const
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  return d->m_valid;
+}
+
+uint64_t
+fastuidraw::gl_binding::TraceReplay::
+replay(enum mode_t mode)
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  return d->m_valid ? d->replay(mode == replay_gl) : 0u;
+}
+
+unsigned int
+fastuidraw::gl_binding::TraceReplay::
+number_calls(void) const
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  return d->m_number_calls;
+}
+
+uint64_t
+fastuidraw::gl_binding::TraceReplay::
+number_bytes(void) const
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  return d->m_number_bytes;
+}
+
+unsigned int
+fastuidraw::gl_binding::TraceReplay::
+number_frames(void) const
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  return d->m_number_frames;
+}
+
+unsigned int
+fastuidraw::gl_binding::TraceReplay::
+number_functions(void) const
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  return d->m_functions.size();
+}
+
+fastuidraw::c_string
+fastuidraw::gl_binding::TraceReplay::
+function_name(unsigned int F) const
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  FASTUIDRAWassert(F < d->m_functions.size());
+  return d->m_functions[F].m_name.c_str();
+}
+
+unsigned int
+fastuidraw::gl_binding::TraceReplay::
+function_calls(unsigned int F) const
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  FASTUIDRAWassert(F < d->m_functions.size());
+  return d->m_functions[F].m_calls;
+}
+
+uint64_t
+fastuidraw::gl_binding::TraceReplay::
+function_bytes(unsigned int F) const
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  FASTUIDRAWassert(F < d->m_functions.size());
+  return d->m_functions[F].m_bytes;
+}
+
+unsigned int
+fastuidraw::gl_binding::TraceReplay::
+number_unhandled_pointers(void) const
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  return d->m_number_unhandled_pointers;
+}
+
+unsigned int
+fastuidraw::gl_binding::TraceReplay::
+number_divergences(void) const
+{
+  TraceReplayPrivate *d;
+  d = static_cast<TraceReplayPrivate*>(m_d);
+  return d->m_number_divergences;
+}
@@ -93,6 +93,8 @@ public:
   string m_function_prefix, m_LoadingFunctionName;
   string m_ErrorLoadingFunctionName;
   std::string m_pre_gl_call_name, m_post_gl_call_name;
+  std::string m_capture_pre_call_name, m_capture_post_call_name;
+  std::string m_capture_install_name, m_replay_lookup_name;
   string m_loadAllFunctionsName, m_argumentName;
   string m_genericCallBackType, m_kglLoggingStream;
   string m_kglLoggingStreamNameOnly;
@@ -146,6 +148,10 @@ SetFunctionPrefix(const string &pre)
   GlobalElements::get().m_LoadingFunctionName=GlobalElements::get().m_function_prefix+"get_proc";
   GlobalElements::get().m_post_gl_call_name=GlobalElements::get().m_function_prefix+"post_call";
   GlobalElements::get().m_pre_gl_call_name=GlobalElements::get().m_function_prefix+"pre_call";
+  GlobalElements::get().m_capture_pre_call_name=GlobalElements::get().m_function_prefix+"capture_pre_call";
+  GlobalElements::get().m_capture_post_call_name=GlobalElements::get().m_function_prefix+"capture_post_call";
+  GlobalElements::get().m_capture_install_name=GlobalElements::get().m_function_prefix+"capture_install_functions";
+  GlobalElements::get().m_replay_lookup_name=GlobalElements::get().m_function_prefix+"replay_function";
   GlobalElements::get().m_ErrorLoadingFunctionName=GlobalElements::get().m_function_prefix+"on_load_function_error";
   GlobalElements::get().m_loadAllFunctionsName=GlobalElements::get().m_function_prefix+"load_all_functions";
   GlobalElements::get().m_kglLoggingStreamNameOnly=GlobalElements::get().m_function_prefix+"LogStream";
@@ -186,6 +192,22 @@ const string&
 openGL_function_info::
 function_load_all() { return GlobalElements::get().m_loadAllFunctionsName; }
 
+const string&
+openGL_function_info::
+function_capture_pre_call(void) { return GlobalElements::get().m_capture_pre_call_name; }
+
+const string&
+openGL_function_info::
+function_capture_post_call(void) { return GlobalElements::get().m_capture_post_call_name; }
+
+const string&
+openGL_function_info::
+function_capture_install(void) { return GlobalElements::get().m_capture_install_name; }
+
+const string&
+openGL_function_info::
+function_replay_lookup(void) { return GlobalElements::get().m_replay_lookup_name; }
+
 const string&
 openGL_function_info::
 argument_name(void) { return GlobalElements::get().m_argumentName; }
@@ -400,6 +422,174 @@ SetNames(const string &functionName,
   m_doNothingFunctionName=GlobalElements::get().m_function_prefix+"do_nothing_function_"+m_functionName;
   m_existsFunctionName=GlobalElements::get().m_function_prefix+"exists_function_"+m_functionName;
   m_getFunctionName=GlobalElements::get().m_function_prefix+"get_function_ptr_"+m_functionName;
+  m_captureFunctionName=GlobalElements::get().m_function_prefix+"capture_function_"+m_functionName;
+  m_captureRealFunctionName=GlobalElements::get().m_function_prefix+"capture_real_function_"+m_functionName;
+  m_replayFunctionName=GlobalElements::get().m_function_prefix+"replay_function_"+m_functionName;
+}
+
+char
+openGL_function_info::
+arg_signature(int i)
+{
+  if (arg_type_is_pointer(i))
+    {
+      /* a pointer to non-const is (at least potentially)
+       * written to by GL
+       */
+      return (m_argTypes[i].first.m_front.find("const") != string::npos) ? 'p' : 'o';
+    }
+
+  string tp(RemoveWhiteSpace(m_argTypes[i].first.m_front));
+  if (tp == "GLsync" || tp == "constGLsync")
+    {
+      return 's';
+    }
+  return 'v';
+}
+
+char
+openGL_function_info::
+return_signature(void)
+{
+  string tp(RemoveWhiteSpace(m_returnType));
+
+  if (!returns_value())
+    {
+      return 'n';
+    }
+  if (tp.find('*') != string::npos)
+    {
+      return 'p';
+    }
+  if (tp == "GLsync")
+    {
+      return 's';
+    }
+  return 'v';
+}
+
+string
+openGL_function_info::
+arg_cast_type(int i)
+{
+  const ArgumentType &tp(m_argTypes[i].first);
+
+  if (!tp.m_back.empty())
+    {
+      /* an array argument is passed as a pointer */
+      return tp.m_front + "*";
+    }
+
+  if (!arg_type_is_pointer(i))
+    {
+      /* a const on a value does not affect the call
+       * and gets in the way of replay_value<>
+       */
+      string::size_type p;
+
+      p = tp.m_front.find("const ");
+      if (p == 0)
+        {
+          return tp.m_front.substr(strlen("const "));
+        }
+    }
+  return tp.m_front;
+}
+
+void
+openGL_function_info::
+output_capture_to_source(ostream &sourceFile)
+{
+  int i;
+
+  /* the real function pointer while capturing */
+  sourceFile << function_pointer_type() << " " << capture_real_function_name()
+             << " = nullptr;\n";
+
+  /* the capture function, which is what the function pointer
+   * points to while capturing; it records the call and its
+   * arguments before and the return value after the call.
+   */
+  sourceFile << front_material() << " " << capture_function_name() << "("
+             << full_arg_list_with_names() <<  ")\n{\n\t"
+             << "uint64_t capture_args[" << std::max(1, number_arguments()) << "] = { ";
+  for(i = 0; i < number_arguments(); ++i)
+    {
+      if (i != 0)
+        {
+          sourceFile << ", ";
+        }
+      sourceFile << "capture_bits(" << argument_name() << i << ")";
+    }
+  if (number_arguments() == 0)
+    {
+      sourceFile << "0";
+    }
+  sourceFile << " };\n\t";
+
+  if (returns_value())
+    {
+      sourceFile << return_type() << " retval;\n\t";
+    }
+
+  sourceFile << function_capture_pre_call() << "(\"" << function_name() << "\", \""
+             << return_signature();
+  for(i = 0; i < number_arguments(); ++i)
+    {
+      sourceFile << arg_signature(i);
+    }
+  sourceFile << "\", capture_args, " << number_arguments() << ");\n\t";
+
+  if (returns_value())
+    {
+      sourceFile << "retval = ";
+    }
+  sourceFile << capture_real_function_name() << "(" << argument_list_names_only() << ");\n\t";
+
+  if (returns_value())
+    {
+      sourceFile << function_capture_post_call() << "(capture_bits(retval));\n\t"
+                 << "return retval;\n}\n\n";
+    }
+  else
+    {
+      sourceFile << function_capture_post_call() << "(0);\n}\n\n";
+    }
+
+  /* the replay function, which issues the call with arguments
+   * decoded from a trace
+   */
+  sourceFile << "uint64_t " << replay_function_name()
+             << "(const uint64_t *replay_args, void *const *replay_ptrs)\n{\n\t"
+             << "(void)replay_args;\n\t(void)replay_ptrs;\n\t";
+  if (returns_value())
+    {
+      sourceFile << "return capture_bits(";
+    }
+  sourceFile << get_function_name() << "()(";
+  for(i = 0; i < number_arguments(); ++i)
+    {
+      if (i != 0)
+        {
+          sourceFile << ", ";
+        }
+      if (arg_type_is_pointer(i))
+        {
+          sourceFile << "(" << arg_cast_type(i) << ")(replay_ptrs[" << i << "])";
+        }
+      else
+        {
+          sourceFile << "replay_value<" << arg_cast_type(i) << ">(replay_args[" << i << "])";
+        }
+    }
+  if (returns_value())
+    {
+      sourceFile << "));\n}\n\n";
+    }
+  else
+    {
+      sourceFile << ");\n\treturn 0;\n}\n\n";
+    }
 }
 
 void
@@ -583,6 +773,8 @@ output_to_source(ostream &sourceFile)
                  << m_getFunctionName << "();\n\t"
                  << "return " << function_pointer_name() << "!="
                  << do_nothing_function_name() << ";\n}\n\n";
+
+      output_capture_to_source(sourceFile);
     }
   #endif
 
@@ -821,6 +1013,79 @@ void
 openGL_function_info::
 SourceEnd(ostream &sourceFile, const list<string> &fileNames)
 {
+  /* install (or uninstall) the capture functions by
+   * swapping the function pointers; functions not yet
+   * loaded are loaded first without emitting warnings
+   */
+  sourceFile << "\n\nbool " << function_capture_install() << "(bool install)\n{\n\t";
+  #ifndef NOGLFUNCTION_POINTERS
+    {
+      sourceFile << "if (install)\n\t{\n\t";
+      for(map<string,openGL_function_info*>::iterator i=GlobalElements::get().m_lookUp.begin();
+          i!=GlobalElements::get().m_lookUp.end(); ++i)
+        {
+          sourceFile << "\tif (" << i->second->function_pointer_name() << "=="
+                     << i->second->local_function_name() << ")\n\t\t{\n\t\t\t"
+                     << i->second->function_pointer_name() << "=("
+                     << i->second->function_pointer_type() << ")"
+                     << function_loader() << "(\"" << i->second->function_name() << "\");\n\t\t\t"
+                     << "if (" << i->second->function_pointer_name() << "==nullptr)\n\t\t\t\t"
+                     << i->second->function_pointer_name() << "="
+                     << i->second->do_nothing_function_name() << ";\n\t\t}\n\t\t"
+                     << "if (" << i->second->function_pointer_name() << "!="
+                     << i->second->capture_function_name() << ")\n\t\t{\n\t\t\t"
+                     << i->second->capture_real_function_name() << "="
+                     << i->second->function_pointer_name() << ";\n\t\t\t"
+                     << i->second->function_pointer_name() << "="
+                     << i->second->capture_function_name() << ";\n\t\t}\n\t";
+        }
+      sourceFile << "}\n\telse\n\t{\n\t";
+      for(map<string,openGL_function_info*>::iterator i=GlobalElements::get().m_lookUp.begin();
+          i!=GlobalElements::get().m_lookUp.end(); ++i)
+        {
+          sourceFile << "\tif (" << i->second->function_pointer_name() << "=="
+                     << i->second->capture_function_name() << ")\n\t\t\t"
+                     << i->second->function_pointer_name() << "="
+                     << i->second->capture_real_function_name() << ";\n\t";
+        }
+      sourceFile << "}\n\treturn true;\n}\n";
+    }
+  #else
+    {
+      sourceFile << "(void)install;\n\treturn false;\n}\n";
+    }
+  #endif
+
+  /* lookup of the replay functions by name via
+   * a binary search; the entries are sorted by
+   * name because m_lookUp is
+   */
+  sourceFile << "\n\nreplay_function_type " << function_replay_lookup() << "(const char *name)\n{\n\t";
+  #ifndef NOGLFUNCTION_POINTERS
+    {
+      sourceFile << "static const struct { const char *m_name; replay_function_type m_function; } entries[] =\n\t{\n\t";
+      for(map<string,openGL_function_info*>::iterator i=GlobalElements::get().m_lookUp.begin();
+          i!=GlobalElements::get().m_lookUp.end(); ++i)
+        {
+          sourceFile << "\t{ \"" << i->second->function_name() << "\", "
+                     << i->second->replay_function_name() << " },\n\t";
+        }
+      sourceFile << "};\n\t"
+                 << "unsigned int begin(0), end(sizeof(entries) / sizeof(entries[0]));\n\t"
+                 << "while (begin < end)\n\t{\n\t\t"
+                 << "unsigned int mid((begin + end) / 2);\n\t\t"
+                 << "int c(std::strcmp(name, entries[mid].m_name));\n\t\t"
+                 << "if (c == 0)\n\t\t\treturn entries[mid].m_function;\n\t\t"
+                 << "if (c < 0)\n\t\t\tend = mid;\n\t\t"
+                 << "else\n\t\t\tbegin = mid + 1;\n\t}\n\t"
+                 << "return nullptr;\n}\n";
+    }
+  #else
+    {
+      sourceFile << "(void)name;\n\treturn nullptr;\n}\n";
+    }
+  #endif
+
   sourceFile << "\n\nvoid " << function_load_all() << "(bool emit_load_warning)\n{\n\t";
   #ifndef NOGLFUNCTION_POINTERS
     {
@@ -860,10 +1125,24 @@ SourceStart(ostream &sourceFile, const list<string> &fileNames)
     }
 
   sourceFile << "#include <sstream>\n"
-             << "#include <iomanip>\n\n";
+             << "#include <iomanip>\n"
+             << "#include <cstring>\n"
+             << "#include <stdint.h>\n\n";
 
   begin_namespace(GlobalElements::get().m_namespace, sourceFile);
 
+  /* the capture and replay code passes every value
+   * (including pointers) as its bits in a uint64_t
+   */
+  sourceFile << "template<typename T>\n"
+             << "inline uint64_t capture_bits(T v)\n{\n\t"
+             << "static_assert(sizeof(T) <= sizeof(uint64_t), \"GL value too large to capture\");\n\t"
+             << "uint64_t r(0);\n\tstd::memcpy(&r, &v, sizeof(T));\n\treturn r;\n}\n\n"
+             << "template<typename T>\n"
+             << "inline T replay_value(uint64_t v)\n{\n\t"
+             << "T r;\n\tstd::memcpy(&r, &v, sizeof(T));\n\treturn r;\n}\n\n"
+             << "typedef uint64_t (*replay_function_type)(const uint64_t *args, void *const *ptrs);\n\n";
+
 
   sourceFile << "void* " << function_loader() << "(const char *name);\n"
              << "void " << function_error_loading() << "(const char *fname);\n"
@@ -872,6 +1151,11 @@ SourceStart(ostream &sourceFile, const list<string> &fileNames)
              << "(const char *call, const char *src, const char *function_name, void* fptr, const char *fileName, int line);\n"
              << "void " << function_pre_gl_call()
              << "(const char *call, const char *src, const char *function_name, void* fptr, const char *fileName, int line);\n"
+             << "void " << function_capture_pre_call()
+             << "(const char *function_name, const char *signature, const uint64_t *args, unsigned int number_args);\n"
+             << "void " << function_capture_post_call() << "(uint64_t return_value);\n"
+             << "bool " << function_capture_install() << "(bool install);\n"
+             << "replay_function_type " << function_replay_lookup() << "(const char *name);\n"
              << "void " << function_load_all() << "(void);\n\n";
 }
 
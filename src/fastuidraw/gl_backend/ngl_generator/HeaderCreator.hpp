@@ -89,6 +89,7 @@ private:
   string m_argListWithNames, m_argListWithoutNames, m_argListOnly;
   string m_functionPointerName, m_debugFunctionName, m_localFunctionName;
   string m_doNothingFunctionName, m_existsFunctionName, m_getFunctionName;
+  string m_captureFunctionName, m_captureRealFunctionName, m_replayFunctionName;
 
   string m_createdFrom;  // string that genertated this object
   string m_argListInput; // the string that generated our arguments lists.
@@ -153,6 +154,22 @@ public:
   const string&
   function_load_all();
 
+  static
+  const string&
+  function_capture_pre_call(void);
+
+  static
+  const string&
+  function_capture_post_call(void);
+
+  static
+  const string&
+  function_capture_install(void);
+
+  static
+  const string&
+  function_replay_lookup(void);
+
   static
   const string&
   argument_name(void);
@@ -204,6 +221,18 @@ public:
   const string&
   load_function_name(void) { return m_existsFunctionName; }
 
+  const string&
+  get_function_name(void) { return m_getFunctionName; }
+
+  const string&
+  capture_function_name(void) { return m_captureFunctionName; }
+
+  const string&
+  capture_real_function_name(void) { return m_captureRealFunctionName; }
+
+  const string&
+  replay_function_name(void) { return m_replayFunctionName; }
+
   const string&
   return_type(void) { return m_returnType; }
 
@@ -232,6 +261,24 @@ public:
   int
   number_arguments(void) { return m_argTypes.size(); }
 
+  /* character describing an argument or return value to the
+   * capture and replay code: 'p' for a pointer to const, 'o'
+   * for a pointer to non-const, 's' for a GLsync, 'v' for any
+   * other value and 'n' for no value
+   */
+  char
+  arg_signature(int i);
+
+  char
+  return_signature(void);
+
+  /* type to which to cast a value to pass as the i'th argument */
+  string
+  arg_cast_type(int i);
+
+  void
+  output_capture_to_source(ostream &sourceFile);
+
   const string&
   front_material(void) { return m_frontMaterial; }
 
@@ -101,6 +101,9 @@ namespace
       m_data_store_backing(fastuidraw::gl::PainterEngineGL::data_store_tbo),
       m_number_pools(3),
       m_break_on_shader_change(false),
+      m_use_indirect_draw(false),
+      m_reorder_opaque_draws(false),
+      m_draw_reorder_window(0),
       m_clipping_type(fastuidraw::gl::PainterEngineGL::clipping_via_gl_clip_distance),
       m_number_context_textures(8),
       /* on Mesa/i965 using switch statement gives much slower
@@ -109,6 +112,7 @@ namespace
       m_vert_shader_use_switch(false),
       m_frag_shader_use_switch(false),
       m_blend_shader_use_switch(false),
+      m_order_item_shaders_by_usage(false),
       m_assign_layout_to_vertex_shader_inputs(true),
       m_assign_layout_to_varyings(false),
       m_assign_binding_points(true),
@@ -124,6 +128,7 @@ namespace
       m_assume_single_gl_context(true),
       m_support_dual_src_blend_shaders(true),
       m_use_uber_item_shader(true),
+      m_async_item_program_build(false),
       m_use_glsl_unpack_fp16(true)
     {}
 
@@ -133,11 +138,15 @@ namespace
     enum fastuidraw::gl::PainterEngineGL::data_store_backing_t m_data_store_backing;
     unsigned int m_number_pools;
     bool m_break_on_shader_change;
+    bool m_use_indirect_draw;
+    bool m_reorder_opaque_draws;
+    unsigned int m_draw_reorder_window;
     enum fastuidraw::gl::PainterEngineGL::clipping_type_t m_clipping_type;
     unsigned int m_number_context_textures;
     bool m_vert_shader_use_switch;
     bool m_frag_shader_use_switch;
     bool m_blend_shader_use_switch;
+    bool m_order_item_shaders_by_usage;
     bool m_assign_layout_to_vertex_shader_inputs;
     bool m_assign_layout_to_varyings;
     bool m_assign_binding_points;
@@ -149,6 +158,7 @@ namespace
     bool m_assume_single_gl_context;
     bool m_support_dual_src_blend_shaders;
     bool m_use_uber_item_shader;
+    bool m_async_item_program_build;
     bool m_use_glsl_unpack_fp16;
 
     std::string m_glsl_version_override;
@@ -159,6 +169,7 @@ namespace
     fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas> m_image_atlas;
     fastuidraw::reference_counted_ptr<fastuidraw::ColorStopAtlas> m_colorstop_atlas;
     fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlas> m_glyph_atlas;
+    fastuidraw::reference_counted_ptr<fastuidraw::gl::ProgramBinaryCache> m_program_binary_cache;
   };
 
   class PainterEngineGLPrivate
@@ -267,6 +278,7 @@ compute_uber_shader_params(const fastuidraw::gl::PainterEngineGL::ConfigurationG
     .frag_shader_use_switch(params.frag_shader_use_switch())
     .number_context_textures(params.number_context_textures())
     .blend_shader_use_switch(params.blend_shader_use_switch())
+    .order_item_shaders_by_usage(params.order_item_shaders_by_usage())
     .data_store_backing(params.data_store_backing())
     .data_blocks_per_store_buffer(params.data_blocks_per_store_buffer())
     .glyph_data_backing(params.glyph_atlas_params().glyph_data_backing_store_type())
@@ -669,6 +681,25 @@ glsl_version_override(c_string v)
   return *this;
 }
 
+const fastuidraw::reference_counted_ptr<fastuidraw::gl::ProgramBinaryCache>&
+fastuidraw::gl::PainterEngineGL::ConfigurationGL::
+program_binary_cache(void) const
+{
+  ConfigurationGLPrivate *d;
+  d = static_cast<ConfigurationGLPrivate*>(m_d);
+  return d->m_program_binary_cache;
+}
+
+fastuidraw::gl::PainterEngineGL::ConfigurationGL&
+fastuidraw::gl::PainterEngineGL::ConfigurationGL::
+program_binary_cache(const reference_counted_ptr<ProgramBinaryCache> &v)
+{
+  ConfigurationGLPrivate *d;
+  d = static_cast<ConfigurationGLPrivate*>(m_d);
+  d->m_program_binary_cache = v;
+  return *this;
+}
+
 fastuidraw::gl::PainterEngineGL::ConfigurationGL&
 fastuidraw::gl::PainterEngineGL::ConfigurationGL::
 configure_from_context(bool choose_optimal_rendering_quality,
@@ -878,6 +909,16 @@ adjust_for_context(const ContextProperties &ctx)
         }
     }
 
+  if (d->m_async_item_program_build
+      && !ctx.has_extension("GL_KHR_parallel_shader_compile")
+      && !ctx.has_extension("GL_ARB_parallel_shader_compile"))
+    {
+      /* without a way to query if a build has completed
+       * without blocking, asynchronous builds only add work.
+       */
+      d->m_async_item_program_build = false;
+    }
+
   #ifndef FASTUIDRAW_GL_USE_GLES
     {
       if (d->m_use_glsl_unpack_fp16)
@@ -966,9 +1007,14 @@ adjust_for_context(const ContextProperties &ctx)
            */
           d->m_assign_binding_points = false;
         }
+
+      d->m_use_indirect_draw = false;
     }
   #else
     {
+      d->m_use_indirect_draw = d->m_use_indirect_draw
+        && (ctx.version() >= ivec2(4, 3) || ctx.has_extension("GL_ARB_multi_draw_indirect"));
+
       if (ctx.version() < ivec2(4, 2))
         {
           d->m_assign_layout_to_varyings = d->m_assign_layout_to_varyings
@@ -1108,6 +1154,12 @@ setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, Configuration
                  unsigned int, number_pools)
 setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
                  bool, break_on_shader_change)
+setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
+                 bool, use_indirect_draw)
+setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
+                 bool, reorder_opaque_draws)
+setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
+                 unsigned int, draw_reorder_window)
 setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
                  enum fastuidraw::gl::PainterEngineGL::clipping_type_t, clipping_type)
 setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
@@ -1118,6 +1170,8 @@ setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, Configuration
                  bool, frag_shader_use_switch)
 setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
                  bool, blend_shader_use_switch)
+setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
+                 bool, order_item_shaders_by_usage)
 setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
                  enum fastuidraw::gl::PainterEngineGL::data_store_backing_t, data_store_backing)
 setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
@@ -1138,6 +1192,8 @@ setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, Configuration
                  bool, support_dual_src_blend_shaders)
 setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
                  bool, use_uber_item_shader)
+setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
+                 bool, async_item_program_build)
 setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
                  bool, use_glsl_unpack_fp16)
 setget_implement(fastuidraw::gl::PainterEngineGL::ConfigurationGL, ConfigurationGLPrivate,
@@ -1189,7 +1245,9 @@ PainterEngineGL(const ConfigurationGL &config_gl,
                 FASTUIDRAWnew detail::PainterShaderRegistrarGL(config_gl, uber_params),
                 ConfigurationBase()
                 .number_context_textures(config_gl.number_context_textures())
-                .supports_bindless_texturing(uber_params.supports_bindless_texturing()),
+                .supports_bindless_texturing(uber_params.supports_bindless_texturing())
+                .reorder_opaque_draws(config_gl.reorder_opaque_draws())
+                .draw_reorder_window(config_gl.draw_reorder_window()),
                 shaders)
 {
   PainterEngineGLPrivate *d;
@@ -44,6 +44,48 @@
 
 namespace
 {
+  template<typename T>
+  uint64_t
+  compute_shader_usage(const fastuidraw::PainterShaderRegistrar &registrar,
+                       const T &shader)
+  {
+    unsigned int ID;
+    uint64_t return_value(0u);
+
+    ID = shader.ID(registrar);
+    for (unsigned int i = 0, endi = shader.number_sub_shaders(); i < endi; ++i)
+      {
+        return_value += registrar.item_shader_usage(ID + i);
+      }
+    return return_value;
+  }
+
+  template<typename T>
+  class ShaderByUsage
+  {
+  public:
+    ShaderByUsage(const fastuidraw::PainterShaderRegistrar &registrar,
+                  const fastuidraw::reference_counted_ptr<T> &shader):
+      m_shader(shader),
+      m_usage(compute_shader_usage(registrar, *shader)),
+      m_ID(shader->ID(registrar))
+    {}
+
+    bool
+    operator<(const ShaderByUsage &rhs) const
+    {
+      /* most used first, ties broken by ID so that
+       * the order (and thus the GLSL) is deterministic
+       */
+      return m_usage > rhs.m_usage
+        || (m_usage == rhs.m_usage && m_ID < rhs.m_ID);
+    }
+
+    fastuidraw::reference_counted_ptr<T> m_shader;
+    uint64_t m_usage;
+    unsigned int m_ID;
+  };
+
   enum uniform_ubo_layout
     {
       uniform_ubo_resolution_x_offset,
@@ -88,6 +130,7 @@ namespace
       m_vert_shader_use_switch(false),
       m_frag_shader_use_switch(false),
       m_blend_shader_use_switch(false),
+      m_order_item_shaders_by_usage(false),
       m_data_store_backing(fastuidraw::glsl::PainterShaderRegistrarGLSL::data_store_tbo),
       m_data_blocks_per_store_buffer(-1),
       m_glyph_data_backing(fastuidraw::glsl::PainterShaderRegistrarGLSL::glyph_data_tbo),
@@ -127,6 +170,7 @@ namespace
     bool m_vert_shader_use_switch;
     bool m_frag_shader_use_switch;
     bool m_blend_shader_use_switch;
+    bool m_order_item_shaders_by_usage;
     enum fastuidraw::glsl::PainterShaderRegistrarGLSL::data_store_backing_t m_data_store_backing;
     int m_data_blocks_per_store_buffer;
     enum fastuidraw::glsl::PainterShaderRegistrarGLSL::glyph_data_backing_t m_glyph_data_backing;
@@ -246,6 +290,7 @@ namespace
                      fastuidraw::glsl::ShaderSource &out_fragment,
                      const fastuidraw::glsl::PainterShaderRegistrarGLSL::UberShaderParams &construct_params,
                      const fastuidraw::glsl::PainterShaderRegistrarGLSL::ShaderFilter<T> *shader_filter,
+                     bool order_by_usage,
                      fastuidraw::c_string discard_macro_value);
 
     template<typename T>
@@ -305,6 +350,7 @@ namespace
     fastuidraw::glsl::ShaderSource::MacroSet m_banded_rays_macros, m_restricted_rays_macros;;
 
     fastuidraw::glsl::varying_list m_clip_varyings;
+    fastuidraw::glsl::detail::StreamedShaderCache m_streamed_shader_cache;
     fastuidraw::glsl::PainterShaderRegistrarGLSL *m_p;
   };
 }
@@ -1050,15 +1096,18 @@ construct_shader_common(enum fastuidraw::PainterBlendShader::shader_type blend_t
     {
       stream_uber_blend_shader(params.blend_shader_use_switch(), frag,
                                make_c_array(m_blend_shaders[blend_type].m_shaders),
-                               blend_type, *m_p);
+                               blend_type, *m_p,
+                               &m_streamed_shader_cache);
 
       stream_uber_brush_vert_shader(params.vert_shader_use_switch(), vert,
                                     make_c_array(m_custom_brush_shaders.m_shaders),
-                                    uber_shader_varyings, brush_varying_datum, *m_p);
+                                    uber_shader_varyings, brush_varying_datum, *m_p,
+                                    &m_streamed_shader_cache);
 
       stream_uber_brush_frag_shader(params.frag_shader_use_switch(), frag,
                                     make_c_array(m_custom_brush_shaders.m_shaders),
-                                    uber_shader_varyings, brush_varying_datum, *m_p);
+                                    uber_shader_varyings, brush_varying_datum, *m_p,
+                                    &m_streamed_shader_cache);
     }
 }
 
@@ -1073,6 +1122,7 @@ construct_shader(enum fastuidraw::PainterBlendShader::shader_type blend_type,
                  fastuidraw::glsl::ShaderSource &frag,
                  const fastuidraw::glsl::PainterShaderRegistrarGLSL::UberShaderParams &params,
                  const fastuidraw::glsl::PainterShaderRegistrarGLSL::ShaderFilter<T> *shader_filter,
+                 bool order_by_usage,
                  fastuidraw::c_string discard_macro_value)
 {
   using namespace fastuidraw;
@@ -1100,6 +1150,25 @@ construct_shader(enum fastuidraw::PainterBlendShader::shader_type blend_type,
       item_shaders = make_c_array(shaders.m_shaders);
     }
 
+  if (order_by_usage)
+    {
+      std::vector<ShaderByUsage<T> > sorted;
+
+      sorted.reserve(item_shaders.size());
+      for(const auto &sh : item_shaders)
+        {
+          sorted.push_back(ShaderByUsage<T>(*m_p, sh));
+        }
+      std::sort(sorted.begin(), sorted.end());
+
+      work_shaders.clear();
+      for(const auto &e : sorted)
+        {
+          work_shaders.push_back(e.m_shader);
+        }
+      item_shaders = make_c_array(work_shaders);
+    }
+
   uber_shader_varyings.add_varyings("shader",
                                     shaders.m_number_varyings,
                                     &shader_varying_datum);
@@ -1109,10 +1178,12 @@ construct_shader(enum fastuidraw::PainterBlendShader::shader_type blend_type,
                           params, discard_macro_value);
 
   stream_uber_vert_shader(params.vert_shader_use_switch(), vert, item_shaders,
-                          uber_shader_varyings, shader_varying_datum, *m_p);
+                          uber_shader_varyings, shader_varying_datum, *m_p,
+                          &m_streamed_shader_cache);
 
   stream_uber_frag_shader(params.frag_shader_use_switch(), frag, item_shaders,
-                          uber_shader_varyings, shader_varying_datum, *m_p);
+                          uber_shader_varyings, shader_varying_datum, *m_p,
+                          &m_streamed_shader_cache);
 }
 
 template<typename T>
@@ -1153,10 +1224,25 @@ construct_shader(enum fastuidraw::PainterBlendShader::shader_type blend_type,
                           params, discard_macro_value);
 
   stream_uber_vert_shader(params.vert_shader_use_switch(), vert, item_shaders,
-                          uber_shader_varyings, shader_varying_datum, *m_p);
+                          uber_shader_varyings, shader_varying_datum, *m_p,
+                          &m_streamed_shader_cache);
 
   stream_uber_frag_shader(params.frag_shader_use_switch(), frag, item_shaders,
-                          uber_shader_varyings, shader_varying_datum, *m_p);
+                          uber_shader_varyings, shader_varying_datum, *m_p,
+                          &m_streamed_shader_cache);
+}
+
+//////////////////////////////////////////////////////////////////////
+// fastuidraw::glsl::PainterShaderRegistrarGLSLTypes::ItemShaderUsageFilter methods
+bool
+fastuidraw::glsl::PainterShaderRegistrarGLSLTypes::ItemShaderUsageFilter::
+use_shader(const reference_counted_ptr<PainterItemShaderGLSL> &shader) const
+{
+  if (m_filter && !m_filter->use_shader(shader))
+    {
+      return false;
+    }
+  return compute_shader_usage(m_registrar, *shader) > 0u;
 }
 
 //////////////////////////////////////////////////////
@@ -1367,6 +1453,8 @@ setget_implement(fastuidraw::glsl::PainterShaderRegistrarGLSL::UberShaderParams,
                  UberShaderParamsPrivate, bool, frag_shader_use_switch)
 setget_implement(fastuidraw::glsl::PainterShaderRegistrarGLSL::UberShaderParams,
                  UberShaderParamsPrivate, bool, blend_shader_use_switch)
+setget_implement(fastuidraw::glsl::PainterShaderRegistrarGLSL::UberShaderParams,
+                 UberShaderParamsPrivate, bool, order_item_shaders_by_usage)
 setget_implement(fastuidraw::glsl::PainterShaderRegistrarGLSL::UberShaderParams,
                  UberShaderParamsPrivate, bool, use_uvec2_for_bindless_handle)
 setget_implement(fastuidraw::glsl::PainterShaderRegistrarGLSL::UberShaderParams,
@@ -1689,6 +1777,7 @@ construct_item_uber_shader(enum PainterBlendShader::shader_type tp,
                                              d->m_item_shaders,
                                              backend_constants, out_vertex, out_fragment,
                                              construct_params, item_shader_filter,
+                                             construct_params.order_item_shaders_by_usage(),
                                              discard_macro_value);
 }
 
@@ -1713,7 +1802,7 @@ construct_item_uber_coverage_shader(const BackendConstants &backend_constants,
                                                      d->m_item_coverage_shaders,
                                                      backend_constants, out_vertex, out_fragment,
                                                      construct_params, item_shader_filter,
-                                                     "fastuidraw_do_nothing()");
+                                                     false, "fastuidraw_do_nothing()");
 }
 
 void
@@ -26,6 +26,7 @@
 #include <map>
 #include <vector>
 #include <list>
+#include <mutex>
 #include <algorithm>
 #include <sstream>
 #include <stdint.h>
@@ -40,6 +41,41 @@
 
 namespace
 {
+  /* A single source added to a ShaderSource along with the
+   * result of processing it (stripping white spaces before
+   * pre-processor directives, replacing double colons and so
+   * on). The processed text of a string or resource never
+   * changes, so it is computed at most once; since copying a
+   * ShaderSource (or adding it to another ShaderSource) copies
+   * the processed text, sources streamed once and added to
+   * many ShaderSource objects are only processed once. Files
+   * are re-read each time the code is assembled.
+   */
+  class SourceEntry
+  {
+  public:
+    typedef enum fastuidraw::glsl::ShaderSource::source_t source_t;
+
+    SourceEntry(const std::string &value, source_t tp):
+      m_value(value),
+      m_type(tp),
+      m_processed_ready(false)
+    {}
+
+    void
+    ready_processed(void) const;
+
+    void
+    append_processed(std::string &dst) const;
+
+    std::string m_value;
+    source_t m_type;
+
+  private:
+    mutable std::string m_processed;
+    mutable bool m_processed_ready;
+  };
+
   class SourcePrivate
   {
   public:
@@ -47,7 +83,10 @@ namespace
 
     typedef enum fastuidraw::glsl::ShaderSource::source_t source_t;
     typedef enum fastuidraw::glsl::ShaderSource::extension_enable_t extension_enable_t;
-    typedef std::pair<std::string, source_t> source_code_t;
+    typedef SourceEntry source_code_t;
+
+    void
+    ready_assembled_code(void);
 
     bool m_dirty;
     std::list<source_code_t> m_values;
@@ -56,6 +95,8 @@ namespace
 
     std::string m_assembled_code;
     std::string m_assembled_code_base;
+    bool m_hash_ready;
+    uint64_t m_hash, m_hash_base;
 
     static
     std::string
@@ -81,6 +122,10 @@ namespace
     void
     add_source_entry(const source_code_t &v, std::ostream &output_stream);
 
+    static
+    bool
+    requires_processing(const std::string &S);
+
     static
     fastuidraw::c_string
     string_from_extension_t(extension_enable_t tp);
@@ -140,6 +185,24 @@ namespace
     std::string m_name, m_value;
   };
 
+  /* A resource never changes once it is created, thus the
+   * processed text of a resource is computed only once.
+   */
+  class processed_resource_hoard:fastuidraw::noncopyable
+  {
+  public:
+    std::map<std::string, std::string> m_data;
+    std::mutex m_mutex;
+  };
+
+  static
+  processed_resource_hoard&
+  processed_resources(void)
+  {
+    static processed_resource_hoard R;
+    return R;
+  }
+
   class MacroSetPrivate
   {
   public:
@@ -155,12 +218,166 @@ namespace
   }
 }
 
+//////////////////////////////////////////////////
+// SourceEntry methods
+void
+SourceEntry::
+ready_processed(void) const
+{
+  if (m_processed_ready || m_type == fastuidraw::glsl::ShaderSource::from_file)
+    {
+      return;
+    }
+
+  if (m_type == fastuidraw::glsl::ShaderSource::from_string
+      && !SourcePrivate::requires_processing(m_value))
+    {
+      /* the vast majority of strings streamed by the uber-shader
+       * builder are single declarations or macros without any
+       * leading white space; for those the processing is the
+       * identity.
+       */
+      m_processed = m_value;
+    }
+  else if (m_type == fastuidraw::glsl::ShaderSource::from_resource)
+    {
+      std::map<std::string, std::string>::const_iterator iter;
+      bool found;
+
+      processed_resources().m_mutex.lock();
+      iter = processed_resources().m_data.find(m_value);
+      found = (iter != processed_resources().m_data.end());
+      if (found)
+        {
+          m_processed = iter->second;
+        }
+      processed_resources().m_mutex.unlock();
+
+      if (!found)
+        {
+          std::ostringstream str;
+
+          SourcePrivate::add_source_entry(*this, str);
+          m_processed = str.str();
+
+          /* do not save the warning emitted for a missing
+           * resource, the resource might be created later.
+           */
+          if (!fastuidraw::fetch_static_resource(m_value.c_str()).empty())
+            {
+              processed_resources().m_mutex.lock();
+              processed_resources().m_data[m_value] = m_processed;
+              processed_resources().m_mutex.unlock();
+            }
+        }
+    }
+  else
+    {
+      std::ostringstream str;
+      SourcePrivate::add_source_entry(*this, str);
+      m_processed = str.str();
+    }
+  m_processed_ready = true;
+}
+
+void
+SourceEntry::
+append_processed(std::string &dst) const
+{
+  if (m_type == fastuidraw::glsl::ShaderSource::from_file)
+    {
+      std::ostringstream str;
+      SourcePrivate::add_source_entry(*this, str);
+      dst += str.str();
+    }
+  else
+    {
+      ready_processed();
+      dst += m_processed;
+    }
+}
+
 //////////////////////////////////////////////////
 // SourcePrivate methods
 SourcePrivate::
 SourcePrivate(void):
-  m_dirty(false)
+  m_dirty(false),
+  m_hash_ready(false),
+  m_hash(0),
+  m_hash_base(0)
+{
+}
+
+bool
+SourcePrivate::
+requires_processing(const std::string &S)
+{
+  /* The processing of a string only modifies lines that start
+   * with a pre-processor directive, lines that are continued with
+   * a \ and occurrences of ::; if none of those characters are
+   * present, the processed string is the same as the string.
+   */
+  char prev_char(0);
+  for (char c : S)
+    {
+      if (c == '#' || c == '\\' || (c == ':' && prev_char == ':'))
+        {
+          return true;
+        }
+      prev_char = c;
+    }
+  return false;
+}
+
+void
+SourcePrivate::
+ready_assembled_code(void)
 {
+  if (!m_dirty)
+    {
+      return;
+    }
+
+  std::ostringstream header;
+
+  if (!m_version.empty())
+    {
+      header << "#version " << m_version << "\n";
+    }
+
+  for(const auto &ext : m_extensions)
+    {
+      header << "#extension " << ext.first << ": "
+             << string_from_extension_t(ext.second)
+             << "\n";
+    }
+
+  #ifdef FASTUIDRAW_DEBUG
+    {
+      header << "#define FASTUIDRAW_DEBUG\n";
+    }
+  #endif
+
+  /* the code with the header is the code without the header
+   * prefixed by the header, so each source is processed
+   * only once.
+   */
+  m_assembled_code_base.clear();
+  for(const source_code_t &src : m_values)
+    {
+      src.append_processed(m_assembled_code_base);
+    }
+
+  /*
+   * some GLSL pre-processors do not like to end on a
+   * comment or other certain tokens, to make them
+   * less grouchy, we emit a few extra \n's
+   */
+  m_assembled_code_base += "\n\n\n";
+  m_assembled_code = header.str() + m_assembled_code_base;
+
+  m_hash_ready = false;
+  m_dirty = false;
 }
 
 fastuidraw::c_string
@@ -314,34 +531,34 @@ add_source_entry(const source_code_t &v, std::ostream &output_stream)
    *   - if just a string, we do NOT add a \n
    */
 
-  if (v.second == ShaderSource::from_file)
+  if (v.m_type == ShaderSource::from_file)
     {
-      std::ifstream file(v.first.c_str());
+      std::ifstream file(v.m_value.c_str());
 
       if (file)
         {
-          add_source_code_from_stream(v.first, file, output_stream);
+          add_source_code_from_stream(v.m_value, file, output_stream);
           output_stream << "\n";
         }
       else
         {
           output_stream << "\n//WARNING: Could not open file \""
-                        << v.first << "\"\n";
+                        << v.m_value << "\"\n";
         }
     }
   else
     {
-      if (v.second == ShaderSource::from_string)
+      if (v.m_type == ShaderSource::from_string)
         {
           std::istringstream istr;
-          istr.str(v.first);
+          istr.str(v.m_value);
           add_source_code_from_stream("", istr, output_stream);
         }
       else
         {
           c_array<const uint8_t> resource_string;
 
-          resource_string = fetch_static_resource(v.first.c_str());
+          resource_string = fetch_static_resource(v.m_value.c_str());
           if (!resource_string.empty() && resource_string.back() == 0)
             {
               std::istringstream istr;
@@ -350,12 +567,12 @@ add_source_entry(const source_code_t &v, std::ostream &output_stream)
               s = reinterpret_cast<fastuidraw::c_string>(resource_string.c_ptr());
               istr.str(std::string(s));
 
-              add_source_code_from_stream(v.first, istr, output_stream);
+              add_source_code_from_stream(v.m_value, istr, output_stream);
               output_stream << "\n";
             }
           else
             {
-              output_stream << "\n//WARNING: Unable to fetch string resource \"" << v.first
+              output_stream << "\n//WARNING: Unable to fetch string resource \"" << v.m_value
                             << "\"\n";
               return;
             }
@@ -507,6 +724,14 @@ add_source(const ShaderSource &obj)
   d = static_cast<SourcePrivate*>(m_d);
   obj_d = static_cast<SourcePrivate*>(obj.m_d);
 
+  /* process the sources of obj before copying them so that
+   * when obj is added to several ShaderSource objects, its
+   * sources are processed only once.
+   */
+  for (const SourcePrivate::source_code_t &src : obj_d->m_values)
+    {
+      src.ready_processed();
+    }
   std::copy(obj_d->m_values.begin(), obj_d->m_values.end(),
             std::insert_iterator<std::list<SourcePrivate::source_code_t> >(d->m_values, d->m_values.end()));
   d->m_dirty = true;
@@ -613,6 +838,7 @@ specify_extensions(const ShaderSource &obj)
     {
       d->m_extensions[ext.first] = ext.second;
     }
+  d->m_dirty = true;
   return *this;
 }
 
@@ -623,49 +849,28 @@ assembled_code(bool code_only) const
   SourcePrivate *d;
   d = static_cast<SourcePrivate*>(m_d);
 
-  if (d->m_dirty)
-    {
-      std::ostringstream output_glsl_source_code;
-      std::ostringstream output_glsl_source_code_base;
-
-      if (!d->m_version.empty())
-        {
-          output_glsl_source_code <<"#version " << d->m_version << "\n";
-        }
-
-      for(const auto &ext : d->m_extensions)
-        {
-          output_glsl_source_code << "#extension " << ext.first << ": "
-                                  << SourcePrivate::string_from_extension_t(ext.second)
-                                  << "\n";
-        }
-
-      #ifdef FASTUIDRAW_DEBUG
-        {
-          output_glsl_source_code << "#define FASTUIDRAW_DEBUG\n";
-        }
-      #endif
-
-      for(const SourcePrivate::source_code_t &src : d->m_values)
-        {
-          SourcePrivate::add_source_entry(src, output_glsl_source_code);
-          SourcePrivate::add_source_entry(src, output_glsl_source_code_base);
-        }
+  d->ready_assembled_code();
+  return code_only ?
+    d->m_assembled_code_base.c_str():
+    d->m_assembled_code.c_str();
+}
 
-      /*
-       * some GLSL pre-processors do not like to end on a
-       * comment or other certain tokens, to make them
-       * less grouchy, we emit a few extra \n's
-       */
-      output_glsl_source_code << "\n\n\n";
-      output_glsl_source_code_base << "\n\n\n";
+uint64_t
+fastuidraw::glsl::ShaderSource::
+content_hash(bool code_only) const
+{
+  SourcePrivate *d;
+  d = static_cast<SourcePrivate*>(m_d);
 
-      d->m_assembled_code = output_glsl_source_code.str();
-      d->m_assembled_code_base = output_glsl_source_code_base.str();
-      d->m_dirty = false;
+  d->ready_assembled_code();
+  if (!d->m_hash_ready)
+    {
+      d->m_hash = FNV1aHash().add(d->m_assembled_code).value();
+      d->m_hash_base = FNV1aHash().add(d->m_assembled_code_base).value();
+      d->m_hash_ready = true;
     }
 
   return code_only ?
-    d->m_assembled_code_base.c_str():
-    d->m_assembled_code.c_str();
+    d->m_hash_base :
+    d->m_hash;
 }
@@ -19,9 +19,11 @@
 
 #include <list>
 #include <map>
+#include <set>
 #include <mutex>
 #include <fastuidraw/image.hpp>
 #include <fastuidraw/image_atlas.hpp>
+#include <fastuidraw/util/worker_pool.hpp>
 #include <private/array3d.hpp>
 #include <private/util_private.hpp>
 
@@ -145,6 +147,175 @@ namespace
     return return_value;
   }
 
+  /* Returns the average of a grid of texels over the region
+   * [min_pt, min_pt + size) (in texels of mipmap level 0) of
+   * an ImageSourceBase, the texels are fetched from the coarsest
+   * mipmap level that has at least a texel per grid cell.
+   */
+  fastuidraw::u8vec4
+  coarse_average_color(const fastuidraw::ImageSourceBase &image_data,
+                       fastuidraw::ivec2 dimensions,
+                       fastuidraw::ivec2 min_pt,
+                       fastuidraw::ivec2 size)
+  {
+    using namespace fastuidraw;
+
+    const int grid_size(4);
+    unsigned int level, count(0);
+    ivec2 level_dimensions;
+    uvec4 sum(0u, 0u, 0u, 0u);
+    u8vec4 texel;
+
+    level = t_max(1u, image_data.number_levels()) - 1u;
+    while (level > 0u
+           && ((size.x() >> level) < grid_size || (size.y() >> level) < grid_size))
+      {
+        --level;
+      }
+
+    level_dimensions.x() = t_max(1, dimensions.x() >> level);
+    level_dimensions.y() = t_max(1, dimensions.y() >> level);
+    for (int y = 0; y < grid_size; ++y)
+      {
+        for (int x = 0; x < grid_size; ++x, ++count)
+          {
+            ivec2 p;
+
+            p.x() = (min_pt.x() + ((2 * x + 1) * size.x()) / (2 * grid_size)) >> level;
+            p.y() = (min_pt.y() + ((2 * y + 1) * size.y()) / (2 * grid_size)) >> level;
+            p.x() = t_min(p.x(), level_dimensions.x() - 1);
+            p.y() = t_min(p.y(), level_dimensions.y() - 1);
+            image_data.fetch_texels(level, p, 1, 1, c_array<u8vec4>(&texel, 1));
+            for (int c = 0; c < 4; ++c)
+              {
+                sum[c] += texel[c];
+              }
+          }
+      }
+
+    for (int c = 0; c < 4; ++c)
+      {
+        texel[c] = static_cast<uint8_t>(sum[c] / count);
+      }
+    return texel;
+  }
+
+  /* Key of a color tile shared by the Image objects made while
+   * the atlas deduplicates color tiles: the texels of all the
+   * mipmap levels of the tile together with a hash of them so
+   * that comparing keys of different tiles rarely needs to walk
+   * the texels.
+   */
+  class SharedColorTileKey
+  {
+  public:
+    explicit
+    SharedColorTileKey(const std::vector<std::vector<fastuidraw::u8vec4> > &levels)
+    {
+      fastuidraw::FNV1aHash hash;
+
+      for (const std::vector<fastuidraw::u8vec4> &texels : levels)
+        {
+          hash.add(fastuidraw::make_c_array(texels).flatten_array());
+          m_texels.insert(m_texels.end(), texels.begin(), texels.end());
+        }
+      m_hash = hash.value();
+    }
+
+    /* the texels of each mipmap level of the tile
+     * as fetched by fetch_color_tile_texels().
+     */
+    void
+    levels(int tile_size,
+           std::vector<fastuidraw::c_array<const fastuidraw::u8vec4> > &dst) const
+    {
+      fastuidraw::c_array<const fastuidraw::u8vec4> texels;
+
+      texels = fastuidraw::make_c_array(m_texels);
+      dst.clear();
+      for (int sz = tile_size; sz > 0; sz /= 2)
+        {
+          dst.push_back(texels.sub_array(0, sz * sz));
+          texels = texels.sub_array(sz * sz);
+        }
+      FASTUIDRAWassert(texels.empty());
+    }
+
+    bool
+    operator<(const SharedColorTileKey &rhs) const
+    {
+      if (m_hash != rhs.m_hash)
+        {
+          return m_hash < rhs.m_hash;
+        }
+      return m_texels < rhs.m_texels;
+    }
+
+    uint64_t m_hash;
+    std::vector<fastuidraw::u8vec4> m_texels;
+  };
+
+  /* A color tile shared by all Image objects whose
+   * tile has the same texels, see
+   * ImageAtlas::deduplicate_color_tiles()
+   */
+  class SharedColorTile
+  {
+  public:
+    explicit
+    SharedColorTile(fastuidraw::ivec3 tile):
+      m_tile(tile),
+      m_count(0)
+    {}
+
+    fastuidraw::ivec3 m_tile;
+    unsigned int m_count;
+  };
+
+  typedef std::map<SharedColorTileKey, SharedColorTile> SharedColorTileMap;
+
+  /* Fetch the texels of all mipmap levels of a color tile as
+   * ImageAtlasPrivate::upload_color_tile_implement() uploads them,
+   * levels[L] holds the texels of level L.
+   */
+  void
+  fetch_color_tile_texels(int tile_size, fastuidraw::ivec2 src_xy,
+                          const fastuidraw::ImageSourceBase &image_data,
+                          std::vector<std::vector<fastuidraw::u8vec4> > &levels)
+  {
+    int sz, level, end_level;
+
+    levels.resize(1u + fastuidraw::uint32_log2(tile_size));
+    end_level = image_data.number_levels();
+    for (level = 0, sz = tile_size; sz > 0; ++level, sz /= 2, src_xy /= 2)
+      {
+        levels[level].resize(sz * sz);
+        if (level < end_level)
+          {
+            image_data.fetch_texels(level, src_xy, sz, sz,
+                                    fastuidraw::make_c_array(levels[level]));
+          }
+        else
+          {
+            std::fill(levels[level].begin(), levels[level].end(),
+                      fastuidraw::u8vec4(255u, 255u, 0u, 255u));
+          }
+      }
+  }
+
+  void
+  fill_color_tile_texels(int tile_size, fastuidraw::u8vec4 color,
+                         std::vector<std::vector<fastuidraw::u8vec4> > &levels)
+  {
+    int sz, level;
+
+    levels.resize(1u + fastuidraw::uint32_log2(tile_size));
+    for (level = 0, sz = tile_size; sz > 0; ++level, sz /= 2)
+      {
+        levels[level].assign(sz * sz, color);
+      }
+  }
+
   class BackingStorePrivate
   {
   public:
@@ -185,12 +356,39 @@ namespace
     bool
     resize_to_fit(int num_tiles);
 
+    /* returns the number of layers the allocated tiles
+     * need, but no less than min_layers.
+     */
+    int
+    compacted_number_layers(int min_layers) const;
+
+    /* moves the allocated tiles of the layers at and after num_layers
+     * to free tiles of the layers before num_layers and removes those
+     * layers; the key of each element added to moves is the tile before
+     * the move and the value is the tile after. Requires that resources
+     * are not locked and that num_layers >= compacted_number_layers(0).
+     */
+    void
+    compact(int num_layers, std::map<fastuidraw::ivec3, fastuidraw::ivec3> &moves);
+
+    int
+    number_allocated(void) const
+    {
+      return m_tile_count;
+    }
+
     void
     lock_resources(void);
 
     void
     unlock_resources(void);
 
+    bool
+    locked(void) const
+    {
+      return m_lock_resources_counter > 0;
+    }
+
     int
     tile_size(void) const
     {
@@ -207,6 +405,21 @@ namespace
     void
     delete_tile_implement(fastuidraw::ivec3 v);
 
+    int
+    tile_index(fastuidraw::ivec3 v) const
+    {
+      return v.x() + m_num_tiles.x() * (v.y() + m_num_tiles.y() * v.z());
+    }
+
+    fastuidraw::ivec3
+    tile_from_index(int idx) const
+    {
+      int per_layer(m_num_tiles.x() * m_num_tiles.y());
+      return fastuidraw::ivec3(idx % m_num_tiles.x(),
+                               (idx % per_layer) / m_num_tiles.x(),
+                               idx / per_layer);
+    }
+
     int m_tile_size;
     fastuidraw::ivec3 m_next_tile;
     fastuidraw::ivec3 m_num_tiles;
@@ -217,6 +430,9 @@ namespace
     std::vector<fastuidraw::ivec3> m_delayed_free_tiles;
 
     #ifdef FASTUIDRAW_DEBUG
+    /* indexed as (layer, y, x) so that adding
+     * layers keeps the values of the existing tiles
+     */
     fastuidraw::array3d<inited_bool> m_tile_allocated;
     #endif
   };
@@ -273,6 +489,28 @@ namespace
     unsigned int m_lock_resources_counter;
   };
 
+  class ImagePrivate;
+
+  /* A color tile of a sparse image that is resident,
+   * ImageAtlasPrivate keeps these in a list ordered
+   * from least to most recently requested.
+   */
+  class ResidentColorTile
+  {
+  public:
+    ResidentColorTile(ImagePrivate *image, unsigned int tile, unsigned int frame):
+      m_image(image),
+      m_tile(tile),
+      m_frame(frame)
+    {}
+
+    ImagePrivate *m_image;
+    unsigned int m_tile;
+    unsigned int m_frame;
+  };
+
+  typedef std::list<ResidentColorTile> ResidentColorTileList;
+
   template<typename T>
   fastuidraw::ivec3
   dimensions_of_store(const fastuidraw::reference_counted_ptr<T> &store)
@@ -293,36 +531,91 @@ namespace
       m_color_tiles(pcolor_tile_size, dimensions_of_store(pcolor_store)),
       m_index_store(pindex_store),
       m_index_store_constant(m_index_store),
-      m_index_tiles(pindex_tile_size, dimensions_of_store(pindex_store))
-    {}
-
-    int
-    number_free_index_tiles(void);
-
-    fastuidraw::ivec3
-    add_index_tile(fastuidraw::c_array<const fastuidraw::ivec3> data);
+      m_index_tiles(pindex_tile_size, dimensions_of_store(pindex_store)),
+      m_residency_frame(0),
+      m_deduplicate_color_tiles(false),
+      m_deduplicated_color_tile_bytes(0),
+      m_number_images_in_creation(0),
+      m_min_color_layers(m_color_tiles.num_tiles().z()),
+      m_min_index_layers(m_index_tiles.num_tiles().z()),
+      m_compaction_threshold(0.0f)
+    {
+      m_sparse_color_tile_budget = m_color_tiles.num_tiles().x()
+        * m_color_tiles.num_tiles().y()
+        * m_color_tiles.num_tiles().z();
+    }
 
     fastuidraw::ivec3
     add_index_tile_index_data(fastuidraw::c_array<const fastuidraw::ivec3> data);
 
+    /* sets dst[i] to the shared color tile with the texels of
+     * keys[i], creating and uploading it if there is none, and
+     * increments its reference count; sets dst[i] as
+     * m_shared_color_tiles.end() if a tile could not be allocated.
+     * All tiles are resolved under a single lock of m_mutex; the
+     * keys of created tiles are moved into m_shared_color_tiles.
+     */
     void
-    delete_index_tile(fastuidraw::ivec3 tile);
+    acquire_shared_color_tiles(std::vector<SharedColorTileKey> &keys,
+                               enum fastuidraw::Image::format_t format,
+                               std::vector<SharedColorTileMap::iterator> &dst);
 
-    fastuidraw::ivec3
-    add_color_tile(fastuidraw::ivec2 src_xy,
-                   const fastuidraw::ImageSourceBase &image_data);
 
+    uint64_t
+    color_tile_bytes(void)
+    {
+      uint64_t return_value(0);
+
+      for (uint64_t sz = m_color_tiles.tile_size(); sz > 0; sz /= 2)
+        {
+          return_value += sz * sz * sizeof(fastuidraw::u8vec4);
+        }
+      return return_value;
+    }
+
+    /* the methods below do NOT lock m_mutex */
+
+    /* decrements the reference count of a shared color
+     * tile, deleting the tile when it reaches zero.
+     */
+    void
+    release_shared_color_tile_implement(SharedColorTileMap::iterator iter);
     fastuidraw::ivec3
-    add_color_tile(fastuidraw::u8vec4 color_data);
+    allocate_color_tile_implement(void);
 
     void
-    delete_color_tile(fastuidraw::ivec3 tile);
+    fill_color_tile_implement(fastuidraw::ivec3 tile, fastuidraw::u8vec4 color_data);
 
-    int
-    number_free_color_tiles(void);
+    void
+    upload_color_tile_implement(fastuidraw::ivec3 tile,
+                                fastuidraw::ivec2 src_xy,
+                                const fastuidraw::ImageSourceBase &image_data);
+
+    bool
+    evict_resident_color_tile_implement(bool free_tile,
+                                        fastuidraw::ivec3 *out_tile = nullptr);
 
     void
-    resize_to_fit(int num_color_tiles, int num_index_tiles);
+    resize_to_fit_implement(int num_color_tiles, int num_index_tiles);
+
+    /* see ImageAtlas::compact() */
+    bool
+    compact_implement(void);
+
+    /* returns the number of layers of the index store below
+     * which compaction cannot go: the layers holding the master
+     * index tile of an image are kept so that the master index
+     * tiles are never moved and values packed from an Image (for
+     * example a cached packed PainterBrush) stay valid.
+     */
+    int
+    min_index_layers_implement(void) const;
+
+    /* returns true if unlocking resources should compact,
+     * see ImageAtlas::compaction_threshold()
+     */
+    bool
+    should_compact_implement(void);
 
     int
     index_tile_size(void)
@@ -346,24 +639,31 @@ namespace
     fastuidraw::reference_counted_ptr<fastuidraw::AtlasIndexBackingStoreBase> m_index_store;
     fastuidraw::reference_counted_ptr<const fastuidraw::AtlasIndexBackingStoreBase> m_index_store_constant;
     tile_allocator m_index_tiles;
-  };
-
-  /* TODO: take into account for repeated tile colors. */
-  bool
-  enough_room_in_atlas(fastuidraw::ivec2 number_color_tiles,
-                       ImageAtlasPrivate *C, int &total_index)
-  {
-    int total_color;
-
-    total_color = number_color_tiles.x() * number_color_tiles.y();
-    total_index = number_index_tiles_needed(number_color_tiles, C->index_tile_size());
 
-    //std::cout << "Need " << total_color << " have: " << C->number_free_color_tiles() << "\n"
-    //        << "Need " << total_index << " have: " << C->number_free_index_tiles() << "\n";
-
-    return total_color <= C->number_free_color_tiles()
-      && total_index <= C->number_free_index_tiles();
-  }
+    /* Resident color tiles of sparse images. A color tile
+     * requested since the last lock_resources() (or when
+     * not locked, in the current request) has m_frame
+     * equal to m_residency_frame and is not evicted.
+     */
+    ResidentColorTileList m_resident_tiles;
+    unsigned int m_residency_frame;
+    int m_sparse_color_tile_budget;
+    std::vector<fastuidraw::ivec3> m_index_tile_scratch;
+
+    /* color tiles shared by their texels */
+    bool m_deduplicate_color_tiles;
+    SharedColorTileMap m_shared_color_tiles;
+    uint64_t m_deduplicated_color_tile_bytes;
+
+    /* images whose tiles are on the atlas, compaction patches
+     * their tiles; it is not done while an image is created
+     * because creation reads its tiles without the lock.
+     */
+    std::set<ImagePrivate*> m_images;
+    int m_number_images_in_creation;
+    int m_min_color_layers, m_min_index_layers;
+    float m_compaction_threshold;
+  };
 
   class per_color_tile
   {
@@ -406,6 +706,11 @@ namespace
       m_master_index_tile_dims(-1.0f, -1.0f),
       m_number_index_lookups(0),
       m_dimensions_index_divisor(-1.0f),
+      m_number_color_tiles_needed(0),
+      m_number_index_tiles_needed(0),
+      m_sparse_source(nullptr),
+      m_fallback_block_size(1),
+      m_num_fallback_blocks(0, 0),
       m_bindless_handle(handle)
     {
     }
@@ -413,16 +718,76 @@ namespace
     ~ImagePrivate();
 
     void
-    create_color_tiles(const fastuidraw::ImageSourceBase &image_data);
+    init_color_tile_dimensions(void);
+
+    /* Creating the tiles of an image on the atlas is done in
+     * three steps so that the atlas mutex is only held for
+     * short times:
+     *  - prepare_tiles() does not lock the atlas mutex (beyond
+     *    what sparse and shared color tiles need), it finds
+     *    the color tiles that are a single color and sets the
+     *    number of color and index tiles the image needs.
+     *  - allocate_tiles_implement() allocates all the tiles of
+     *    the image and requires that the atlas mutex is locked.
+     *  - upload_tiles() fetches the texels of the color tiles
+     *    and computes the index tiles without the lock and
+     *    uploads them in short locked sections.
+     */
+    void
+    prepare_tiles(const fastuidraw::ImageSourceBase &image_data, bool sparse);
+
+    void
+    allocate_tiles_implement(void);
+
+    void
+    upload_tiles(const fastuidraw::ImageSourceBase &image_data);
+
+    void
+    prepare_color_tiles(const fastuidraw::ImageSourceBase &image_data);
+
+    void
+    create_shared_color_tiles(const fastuidraw::ImageSourceBase &image_data);
+
+    void
+    create_sparse_color_tiles(const fastuidraw::ImageSourceBase &image_data);
+
+    void
+    prepare_index_tiles(void);
 
     void
-    create_index_tiles(void);
+    compute_index_tiles(std::vector<fastuidraw::ivec3> &dst);
+
+    /* the methods below require that the atlas mutex is locked */
+    void
+    upload_index_tiles_implement(fastuidraw::c_array<const fastuidraw::ivec3> data);
+
+    /* change the tiles of the image as moved by compaction, returns
+     * true if the index tiles of the image need to be rewritten.
+     */
+    bool
+    move_tiles_implement(const std::map<fastuidraw::ivec3, fastuidraw::ivec3> &color_moves,
+                         const std::map<fastuidraw::ivec3, fastuidraw::ivec3> &index_moves);
+
+    bool
+    request_residency(const fastuidraw::Rect &texel_rect, float texels_per_pixel);
+
+    bool
+    make_resident_implement(int tx, int ty);
+
+    fastuidraw::ivec3
+    fallback_tile(unsigned int t) const;
+
+    void
+    evict_implement(unsigned int tile);
+
+    void
+    update_index_tile_implement(int ix, int iy);
 
     template<typename T>
     fastuidraw::ivec2
-    create_index_layer(fastuidraw::c_array<const T> src_tiles,
-                       fastuidraw::ivec2 src_dims,
-                       std::list<std::vector<fastuidraw::ivec3> > &destination);
+    compute_index_layer(fastuidraw::c_array<const T> src_tiles,
+                        fastuidraw::ivec2 src_dims,
+                        fastuidraw::c_array<fastuidraw::ivec3> dst);
 
     fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas> m_atlas;
     ImageAtlasPrivate *m_atlas_private;
@@ -437,15 +802,111 @@ namespace
     fastuidraw::ivec2 m_num_color_tiles;
     std::map<fastuidraw::u8vec4, fastuidraw::ivec3> m_repeated_tiles;
     std::vector<per_color_tile> m_color_tiles;
+
+    /* the shared color tiles (one entry per color tile,
+     * ImageAtlasPrivate::m_shared_color_tiles.end() for a
+     * tile that could not be allocated) used when the atlas
+     * deduplicates color tiles, see
+     * ImageAtlas::deduplicate_color_tiles().
+     */
+    std::vector<SharedColorTileMap::iterator> m_shared_color_tiles;
     std::list<std::vector<fastuidraw::ivec3> > m_index_tiles;
     fastuidraw::ivec3 m_master_index_tile;
     fastuidraw::vec2 m_master_index_tile_dims;
     unsigned int m_number_index_lookups;
     float m_dimensions_index_divisor;
 
+    /* Data between prepare_tiles() and upload_tiles(); if
+     * the color tile t is a single color, m_tile_colors[t]
+     * is that color. The entries of m_repeated_tiles and
+     * m_color_tiles not yet allocated are (-1, -1, -1).
+     */
+    std::vector<fastuidraw::u8vec4> m_tile_colors;
+    int m_number_color_tiles_needed;
+    int m_number_index_tiles_needed;
+
+    /* Data for when the image is sparse; a color tile that is not
+     * resident is a single color tile of m_repeated_tiles; these
+     * tiles form a low resolution version of the image that stays
+     * resident: the color tiles are grouped into blocks of
+     * m_fallback_block_size x m_fallback_block_size tiles and the
+     * tiles of the block B are replaced by the single color tile of
+     * color m_fallback_colors[B.x + B.y * m_num_fallback_blocks.x()],
+     * the average color of the block, see fallback_tile().
+     */
+    const fastuidraw::ImageSourceBase *m_sparse_source;
+    int m_fallback_block_size;
+    fastuidraw::ivec2 m_num_fallback_blocks;
+    std::vector<fastuidraw::u8vec4> m_fallback_colors;
+    std::vector<ResidentColorTileList::iterator> m_resident;
+
     /* data for when image has different type than on_atlas */
     uint64_t m_bindless_handle;
   };
+
+  /* Task of ImageAtlas::create_batch(), runs either
+   * ImagePrivate::prepare_tiles() or ImagePrivate::upload_tiles()
+   * of a single image.
+   */
+  class ImageBatchTask:public fastuidraw::WorkerPool::Task
+  {
+  public:
+    ImageBatchTask(ImagePrivate *image,
+                   const fastuidraw::ImageSourceBase *image_data,
+                   bool upload):
+      m_image(image),
+      m_image_data(image_data),
+      m_upload(upload)
+    {}
+
+  protected:
+    virtual
+    void
+    run(void)
+    {
+      if (m_upload)
+        {
+          m_image->upload_tiles(*m_image_data);
+        }
+      else
+        {
+          m_image->prepare_tiles(*m_image_data, false);
+        }
+    }
+
+  private:
+    ImagePrivate *m_image;
+    const fastuidraw::ImageSourceBase *m_image_data;
+    bool m_upload;
+  };
+
+  void
+  run_image_batch(fastuidraw::c_array<ImagePrivate* const> images,
+                  fastuidraw::c_array<const fastuidraw::ImageSourceBase* const> image_data,
+                  bool upload,
+                  const fastuidraw::reference_counted_ptr<fastuidraw::WorkerPool> &pool)
+  {
+    std::vector<fastuidraw::reference_counted_ptr<ImageBatchTask> > tasks;
+
+    for (unsigned int i = 0; i < images.size(); ++i)
+      {
+        tasks.push_back(FASTUIDRAWnew ImageBatchTask(images[i], image_data[i], upload));
+        if (pool)
+          {
+            pool->add_task(tasks.back());
+          }
+      }
+
+    /* execute the tasks not yet started by the pool on this
+     * thread, so that the calling thread takes its share
+     * of the work.
+     */
+    for (const auto &task : tasks)
+      {
+        task->execute();
+        task->wait();
+      }
+  }
 }
 
 /////////////////////////////////////////////
@@ -460,6 +921,11 @@ ImagePrivate(fastuidraw::ImageAtlas &patlas,
   m_number_levels(image_data.number_levels()),
   m_type(fastuidraw::Image::on_atlas),
   m_format(image_data.format()),
+  m_number_color_tiles_needed(0),
+  m_number_index_tiles_needed(0),
+  m_sparse_source(nullptr),
+  m_fallback_block_size(1),
+  m_num_fallback_blocks(0, 0),
   m_bindless_handle(-1)
 {
   using namespace fastuidraw;
@@ -468,9 +934,6 @@ ImagePrivate(fastuidraw::ImageAtlas &patlas,
   FASTUIDRAWassert(m_dimensions.y() > 0);
   FASTUIDRAWassert(m_atlas);
 
-  create_color_tiles(image_data);
-  create_index_tiles();
-
   /* Mipmap filtering cannot go beyond the tile size or the
    * size of the image.
    */
@@ -482,24 +945,56 @@ ImagePrivate(fastuidraw::ImageAtlas &patlas,
 ImagePrivate::
 ~ImagePrivate()
 {
-  for(const per_color_tile &C : m_color_tiles)
+  if (m_type == fastuidraw::Image::on_atlas)
     {
-      if (C.m_non_repeat_color)
+      /* release the tiles in the same locked section that removes
+       * the image from the atlas so that a compaction never sees
+       * tiles that no image references.
+       */
+      std::lock_guard<std::mutex> M(m_atlas_private->m_mutex);
+      tile_allocator &color_tiles(m_atlas_private->m_color_tiles);
+      tile_allocator &index_tiles(m_atlas_private->m_index_tiles);
+
+      m_atlas_private->m_images.erase(this);
+      if (m_sparse_source)
         {
-          m_atlas_private->delete_color_tile(C.m_tile);
+          for (unsigned int t = 0, endt = m_resident.size(); t < endt; ++t)
+            {
+              if (m_resident[t] != m_atlas_private->m_resident_tiles.end())
+                {
+                  color_tiles.delete_tile(m_color_tiles[t].m_tile);
+                  m_atlas_private->m_resident_tiles.erase(m_resident[t]);
+                }
+            }
         }
-    }
 
-  for(const auto &C : m_repeated_tiles)
-    {
-      m_atlas_private->delete_color_tile(C.second);
-    }
+      for(const per_color_tile &C : m_color_tiles)
+        {
+          if (C.m_non_repeat_color)
+            {
+              color_tiles.delete_tile(C.m_tile);
+            }
+        }
 
-  for(const auto &tile_array: m_index_tiles)
-    {
-      for(const fastuidraw::ivec3 &index_tile : tile_array)
+      for(const auto &C : m_repeated_tiles)
+        {
+          color_tiles.delete_tile(C.second);
+        }
+
+      for(SharedColorTileMap::iterator iter : m_shared_color_tiles)
+        {
+          if (iter != m_atlas_private->m_shared_color_tiles.end())
+            {
+              m_atlas_private->release_shared_color_tile_implement(iter);
+            }
+        }
+
+      for(const auto &tile_array: m_index_tiles)
         {
-          m_atlas_private->delete_index_tile(index_tile);
+          for(const fastuidraw::ivec3 &index_tile : tile_array)
+            {
+              index_tiles.delete_tile(index_tile);
+            }
         }
     }
 
@@ -511,18 +1006,56 @@ ImagePrivate::
 
 void
 ImagePrivate::
-create_color_tiles(const fastuidraw::ImageSourceBase &image_data)
+init_color_tile_dimensions(void)
 {
   int tile_interior_size;
-  int color_tile_size;
 
-  color_tile_size = m_atlas_private->color_tile_size();
-  tile_interior_size = color_tile_size;
+  tile_interior_size = m_atlas_private->color_tile_size();
   m_num_color_tiles = divide_up(m_dimensions, tile_interior_size);
   m_master_index_tile_dims = fastuidraw::vec2(m_dimensions) / static_cast<float>(tile_interior_size);
   m_dimensions_index_divisor = static_cast<float>(tile_interior_size);
+}
+
+void
+ImagePrivate::
+prepare_tiles(const fastuidraw::ImageSourceBase &image_data, bool sparse)
+{
+  bool deduplicate;
+
+  m_atlas_private->m_mutex.lock();
+  deduplicate = m_atlas_private->m_deduplicate_color_tiles;
+  m_atlas_private->m_images.insert(this);
+  ++m_atlas_private->m_number_images_in_creation;
+  m_atlas_private->m_mutex.unlock();
+
+  if (sparse)
+    {
+      create_sparse_color_tiles(image_data);
+    }
+  else if (deduplicate)
+    {
+      create_shared_color_tiles(image_data);
+    }
+  else
+    {
+      prepare_color_tiles(image_data);
+    }
+  prepare_index_tiles();
+}
+
+void
+ImagePrivate::
+prepare_color_tiles(const fastuidraw::ImageSourceBase &image_data)
+{
+  int tile_interior_size;
+  int color_tile_size;
+  fastuidraw::ivec3 unallocated(-1, -1, -1);
+
+  color_tile_size = m_atlas_private->color_tile_size();
+  tile_interior_size = color_tile_size;
+  init_color_tile_dimensions();
 
-  unsigned int savings(0);
+  m_tile_colors.resize(m_num_color_tiles.x() * m_num_color_tiles.y());
   for(int ty = 0, source_y = 0;
       ty < m_num_color_tiles.y();
       ++ty, source_y += tile_interior_size)
@@ -531,106 +1064,615 @@ create_color_tiles(const fastuidraw::ImageSourceBase &image_data)
           tx < m_num_color_tiles.x();
           ++tx, source_x += tile_interior_size)
         {
-          fastuidraw::ivec3 new_tile;
           fastuidraw::ivec2 src_xy(source_x, source_y);
+          fastuidraw::u8vec4 &same_color_value(m_tile_colors[m_color_tiles.size()]);
           bool all_same_color;
-          fastuidraw::u8vec4 same_color_value;
 
           all_same_color = image_data.all_same_color(src_xy, color_tile_size, &same_color_value);
-
           if (all_same_color)
             {
-              std::map<fastuidraw::u8vec4, fastuidraw::ivec3>::iterator iter;
-
-              iter = m_repeated_tiles.find(same_color_value);
-              if (iter != m_repeated_tiles.end())
-                {
-                  new_tile = iter->second;
-                  ++savings;
-                }
-              else
-                {
-                  new_tile = m_atlas_private->add_color_tile(same_color_value);
-                  m_repeated_tiles[same_color_value] = new_tile;
-                }
+              m_repeated_tiles[same_color_value] = unallocated;
             }
           else
             {
-              new_tile = m_atlas_private->add_color_tile(src_xy, image_data);
+              ++m_number_color_tiles_needed;
             }
-
-          m_color_tiles.push_back(per_color_tile(new_tile, !all_same_color) );
+          m_color_tiles.push_back(per_color_tile(unallocated, !all_same_color));
         }
     }
-
-  FASTUIDRAWunused(savings);
-  //std::cout << "Saved " << savings << " out of "
-  //        << m_num_color_tiles.x() * m_num_color_tiles.y()
-  //        << " tiles from repeat color magicks\n";
+  m_number_color_tiles_needed += m_repeated_tiles.size();
 }
 
-
-/*
- * returns the number of index tiles needed to
- * store the created index data.
- */
-template<typename T>
-fastuidraw::ivec2
+void
 ImagePrivate::
-create_index_layer(fastuidraw::c_array<const T> src_tiles,
-                   fastuidraw::ivec2 src_dims,
-                   std::list<std::vector<fastuidraw::ivec3> > &destination)
+create_shared_color_tiles(const fastuidraw::ImageSourceBase &image_data)
 {
-  int index_tile_size;
-  fastuidraw::ivec2 num_index_tiles;
+  int tile_interior_size;
+  int color_tile_size;
+  std::vector<std::vector<fastuidraw::u8vec4> > tile_texels;
+  std::vector<SharedColorTileKey> keys;
+
+  color_tile_size = m_atlas_private->color_tile_size();
+  tile_interior_size = color_tile_size;
+  init_color_tile_dimensions();
+
+  /* fetch and hash the texels of every tile without
+   * the atlas lock, the tiles are then resolved and
+   * uploaded under a single lock.
+   */
+  keys.reserve(m_num_color_tiles.x() * m_num_color_tiles.y());
+  for(int ty = 0, source_y = 0;
+      ty < m_num_color_tiles.y();
+      ++ty, source_y += tile_interior_size)
+    {
+      for(int tx = 0, source_x = 0;
+          tx < m_num_color_tiles.x();
+          ++tx, source_x += tile_interior_size)
+        {
+          fastuidraw::ivec2 src_xy(source_x, source_y);
+          fastuidraw::u8vec4 same_color_value;
+
+          /* a tile of a single color is keyed by its texels so
+           * that it matches any tile with the same texels.
+           */
+          if (image_data.all_same_color(src_xy, color_tile_size, &same_color_value))
+            {
+              fill_color_tile_texels(color_tile_size, same_color_value, tile_texels);
+            }
+          else
+            {
+              fetch_color_tile_texels(color_tile_size, src_xy, image_data, tile_texels);
+            }
+          keys.push_back(SharedColorTileKey(tile_texels));
+        }
+    }
+
+  m_atlas_private->acquire_shared_color_tiles(keys, image_data.format(), m_shared_color_tiles);
+  for (SharedColorTileMap::iterator iter : m_shared_color_tiles)
+    {
+      fastuidraw::ivec3 new_tile(-1, -1, -1);
+
+      if (iter != m_atlas_private->m_shared_color_tiles.end())
+        {
+          new_tile = iter->second.m_tile;
+        }
+      m_color_tiles.push_back(per_color_tile(new_tile, false));
+    }
+}
+
+void
+ImagePrivate::
+create_sparse_color_tiles(const fastuidraw::ImageSourceBase &image_data)
+{
+  using namespace fastuidraw;
+
+  /* the low resolution version of the image is at most
+   * max_fallback_blocks x max_fallback_blocks texels.
+   */
+  const int max_fallback_blocks(8);
+  int color_tile_size, block_texels;
+  unsigned int num_tiles;
+
+  init_color_tile_dimensions();
+  num_tiles = m_num_color_tiles.x() * m_num_color_tiles.y();
+  color_tile_size = m_atlas_private->color_tile_size();
+
+  m_fallback_block_size = 1;
+  m_num_fallback_blocks = m_num_color_tiles;
+  while (m_num_fallback_blocks.x() > max_fallback_blocks
+         || m_num_fallback_blocks.y() > max_fallback_blocks)
+    {
+      m_fallback_block_size *= 2;
+      m_num_fallback_blocks = divide_up(m_num_color_tiles, m_fallback_block_size);
+    }
+
+  block_texels = m_fallback_block_size * color_tile_size;
+  for (int by = 0; by < m_num_fallback_blocks.y(); ++by)
+    {
+      for (int bx = 0; bx < m_num_fallback_blocks.x(); ++bx)
+        {
+          ivec2 min_pt(bx * block_texels, by * block_texels), size;
+          u8vec4 color;
+
+          size.x() = t_min(block_texels, m_dimensions.x() - min_pt.x());
+          size.y() = t_min(block_texels, m_dimensions.y() - min_pt.y());
+          color = coarse_average_color(image_data, m_dimensions, min_pt, size);
+          m_fallback_colors.push_back(color);
+          m_repeated_tiles[color] = ivec3(-1, -1, -1);
+        }
+    }
+
+  /* allocate and fill the single color tiles of the
+   * low resolution version in one locked section
+   */
+  m_atlas_private->m_mutex.lock();
+  for (auto &R : m_repeated_tiles)
+    {
+      R.second = m_atlas_private->allocate_color_tile_implement();
+      if (R.second != ivec3(-1, -1, -1))
+        {
+          m_atlas_private->fill_color_tile_implement(R.second, R.first);
+        }
+    }
+  m_atlas_private->m_mutex.unlock();
+
+  m_sparse_source = &image_data;
+  m_color_tiles.resize(num_tiles, per_color_tile(ivec3(-1, -1, -1), false));
+  for (unsigned int t = 0; t < num_tiles; ++t)
+    {
+      m_color_tiles[t].m_tile = fallback_tile(t);
+    }
+  m_resident.assign(num_tiles, m_atlas_private->m_resident_tiles.end());
+}
+
+fastuidraw::ivec3
+ImagePrivate::
+fallback_tile(unsigned int t) const
+{
+  using namespace fastuidraw;
+
+  std::map<u8vec4, ivec3>::const_iterator iter;
+  int bx, by;
+
+  bx = (t % m_num_color_tiles.x()) / m_fallback_block_size;
+  by = (t / m_num_color_tiles.x()) / m_fallback_block_size;
+  iter = m_repeated_tiles.find(m_fallback_colors[bx + by * m_num_fallback_blocks.x()]);
+  FASTUIDRAWassert(iter != m_repeated_tiles.end());
+
+  return iter->second;
+}
+
+bool
+ImagePrivate::
+request_residency(const fastuidraw::Rect &texel_rect, float texels_per_pixel)
+{
+  using namespace fastuidraw;
+
+  int color_tile_size, index_tile_size;
+  ivec2 tmin, tmax, imin, imax;
+  std::vector<bool> changed;
+  bool return_value(true);
+
+  if (!m_sparse_source)
+    {
+      return true;
+    }
+
+  /* when a block of the low resolution version of the image
+   * covers no more than a pixel, sampling the color tiles is
+   * no better than sampling the fallback tiles.
+   */
+  color_tile_size = m_atlas_private->color_tile_size();
+  if (texels_per_pixel >= static_cast<float>(color_tile_size * m_fallback_block_size))
+    {
+      return true;
+    }
+
+  if (texel_rect.m_max_point.x() < 0.0f
+      || texel_rect.m_max_point.y() < 0.0f
+      || texel_rect.m_min_point.x() >= static_cast<float>(m_dimensions.x())
+      || texel_rect.m_min_point.y() >= static_cast<float>(m_dimensions.y())
+      || texel_rect.m_max_point.x() < texel_rect.m_min_point.x()
+      || texel_rect.m_max_point.y() < texel_rect.m_min_point.y())
+    {
+      return true;
+    }
+
+  for (int c = 0; c < 2; ++c)
+    {
+      float fmin, fmax;
+
+      fmin = t_max(0.0f, texel_rect.m_min_point[c]);
+      fmax = t_min(static_cast<float>(m_dimensions[c] - 1), texel_rect.m_max_point[c]);
+      tmin[c] = static_cast<int>(fmin) / color_tile_size;
+      tmax[c] = t_min(m_num_color_tiles[c] - 1, static_cast<int>(fmax) / color_tile_size);
+    }
 
   index_tile_size = m_atlas_private->index_tile_size();
-  num_index_tiles = divide_up(src_dims, index_tile_size);
+  imin = tmin / index_tile_size;
+  imax = tmax / index_tile_size;
+  changed.resize((imax.x() - imin.x() + 1) * (imax.y() - imin.y() + 1), false);
 
-  destination.push_back(std::vector<fastuidraw::ivec3>());
+  std::lock_guard<std::mutex> M(m_atlas_private->m_mutex);
+  if (!m_atlas_private->m_color_tiles.locked())
+    {
+      ++m_atlas_private->m_residency_frame;
+    }
 
-  std::vector<fastuidraw::ivec3> vtile_data(index_tile_size * index_tile_size);
-  fastuidraw::c_array<fastuidraw::ivec3> tile_data;
-  tile_data = fastuidraw::make_c_array(vtile_data);
+  for (int ty = tmin.y(); ty <= tmax.y(); ++ty)
+    {
+      for (int tx = tmin.x(); tx <= tmax.x(); ++tx)
+        {
+          unsigned int t;
+          bool was_resident;
+
+          t = tx + ty * m_num_color_tiles.x();
+          was_resident = (m_resident[t] != m_atlas_private->m_resident_tiles.end());
+          if (make_resident_implement(tx, ty))
+            {
+              if (!was_resident)
+                {
+                  int ix, iy;
+
+                  ix = tx / index_tile_size - imin.x();
+                  iy = ty / index_tile_size - imin.y();
+                  changed[ix + iy * (imax.x() - imin.x() + 1)] = true;
+                }
+            }
+          else
+            {
+              return_value = false;
+            }
+        }
+    }
 
-  for(int source_y = 0; source_y < src_dims.y(); source_y += index_tile_size)
+  for (int iy = imin.y(), i = 0; iy <= imax.y(); ++iy)
     {
-      for(int source_x = 0; source_x < src_dims.x(); source_x += index_tile_size)
+      for (int ix = imin.x(); ix <= imax.x(); ++ix, ++i)
         {
-          fastuidraw::ivec3 new_tile;
-          copy_sub_data<fastuidraw::ivec3, T>(tile_data, index_tile_size, index_tile_size,
-                                              src_tiles, source_x, source_y,
-                                              src_dims);
-          new_tile = m_atlas_private->add_index_tile(tile_data);
-          destination.back().push_back(new_tile);
+          if (changed[i])
+            {
+              update_index_tile_implement(ix, iy);
+            }
         }
     }
-  return num_index_tiles;
+
+  return return_value;
+}
+
+bool
+ImagePrivate::
+make_resident_implement(int tx, int ty)
+{
+  using namespace fastuidraw;
+
+  ImageAtlasPrivate *A(m_atlas_private);
+  unsigned int t;
+  ivec3 tile;
+
+  t = tx + ty * m_num_color_tiles.x();
+  if (m_resident[t] != A->m_resident_tiles.end())
+    {
+      /* move to the back of the list, i.e. mark
+       * as most recently requested
+       */
+      A->m_resident_tiles.splice(A->m_resident_tiles.end(), A->m_resident_tiles, m_resident[t]);
+      m_resident[t]->m_frame = A->m_residency_frame;
+      return true;
+    }
+
+  if (static_cast<int>(A->m_resident_tiles.size()) < A->m_sparse_color_tile_budget)
+    {
+      tile = A->allocate_color_tile_implement();
+    }
+  else if (!A->evict_resident_color_tile_implement(false, &tile))
+    {
+      return false;
+    }
+
+  A->upload_color_tile_implement(tile, ivec2(tx, ty) * A->color_tile_size(), *m_sparse_source);
+  m_color_tiles[t].m_tile = tile;
+  A->m_resident_tiles.push_back(ResidentColorTile(this, t, A->m_residency_frame));
+  m_resident[t] = --A->m_resident_tiles.end();
+
+  return true;
+}
+
+void
+ImagePrivate::
+evict_implement(unsigned int t)
+{
+  int index_tile_size;
+
+  FASTUIDRAWassert(m_resident[t] != m_atlas_private->m_resident_tiles.end());
+  m_atlas_private->m_resident_tiles.erase(m_resident[t]);
+  m_resident[t] = m_atlas_private->m_resident_tiles.end();
+  m_color_tiles[t].m_tile = fallback_tile(t);
+
+  index_tile_size = m_atlas_private->index_tile_size();
+  update_index_tile_implement((t % m_num_color_tiles.x()) / index_tile_size,
+                              (t / m_num_color_tiles.x()) / index_tile_size);
+}
+
+void
+ImagePrivate::
+update_index_tile_implement(int ix, int iy)
+{
+  using namespace fastuidraw;
+
+  int index_tile_size;
+  ivec2 num_index_tiles;
+  ivec3 index_tile;
+  std::vector<ivec3> &tile_data(m_atlas_private->m_index_tile_scratch);
+
+  /* the first element of m_index_tiles are the index
+   * tiles that point to the color tiles; rewrite the
+   * entire index tile so that the padding beyond the
+   * image is also updated.
+   */
+  index_tile_size = m_atlas_private->index_tile_size();
+  num_index_tiles = divide_up(m_num_color_tiles, index_tile_size);
+  index_tile = m_index_tiles.front()[ix + iy * num_index_tiles.x()];
+
+  tile_data.resize(index_tile_size * index_tile_size);
+  copy_sub_data<ivec3, per_color_tile>(make_c_array(tile_data), index_tile_size, index_tile_size,
+                                       c_array<const per_color_tile>(make_c_array(m_color_tiles)),
+                                       ix * index_tile_size, iy * index_tile_size,
+                                       m_num_color_tiles);
+  m_atlas_private->m_index_store->set_data(index_tile.x() * index_tile_size,
+                                           index_tile.y() * index_tile_size,
+                                           index_tile.z(),
+                                           index_tile_size, index_tile_size,
+                                           make_c_array(tile_data));
 }
 
 void
 ImagePrivate::
-create_index_tiles(void)
+prepare_index_tiles(void)
 {
   fastuidraw::ivec2 num_index_tiles;
-  int level(2);
+  int index_tile_size;
   float findex_tile_size;
 
-  findex_tile_size = static_cast<float>(m_atlas_private->index_tile_size());
-  num_index_tiles = create_index_layer<per_color_tile>(fastuidraw::make_c_array(m_color_tiles),
-                                                       m_num_color_tiles, m_index_tiles);
+  index_tile_size = m_atlas_private->index_tile_size();
+  findex_tile_size = static_cast<float>(index_tile_size);
+  num_index_tiles = divide_up(m_num_color_tiles, index_tile_size);
 
-  for(level = 2; num_index_tiles.x() > 1 || num_index_tiles.y() > 1; ++level)
+  for(m_number_index_lookups = 1; num_index_tiles.x() > 1 || num_index_tiles.y() > 1; ++m_number_index_lookups)
     {
-      num_index_tiles = create_index_layer<fastuidraw::ivec3>(fastuidraw::make_c_array(m_index_tiles.back()),
-                                                              num_index_tiles, m_index_tiles);
+      num_index_tiles = divide_up(num_index_tiles, index_tile_size);
       m_dimensions_index_divisor *= findex_tile_size;
       m_master_index_tile_dims /= findex_tile_size;
     }
+  m_number_index_tiles_needed = number_index_tiles_needed(m_num_color_tiles, index_tile_size);
+}
+
+void
+ImagePrivate::
+allocate_tiles_implement(void)
+{
+  using namespace fastuidraw;
+
+  tile_allocator &color_tiles(m_atlas_private->m_color_tiles);
+  tile_allocator &index_tiles(m_atlas_private->m_index_tiles);
+  ivec2 num_index_tiles;
+
+  for (auto &R : m_repeated_tiles)
+    {
+      if (R.second == ivec3(-1, -1, -1))
+        {
+          R.second = color_tiles.allocate_tile();
+        }
+    }
+
+  for (unsigned int t = 0, endt = m_tile_colors.size(); t < endt; ++t)
+    {
+      if (m_color_tiles[t].m_non_repeat_color)
+        {
+          m_color_tiles[t].m_tile = color_tiles.allocate_tile();
+        }
+      else
+        {
+          m_color_tiles[t].m_tile = m_repeated_tiles[m_tile_colors[t]];
+        }
+    }
+
+  num_index_tiles = m_num_color_tiles;
+  do
+    {
+      num_index_tiles = divide_up(num_index_tiles, index_tiles.tile_size());
+      m_index_tiles.push_back(std::vector<ivec3>());
+      for (int i = 0, endi = num_index_tiles.x() * num_index_tiles.y(); i < endi; ++i)
+        {
+          m_index_tiles.back().push_back(index_tiles.allocate_tile());
+        }
+    }
+  while (num_index_tiles.x() > 1 || num_index_tiles.y() > 1);
 
   FASTUIDRAWassert(m_index_tiles.back().size() == 1);
+  FASTUIDRAWassert(m_index_tiles.size() == m_number_index_lookups);
   m_master_index_tile = m_index_tiles.back()[0];
-  m_number_index_lookups = m_index_tiles.size();
+}
+
+/*
+ * writes the index tiles of the layer that points to
+ * src_tiles to dst, one after the other; returns the
+ * number of index tiles of the layer.
+ */
+template<typename T>
+fastuidraw::ivec2
+ImagePrivate::
+compute_index_layer(fastuidraw::c_array<const T> src_tiles,
+                    fastuidraw::ivec2 src_dims,
+                    fastuidraw::c_array<fastuidraw::ivec3> dst)
+{
+  int index_tile_size, tile_texels;
+  fastuidraw::ivec2 num_index_tiles;
+
+  index_tile_size = m_atlas_private->index_tile_size();
+  tile_texels = index_tile_size * index_tile_size;
+  num_index_tiles = divide_up(src_dims, index_tile_size);
+
+  for(int source_y = 0, t = 0; source_y < src_dims.y(); source_y += index_tile_size)
+    {
+      for(int source_x = 0; source_x < src_dims.x(); source_x += index_tile_size, ++t)
+        {
+          copy_sub_data<fastuidraw::ivec3, T>(dst.sub_array(t * tile_texels, tile_texels),
+                                              index_tile_size, index_tile_size,
+                                              src_tiles, source_x, source_y,
+                                              src_dims);
+        }
+    }
+  return num_index_tiles;
+}
+
+void
+ImagePrivate::
+upload_tiles(const fastuidraw::ImageSourceBase &image_data)
+{
+  using namespace fastuidraw;
+
+  /* number of color tiles whose texels are fetched before
+   * taking the lock to upload them
+   */
+  const unsigned int chunk_size(16);
+  int color_tile_size;
+  std::vector<unsigned int> tiles;
+  std::vector<std::vector<std::vector<u8vec4> > > texels(chunk_size);
+  std::vector<c_array<const u8vec4> > levels;
+  std::vector<ivec3> index_data;
+
+  color_tile_size = m_atlas_private->color_tile_size();
+  for (unsigned int t = 0, endt = m_tile_colors.size(); t < endt; ++t)
+    {
+      if (m_color_tiles[t].m_non_repeat_color)
+        {
+          tiles.push_back(t);
+        }
+    }
+
+  for (unsigned int c = 0, endc = tiles.size(); c < endc; c += chunk_size)
+    {
+      unsigned int num;
+
+      num = t_min(chunk_size, endc - c);
+      for (unsigned int i = 0; i < num; ++i)
+        {
+          unsigned int t(tiles[c + i]);
+          ivec2 src_xy(t % m_num_color_tiles.x(), t / m_num_color_tiles.x());
+
+          fetch_color_tile_texels(color_tile_size, src_xy * color_tile_size,
+                                  image_data, texels[i]);
+        }
+
+      std::lock_guard<std::mutex> M(m_atlas_private->m_mutex);
+      for (unsigned int i = 0; i < num; ++i)
+        {
+          levels.resize(texels[i].size());
+          for (unsigned int L = 0; L < levels.size(); ++L)
+            {
+              levels[L] = make_c_array(texels[i][L]);
+            }
+
+          ImageSourceCArray tile_data(uvec2(color_tile_size, color_tile_size),
+                                      make_c_array(levels), image_data.format());
+          m_atlas_private->upload_color_tile_implement(m_color_tiles[tiles[c + i]].m_tile,
+                                                       ivec2(0, 0), tile_data);
+        }
+    }
+
+  compute_index_tiles(index_data);
+
+  std::lock_guard<std::mutex> M(m_atlas_private->m_mutex);
+  if (!m_tile_colors.empty())
+    {
+      for (const auto &R : m_repeated_tiles)
+        {
+          m_atlas_private->fill_color_tile_implement(R.second, R.first);
+        }
+    }
+  upload_index_tiles_implement(make_c_array(index_data));
+  --m_atlas_private->m_number_images_in_creation;
+
+  m_tile_colors.clear();
+}
+
+void
+ImagePrivate::
+compute_index_tiles(std::vector<fastuidraw::ivec3> &index_data)
+{
+  using namespace fastuidraw;
+
+  int tile_texels;
+  c_array<ivec3> dst;
+  ivec2 src_dims;
+
+  /* the first layer of index tiles points to the color
+   * tiles, each following layer to the previous layer.
+   */
+  tile_texels = m_atlas_private->index_tile_size() * m_atlas_private->index_tile_size();
+  index_data.resize(m_number_index_tiles_needed * tile_texels);
+  dst = make_c_array(index_data);
+  src_dims = compute_index_layer<per_color_tile>(make_c_array(m_color_tiles),
+                                                 m_num_color_tiles, dst);
+  for (auto iter = m_index_tiles.begin(); std::next(iter) != m_index_tiles.end(); ++iter)
+    {
+      dst = dst.sub_array(iter->size() * tile_texels);
+      src_dims = compute_index_layer<ivec3>(make_c_array(*iter), src_dims, dst);
+    }
+}
+
+void
+ImagePrivate::
+upload_index_tiles_implement(fastuidraw::c_array<const fastuidraw::ivec3> data)
+{
+  using namespace fastuidraw;
+
+  int index_tile_size, tile_texels;
+
+  index_tile_size = m_atlas_private->index_tile_size();
+  tile_texels = index_tile_size * index_tile_size;
+  for (const auto &layer : m_index_tiles)
+    {
+      for (const ivec3 &tile : layer)
+        {
+          m_atlas_private->m_index_store->set_data(tile.x() * index_tile_size,
+                                                   tile.y() * index_tile_size,
+                                                   tile.z(),
+                                                   index_tile_size, index_tile_size,
+                                                   data.sub_array(0, tile_texels));
+          data = data.sub_array(tile_texels);
+        }
+    }
+}
+
+bool
+ImagePrivate::
+move_tiles_implement(const std::map<fastuidraw::ivec3, fastuidraw::ivec3> &color_moves,
+                     const std::map<fastuidraw::ivec3, fastuidraw::ivec3> &index_moves)
+{
+  using namespace fastuidraw;
+
+  std::map<ivec3, ivec3>::const_iterator iter;
+  bool return_value(false);
+
+  for (per_color_tile &C : m_color_tiles)
+    {
+      iter = color_moves.find(C.m_tile);
+      if (iter != color_moves.end())
+        {
+          C.m_tile = iter->second;
+          return_value = true;
+        }
+    }
+
+  for (auto &R : m_repeated_tiles)
+    {
+      iter = color_moves.find(R.second);
+      if (iter != color_moves.end())
+        {
+          R.second = iter->second;
+        }
+    }
+
+  for (auto &layer : m_index_tiles)
+    {
+      for (ivec3 &tile : layer)
+        {
+          iter = index_moves.find(tile);
+          if (iter != index_moves.end())
+            {
+              tile = iter->second;
+              return_value = true;
+            }
+        }
+    }
+  /* compaction keeps the layers of the master index tiles,
+   * see ImageAtlasPrivate::min_index_layers_implement()
+   */
+  FASTUIDRAWassert(m_master_index_tile == m_index_tiles.back()[0]);
+
+  return return_value;
 }
 
 ///////////////////////////////////////////
@@ -646,7 +1688,7 @@ tile_allocator(int tile_size, fastuidraw::ivec3 store_dimensions):
   m_lock_resources_counter(0)
 #ifdef FASTUIDRAW_DEBUG
   ,
-  m_tile_allocated(m_num_tiles.x(), m_num_tiles.y(), m_num_tiles.z())
+  m_tile_allocated(m_num_tiles.z(), m_num_tiles.y(), m_num_tiles.x())
 #endif
 {
   FASTUIDRAWassert(m_tile_size == 0 || store_dimensions.x() % m_tile_size == 0);
@@ -696,8 +1738,8 @@ allocate_tile(void)
 
   #ifdef FASTUIDRAW_DEBUG
     {
-      FASTUIDRAWassert(!m_tile_allocated(return_value.x(), return_value.y(), return_value.z()).m_value);
-      m_tile_allocated(return_value.x(), return_value.y(), return_value.z()) = true;
+      FASTUIDRAWassert(!m_tile_allocated(return_value.z(), return_value.y(), return_value.x()).m_value);
+      m_tile_allocated(return_value.z(), return_value.y(), return_value.x()) = true;
     }
   #endif
 
@@ -749,8 +1791,8 @@ delete_tile_implement(fastuidraw::ivec3 v)
   FASTUIDRAWassert(m_lock_resources_counter == 0);
   #ifdef FASTUIDRAW_DEBUG
     {
-      FASTUIDRAWassert(m_tile_allocated(v.x(), v.y(), v.z()).m_value);
-      m_tile_allocated(v.x(), v.y(), v.z()) = false;
+      FASTUIDRAWassert(m_tile_allocated(v.z(), v.y(), v.x()).m_value);
+      m_tile_allocated(v.z(), v.y(), v.x()) = false;
     }
   #endif
 
@@ -791,145 +1833,411 @@ resize_to_fit(int num_tiles)
       m_num_tiles.z() += needed_layers;
       #ifdef FASTUIDRAW_DEBUG
         {
-          m_tile_allocated.resize(m_num_tiles.x(), m_num_tiles.y(), m_num_tiles.z());
+          m_tile_allocated.resize(m_num_tiles.z(), m_num_tiles.y(), m_num_tiles.x());
         }
       #endif
 
-      return true;
-    }
-  else
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+int
+tile_allocator::
+compacted_number_layers(int min_layers) const
+{
+  int tiles_per_layer, return_value;
+
+  tiles_per_layer = m_num_tiles.x() * m_num_tiles.y();
+  if (tiles_per_layer <= 0)
+    {
+      return m_num_tiles.z();
+    }
+
+  return_value = m_tile_count / tiles_per_layer;
+  if (m_tile_count > return_value * tiles_per_layer)
+    {
+      ++return_value;
+    }
+  return fastuidraw::t_max(min_layers, return_value);
+}
+
+void
+tile_allocator::
+compact(int num_layers, std::map<fastuidraw::ivec3, fastuidraw::ivec3> &moves)
+{
+  int end_allocated, end_kept;
+  std::vector<bool> allocated;
+
+  FASTUIDRAWassert(m_lock_resources_counter == 0);
+  FASTUIDRAWassert(m_delayed_free_tiles.empty());
+  FASTUIDRAWassert(num_layers >= compacted_number_layers(0));
+  FASTUIDRAWassert(num_layers <= m_num_tiles.z());
+
+  /* the tiles before m_next_tile that are not in
+   * m_free_tiles are the allocated tiles.
+   */
+  end_allocated = fastuidraw::t_min(tile_index(m_next_tile),
+                                    m_num_tiles.x() * m_num_tiles.y() * m_num_tiles.z());
+  end_kept = m_num_tiles.x() * m_num_tiles.y() * num_layers;
+
+  if (end_allocated > end_kept)
+    {
+      std::vector<int> free_kept;
+
+      allocated.resize(end_allocated, true);
+      for (const fastuidraw::ivec3 &v : m_free_tiles)
+        {
+          allocated[tile_index(v)] = false;
+        }
+
+      for (int i = 0; i < end_kept; ++i)
+        {
+          if (!allocated[i])
+            {
+              free_kept.push_back(i);
+            }
+        }
+
+      /* move each allocated tile of the removed layers to
+       * the last free tile of the kept layers.
+       */
+      for (int i = end_kept; i < end_allocated; ++i)
+        {
+          if (allocated[i])
+            {
+              fastuidraw::ivec3 src(tile_from_index(i)), dst;
+
+              FASTUIDRAWassert(!free_kept.empty());
+              dst = tile_from_index(free_kept.back());
+              free_kept.pop_back();
+              moves[src] = dst;
+
+              #ifdef FASTUIDRAW_DEBUG
+                {
+                  m_tile_allocated(src.z(), src.y(), src.x()) = false;
+                  m_tile_allocated(dst.z(), dst.y(), dst.x()) = true;
+                }
+              #endif
+            }
+        }
+
+      /* the free list is popped from its back, have
+       * the lowest free tiles allocated first.
+       */
+      m_free_tiles.clear();
+      for (auto iter = free_kept.rbegin(); iter != free_kept.rend(); ++iter)
+        {
+          m_free_tiles.push_back(tile_from_index(*iter));
+        }
+      m_next_tile = fastuidraw::ivec3(0, 0, num_layers);
+    }
+
+  m_num_tiles.z() = num_layers;
+  #ifdef FASTUIDRAW_DEBUG
+    {
+      m_tile_allocated.resize(m_num_tiles.z(), m_num_tiles.y(), m_num_tiles.x());
+    }
+  #endif
+}
+
+/////////////////////////////////////////
+// ImageAtlasPrivate methods
+void
+ImageAtlasPrivate::
+fill_color_tile_implement(fastuidraw::ivec3 tile, fastuidraw::u8vec4 color_data)
+{
+  fastuidraw::ivec2 dst_xy;
+  int sz;
+
+  dst_xy.x() = tile.x() * m_color_tiles.tile_size();
+  dst_xy.y() = tile.y() * m_color_tiles.tile_size();
+  sz = m_color_tiles.tile_size();
+
+  for (int level = 0; sz > 0; ++level, sz /= 2, dst_xy /= 2)
+    {
+      m_color_store->set_data(level, dst_xy, tile.z(), sz, color_data);
+    }
+}
+
+void
+ImageAtlasPrivate::
+upload_color_tile_implement(fastuidraw::ivec3 tile,
+                            fastuidraw::ivec2 src_xy,
+                            const fastuidraw::ImageSourceBase &image_data)
+{
+  fastuidraw::ivec2 dst_xy;
+  int sz, level, end_level;
+
+  dst_xy.x() = tile.x() * m_color_tiles.tile_size();
+  dst_xy.y() = tile.y() * m_color_tiles.tile_size();
+  sz = m_color_tiles.tile_size();
+  end_level = image_data.number_levels();
+
+  for (level = 0; level < end_level && sz > 0; ++level, sz /= 2, dst_xy /= 2, src_xy /= 2)
+    {
+      m_color_store->set_data(level, dst_xy, tile.z(), src_xy, sz, image_data);
+    }
+
+  for (; sz > 0; ++level, sz /= 2, dst_xy /= 2, src_xy /= 2, sz /= 2)
+    {
+      m_color_store->set_data(level, dst_xy, tile.z(), sz,
+                              fastuidraw::u8vec4(255u, 255u, 0u, 255u));
+    }
+}
+
+fastuidraw::ivec3
+ImageAtlasPrivate::
+allocate_color_tile_implement(void)
+{
+  if (m_color_tiles.number_free() < 1 && m_color_tiles.resize_to_fit(1))
+    {
+      m_color_store->resize(m_color_tiles.num_tiles().z());
+    }
+  return m_color_tiles.allocate_tile();
+}
+
+bool
+ImageAtlasPrivate::
+evict_resident_color_tile_implement(bool free_tile, fastuidraw::ivec3 *out_tile)
+{
+  fastuidraw::ivec3 tile;
+
+  if (m_resident_tiles.empty()
+      || m_resident_tiles.front().m_frame == m_residency_frame)
     {
       return false;
     }
+
+  ResidentColorTile &R(m_resident_tiles.front());
+  tile = R.m_image->m_color_tiles[R.m_tile].m_tile;
+  R.m_image->evict_implement(R.m_tile);
+
+  if (free_tile)
+    {
+      m_color_tiles.delete_tile(tile);
+    }
+
+  if (out_tile)
+    {
+      *out_tile = tile;
+    }
+  return true;
 }
 
-/////////////////////////////////////////
-// ImageAtlasPrivate methods
-int
+void
 ImageAtlasPrivate::
-number_free_index_tiles(void)
+acquire_shared_color_tiles(std::vector<SharedColorTileKey> &keys,
+                           enum fastuidraw::Image::format_t format,
+                           std::vector<SharedColorTileMap::iterator> &dst)
 {
+  int tile_size(color_tile_size());
+  std::vector<fastuidraw::c_array<const fastuidraw::u8vec4> > levels;
   std::lock_guard<std::mutex> M(m_mutex);
-  return m_index_tiles.number_free();
+
+  dst.resize(keys.size());
+  for (unsigned int i = 0; i < keys.size(); ++i)
+    {
+      SharedColorTileMap::iterator iter;
+
+      iter = m_shared_color_tiles.find(keys[i]);
+      if (iter == m_shared_color_tiles.end())
+        {
+          fastuidraw::ivec3 tile;
+
+          tile = allocate_color_tile_implement();
+          if (tile == fastuidraw::ivec3(-1, -1, -1))
+            {
+              dst[i] = m_shared_color_tiles.end();
+              continue;
+            }
+
+          iter = m_shared_color_tiles.insert(std::make_pair(std::move(keys[i]), SharedColorTile(tile))).first;
+          iter->first.levels(tile_size, levels);
+
+          fastuidraw::ImageSourceCArray tile_texels(fastuidraw::uvec2(tile_size, tile_size),
+                                                    fastuidraw::make_c_array(levels),
+                                                    format);
+          upload_color_tile_implement(tile, fastuidraw::ivec2(0, 0), tile_texels);
+        }
+      else
+        {
+          m_deduplicated_color_tile_bytes += color_tile_bytes();
+        }
+
+      ++iter->second.m_count;
+      dst[i] = iter;
+    }
 }
 
-fastuidraw::ivec3
+void
 ImageAtlasPrivate::
-add_index_tile(fastuidraw::c_array<const fastuidraw::ivec3> data)
+release_shared_color_tile_implement(SharedColorTileMap::iterator iter)
 {
-  fastuidraw::ivec3 return_value;
-  std::lock_guard<std::mutex> M(m_mutex);
+  FASTUIDRAWassert(iter != m_shared_color_tiles.end());
+  FASTUIDRAWassert(iter->second.m_count > 0u);
 
-  return_value = m_index_tiles.allocate_tile();
-  if (return_value != fastuidraw::ivec3(-1, -1, -1))
+  --iter->second.m_count;
+  if (iter->second.m_count == 0u)
     {
-      m_index_store->set_data(return_value.x() * m_index_tiles.tile_size(),
-                              return_value.y() * m_index_tiles.tile_size(),
-                              return_value.z(),
-                              m_index_tiles.tile_size(),
-                              m_index_tiles.tile_size(),
-                              data);
+      /* the tile is only freed at unlock_resources() if
+       * the atlas is locked, but it is no longer shared.
+       */
+      m_color_tiles.delete_tile(iter->second.m_tile);
+      m_shared_color_tiles.erase(iter);
+    }
+  else
+    {
+      m_deduplicated_color_tile_bytes -= color_tile_bytes();
     }
-
-  return return_value;
 }
 
 void
 ImageAtlasPrivate::
-delete_index_tile(fastuidraw::ivec3 tile)
+resize_to_fit_implement(int num_color_tiles, int num_index_tiles)
 {
-  std::lock_guard<std::mutex> M(m_mutex);
-  m_index_tiles.delete_tile(tile);
+  if (m_color_tiles.resize_to_fit(num_color_tiles))
+    {
+      m_color_store->resize(m_color_tiles.num_tiles().z());
+    }
+  if (m_index_tiles.resize_to_fit(num_index_tiles))
+    {
+      m_index_store->resize(m_index_tiles.num_tiles().z());
+    }
 }
 
 int
 ImageAtlasPrivate::
-number_free_color_tiles(void)
+min_index_layers_implement(void) const
 {
-  std::lock_guard<std::mutex> M(m_mutex);
-  return m_color_tiles.number_free();
+  int return_value(m_min_index_layers);
+
+  for (const ImagePrivate *image : m_images)
+    {
+      return_value = fastuidraw::t_max(return_value, image->m_master_index_tile.z() + 1);
+    }
+  return return_value;
 }
 
-fastuidraw::ivec3
+bool
 ImageAtlasPrivate::
-add_color_tile(fastuidraw::u8vec4 color_data)
+should_compact_implement(void)
 {
-  fastuidraw::ivec3 return_value;
-  fastuidraw::ivec2 dst_xy;
-  int sz;
+  if (m_compaction_threshold <= 0.0f
+      || m_color_tiles.locked()
+      || !m_color_store
+      || !m_index_store)
+    {
+      return false;
+    }
 
-  std::lock_guard<std::mutex> M(m_mutex);
-  return_value = m_color_tiles.allocate_tile();
-  if (return_value != fastuidraw::ivec3(-1, -1, -1))
+  const tile_allocator *allocators[2] = { &m_color_tiles, &m_index_tiles };
+  int min_layers[2] = { m_min_color_layers, min_index_layers_implement() };
+
+  for (int i = 0; i < 2; ++i)
     {
-      dst_xy.x() = return_value.x() * m_color_tiles.tile_size();
-      dst_xy.y() = return_value.y() * m_color_tiles.tile_size();
-      sz = m_color_tiles.tile_size();
+      const fastuidraw::ivec3 &num_tiles(allocators[i]->num_tiles());
+      float used;
 
-      for (int level = 0; sz > 0; ++level, sz /= 2, dst_xy /= 2)
+      used = static_cast<float>(allocators[i]->number_allocated())
+        / static_cast<float>(num_tiles.x() * num_tiles.y() * num_tiles.z());
+      if (allocators[i]->compacted_number_layers(min_layers[i]) < num_tiles.z()
+          && used < m_compaction_threshold)
         {
-          m_color_store->set_data(level, dst_xy, return_value.z(),
-                                  sz, color_data);
+          return true;
         }
     }
-
-  return return_value;
+  return false;
 }
 
-fastuidraw::ivec3
+bool
 ImageAtlasPrivate::
-add_color_tile(fastuidraw::ivec2 src_xy,
-               const fastuidraw::ImageSourceBase &image_data)
+compact_implement(void)
 {
-  fastuidraw::ivec3 return_value;
-  fastuidraw::ivec2 dst_xy;
-  int sz, level, end_level;
+  using namespace fastuidraw;
 
-  std::lock_guard<std::mutex> M(m_mutex);
-  return_value = m_color_tiles.allocate_tile();
-  if (return_value != fastuidraw::ivec3(-1, -1, -1))
+  std::map<ivec3, ivec3> color_moves, index_moves;
+  int color_layers, index_layers;
+  std::vector<ivec3> index_data;
+
+  if (m_color_tiles.locked()
+      || m_number_images_in_creation > 0
+      || !m_color_store
+      || !m_index_store)
+    {
+      return false;
+    }
+
+  color_layers = m_color_tiles.compacted_number_layers(m_min_color_layers);
+  index_layers = m_index_tiles.compacted_number_layers(min_index_layers_implement());
+  if (color_layers >= m_color_tiles.num_tiles().z()
+      && index_layers >= m_index_tiles.num_tiles().z())
     {
-      dst_xy.x() = return_value.x() * m_color_tiles.tile_size();
-      dst_xy.y() = return_value.y() * m_color_tiles.tile_size();
-      sz = m_color_tiles.tile_size();
-      end_level = image_data.number_levels();
+      return false;
+    }
 
-      for (level = 0; level < end_level && sz > 0; ++level, sz /= 2, dst_xy /= 2, src_xy /= 2)
+  /* move the color tiles with copies within the color store;
+   * the index tiles are written again from the tiles of the
+   * images instead.
+   */
+  if (color_layers < m_color_tiles.num_tiles().z())
+    {
+      m_color_tiles.compact(color_layers, color_moves);
+      for (const auto &M : color_moves)
         {
-          m_color_store->set_data(level, dst_xy, return_value.z(), src_xy, sz, image_data);
+          ivec2 src_xy, dst_xy;
+          int sz;
+
+          sz = m_color_tiles.tile_size();
+          src_xy = ivec2(M.first.x(), M.first.y()) * sz;
+          dst_xy = ivec2(M.second.x(), M.second.y()) * sz;
+          for (int level = 0; sz > 0; ++level, sz /= 2, src_xy /= 2, dst_xy /= 2)
+            {
+              m_color_store->copy_data(level, src_xy, M.first.z(),
+                                       dst_xy, M.second.z(), sz);
+            }
         }
+    }
+
+  if (index_layers < m_index_tiles.num_tiles().z())
+    {
+      m_index_tiles.compact(index_layers, index_moves);
+    }
+
+  for (auto &S : m_shared_color_tiles)
+    {
+      std::map<ivec3, ivec3>::const_iterator iter;
 
-      for (; sz > 0; ++level, sz /= 2, dst_xy /= 2, src_xy /= 2, sz /= 2)
+      iter = color_moves.find(S.second.m_tile);
+      if (iter != color_moves.end())
         {
-          m_color_store->set_data(level, dst_xy, return_value.z(), sz,
-                                  fastuidraw::u8vec4(255u, 255u, 0u, 255u));
+          S.second.m_tile = iter->second;
         }
     }
 
-  return return_value;
-}
-
-void
-ImageAtlasPrivate::
-delete_color_tile(fastuidraw::ivec3 tile)
-{
-  std::lock_guard<std::mutex> M(m_mutex);
-  m_color_tiles.delete_tile(tile);
-}
+  for (ImagePrivate *image : m_images)
+    {
+      if (image->move_tiles_implement(color_moves, index_moves))
+        {
+          image->compute_index_tiles(index_data);
+          image->upload_index_tiles_implement(make_c_array(index_data));
+        }
+    }
 
-void
-ImageAtlasPrivate::
-resize_to_fit(int num_color_tiles, int num_index_tiles)
-{
-  std::lock_guard<std::mutex> M(m_mutex);
-  if (m_color_tiles.resize_to_fit(num_color_tiles))
+  if (color_layers < m_color_store->dimensions().z())
     {
-      m_color_store->resize(m_color_tiles.num_tiles().z());
+      m_color_store->resize(color_layers);
     }
-  if (m_index_tiles.resize_to_fit(num_index_tiles))
+
+  if (index_layers < m_index_store->dimensions().z())
     {
-      m_index_store->resize(m_index_tiles.num_tiles().z());
+      m_index_store->resize(index_layers);
     }
+
+  return true;
 }
 
 ////////////////////////////////////////
@@ -1043,7 +2351,7 @@ resize(int new_num_layers)
   BackingStorePrivate *d;
 
   d = static_cast<BackingStorePrivate*>(m_d);
-  FASTUIDRAWassert(new_num_layers > d->m_dimensions.z());
+  FASTUIDRAWassert(new_num_layers > 0);
   resize_implement(new_num_layers);
   d->m_dimensions.z() = new_num_layers;
 }
@@ -1087,7 +2395,7 @@ resize(int new_num_layers)
   BackingStorePrivate *d;
 
   d = static_cast<BackingStorePrivate*>(m_d);
-  FASTUIDRAWassert(new_num_layers > d->m_dimensions.z());
+  FASTUIDRAWassert(new_num_layers > 0);
   resize_implement(new_num_layers);
   d->m_dimensions.z() = new_num_layers;
 }
@@ -1120,6 +2428,10 @@ lock_resources(void)
   d = static_cast<ImageAtlasPrivate*>(m_d);
 
   std::lock_guard<std::mutex> M(d->m_mutex);
+  if (!d->m_color_tiles.locked())
+    {
+      ++d->m_residency_frame;
+    }
   d->m_color_tiles.lock_resources();
   d->m_index_tiles.lock_resources();
   d->m_delete_actions.lock_resources();
@@ -1136,6 +2448,44 @@ unlock_resources(void)
   d->m_color_tiles.unlock_resources();
   d->m_index_tiles.unlock_resources();
   d->m_delete_actions.unlock_resources();
+  if (d->should_compact_implement())
+    {
+      d->compact_implement();
+    }
+}
+
+bool
+fastuidraw::ImageAtlas::
+compact(void)
+{
+  ImageAtlasPrivate *d;
+  d = static_cast<ImageAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> M(d->m_mutex);
+  return d->compact_implement();
+}
+
+float
+fastuidraw::ImageAtlas::
+compaction_threshold(void) const
+{
+  ImageAtlasPrivate *d;
+  d = static_cast<ImageAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> M(d->m_mutex);
+  return d->m_compaction_threshold;
+}
+
+fastuidraw::ImageAtlas&
+fastuidraw::ImageAtlas::
+compaction_threshold(float v)
+{
+  ImageAtlasPrivate *d;
+  d = static_cast<ImageAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> M(d->m_mutex);
+  d->m_compaction_threshold = v;
+  return *this;
 }
 
 int
@@ -1209,12 +2559,13 @@ queue_resource_release_action(const reference_counted_ptr<Image::ResourceRelease
 
 fastuidraw::reference_counted_ptr<fastuidraw::Image>
 fastuidraw::ImageAtlas::
-create_image_on_atlas(int w, int h, const ImageSourceBase &image_data)
+create_image_on_atlas(int w, int h, const ImageSourceBase &image_data,
+                      bool sparse)
 {
   int tile_interior_size;
-  ivec2 num_color_tiles;
-  int index_tiles;
   ImageAtlasPrivate *d;
+  ImagePrivate *image;
+  reference_counted_ptr<Image> return_value;
 
   d = static_cast<ImageAtlasPrivate*>(m_d);
   if (w <= 0 || h <= 0 || !d->m_color_store || !d->m_index_store)
@@ -1228,19 +2579,73 @@ create_image_on_atlas(int w, int h, const ImageSourceBase &image_data)
       return reference_counted_ptr<Image>();
     }
 
-  num_color_tiles = divide_up(ivec2(w, h), tile_interior_size);
-  if (!enough_room_in_atlas(num_color_tiles, d, index_tiles))
+  return_value = FASTUIDRAWnew Image(*this, w, h, image_data);
+  image = static_cast<ImagePrivate*>(return_value->m_d);
+  image->prepare_tiles(image_data, sparse);
+
+  d->m_mutex.lock();
+  d->resize_to_fit_implement(image->m_number_color_tiles_needed,
+                             image->m_number_index_tiles_needed);
+  image->allocate_tiles_implement();
+  d->m_mutex.unlock();
+
+  image->upload_tiles(image_data);
+  return return_value;
+}
+
+void
+fastuidraw::ImageAtlas::
+create_batch(c_array<const ivec2> dimensions,
+             c_array<const ImageSourceBase* const> image_data,
+             c_array<reference_counted_ptr<Image> > out_images,
+             const reference_counted_ptr<WorkerPool> &pool)
+{
+  ImageAtlasPrivate *d;
+  std::vector<ImagePrivate*> images;
+  std::vector<const ImageSourceBase*> sources;
+  int num_color_tiles(0), num_index_tiles(0);
+
+  FASTUIDRAWassert(dimensions.size() == image_data.size());
+  FASTUIDRAWassert(dimensions.size() == out_images.size());
+
+  d = static_cast<ImageAtlasPrivate*>(m_d);
+  for (unsigned int i = 0; i < dimensions.size(); ++i)
     {
-      /* TODO:
-       * there actually might be enough room if we take into account
-       * the savings from repeated tiles. The correct thing is to
-       * delay this until iamge construction, check if it succeeded
-       * and if not then delete it and return an invalid handle.
-       */
-      d->resize_to_fit(num_color_tiles.x() * num_color_tiles.y(), index_tiles);
+      int w(dimensions[i].x()), h(dimensions[i].y());
+
+      if (w > 0 && h > 0 && d->m_color_store && d->m_index_store && color_tile_size() > 0)
+        {
+          out_images[i] = FASTUIDRAWnew Image(*this, w, h, *image_data[i]);
+          images.push_back(static_cast<ImagePrivate*>(out_images[i]->m_d));
+          sources.push_back(image_data[i]);
+        }
+      else
+        {
+          out_images[i] = create(w, h, *image_data[i]);
+        }
+    }
+
+  if (images.empty())
+    {
+      return;
+    }
+
+  run_image_batch(make_c_array(images), make_c_array(sources), false, pool);
+
+  d->m_mutex.lock();
+  for (ImagePrivate *image : images)
+    {
+      num_color_tiles += image->m_number_color_tiles_needed;
+      num_index_tiles += image->m_number_index_tiles_needed;
+    }
+  d->resize_to_fit_implement(num_color_tiles, num_index_tiles);
+  for (ImagePrivate *image : images)
+    {
+      image->allocate_tiles_implement();
     }
+  d->m_mutex.unlock();
 
-  return FASTUIDRAWnew Image(*this, w, h, image_data);
+  run_image_batch(make_c_array(images), make_c_array(sources), true, pool);
 }
 
 fastuidraw::reference_counted_ptr<fastuidraw::Image>
@@ -1286,7 +2691,7 @@ create(int w, int h, const ImageSourceBase &image_data,
         }
       else if (try_types[i] == Image::on_atlas)
         {
-          return_value = create_image_on_atlas(w, h, image_data);
+          return_value = create_image_on_atlas(w, h, image_data, false);
         }
     }
 
@@ -1299,6 +2704,96 @@ create(int w, int h, const ImageSourceBase &image_data,
   return return_value;
 }
 
+fastuidraw::reference_counted_ptr<fastuidraw::Image>
+fastuidraw::ImageAtlas::
+create_sparse(int w, int h, const ImageSourceBase &image_data)
+{
+  reference_counted_ptr<Image> return_value;
+
+  return_value = create_image_on_atlas(w, h, image_data, true);
+  if (!return_value)
+    {
+      return_value = create(w, h, image_data);
+    }
+  return return_value;
+}
+
+int
+fastuidraw::ImageAtlas::
+sparse_color_tile_budget(void) const
+{
+  ImageAtlasPrivate *d;
+  d = static_cast<ImageAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> M(d->m_mutex);
+  return d->m_sparse_color_tile_budget;
+}
+
+fastuidraw::ImageAtlas&
+fastuidraw::ImageAtlas::
+sparse_color_tile_budget(int v)
+{
+  ImageAtlasPrivate *d;
+  d = static_cast<ImageAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> M(d->m_mutex);
+  d->m_sparse_color_tile_budget = t_max(0, v);
+  if (!d->m_color_tiles.locked())
+    {
+      ++d->m_residency_frame;
+    }
+  while (static_cast<int>(d->m_resident_tiles.size()) > d->m_sparse_color_tile_budget
+         && d->evict_resident_color_tile_implement(true))
+    {}
+
+  return *this;
+}
+
+int
+fastuidraw::ImageAtlas::
+number_sparse_resident_color_tiles(void) const
+{
+  ImageAtlasPrivate *d;
+  d = static_cast<ImageAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> M(d->m_mutex);
+  return d->m_resident_tiles.size();
+}
+
+bool
+fastuidraw::ImageAtlas::
+deduplicate_color_tiles(void) const
+{
+  ImageAtlasPrivate *d;
+  d = static_cast<ImageAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> M(d->m_mutex);
+  return d->m_deduplicate_color_tiles;
+}
+
+fastuidraw::ImageAtlas&
+fastuidraw::ImageAtlas::
+deduplicate_color_tiles(bool v)
+{
+  ImageAtlasPrivate *d;
+  d = static_cast<ImageAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> M(d->m_mutex);
+  d->m_deduplicate_color_tiles = v;
+  return *this;
+}
+
+uint64_t
+fastuidraw::ImageAtlas::
+deduplicated_color_tile_bytes(void) const
+{
+  ImageAtlasPrivate *d;
+  d = static_cast<ImageAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> M(d->m_mutex);
+  return d->m_deduplicated_color_tile_bytes;
+}
+
 //////////////////////////////////////
 // fastuidraw::Image methods
 fastuidraw::Image::
@@ -1410,3 +2905,21 @@ format(void) const
   d = static_cast<ImagePrivate*>(m_d);
   return d->m_format;
 }
+
+bool
+fastuidraw::Image::
+sparse(void) const
+{
+  ImagePrivate *d;
+  d = static_cast<ImagePrivate*>(m_d);
+  return d->m_sparse_source != nullptr;
+}
+
+bool
+fastuidraw::Image::
+request_residency(const Rect &texel_rect, float texels_per_pixel) const
+{
+  ImagePrivate *d;
+  d = static_cast<ImagePrivate*>(m_d);
+  return d->request_residency(texel_rect, texels_per_pixel);
+}
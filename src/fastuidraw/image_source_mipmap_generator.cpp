@@ -0,0 +1,1070 @@
+/*!
+ * \file image_source_mipmap_generator.cpp
+ * \brief file image_source_mipmap_generator.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+
+#include <list>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include <fastuidraw/image_source_mipmap_generator.hpp>
+#include <fastuidraw/util/math.hpp>
+#include <fastuidraw/util/fastuidraw_memory.hpp>
+#include <private/util_private.hpp>
+
+namespace
+{
+  enum
+    {
+      /* a cell of a generated level is square, a cell of level L
+       * has the width and height max(min_cell_size, level0_cell_size >> L)
+       * so that a cell covers (up to min_cell_size) a color tile of an
+       * ImageAtlas, i.e. a tile only computes the texels it uploads.
+       */
+      level0_cell_size = 32,
+      min_cell_size = 2,
+
+      /* number of texels of the cells kept after a request is completed */
+      max_cached_texels = 256 * 1024,
+
+      /* the cells of a level are only computed on the WorkerPool
+       * if they have at least this many texels, below that the
+       * cost of the tasks outweighs the work.
+       */
+      min_parallel_texels = 16 * 1024,
+
+      /* the Kaiser filter has kaiser_taps taps, the first tap for
+       * the texel x is at the texel 2 * x - kaiser_offset of the
+       * previous level
+       */
+      kaiser_taps = 8,
+      kaiser_offset = 3,
+    };
+
+  class ColorTables:fastuidraw::noncopyable
+  {
+  public:
+    enum
+      {
+        number_guesses = 4096
+      };
+
+    ColorTables(void);
+
+    static
+    const ColorTables&
+    get(void)
+    {
+      static ColorTables R;
+      return R;
+    }
+
+    /* returns the sRGB value nearest to the linear value v */
+    uint8_t
+    encode_srgb(float v) const
+    {
+      unsigned int c;
+
+      v = fastuidraw::t_max(0.0f, fastuidraw::t_min(1.0f, v));
+      c = m_srgb_guess[static_cast<int>(v * float(number_guesses - 1))];
+      while (c < 255u && v >= m_srgb_mid[c])
+        {
+          ++c;
+        }
+      while (c > 0u && v < m_srgb_mid[c - 1u])
+        {
+          --c;
+        }
+      return c;
+    }
+
+    float m_srgb_to_linear[256];
+    float m_unorm_to_float[256];
+    float m_kaiser_weights[kaiser_taps];
+
+  private:
+    static
+    double
+    bessel_i0(double x);
+
+    /* m_srgb_mid[c] is the linear value half way
+     * between the sRGB values c and c + 1
+     */
+    float m_srgb_mid[255];
+
+    /* m_srgb_guess[i] is the sRGB value nearest
+     * to the linear value i / (number_guesses - 1)
+     */
+    uint8_t m_srgb_guess[number_guesses];
+  };
+
+  class Converter
+  {
+  public:
+    Converter(enum fastuidraw::Image::format_t fmt,
+              enum fastuidraw::ImageSourceMipmapGenerator::color_space_t cs):
+      m_tables(ColorTables::get()),
+      m_premultiplied(fmt == fastuidraw::Image::premultipied_rgba_format),
+      m_srgb(cs == fastuidraw::ImageSourceMipmapGenerator::srgb_color_space)
+    {}
+
+    /* convert to linear color pre-multiplied by alpha */
+    fastuidraw::vec4
+    to_working(fastuidraw::u8vec4 p) const;
+
+    fastuidraw::u8vec4
+    from_working(const fastuidraw::vec4 &v) const;
+
+  private:
+    const ColorTables &m_tables;
+    bool m_premultiplied, m_srgb;
+  };
+
+  class CellKey
+  {
+  public:
+    CellKey(unsigned int level, fastuidraw::ivec2 cell):
+      m_level(level),
+      m_cell(cell)
+    {}
+
+    bool
+    operator<(const CellKey &rhs) const
+    {
+      if (m_level != rhs.m_level)
+        {
+          return m_level < rhs.m_level;
+        }
+      if (m_cell.y() != rhs.m_cell.y())
+        {
+          return m_cell.y() < rhs.m_cell.y();
+        }
+      return m_cell.x() < rhs.m_cell.x();
+    }
+
+    unsigned int m_level;
+    fastuidraw::ivec2 m_cell;
+  };
+
+  class Cell:fastuidraw::noncopyable
+  {
+  public:
+    explicit
+    Cell(int size):
+      m_texels(size * size)
+    {}
+
+    /* texel (x, y) of the cell is at m_texels[x + size * y] */
+    std::vector<fastuidraw::vec4> m_texels;
+    std::list<CellKey>::iterator m_lru_location;
+  };
+
+  class GeneratorPrivate;
+
+  class CellTask:public fastuidraw::WorkerPool::Task
+  {
+  public:
+    CellTask(const GeneratorPrivate *d, const CellKey &key, Cell *cell):
+      m_d(d),
+      m_key(key),
+      m_cell(cell)
+    {}
+
+    /* if the previous level is from the source, the caller
+     * fills m_source_texels with the texels the cell reads
+     */
+    std::vector<fastuidraw::u8vec4> m_source_texels;
+
+  protected:
+    virtual
+    void
+    run(void);
+
+  private:
+    const GeneratorPrivate *m_d;
+    CellKey m_key;
+    Cell *m_cell;
+  };
+
+  class GeneratorPrivate:fastuidraw::noncopyable
+  {
+  public:
+    typedef std::map<CellKey, Cell*> CellMap;
+
+    GeneratorPrivate(fastuidraw::uvec2 dimensions,
+                     const fastuidraw::ImageSourceBase &src,
+                     enum fastuidraw::ImageSourceMipmapGenerator::filter_t filter,
+                     enum fastuidraw::ImageSourceMipmapGenerator::color_space_t color_space,
+                     const fastuidraw::reference_counted_ptr<fastuidraw::WorkerPool> &pool);
+
+    ~GeneratorPrivate();
+
+    static
+    int
+    cell_size(unsigned int level)
+    {
+      return (level < 32u) ?
+        fastuidraw::t_max(int(min_cell_size), int(level0_cell_size) >> level) :
+        int(min_cell_size);
+    }
+
+    fastuidraw::ivec2
+    level_dimensions(unsigned int level) const
+    {
+      return fastuidraw::ivec2(fastuidraw::t_max(1, m_dimensions.x() >> level),
+                               fastuidraw::t_max(1, m_dimensions.y() >> level));
+    }
+
+    /* region of the previous level read to compute the
+     * region [min, min + size) of a generated level
+     */
+    void
+    footprint(fastuidraw::ivec2 min, fastuidraw::ivec2 size,
+              fastuidraw::ivec2 *out_min, fastuidraw::ivec2 *out_size) const;
+
+    /* make sure that the cells of a generated level covering the
+     * region [min, max) exist in m_cells, adding the cells that
+     * need to be computed to m_missing[level]; [min, max) must be
+     * within the dimensions of the level.
+     */
+    void
+    require_cells(unsigned int level, fastuidraw::ivec2 min, fastuidraw::ivec2 max);
+
+    /* compute the cells listed in m_missing */
+    void
+    compute_missing_cells(void);
+
+    void
+    compute_cell(const CellKey &key,
+                 fastuidraw::c_array<const fastuidraw::u8vec4> source_texels,
+                 Cell *cell) const;
+
+    /* write texels of a generated level whose cells are present
+     * to dst, texels outside of the level duplicate the boundary
+     */
+    void
+    gather(unsigned int level, fastuidraw::ivec2 location,
+           int w, int h, fastuidraw::vec4 *dst) const;
+
+    /* returns a pointer to the texel (x, y) of a generated level
+     * whose cell is present; the texels to the right of it up to
+     * the end of the cell follow it
+     */
+    const fastuidraw::vec4*
+    texel(unsigned int level, int x, int y) const;
+
+    void
+    evict_cells(unsigned int max_texels);
+
+    fastuidraw::ivec2 m_dimensions;
+    const fastuidraw::ImageSourceBase &m_src;
+    enum fastuidraw::ImageSourceMipmapGenerator::filter_t m_filter;
+    enum fastuidraw::ImageSourceMipmapGenerator::color_space_t m_color_space;
+    fastuidraw::reference_counted_ptr<fastuidraw::WorkerPool> m_pool;
+    unsigned int m_number_source_levels, m_number_levels;
+    Converter m_converter;
+
+    std::mutex m_mutex;
+    CellMap m_cells;
+    unsigned int m_cached_texels;
+
+    /* front is most recently used */
+    std::list<CellKey> m_lru;
+
+    /* work room for a request */
+    std::vector<std::vector<CellKey> > m_missing;
+    std::vector<fastuidraw::vec4> m_gather_scratch;
+  };
+}
+
+//////////////////////////////////////////
+// filter kernels, each kernel computes a row of
+// a generated level from rows of the previous level
+namespace
+{
+#if defined(__SSE2__)
+  inline
+  __m128
+  load_texel(const fastuidraw::vec4 &v)
+  {
+    return _mm_loadu_ps(v.c_ptr());
+  }
+
+  inline
+  void
+  store_texel(fastuidraw::vec4 &v, __m128 p)
+  {
+    _mm_storeu_ps(v.c_ptr(), p);
+  }
+#endif
+
+  /* dst[x] = average of row0[2x], row0[2x + 1], row1[2x], row1[2x + 1] */
+  void
+  box_reduce_row(const fastuidraw::vec4 *row0,
+                 const fastuidraw::vec4 *row1,
+                 int w, fastuidraw::vec4 *dst)
+  {
+#if defined(__SSE2__)
+    const __m128 quarter(_mm_set1_ps(0.25f));
+    for (int x = 0; x < w; ++x, row0 += 2, row1 += 2)
+      {
+        __m128 p;
+
+        p = _mm_add_ps(_mm_add_ps(load_texel(row0[0]), load_texel(row0[1])),
+                       _mm_add_ps(load_texel(row1[0]), load_texel(row1[1])));
+        store_texel(dst[x], _mm_mul_ps(p, quarter));
+      }
+#else
+    for (int x = 0; x < w; ++x, row0 += 2, row1 += 2)
+      {
+        dst[x] = 0.25f * (row0[0] + row0[1] + row1[0] + row1[1]);
+      }
+#endif
+  }
+
+  /* dst[x] = sum of weights[k] * row[2x + k] */
+  void
+  kaiser_reduce_row(const float *weights,
+                    const fastuidraw::vec4 *row,
+                    int w, fastuidraw::vec4 *dst)
+  {
+#if defined(__SSE2__)
+    __m128 wts[kaiser_taps];
+
+    for (int k = 0; k < kaiser_taps; ++k)
+      {
+        wts[k] = _mm_set1_ps(weights[k]);
+      }
+
+    for (int x = 0; x < w; ++x, row += 2)
+      {
+        __m128 p;
+
+        p = _mm_mul_ps(wts[0], load_texel(row[0]));
+        for (int k = 1; k < kaiser_taps; ++k)
+          {
+            p = _mm_add_ps(p, _mm_mul_ps(wts[k], load_texel(row[k])));
+          }
+        store_texel(dst[x], p);
+      }
+#else
+    for (int x = 0; x < w; ++x, row += 2)
+      {
+        dst[x] = weights[0] * row[0];
+        for (int k = 1; k < kaiser_taps; ++k)
+          {
+            dst[x] += weights[k] * row[k];
+          }
+      }
+#endif
+  }
+
+  /* dst[x] = sum of weights[k] * rows[k][x] */
+  void
+  kaiser_reduce_column(const float *weights,
+                       const fastuidraw::vec4 *const *rows,
+                       int w, fastuidraw::vec4 *dst)
+  {
+#if defined(__SSE2__)
+    __m128 wts[kaiser_taps];
+
+    for (int k = 0; k < kaiser_taps; ++k)
+      {
+        wts[k] = _mm_set1_ps(weights[k]);
+      }
+
+    for (int x = 0; x < w; ++x)
+      {
+        __m128 p;
+
+        p = _mm_mul_ps(wts[0], load_texel(rows[0][x]));
+        for (int k = 1; k < kaiser_taps; ++k)
+          {
+            p = _mm_add_ps(p, _mm_mul_ps(wts[k], load_texel(rows[k][x])));
+          }
+        store_texel(dst[x], p);
+      }
+#else
+    for (int x = 0; x < w; ++x)
+      {
+        dst[x] = weights[0] * rows[0][x];
+        for (int k = 1; k < kaiser_taps; ++k)
+          {
+            dst[x] += weights[k] * rows[k][x];
+          }
+      }
+#endif
+  }
+
+  /* the negative lobes of the Kaiser filter can overshoot, clamp
+   * alpha to [0, 1] and the pre-multiplied RGB to [0, alpha]
+   */
+  void
+  clamp_row(int w, fastuidraw::vec4 *dst)
+  {
+#if defined(__SSE2__)
+    const __m128 zero(_mm_setzero_ps()), one(_mm_set1_ps(1.0f));
+    for (int x = 0; x < w; ++x)
+      {
+        __m128 p, a;
+
+        p = _mm_min_ps(_mm_max_ps(load_texel(dst[x]), zero), one);
+        a = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3));
+        store_texel(dst[x], _mm_min_ps(p, a));
+      }
+#else
+    for (int x = 0; x < w; ++x)
+      {
+        float a;
+
+        a = fastuidraw::t_max(0.0f, fastuidraw::t_min(1.0f, dst[x].w()));
+        for (int c = 0; c < 3; ++c)
+          {
+            dst[x][c] = fastuidraw::t_max(0.0f, fastuidraw::t_min(a, dst[x][c]));
+          }
+        dst[x].w() = a;
+      }
+#endif
+  }
+}
+
+//////////////////////////////////////////
+// ColorTables methods
+ColorTables::
+ColorTables(void)
+{
+  double kaiser_sum(0.0);
+
+  for (unsigned int c = 0; c < 256u; ++c)
+    {
+      double s, v;
+
+      s = static_cast<double>(c) / 255.0;
+      v = (s <= 0.04045) ?
+        s / 12.92 :
+        std::pow((s + 0.055) / 1.055, 2.4);
+
+      m_srgb_to_linear[c] = v;
+      m_unorm_to_float[c] = s;
+    }
+
+  for (unsigned int c = 0; c < 255u; ++c)
+    {
+      m_srgb_mid[c] = 0.5f * (m_srgb_to_linear[c] + m_srgb_to_linear[c + 1u]);
+    }
+
+  for (unsigned int i = 0, c = 0; i < number_guesses; ++i)
+    {
+      float v;
+
+      v = static_cast<float>(i) / static_cast<float>(number_guesses - 1);
+      while (c < 255u && v >= m_srgb_mid[c])
+        {
+          ++c;
+        }
+      m_srgb_guess[i] = c;
+    }
+
+  /* the taps of the texel x of the generated level are centered
+   * on the texels 2x - 3, ..., 2x + 4 of the previous level whose
+   * distances to the center of texel x are -3.5, ..., 3.5 texels
+   * of the previous level. The filter is a sinc scaled by 2 (the
+   * reduction) windowed by a Kaiser window of radius 4 and
+   * beta = 4, the same choice as many texture tools.
+   */
+  for (int k = 0; k < kaiser_taps; ++k)
+    {
+      const double beta(4.0), radius(4.0);
+      double t, u, sinc, r, window;
+
+      t = static_cast<double>(k) - 3.5;
+      u = M_PI * t * 0.5;
+      sinc = std::sin(u) / u;
+      r = t / radius;
+      window = bessel_i0(beta * std::sqrt(1.0 - r * r)) / bessel_i0(beta);
+      m_kaiser_weights[k] = sinc * window;
+      kaiser_sum += m_kaiser_weights[k];
+    }
+
+  for (int k = 0; k < kaiser_taps; ++k)
+    {
+      m_kaiser_weights[k] /= kaiser_sum;
+    }
+}
+
+double
+ColorTables::
+bessel_i0(double x)
+{
+  double sum(1.0), term(1.0), q;
+
+  q = 0.25 * x * x;
+  for (int k = 1; k < 32; ++k)
+    {
+      term *= q / static_cast<double>(k * k);
+      sum += term;
+    }
+  return sum;
+}
+
+//////////////////////////////////////////
+// Converter methods
+fastuidraw::vec4
+Converter::
+to_working(fastuidraw::u8vec4 p) const
+{
+  fastuidraw::vec4 return_value;
+  float a;
+
+  a = m_tables.m_unorm_to_float[p.w()];
+  return_value.w() = a;
+  if (m_premultiplied && !m_srgb)
+    {
+      for (int c = 0; c < 3; ++c)
+        {
+          return_value[c] = m_tables.m_unorm_to_float[p[c]];
+        }
+    }
+  else if (m_srgb)
+    {
+      for (int c = 0; c < 3; ++c)
+        {
+          unsigned int v(p[c]);
+
+          if (m_premultiplied)
+            {
+              /* the sRGB encoding is of the color before
+               * it was pre-multiplied by alpha.
+               */
+              v = (p.w() != 0u) ?
+                fastuidraw::t_min(255u, (255u * v + p.w() / 2u) / p.w()) :
+                0u;
+            }
+          return_value[c] = a * m_tables.m_srgb_to_linear[v];
+        }
+    }
+  else
+    {
+      for (int c = 0; c < 3; ++c)
+        {
+          return_value[c] = a * m_tables.m_unorm_to_float[p[c]];
+        }
+    }
+  return return_value;
+}
+
+fastuidraw::u8vec4
+Converter::
+from_working(const fastuidraw::vec4 &v) const
+{
+  fastuidraw::u8vec4 return_value;
+  float a;
+
+  a = fastuidraw::t_max(0.0f, fastuidraw::t_min(1.0f, v.w()));
+  return_value.w() = static_cast<uint8_t>(a * 255.0f + 0.5f);
+  for (int c = 0; c < 3; ++c)
+    {
+      float q;
+
+      q = fastuidraw::t_max(0.0f, fastuidraw::t_min(a, v[c]));
+      if (m_premultiplied && !m_srgb)
+        {
+          return_value[c] = static_cast<uint8_t>(q * 255.0f + 0.5f);
+        }
+      else if (return_value.w() == 0u)
+        {
+          return_value[c] = 0u;
+        }
+      else if (m_srgb)
+        {
+          unsigned int s;
+
+          s = m_tables.encode_srgb(q / a);
+          if (m_premultiplied)
+            {
+              s = (s * return_value.w() + 127u) / 255u;
+            }
+          return_value[c] = s;
+        }
+      else
+        {
+          return_value[c] = static_cast<uint8_t>(255.0f * q / a + 0.5f);
+        }
+    }
+  return return_value;
+}
+
+//////////////////////////////////////////
+// CellTask methods
+void
+CellTask::
+run(void)
+{
+  m_d->compute_cell(m_key, fastuidraw::make_c_array(m_source_texels), m_cell);
+}
+
+//////////////////////////////////////////
+// GeneratorPrivate methods
+GeneratorPrivate::
+GeneratorPrivate(fastuidraw::uvec2 dimensions,
+                 const fastuidraw::ImageSourceBase &src,
+                 enum fastuidraw::ImageSourceMipmapGenerator::filter_t filter,
+                 enum fastuidraw::ImageSourceMipmapGenerator::color_space_t color_space,
+                 const fastuidraw::reference_counted_ptr<fastuidraw::WorkerPool> &pool):
+  m_dimensions(fastuidraw::t_max(1u, dimensions.x()),
+               fastuidraw::t_max(1u, dimensions.y())),
+  m_src(src),
+  m_filter(filter),
+  m_color_space(color_space),
+  m_pool(pool),
+  m_number_source_levels(fastuidraw::t_max(1u, src.number_levels())),
+  m_converter(src.format(), color_space),
+  m_cached_texels(0)
+{
+  uint32_t max_dim;
+
+  max_dim = fastuidraw::t_max(m_dimensions.x(), m_dimensions.y());
+  m_number_levels = fastuidraw::t_max(m_number_source_levels,
+                                      1u + fastuidraw::uint32_log2(max_dim));
+  m_missing.resize(m_number_levels);
+}
+
+GeneratorPrivate::
+~GeneratorPrivate()
+{
+  evict_cells(0);
+}
+
+void
+GeneratorPrivate::
+footprint(fastuidraw::ivec2 min, fastuidraw::ivec2 size,
+          fastuidraw::ivec2 *out_min, fastuidraw::ivec2 *out_size) const
+{
+  if (m_filter == fastuidraw::ImageSourceMipmapGenerator::kaiser_filter)
+    {
+      *out_min = 2 * min - fastuidraw::ivec2(kaiser_offset);
+      *out_size = 2 * size + fastuidraw::ivec2(kaiser_taps - 2);
+    }
+  else
+    {
+      *out_min = 2 * min;
+      *out_size = 2 * size;
+    }
+}
+
+void
+GeneratorPrivate::
+require_cells(unsigned int level, fastuidraw::ivec2 min, fastuidraw::ivec2 max)
+{
+  fastuidraw::ivec2 cmin, cmax, missing_min(0, 0), missing_max(0, 0);
+  bool has_missing(false);
+  int size(cell_size(level));
+
+  FASTUIDRAWassert(level >= m_number_source_levels);
+  cmin = min / size;
+  cmax = (max - fastuidraw::ivec2(1)) / size;
+  for (int cy = cmin.y(); cy <= cmax.y(); ++cy)
+    {
+      for (int cx = cmin.x(); cx <= cmax.x(); ++cx)
+        {
+          CellKey K(level, fastuidraw::ivec2(cx, cy));
+          CellMap::iterator iter;
+
+          iter = m_cells.find(K);
+          if (iter != m_cells.end())
+            {
+              m_lru.splice(m_lru.begin(), m_lru, iter->second->m_lru_location);
+              continue;
+            }
+
+          Cell *cell;
+
+          cell = FASTUIDRAWnew Cell(size);
+          m_cached_texels += size * size;
+          m_lru.push_front(K);
+          cell->m_lru_location = m_lru.begin();
+          m_cells[K] = cell;
+          m_missing[level].push_back(K);
+
+          if (!has_missing)
+            {
+              missing_min = missing_max = fastuidraw::ivec2(cx, cy);
+              has_missing = true;
+            }
+          else
+            {
+              missing_min.x() = fastuidraw::t_min(missing_min.x(), cx);
+              missing_min.y() = fastuidraw::t_min(missing_min.y(), cy);
+              missing_max.x() = fastuidraw::t_max(missing_max.x(), cx);
+              missing_max.y() = fastuidraw::t_max(missing_max.y(), cy);
+            }
+        }
+    }
+
+  if (has_missing && level - 1u >= m_number_source_levels)
+    {
+      fastuidraw::ivec2 level_dims, prev_dims, rmin, rmax, fmin, fsize;
+
+      /* require the cells of the previous level that
+       * the missing cells of this level read
+       */
+      level_dims = level_dimensions(level);
+      prev_dims = level_dimensions(level - 1u);
+      rmin = missing_min * size;
+      rmax.x() = fastuidraw::t_min(level_dims.x(), (missing_max.x() + 1) * size);
+      rmax.y() = fastuidraw::t_min(level_dims.y(), (missing_max.y() + 1) * size);
+      footprint(rmin, rmax - rmin, &fmin, &fsize);
+
+      rmin.x() = fastuidraw::t_max(0, fmin.x());
+      rmin.y() = fastuidraw::t_max(0, fmin.y());
+      rmax.x() = fastuidraw::t_min(prev_dims.x(), fmin.x() + fsize.x());
+      rmax.y() = fastuidraw::t_min(prev_dims.y(), fmin.y() + fsize.y());
+      require_cells(level - 1u, rmin, rmax);
+    }
+}
+
+void
+GeneratorPrivate::
+compute_missing_cells(void)
+{
+  std::vector<fastuidraw::reference_counted_ptr<CellTask> > tasks;
+  int missing_texels;
+
+  /* a level reads the previous level, so the levels
+   * are computed from finest to coarsest; the cells
+   * of a level are independent of each other.
+   */
+  for (unsigned int level = m_number_source_levels; level < m_number_levels; ++level)
+    {
+      if (m_missing[level].empty())
+        {
+          continue;
+        }
+
+      tasks.clear();
+      missing_texels = 0;
+      for (const CellKey &K : m_missing[level])
+        {
+          fastuidraw::reference_counted_ptr<CellTask> task;
+
+          task = FASTUIDRAWnew CellTask(this, K, m_cells[K]);
+          if (level == m_number_source_levels)
+            {
+              fastuidraw::ivec2 min, size, fmin, fsize, level_dims;
+              int csize(cell_size(level));
+
+              /* the source is only accessed from this thread */
+              level_dims = level_dimensions(level);
+              min = K.m_cell * csize;
+              size.x() = fastuidraw::t_min(csize, level_dims.x() - min.x());
+              size.y() = fastuidraw::t_min(csize, level_dims.y() - min.y());
+              footprint(min, size, &fmin, &fsize);
+
+              task->m_source_texels.resize(fsize.x() * fsize.y());
+              m_src.fetch_texels(level - 1u, fmin, fsize.x(), fsize.y(),
+                                 fastuidraw::make_c_array(task->m_source_texels));
+            }
+          tasks.push_back(task);
+          missing_texels += cell_size(level) * cell_size(level);
+        }
+
+      if (m_pool && m_pool->number_threads() > 1u
+          && tasks.size() > 1u && missing_texels >= min_parallel_texels)
+        {
+          for (const fastuidraw::reference_counted_ptr<CellTask> &task : tasks)
+            {
+              m_pool->add_task(task);
+            }
+        }
+
+      /* execute the tasks not yet started by the pool on this
+       * thread so that a request never waits on a pool whose
+       * threads are busy.
+       */
+      for (const fastuidraw::reference_counted_ptr<CellTask> &task : tasks)
+        {
+          task->execute();
+          task->wait();
+        }
+      m_missing[level].clear();
+    }
+}
+
+void
+GeneratorPrivate::
+compute_cell(const CellKey &key,
+             fastuidraw::c_array<const fastuidraw::u8vec4> source_texels,
+             Cell *cell) const
+{
+  fastuidraw::ivec2 level_dims, min, size, fmin, fsize;
+  std::vector<fastuidraw::vec4> input;
+  int csize(cell_size(key.m_level));
+
+  level_dims = level_dimensions(key.m_level);
+  min = key.m_cell * csize;
+  size.x() = fastuidraw::t_min(csize, level_dims.x() - min.x());
+  size.y() = fastuidraw::t_min(csize, level_dims.y() - min.y());
+  footprint(min, size, &fmin, &fsize);
+
+  input.resize(fsize.x() * fsize.y());
+  if (key.m_level == m_number_source_levels)
+    {
+      FASTUIDRAWassert(source_texels.size() == input.size());
+      for (unsigned int i = 0; i < input.size(); ++i)
+        {
+          input[i] = m_converter.to_working(source_texels[i]);
+        }
+    }
+  else
+    {
+      gather(key.m_level - 1u, fmin, fsize.x(), fsize.y(), &input[0]);
+    }
+
+  if (m_filter == fastuidraw::ImageSourceMipmapGenerator::kaiser_filter)
+    {
+      const float *weights(ColorTables::get().m_kaiser_weights);
+      std::vector<fastuidraw::vec4> horizontal(size.x() * fsize.y());
+      const fastuidraw::vec4 *rows[kaiser_taps];
+
+      /* the filter is separable: first filter each row of the
+       * input horizontally, then filter the columns of that.
+       */
+      for (int y = 0; y < fsize.y(); ++y)
+        {
+          kaiser_reduce_row(weights, &input[y * fsize.x()],
+                            size.x(), &horizontal[y * size.x()]);
+        }
+
+      for (int y = 0; y < size.y(); ++y)
+        {
+          fastuidraw::vec4 *dst;
+
+          for (int k = 0; k < kaiser_taps; ++k)
+            {
+              rows[k] = &horizontal[(2 * y + k) * size.x()];
+            }
+          dst = &cell->m_texels[y * csize];
+          kaiser_reduce_column(weights, rows, size.x(), dst);
+          clamp_row(size.x(), dst);
+        }
+    }
+  else
+    {
+      for (int y = 0; y < size.y(); ++y)
+        {
+          box_reduce_row(&input[2 * y * fsize.x()],
+                         &input[(2 * y + 1) * fsize.x()],
+                         size.x(), &cell->m_texels[y * csize]);
+        }
+    }
+}
+
+const fastuidraw::vec4*
+GeneratorPrivate::
+texel(unsigned int level, int x, int y) const
+{
+  CellMap::const_iterator iter;
+  int size(cell_size(level));
+
+  iter = m_cells.find(CellKey(level, fastuidraw::ivec2(x, y) / size));
+  FASTUIDRAWassert(iter != m_cells.end());
+  return &iter->second->m_texels[(x % size) + (y % size) * size];
+}
+
+void
+GeneratorPrivate::
+gather(unsigned int level, fastuidraw::ivec2 location,
+       int w, int h, fastuidraw::vec4 *dst) const
+{
+  fastuidraw::ivec2 level_dims;
+  int x_begin, x_end, size(cell_size(level));
+
+  /* texels [x_begin, x_end) of each row are within the level */
+  level_dims = level_dimensions(level);
+  x_begin = fastuidraw::t_min(w, fastuidraw::t_max(0, -location.x()));
+  x_end = fastuidraw::t_max(x_begin, fastuidraw::t_min(w, level_dims.x() - location.x()));
+
+  for (int y = 0; y < h; ++y, dst += w)
+    {
+      int sy, x;
+
+      sy = location.y() + y;
+      sy = fastuidraw::t_max(0, fastuidraw::t_min(level_dims.y() - 1, sy));
+
+      for (x = 0; x < x_begin; ++x)
+        {
+          dst[x] = *texel(level, 0, sy);
+        }
+
+      while (x < x_end)
+        {
+          const fastuidraw::vec4 *src;
+          int sx, n;
+
+          sx = location.x() + x;
+          n = fastuidraw::t_min(x_end - x, size - sx % size);
+          src = texel(level, sx, sy);
+          std::copy(src, src + n, dst + x);
+          x += n;
+        }
+
+      for (; x < w; ++x)
+        {
+          dst[x] = *texel(level, level_dims.x() - 1, sy);
+        }
+    }
+}
+
+void
+GeneratorPrivate::
+evict_cells(unsigned int max_texels)
+{
+  while (m_cached_texels > max_texels)
+    {
+      CellMap::iterator iter;
+
+      iter = m_cells.find(m_lru.back());
+      FASTUIDRAWassert(iter != m_cells.end());
+      m_cached_texels -= iter->second->m_texels.size();
+      FASTUIDRAWdelete(iter->second);
+      m_cells.erase(iter);
+      m_lru.pop_back();
+    }
+}
+
+//////////////////////////////////////////////////
+// fastuidraw::ImageSourceMipmapGenerator methods
+fastuidraw::ImageSourceMipmapGenerator::
+ImageSourceMipmapGenerator(uvec2 dimensions,
+                           const ImageSourceBase &src,
+                           enum filter_t filter,
+                           enum color_space_t color_space,
+                           const reference_counted_ptr<WorkerPool> &pool)
+{
+  m_d = FASTUIDRAWnew GeneratorPrivate(dimensions, src, filter, color_space, pool);
+}
+
+fastuidraw::ImageSourceMipmapGenerator::
+~ImageSourceMipmapGenerator()
+{
+  GeneratorPrivate *d;
+  d = static_cast<GeneratorPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+enum fastuidraw::ImageSourceMipmapGenerator::filter_t
+fastuidraw::ImageSourceMipmapGenerator::
+filter(void) const
+{
+  GeneratorPrivate *d;
+  d = static_cast<GeneratorPrivate*>(m_d);
+  return d->m_filter;
+}
+
+enum fastuidraw::ImageSourceMipmapGenerator::color_space_t
+fastuidraw::ImageSourceMipmapGenerator::
+color_space(void) const
+{
+  GeneratorPrivate *d;
+  d = static_cast<GeneratorPrivate*>(m_d);
+  return d->m_color_space;
+}
+
+void
+fastuidraw::ImageSourceMipmapGenerator::
+clear_cache(void)
+{
+  GeneratorPrivate *d;
+  d = static_cast<GeneratorPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> M(d->m_mutex);
+  d->evict_cells(0);
+}
+
+bool
+fastuidraw::ImageSourceMipmapGenerator::
+all_same_color(ivec2 location, int square_size, u8vec4 *dst) const
+{
+  GeneratorPrivate *d;
+  d = static_cast<GeneratorPrivate*>(m_d);
+
+  /* the generated levels of a region of constant color
+   * are that color (up to the filter reading a margin
+   * around the region for the Kaiser filter)
+   */
+  return d->m_src.all_same_color(location, square_size, dst);
+}
+
+unsigned int
+fastuidraw::ImageSourceMipmapGenerator::
+number_levels(void) const
+{
+  GeneratorPrivate *d;
+  d = static_cast<GeneratorPrivate*>(m_d);
+  return d->m_number_levels;
+}
+
+void
+fastuidraw::ImageSourceMipmapGenerator::
+fetch_texels(unsigned int level, ivec2 location,
+             unsigned int w, unsigned int h,
+             c_array<u8vec4> dst) const
+{
+  GeneratorPrivate *d;
+  d = static_cast<GeneratorPrivate*>(m_d);
+
+  FASTUIDRAWassert(level < d->m_number_levels);
+  if (level < d->m_number_source_levels)
+    {
+      d->m_src.fetch_texels(level, location, w, h, dst);
+      return;
+    }
+
+  ivec2 level_dims, min, max;
+
+  level_dims = d->level_dimensions(level);
+  min.x() = t_max(0, t_min(level_dims.x() - 1, location.x()));
+  min.y() = t_max(0, t_min(level_dims.y() - 1, location.y()));
+  max.x() = t_max(min.x() + 1, t_min(level_dims.x(), location.x() + int(w)));
+  max.y() = t_max(min.y() + 1, t_min(level_dims.y(), location.y() + int(h)));
+
+  std::lock_guard<std::mutex> M(d->m_mutex);
+  d->require_cells(level, min, max);
+  d->compute_missing_cells();
+
+  d->m_gather_scratch.resize(w * h);
+  d->gather(level, location, w, h, &d->m_gather_scratch[0]);
+  for (unsigned int i = 0, endi = w * h; i < endi; ++i)
+    {
+      dst[i] = d->m_converter.from_working(d->m_gather_scratch[i]);
+    }
+  d->evict_cells(max_cached_texels);
+}
+
+enum fastuidraw::Image::format_t
+fastuidraw::ImageSourceMipmapGenerator::
+format(void) const
+{
+  GeneratorPrivate *d;
+  d = static_cast<GeneratorPrivate*>(m_d);
+  return d->m_src.format();
+}
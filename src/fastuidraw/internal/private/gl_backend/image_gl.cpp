@@ -67,6 +67,11 @@ namespace
     set_data(int mipmap_level, fastuidraw::ivec2 dst_xy, int dst_l,
              unsigned int size, fastuidraw::u8vec4 color_value);
 
+    virtual
+    void
+    copy_data(int mipmap_level, fastuidraw::ivec2 src_xy, int src_l,
+              fastuidraw::ivec2 dst_xy, int dst_l, unsigned int size);
+
     virtual
     void
     flush(void)
@@ -264,6 +269,22 @@ set_data(int mipmap_level, fastuidraw::ivec2 dst_xy, int dst_l,
   m_backing_store.set_data_c_array(V, raw_data);
 }
 
+void
+ColorBackingStoreGL::
+copy_data(int mipmap_level, fastuidraw::ivec2 src_xy, int src_l,
+          fastuidraw::ivec2 dst_xy, int dst_l, unsigned int size)
+{
+  if (mipmap_level >= m_backing_store.num_mipmaps())
+    {
+      return;
+    }
+
+  m_backing_store.copy_data(mipmap_level,
+                            fastuidraw::ivec3(src_xy.x(), src_xy.y(), src_l),
+                            fastuidraw::ivec3(dst_xy.x(), dst_xy.y(), dst_l),
+                            fastuidraw::ivec3(size, size, 1));
+}
+
 fastuidraw::ivec3
 ColorBackingStoreGL::
 store_size(int log2_tile_size, int log2_num_tiles_per_row_per_col, int num_layers)
@@ -116,7 +116,8 @@ public:
   DrawState(void):
     m_current_program(nullptr),
     m_current_blend_mode(),
-    m_blend_type(fastuidraw::PainterBlendShader::number_types)
+    m_blend_type(fastuidraw::PainterBlendShader::number_types),
+    m_item_group(0)
   {}
 
   void
@@ -152,6 +153,18 @@ public:
     return m_blend_type;
   }
 
+  void
+  item_group(uint32_t v)
+  {
+    m_item_group = v;
+  }
+
+  uint32_t
+  item_group(void) const
+  {
+    return m_item_group;
+  }
+
   void
   restore_gl_state(const fastuidraw::gl::detail::painter_vao &vao,
                    PainterBackendGL *pr,
@@ -169,6 +182,7 @@ private:
   fastuidraw::gl::Program *m_current_program;
   const fastuidraw::BlendMode *m_current_blend_mode;
   enum fastuidraw::PainterBlendShader::shader_type m_blend_type;
+  uint32_t m_item_group;
   RenderTargetState m_current_render_target_state;
 };
 
@@ -177,7 +191,8 @@ class fastuidraw::gl::detail::PainterBackendGL::DrawEntry
 public:
   DrawEntry(const fastuidraw::BlendMode &mode,
             fastuidraw::gl::Program *new_program,
-            enum fastuidraw::PainterBlendShader::shader_type blend_type);
+            enum fastuidraw::PainterBlendShader::shader_type blend_type,
+            uint32_t item_group);
 
   DrawEntry(const fastuidraw::BlendMode &mode);
 
@@ -186,6 +201,10 @@ public:
   void
   add_entry(GLsizei count, const void *offset);
 
+  /* append to dst the indirect draw commands of the entry */
+  void
+  write_indirect_commands(std::vector<fastuidraw::gl::detail::draw_elements_indirect_command> &dst);
+
   void
   draw(fastuidraw::gl::detail::PainterBackendGL *pr,
        const fastuidraw::gl::detail::painter_vao &vao,
@@ -200,6 +219,16 @@ private:
   std::vector<const GLvoid*> m_indices;
   fastuidraw::gl::Program *m_new_program;
   enum fastuidraw::PainterBlendShader::shader_type m_blend_type;
+
+  /* the item shader group that selected m_new_program,
+   * i.e. the group to which GPU time is attributed
+   */
+  uint32_t m_item_group;
+
+  /* location within the indirect buffer of the first
+   * command of this entry.
+   */
+  unsigned int m_indirect_first;
 };
 
 class fastuidraw::gl::detail::PainterBackendGL::DrawCommand:
@@ -253,11 +282,14 @@ private:
 fastuidraw::gl::detail::PainterBackendGL::DrawEntry::
 DrawEntry(const BlendMode &mode,
           Program *new_program,
-          enum PainterBlendShader::shader_type blend_type):
+          enum PainterBlendShader::shader_type blend_type,
+          uint32_t item_group):
   m_set_blend(true),
   m_blend_mode(mode),
   m_new_program(new_program),
-  m_blend_type(blend_type)
+  m_blend_type(blend_type),
+  m_item_group(item_group),
+  m_indirect_first(0)
 {
 }
 
@@ -266,7 +298,9 @@ DrawEntry(const BlendMode &mode):
   m_set_blend(true),
   m_blend_mode(mode),
   m_new_program(nullptr),
-  m_blend_type(PainterBlendShader::number_types)
+  m_blend_type(PainterBlendShader::number_types),
+  m_item_group(0),
+  m_indirect_first(0)
 {
 }
 
@@ -275,7 +309,9 @@ DrawEntry(const reference_counted_ptr<const PainterDrawBreakAction> &action):
   m_set_blend(false),
   m_action(action),
   m_new_program(nullptr),
-  m_blend_type(PainterBlendShader::number_types)
+  m_blend_type(PainterBlendShader::number_types),
+  m_item_group(0),
+  m_indirect_first(0)
 {
 }
 
@@ -287,6 +323,28 @@ add_entry(GLsizei count, const void *offset)
   m_indices.push_back(offset);
 }
 
+void
+fastuidraw::gl::detail::PainterBackendGL::DrawEntry::
+write_indirect_commands(std::vector<draw_elements_indirect_command> &dst)
+{
+  FASTUIDRAWassert(m_counts.size() == m_indices.size());
+  m_indirect_first = dst.size();
+  for(unsigned int i = 0, endi = m_counts.size(); i < endi; ++i)
+    {
+      draw_elements_indirect_command cmd;
+
+      /* the offsets are byte offsets into the index buffer,
+       * see DrawCommand::add_entry()
+       */
+      cmd.m_count = m_counts[i];
+      cmd.m_instance_count = 1;
+      cmd.m_first_index = reinterpret_cast<uintptr_t>(m_indices[i]) / sizeof(PainterIndex);
+      cmd.m_base_vertex = 0;
+      cmd.m_base_instance = 0;
+      dst.push_back(cmd);
+    }
+}
+
 void
 fastuidraw::gl::detail::PainterBackendGL::DrawEntry::
 draw(fastuidraw::gl::detail::PainterBackendGL *pr,
@@ -294,6 +352,7 @@ draw(fastuidraw::gl::detail::PainterBackendGL *pr,
      DrawState *st) const
 {
   uint32_t flags(0);
+  bool timed;
 
   if (m_action)
     {
@@ -304,6 +363,16 @@ draw(fastuidraw::gl::detail::PainterBackendGL *pr,
       fastuidraw_glBindVertexArray(0);
       flags |= m_action->execute(pr);
       fastuidraw_glBindVertexArray(vao.vao());
+
+      #ifndef FASTUIDRAW_GL_USE_GLES
+        {
+          /* the indirect buffer binding is not part of the VAO state */
+          if (vao.indirect_bo() != 0)
+            {
+              fastuidraw_glBindBuffer(GL_DRAW_INDIRECT_BUFFER, vao.indirect_bo());
+            }
+        }
+      #endif
     }
 
   if (m_set_blend)
@@ -312,10 +381,14 @@ draw(fastuidraw::gl::detail::PainterBackendGL *pr,
       flags |= gpu_dirty_state::blend_mode;
     }
 
-  if (m_new_program && st->current_program() != m_new_program)
+  if (m_new_program)
     {
-      st->current_program(m_new_program);
-      flags |= gpu_dirty_state::shader;
+      st->item_group(m_item_group);
+      if (st->current_program() != m_new_program)
+        {
+          st->current_program(m_new_program);
+          flags |= gpu_dirty_state::shader;
+        }
     }
 
   if (m_blend_type != PainterBlendShader::number_types && st->blend_type() != m_blend_type)
@@ -332,12 +405,25 @@ draw(fastuidraw::gl::detail::PainterBackendGL *pr,
     }
 
   FASTUIDRAWassert(m_counts.size() == m_indices.size());
+  timed = pr->begin_gpu_timer(st->item_group());
 
   #ifndef FASTUIDRAW_GL_USE_GLES
     {
-      fastuidraw_glMultiDrawElements(GL_TRIANGLES, &m_counts[0],
-                                     opengl_trait<PainterIndex>::type,
-                                     &m_indices[0], m_counts.size());
+      if (vao.indirect_bo() != 0)
+        {
+          const draw_elements_indirect_command *cmd(nullptr);
+
+          cmd += m_indirect_first;
+          fastuidraw_glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                                 opengl_trait<PainterIndex>::type,
+                                                 cmd, m_counts.size(), 0);
+        }
+      else
+        {
+          fastuidraw_glMultiDrawElements(GL_TRIANGLES, &m_counts[0],
+                                         opengl_trait<PainterIndex>::type,
+                                         &m_indices[0], m_counts.size());
+        }
     }
   #else
     {
@@ -360,6 +446,11 @@ draw(fastuidraw::gl::detail::PainterBackendGL *pr,
         }
     }
   #endif
+
+  if (timed)
+    {
+      pr->end_gpu_timer();
+    }
 }
 
 ////////////////////////////////////
@@ -439,21 +530,36 @@ draw_break(enum PainterSurface::render_type_t render_type,
       Program *new_program;
       if (m_pr->use_uber_shader())
         {
-          if (render_type == PainterSurface::color_buffer_type)
-            {
-              enum PainterEngineGL::program_type_t pz;
-              pz = m_pr->m_choose_uber_program[new_disc != 0u];
-              new_program = m_pr->m_cached_programs.program(pz, new_blend_type).get();
-            }
-          else
-            {
-              new_program = m_pr->m_cached_programs.m_deferred_coverage_program.get();
-            }
+          new_program = m_pr->uber_program(render_type, new_disc, new_blend_type);
         }
       else
         {
           new_program =
-            m_pr->m_cached_item_programs->program_of_item_shader(render_type, new_disc, new_blend_type).get();
+            m_pr->m_cached_item_programs->program_of_item_shader(render_type, new_disc, new_blend_type, false);
+          if (!new_program)
+            {
+              /* The program of the item shader is still being
+               * built. Draw with the uber-shader until it is ready,
+               * but only if the uber-shader has finished building
+               * (it was started in on_painter_begin()) and includes
+               * the item shader; compiling the uber-shader here would
+               * be a far longer stall than waiting for the (much
+               * smaller) program of the item shader.
+               */
+              Program *uber;
+
+              uber = m_pr->uber_program(render_type, new_disc, new_blend_type);
+              if (uber && uber->build_complete()
+                  && m_pr->m_reg_gl->programs_are_current(m_pr->m_cached_programs))
+                {
+                  new_program = uber;
+                }
+              else
+                {
+                  new_program =
+                    m_pr->m_cached_item_programs->program_of_item_shader(render_type, new_disc, new_blend_type, true);
+                }
+            }
         }
 
       if (!m_draws.empty())
@@ -463,7 +569,7 @@ draw_break(enum PainterSurface::render_type_t render_type,
         }
 
       FASTUIDRAWassert(new_program);
-      m_draws.push_back(DrawEntry(fastuidraw::BlendMode(new_mode), new_program, new_blend_type));
+      m_draws.push_back(DrawEntry(fastuidraw::BlendMode(new_mode), new_program, new_blend_type, new_disc));
       return return_value;
     }
   else if (old_mode != new_mode)
@@ -518,11 +624,29 @@ draw(void) const
       FASTUIDRAWassert(!"Bad value for m_vao.m_data_store_backing");
     }
 
+  #ifndef FASTUIDRAW_GL_USE_GLES
+    {
+      if (m_vao.indirect_bo() != 0)
+        {
+          fastuidraw_glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_vao.indirect_bo());
+        }
+    }
+  #endif
+
   for(const DrawEntry &entry : m_draws)
     {
       entry.draw(m_pr, m_vao, m_pr->m_draw_state);
     }
   fastuidraw_glBindVertexArray(0);
+
+  #ifndef FASTUIDRAW_GL_USE_GLES
+    {
+      if (m_vao.indirect_bo() != 0)
+        {
+          fastuidraw_glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+    }
+  #endif
 }
 
 void
@@ -539,6 +663,17 @@ unmap_implement(unsigned int attributes_written,
                             indices_written,
                             data_store_written,
                             m_vao);
+
+  if (m_vao.indirect_bo() != 0)
+    {
+      std::vector<draw_elements_indirect_command> commands;
+
+      for(DrawEntry &entry : m_draws)
+        {
+          entry.write_indirect_commands(commands);
+        }
+      m_pool->upload_indirect_commands(make_c_array(commands), m_vao);
+    }
 }
 
 void
@@ -652,10 +787,21 @@ on_pre_draw(PainterBackendGL *pr, GLuint current_fbo)
       m_blend_type = PainterBlendShader::number_types;
     }
 
+  if (!pr->use_uber_shader())
+    {
+      /* each draw sets the program of its item shader, do
+       * not make GL link the uber-shader just to start.
+       */
+      m_current_program = nullptr;
+    }
+
   RenderTargetState R;
   R.m_fbo = current_fbo;
   m_current_render_target_state = pr->set_gl_state(R, m_blend_type, gpu_dirty_state::all);
-  m_current_program->use_program();
+  if (m_current_program)
+    {
+      m_current_program->use_program();
+    }
   m_current_blend_mode = nullptr;
 }
 
@@ -666,9 +812,11 @@ restore_gl_state(const fastuidraw::gl::detail::painter_vao &vao,
                  fastuidraw::gpu_dirty_state flags)
 {
   m_current_render_target_state = pr->set_gl_state(m_current_render_target_state, m_blend_type, flags);
-  if (flags & gpu_dirty_state::shader)
+  /* m_current_program is nullptr before the first draw
+   * when not using the uber-shader, that draw sets it.
+   */
+  if ((flags & gpu_dirty_state::shader) && m_current_program)
     {
-      FASTUIDRAWassert(m_current_program);
       m_current_program->use_program();
     }
 
@@ -798,7 +946,9 @@ PainterBackendGL(const fastuidraw::gl::PainterEngineGL *f):
   PainterBackend(),
   m_uniform_values(glsl::PainterShaderRegistrarGLSL::ubo_size()),
   m_nearest_filter_sampler(0),
-  m_surface_gl(nullptr)
+  m_surface_gl(nullptr),
+  m_gpu_clock(0),
+  m_last_submit_time(0)
 {
   reference_counted_ptr<PainterShaderRegistrar> reg_base(&f->painter_shader_registrar());
 
@@ -860,6 +1010,15 @@ fastuidraw::gl::detail::PainterBackendGL::
     {
       fastuidraw_glDeleteSamplers(1, &m_nearest_filter_sampler);
     }
+
+  for (const GPUTimer &T : m_pending_gpu_timers)
+    {
+      m_free_gpu_queries.push_back(T.m_query);
+    }
+  if (!m_free_gpu_queries.empty())
+    {
+      fastuidraw_glDeleteQueries(m_free_gpu_queries.size(), &m_free_gpu_queries[0]);
+    }
   FASTUIDRAWdelete(m_draw_state);
 }
 
@@ -1263,6 +1422,7 @@ on_post_draw(void)
   fastuidraw_glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
   fastuidraw_glDisable(GL_SCISSOR_TEST);
   m_pool->next_pool();
+  poll_gpu_timers(false);
 }
 
 fastuidraw::reference_counted_ptr<fastuidraw::PainterDrawBreakAction>
@@ -1289,6 +1449,27 @@ bind_coverage_surface(const reference_counted_ptr<PainterSurface> &surface)
   return FASTUIDRAWnew CoverageTextureBindAction(surface->image(*m_image_atlas), this);
 }
 
+fastuidraw::gl::Program*
+fastuidraw::gl::detail::PainterBackendGL::
+uber_program(enum PainterSurface::render_type_t render_type,
+             uint32_t item_group,
+             enum PainterBlendShader::shader_type blend_type)
+{
+  if (render_type == PainterSurface::color_buffer_type)
+    {
+      enum PainterEngineGL::program_type_t pz;
+      bool with_discard;
+
+      with_discard = (item_group & PainterShaderRegistrarGL::shader_group_discard_mask) != 0u;
+      pz = m_choose_uber_program[with_discard];
+      return m_cached_programs.program(pz, blend_type).get();
+    }
+  else
+    {
+      return m_cached_programs.m_deferred_coverage_program.get();
+    }
+}
+
 fastuidraw::reference_counted_ptr<fastuidraw::PainterDraw>
 fastuidraw::gl::detail::PainterBackendGL::
 map_draw(void)
@@ -1304,5 +1485,132 @@ on_painter_begin(void)
   if (m_cached_item_programs)
     {
       m_cached_item_programs->reset();
+      if (m_reg_gl->params().async_item_program_build())
+        {
+          /* start building the uber-shader, without waiting for
+           * it, so that it is ready as the fallback for drawing
+           * with item shaders whose programs are still building.
+           */
+          m_cached_programs.begin_build();
+        }
+    }
+  poll_gpu_timers(false);
+}
+
+void
+fastuidraw::gl::detail::PainterBackendGL::
+profiler(const reference_counted_ptr<PainterProfiler> &p)
+{
+  /* the results of the pending queries go to
+   * the profiler that was active when they
+   * were issued.
+   */
+  poll_gpu_timers(true);
+  m_profiler = p;
+  m_gpu_clock = m_last_submit_time = 0;
+}
+
+bool
+fastuidraw::gl::detail::PainterBackendGL::
+begin_gpu_timer(uint32_t item_group)
+{
+  /* GL_TIME_ELAPSED queries are only core in desktop GL;
+   * GLES only has them with EXT_disjoint_timer_query.
+   */
+  #ifndef FASTUIDRAW_GL_USE_GLES
+    {
+      GPUTimer T;
+
+      if (!m_profiler || !m_profiler->gpu_timing())
+        {
+          return false;
+        }
+
+      if (m_free_gpu_queries.empty())
+        {
+          fastuidraw_glGenQueries(1, &T.m_query);
+        }
+      else
+        {
+          T.m_query = m_free_gpu_queries.back();
+          m_free_gpu_queries.pop_back();
+        }
+      T.m_item_group = item_group;
+      T.m_submit_time = m_profiler->time_now();
+      fastuidraw_glBeginQuery(GL_TIME_ELAPSED, T.m_query);
+      m_pending_gpu_timers.push_back(T);
+      return true;
+    }
+  #else
+    {
+      FASTUIDRAWunused(item_group);
+      return false;
+    }
+  #endif
+}
+
+void
+fastuidraw::gl::detail::PainterBackendGL::
+end_gpu_timer(void)
+{
+  #ifndef FASTUIDRAW_GL_USE_GLES
+    {
+      fastuidraw_glEndQuery(GL_TIME_ELAPSED);
+    }
+  #endif
+}
+
+void
+fastuidraw::gl::detail::PainterBackendGL::
+poll_gpu_timers(bool wait)
+{
+  #ifndef FASTUIDRAW_GL_USE_GLES
+    {
+      /* queries complete in the order they were issued,
+       * so stop at the first one that is not available.
+       */
+      while (!m_pending_gpu_timers.empty())
+        {
+          const GPUTimer &T(m_pending_gpu_timers.front());
+          GLuint64 elapsed(0);
+
+          if (!wait)
+            {
+              GLuint available(GL_FALSE);
+
+              fastuidraw_glGetQueryObjectuiv(T.m_query, GL_QUERY_RESULT_AVAILABLE, &available);
+              if (available == GL_FALSE)
+                {
+                  return;
+                }
+            }
+
+          fastuidraw_glGetQueryObjectui64v(T.m_query, GL_QUERY_RESULT, &elapsed);
+          if (m_profiler)
+            {
+              uint64_t begin;
+
+              /* The GPU does not report when it started the draws;
+               * place the draws of a submission back to back starting
+               * at the time the first was issued. A submit time going
+               * backwards means that the profiler was cleared.
+               */
+              if (T.m_submit_time < m_last_submit_time)
+                {
+                  m_gpu_clock = 0;
+                }
+              begin = t_max(T.m_submit_time, m_gpu_clock);
+              m_profiler->add_gpu_event("draw_break", begin, elapsed, T.m_item_group);
+              m_gpu_clock = begin + elapsed;
+              m_last_submit_time = T.m_submit_time;
+            }
+          m_free_gpu_queries.push_back(T.m_query);
+          m_pending_gpu_timers.pop_front();
+        }
     }
+  #else
+    {
+      FASTUIDRAWunused(wait);
+    }
+  #endif
 }
@@ -19,6 +19,8 @@
 #ifndef FASTUIDRAW_PAINTER_BACKEND_GL_HPP
 #define FASTUIDRAW_PAINTER_BACKEND_GL_HPP
 
+#include <deque>
+#include <vector>
 #include <fastuidraw/painter/backend/painter_backend.hpp>
 #include <fastuidraw/glsl/painter_shader_registrar_glsl.hpp>
 #include <fastuidraw/gl_backend/ngl_header.hpp>
@@ -89,6 +91,10 @@ namespace fastuidraw
         void
         on_painter_begin(void) override final;
 
+        virtual
+        void
+        profiler(const reference_counted_ptr<PainterProfiler> &p) override final;
+
         GLuint
         clear_buffers_of_current_surface(bool clear_depth, bool clear_color);
 
@@ -111,6 +117,17 @@ namespace fastuidraw
           bool m_color_buffer_as_image;
         };
 
+        /* a GL_TIME_ELAPSED query around the draw calls of
+         * a DrawEntry whose result is not yet reported.
+         */
+        class GPUTimer
+        {
+        public:
+          GLuint m_query;
+          uint32_t m_item_group;
+          uint64_t m_submit_time;
+        };
+
         class TextureImageBindAction;
         class CoverageTextureBindAction;
         class DrawState;
@@ -122,6 +139,27 @@ namespace fastuidraw
                      enum PainterBlendShader::shader_type blend_type,
                      gpu_dirty_state v);
 
+        /* returns true if a timer query was started, in which
+         * case end_gpu_timer() must be called after the draws
+         */
+        bool
+        begin_gpu_timer(uint32_t item_group);
+
+        void
+        end_gpu_timer(void);
+
+        /* report the results of the timer queries that are
+         * available to m_profiler; if wait is true, wait for
+         * all results.
+         */
+        void
+        poll_gpu_timers(bool wait);
+
+        Program*
+        uber_program(enum PainterSurface::render_type_t render_type,
+                     uint32_t item_group,
+                     enum PainterBlendShader::shader_type blend_type);
+
         reference_counted_ptr<PainterShaderRegistrarGL> m_reg_gl;
         reference_counted_ptr<GlyphAtlasGL> m_glyph_atlas;
         reference_counted_ptr<ImageAtlasGL> m_image_atlas;
@@ -139,6 +177,11 @@ namespace fastuidraw
         PainterShaderRegistrarGL::program_set m_cached_programs;
         reference_counted_ptr<PainterShaderRegistrarGL::CachedItemPrograms> m_cached_item_programs;
         fastuidraw::vecN<enum PainterEngineGL::program_type_t, 2> m_choose_uber_program;
+
+        reference_counted_ptr<PainterProfiler> m_profiler;
+        std::vector<GLuint> m_free_gpu_queries;
+        std::deque<GPUTimer> m_pending_gpu_timers;
+        uint64_t m_gpu_clock, m_last_submit_time;
       };
     } //namespace detail
   } //namespace gl
@@ -58,6 +58,29 @@ namespace
   };
 }
 
+//////////////////////////////////////////////////////////////
+// fastuidraw::gl::detail::PainterShaderRegistrarGL::program_set methods
+void
+fastuidraw::gl::detail::PainterShaderRegistrarGL::program_set::
+begin_build(void) const
+{
+  for (const programs_per_blend &b : m_item_programs)
+    {
+      for (const program_ref &p : b)
+        {
+          if (p)
+            {
+              p->begin_build();
+            }
+        }
+    }
+
+  if (m_deferred_coverage_program)
+    {
+      m_deferred_coverage_program->begin_build();
+    }
+}
+
 //////////////////////////////////////////////////////////////
 // fastuidraw::gl::detail::PainterShaderRegistrarGL::CachedItemPrograms methods
 void
@@ -79,19 +102,31 @@ reset(void)
     }
 }
 
-const fastuidraw::gl::detail::PainterShaderRegistrarGL::program_ref&
+fastuidraw::gl::Program*
 fastuidraw::gl::detail::PainterShaderRegistrarGL::CachedItemPrograms::
 program_of_item_shader(enum PainterSurface::render_type_t render_type,
                        unsigned int shader_group,
-                       enum PainterBlendShader::shader_type blend_type)
+                       enum PainterBlendShader::shader_type blend_type,
+                       bool wait_for_build)
 {
   program_ref &dst(*PainterShaderRegistrarGL::resize_item_shader_vector_as_needed(render_type, shader_group,
                                                                                   blend_type, m_item_programs));
   if (!dst)
     {
-      dst = m_reg->program_of_item_shader(render_type, shader_group, blend_type);
+      program_ref pr;
+
+      pr = m_reg->program_of_item_shader(render_type, shader_group, blend_type);
+      if (pr && !wait_for_build
+          && m_reg->params().async_item_program_build() && !pr->build_complete())
+        {
+          /* only cache the program once it is complete so that
+           * all later draws switch to it at once.
+           */
+          return nullptr;
+        }
+      dst = pr;
     }
-  return dst;
+  return dst.get();
 }
 
 //////////////////////////////////////
@@ -106,6 +141,7 @@ PainterShaderRegistrarGL(const PainterEngineGL::ConfigurationGL &P,
   m_number_blend_shaders_in_item_programs(0)
 {
   configure_backend();
+  record_item_shader_usage(m_uber_shader_builder_params.order_item_shaders_by_usage());
   m_backend_constants
     .set_from_atlas(*m_params.colorstop_atlas())
     .set_from_atlas(*m_params.image_atlas());
@@ -560,10 +596,19 @@ programs(void)
     {
       build_programs();
       m_number_shaders_in_program = number_shaders;
+      m_programs.m_number_shaders = number_shaders;
     }
   return m_programs;
 }
 
+bool
+fastuidraw::gl::detail::PainterShaderRegistrarGL::
+programs_are_current(const program_set &p)
+{
+  Mutex::Guard m(mutex());
+  return p.m_number_shaders == registered_shader_count();
+}
+
 fastuidraw::gl::detail::PainterShaderRegistrarGL::program_ref*
 fastuidraw::gl::detail::PainterShaderRegistrarGL::
 resize_item_shader_vector_as_needed(enum PainterSurface::render_type_t prender_type,
@@ -619,6 +664,11 @@ program_of_item_shader(enum PainterSurface::render_type_t prender_type,
         {
           dst = build_program_of_coverage_item_shader(shader);
         }
+
+      if (dst && m_params.async_item_program_build())
+        {
+          dst->begin_build();
+        }
     }
 
   return dst;
@@ -692,7 +742,8 @@ build_program_of_item_shader(unsigned int shader, bool shader_uses_discard,
 
   return_value = FASTUIDRAWnew Program(vert, frag,
                                        m_attribute_binder,
-                                       m_initializer);
+                                       m_initializer,
+                                       m_params.program_binary_cache());
   return return_value;
 }
 
@@ -721,7 +772,8 @@ build_program_of_coverage_item_shader(unsigned int shader)
 
   return_value = FASTUIDRAWnew Program(vert, frag,
                                        m_attribute_binder,
-                                       m_initializer);
+                                       m_initializer,
+                                       m_params.program_binary_cache());
   return return_value;
 }
 
@@ -776,7 +828,8 @@ build_program(enum PainterEngineGL::program_type_t tp,
 
   return_value = FASTUIDRAWnew Program(vert, frag,
                                        m_attribute_binder,
-                                       m_initializer);
+                                       m_initializer,
+                                       m_params.program_binary_cache());
   return return_value;
 }
 
@@ -807,6 +860,7 @@ build_deferred_coverage_program(void)
 
   return_value = FASTUIDRAWnew Program(vert, frag,
                                        m_attribute_binder,
-                                       m_initializer);
+                                       m_initializer,
+                                       m_params.program_binary_cache());
   return return_value;
 }
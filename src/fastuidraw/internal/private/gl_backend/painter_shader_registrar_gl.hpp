@@ -50,6 +50,10 @@ public:
   class program_set
   {
   public:
+    program_set(void):
+      m_number_shaders(0)
+    {}
+
     const programs_per_blend&
     programs(enum PainterBlendShader::shader_type blend_type) const
     {
@@ -70,8 +74,17 @@ public:
       return programs(blend_type)[tp];
     }
 
+    /* issue the builds of all programs of the set, see
+     * Program::begin_build()
+     */
+    void
+    begin_build(void) const;
+
     vecN<programs_per_blend, PainterBlendShader::number_types> m_item_programs;
     program_ref m_deferred_coverage_program;
+
+    /* value of registered_shader_count() when built */
+    unsigned int m_number_shaders;
   };
 
   class CachedItemPrograms:
@@ -87,10 +100,16 @@ public:
     void
     reset(void);
 
-    const program_ref&
+    /* Returns nullptr if the program is still being built
+     * asynchronously, unless wait_for_build is true in which
+     * case the program is returned regardless (and using it
+     * waits for GL to finish building it).
+     */
+    Program*
     program_of_item_shader(enum PainterSurface::render_type_t render_type,
                            unsigned int shader_group,
-                           enum PainterBlendShader::shader_type blend_type);
+                           enum PainterBlendShader::shader_type blend_type,
+                           bool wait_for_build);
 
   private:
     reference_counted_ptr<PainterShaderRegistrarGL> m_reg;
@@ -105,6 +124,12 @@ public:
   const program_set&
   programs(void);
 
+  /* returns true if the programs of the program_set include
+   * all shaders registered so far.
+   */
+  bool
+  programs_are_current(const program_set &p);
+
   program_ref
   program_of_item_shader(enum PainterSurface::render_type_t render_type,
                          unsigned int shader_group,
@@ -33,6 +33,7 @@ painter_vao_pool(const PainterEngineGL::ConfigurationGL &params,
   m_tex_buffer_support(tex_buffer_support),
   m_data_store_binding(data_store_binding),
   m_assume_single_gl_context(params.assume_single_gl_context()),
+  m_use_indirect_draw(params.use_indirect_draw()),
   m_buffer_streaming_type(params.buffer_streaming_type()),
   m_current_pool(0),
   m_free_vaos(params.number_pools()),
@@ -96,6 +97,17 @@ request_vao(void)
       return_value.m_index_bo = generate_bo(GL_ELEMENT_ARRAY_BUFFER, m_num_indices * sizeof(PainterIndex));
       return_value.m_header_bo = generate_bo(GL_ARRAY_BUFFER, m_num_attributes * sizeof(uint32_t));
 
+      #ifndef FASTUIDRAW_GL_USE_GLES
+        {
+          if (m_use_indirect_draw)
+            {
+              /* sized on upload, see upload_indirect_commands() */
+              fastuidraw_glGenBuffers(1, &return_value.m_indirect_bo);
+              FASTUIDRAWassert(return_value.m_indirect_bo != 0);
+            }
+        }
+      #endif
+
       #ifndef __EMSCRIPTEN__
         {
           if (m_data_store_backing == glsl::PainterShaderRegistrarGLSL::data_store_tbo)
@@ -230,6 +242,36 @@ unmap_vao_buffers(unsigned int attributes_written,
     }
 }
 
+void
+fastuidraw::gl::detail::painter_vao_pool::
+upload_indirect_commands(c_array<const draw_elements_indirect_command> commands,
+                         const painter_vao &vao)
+{
+  #ifndef FASTUIDRAW_GL_USE_GLES
+    {
+      FASTUIDRAWassert(vao.m_indirect_bo != 0);
+      if (!commands.empty())
+        {
+          /* the commands are tiny compared to the other buffers,
+           * always orphan to not stall on the GPU reading the
+           * commands of a previous use of the buffer.
+           */
+          fastuidraw_glBindBuffer(GL_DRAW_INDIRECT_BUFFER, vao.m_indirect_bo);
+          fastuidraw_glBufferData(GL_DRAW_INDIRECT_BUFFER,
+                                  commands.size() * sizeof(draw_elements_indirect_command),
+                                  commands.c_ptr(), GL_STREAM_DRAW);
+          fastuidraw_glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+    }
+  #else
+    {
+      FASTUIDRAWunused(commands);
+      FASTUIDRAWunused(vao);
+      FASTUIDRAWassert(!"Indirect draw not supported in GLES");
+    }
+  #endif
+}
+
 void
 fastuidraw::gl::detail::painter_vao_pool::
 prepare_index_vertex_sources(GLuint attribute_bo,
@@ -290,6 +332,10 @@ release_vao_resources(const painter_vao &V)
   fastuidraw_glDeleteBuffers(1, &V.m_header_bo);
   fastuidraw_glDeleteBuffers(1, &V.m_index_bo);
   fastuidraw_glDeleteBuffers(1, &V.m_data_bo);
+  if (V.m_indirect_bo != 0)
+    {
+      fastuidraw_glDeleteBuffers(1, &V.m_indirect_bo);
+    }
   if (m_assume_single_gl_context)
     {
       fastuidraw_glDeleteVertexArrays(1, &V.m_vao);
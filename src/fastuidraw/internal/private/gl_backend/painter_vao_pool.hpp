@@ -50,6 +50,19 @@ public:
   std::vector<uvec4> m_data_store;
 };
       
+/* Layout of a command read from a GL_DRAW_INDIRECT_BUFFER
+ * by glMultiDrawElementsIndirect().
+ */
+class draw_elements_indirect_command
+{
+public:
+  GLuint m_count;
+  GLuint m_instance_count;
+  GLuint m_first_index;
+  GLint m_base_vertex;
+  GLuint m_base_instance;
+};
+
 class painter_vao
 {
 public:
@@ -59,6 +72,7 @@ public:
     m_header_bo(0),
     m_index_bo(0),
     m_data_bo(0),
+    m_indirect_bo(0),
     m_data_tbo(0)
   {}
   
@@ -114,12 +128,22 @@ public:
   {
     return m_data_tbo;
   }
+
+  /* the buffer object to hold the draw_elements_indirect_command
+   * values, is 0 if ConfigurationGL::use_indirect_draw() is false.
+   */
+  GLuint
+  indirect_bo(void) const
+  {
+    return m_indirect_bo;
+  }
   
 private:
   friend class painter_vao_pool;
 
   GLuint m_vao;
   GLuint m_attribute_bo, m_header_bo, m_index_bo, m_data_bo;
+  GLuint m_indirect_bo;
   GLuint m_data_tbo;
   enum glsl::PainterShaderRegistrarGLSL::data_store_backing_t m_data_store_backing;
   unsigned int m_data_store_binding_point;
@@ -172,6 +196,11 @@ public:
                     unsigned int data_store_written,
                     const painter_vao &vao);
 
+  /* upload the commands to the buffer painter_vao::indirect_bo() */
+  void
+  upload_indirect_commands(c_array<const draw_elements_indirect_command> commands,
+                           const painter_vao &vao);
+
 private:
   GLuint
   generate_tbo(GLuint src_buffer, GLenum fmt, unsigned int unit);
@@ -190,6 +219,7 @@ private:
   enum tex_buffer_support_t m_tex_buffer_support;
   unsigned int m_data_store_binding;
   bool m_assume_single_gl_context;
+  bool m_use_indirect_draw;
   enum PainterEngineGL::buffer_streaming_type_t m_buffer_streaming_type;
 
   unsigned int m_current_pool;
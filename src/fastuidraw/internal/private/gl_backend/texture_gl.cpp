@@ -462,3 +462,170 @@ clear_texture_2d(GLuint texture, GLint level, enum texture_type_t type,
   fastuidraw_glBindFramebuffer(GL_DRAW_FRAMEBUFFER, old_fbo);
   fastuidraw_glDeleteFramebuffers(1, &fbo);
 }
+
+////////////////////////////////
+// PixelUnpackStaging methods
+fastuidraw::gl::detail::PixelUnpackStaging::
+PixelUnpackStaging(void):
+  m_current(0),
+  m_mapped(false)
+{}
+
+fastuidraw::gl::detail::PixelUnpackStaging::
+~PixelUnpackStaging()
+{
+  for (Buffer &B : m_buffers)
+    {
+      if (B.m_fence)
+        {
+          fastuidraw_glDeleteSync(B.m_fence);
+        }
+      fastuidraw_glDeleteBuffers(1, &B.m_bo);
+    }
+}
+
+bool
+fastuidraw::gl::detail::PixelUnpackStaging::
+buffer_ready(Buffer &B)
+{
+  GLenum status;
+
+  if (!B.m_fence)
+    {
+      return true;
+    }
+
+  status = fastuidraw_glClientWaitSync(B.m_fence, 0, 0);
+  if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+    {
+      fastuidraw_glDeleteSync(B.m_fence);
+      B.m_fence = nullptr;
+      return true;
+    }
+
+  return false;
+}
+
+uint8_t*
+fastuidraw::gl::detail::PixelUnpackStaging::
+begin_upload(unsigned int size)
+{
+  #ifdef __EMSCRIPTEN__
+    {
+      /* WebGL2 does not have buffer mapping */
+      FASTUIDRAWunused(size);
+      return nullptr;
+    }
+  #else
+    {
+      Buffer *B(nullptr);
+      void *ptr;
+
+      FASTUIDRAWassert(!m_mapped);
+      FASTUIDRAWassert(size > 0);
+
+      /* look for a buffer whose uploads have completed,
+       * starting with the oldest.
+       */
+      for (unsigned int i = 1, endi = m_buffers.size(); i <= endi && !B; ++i)
+        {
+          unsigned int idx;
+
+          idx = (m_current + i) % endi;
+          if (buffer_ready(m_buffers[idx]))
+            {
+              B = &m_buffers[idx];
+              m_current = idx;
+            }
+        }
+
+      if (!B && m_buffers.size() < max_number_buffers)
+        {
+          m_buffers.push_back(Buffer());
+          m_current = m_buffers.size() - 1;
+          B = &m_buffers.back();
+          fastuidraw_glGenBuffers(1, &B->m_bo);
+        }
+
+      if (!B)
+        {
+          GLenum status;
+
+          /* all buffers are in flight, wait on the oldest */
+          m_current = (m_current + 1) % m_buffers.size();
+          B = &m_buffers[m_current];
+          FASTUIDRAWassert(B->m_fence);
+          do
+            {
+              status = fastuidraw_glClientWaitSync(B->m_fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                                   1000000000u);
+            }
+          while (status == GL_TIMEOUT_EXPIRED);
+
+          fastuidraw_glDeleteSync(B->m_fence);
+          B->m_fence = nullptr;
+        }
+
+      fastuidraw_glBindBuffer(GL_PIXEL_UNPACK_BUFFER, B->m_bo);
+
+      /* (re)allocate the backing store if it is too small or if
+       * it is much larger than needed, so that a single large
+       * upload does not keep a large buffer alive forever.
+       */
+      if (B->m_size < size || (B->m_size > 4u * size && B->m_size > (1u << 20u)))
+        {
+          B->m_size = size;
+          fastuidraw_glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        }
+
+      /* the buffer is not in use by the GPU, so the mapping
+       * can be unsynchronized.
+       */
+      ptr = fastuidraw_glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                        GL_MAP_WRITE_BIT
+                                        | GL_MAP_INVALIDATE_RANGE_BIT
+                                        | GL_MAP_UNSYNCHRONIZED_BIT);
+      if (!ptr)
+        {
+          fastuidraw_glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+          return nullptr;
+        }
+
+      m_mapped = true;
+      return static_cast<uint8_t*>(ptr);
+    }
+  #endif
+}
+
+void
+fastuidraw::gl::detail::PixelUnpackStaging::
+end_writes(void)
+{
+  #ifndef __EMSCRIPTEN__
+    {
+      if (m_mapped)
+        {
+          fastuidraw_glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+    }
+  #endif
+}
+
+void
+fastuidraw::gl::detail::PixelUnpackStaging::
+end_upload(void)
+{
+  #ifndef __EMSCRIPTEN__
+    {
+      if (m_mapped)
+        {
+          Buffer &B(m_buffers[m_current]);
+
+          FASTUIDRAWassert(!B.m_fence);
+          B.m_fence = fastuidraw_glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+          fastuidraw_glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+          m_mapped = false;
+        }
+    }
+  #endif
+}
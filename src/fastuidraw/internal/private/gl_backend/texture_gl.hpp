@@ -20,7 +20,6 @@
 #ifndef FASTUIDRAW_TEXTURE_GL_HPP
 #define FASTUIDRAW_TEXTURE_GL_HPP
 
-#include <list>
 #include <vector>
 #include <algorithm>
 
@@ -30,6 +29,7 @@
 #include <fastuidraw/gl_backend/ngl_header.hpp>
 #include <fastuidraw/gl_backend/gl_context_properties.hpp>
 
+#include <private/util_private.hpp>
 #include <private/gl_backend/scratch_renderer.hpp>
 
 namespace fastuidraw { namespace gl { namespace detail {
@@ -336,17 +336,117 @@ template<size_t N>
 class EntryLocationN
 {
 public:
-  typedef std::pair<EntryLocationN, std::vector<uint8_t> > with_data;
-
   EntryLocationN(void):
     m_mipmap_level(0u)
   {}
 
+  /* Returns the number of texels of the region. */
+  unsigned int
+  number_texels(void) const
+  {
+    unsigned int return_value(1);
+    for (unsigned int i = 0; i < N; ++i)
+      {
+        return_value *= m_size[i];
+      }
+    return return_value;
+  }
+
+  /* Returns true if the region of this is directly
+   * followed along the x-axis by the region of rhs,
+   * i.e. the union of the two regions is a box and
+   * can be uploaded with a single call.
+   */
+  bool
+  followed_by(const EntryLocationN &rhs) const
+  {
+    if (m_mipmap_level != rhs.m_mipmap_level
+        || m_location[0] + m_size[0] != rhs.m_location[0])
+      {
+        return false;
+      }
+
+    for (unsigned int i = 1; i < N; ++i)
+      {
+        if (m_location[i] != rhs.m_location[i]
+            || m_size[i] != rhs.m_size[i])
+          {
+            return false;
+          }
+      }
+    return true;
+  }
+
   vecN<int, N> m_location;
   vecN<GLsizei, N> m_size;
   unsigned int m_mipmap_level;
 };
 
+/* A small ring of GL_PIXEL_UNPACK_BUFFER objects from which
+ * TextureGLGeneric::flush() sources its texel uploads. After the
+ * uploads from a buffer are issued, a fence is placed and the
+ * buffer is only written to again once that fence has signaled,
+ * so that writing the texel data never waits on the GPU and
+ * the GL implementation does not need to copy the texel data
+ * when the upload calls are made.
+ */
+class PixelUnpackStaging:noncopyable
+{
+public:
+  PixelUnpackStaging(void);
+  ~PixelUnpackStaging();
+
+  /* Bind a buffer of at least size bytes to GL_PIXEL_UNPACK_BUFFER
+   * and return a pointer to which to write the texel data; the
+   * uploads then take as pixel pointer the byte offset into the
+   * buffer. Returns nullptr if buffer objects cannot be used
+   * for staging, in which case nothing is bound.
+   */
+  uint8_t*
+  begin_upload(unsigned int size);
+
+  /* To be called after the texel data is written and before the
+   * upload calls are made; unmaps the buffer.
+   */
+  void
+  end_writes(void);
+
+  /* To be called after the upload calls are made; places a fence
+   * for the buffer and unbinds it from GL_PIXEL_UNPACK_BUFFER.
+   */
+  void
+  end_upload(void);
+
+private:
+  enum
+    {
+      /* maximum number of buffers in the ring */
+      max_number_buffers = 4
+    };
+
+  class Buffer
+  {
+  public:
+    Buffer(void):
+      m_bo(0),
+      m_size(0),
+      m_fence(nullptr)
+    {}
+
+    GLuint m_bo;
+    unsigned int m_size;
+    GLsync m_fence;
+  };
+
+  static
+  bool
+  buffer_ready(Buffer &B);
+
+  std::vector<Buffer> m_buffers;
+  unsigned int m_current;
+  bool m_mapped;
+};
+
 class UseTexStorage
 {
 public:
@@ -400,6 +500,16 @@ public:
   set_data_c_array(const EntryLocation &loc,
                    c_array<const uint8_t> data);
 
+  /* Copy a region of a mipmap level of the texture to another
+   * (non-overlapping) region of the same mipmap level; the copy
+   * is not delayed, it first flushes so that the copy sees the
+   * data of all previous calls to set_data_vector(),
+   * set_data_c_array() and resize().
+   */
+  void
+  copy_data(int mipmap_level, vecN<int, N> src, vecN<int, N> dst,
+            vecN<int, N> size);
+
   void
   resize(vecN<int, N> new_dims)
   {
@@ -420,6 +530,65 @@ public:
 
 private:
 
+  /* An upload requested by set_data_vector() or set_data_c_array()
+   * for a delayed texture; the texel data is stored in m_staging.
+   */
+  class PendingUpload
+  {
+  public:
+    EntryLocation m_loc;
+    unsigned int m_offset, m_bytes;
+  };
+
+  /* A run [m_begin, m_end) of m_upload_order whose uploads
+   * are uploaded with a single call; the merged texel data
+   * is at m_offset bytes into the upload buffer.
+   */
+  class MergedUpload
+  {
+  public:
+    EntryLocation m_loc;
+    unsigned int m_begin, m_end;
+    unsigned int m_offset;
+  };
+
+  /* Orders the indices of PendingUpload values so that those
+   * that can merge are next to each other: by mipmap level,
+   * then by the location and size along each axis except the
+   * x-axis (i.e. by layer, then by row) and last by location
+   * along the x-axis.
+   */
+  class UploadOrder
+  {
+  public:
+    explicit
+    UploadOrder(const std::vector<PendingUpload> &uploads):
+      m_uploads(uploads)
+    {}
+
+    bool
+    operator()(unsigned int lhs, unsigned int rhs) const
+    {
+      return compare(m_uploads[lhs].m_loc, m_uploads[rhs].m_loc, true) < 0;
+    }
+
+    static
+    int
+    compare(const EntryLocation &a, const EntryLocation &b, bool include_x);
+
+  private:
+    const std::vector<PendingUpload> &m_uploads;
+  };
+
+  enum
+    {
+      /* after a flush, the staging vectors are released
+       * if their capacity exceeds this many bytes so that
+       * a single large upload does not keep its memory.
+       */
+      max_retained_staging_bytes = 1024u * 1024u
+    };
+
   void
   create_texture(void) const;
 
@@ -430,6 +599,22 @@ private:
   void
   flush_size_change(void);
 
+  void
+  add_pending_upload(const EntryLocation &loc,
+                     c_array<const uint8_t> data);
+
+  void
+  compute_merged_uploads(void);
+
+  bool
+  ordered_uploads_disjoint(void) const;
+
+  void
+  release_staging(void);
+
+  void
+  write_merged_upload(const MergedUpload &M, uint8_t *dst) const;
+
   GLenum m_internal_format;
   GLenum m_external_format;
   GLenum m_external_type;
@@ -445,10 +630,16 @@ private:
   mutable int m_number_times_create_texture_called;
   CopyImageSubData m_blitter;
 
-  typedef typename EntryLocation::with_data with_data;
-  typedef std::list<with_data> list_type;
-
-  list_type m_unflushed_commands;
+  /* the texel data of the uploads is packed into m_staging;
+   * the vectors are cleared (but keep their capacity unless
+   * it is large) on flush() so that they are reused.
+   */
+  std::vector<PendingUpload> m_unflushed_commands;
+  std::vector<uint8_t> m_staging;
+  std::vector<unsigned int> m_upload_order;
+  std::vector<MergedUpload> m_merged_uploads;
+  std::vector<uint8_t> m_client_upload;
+  PixelUnpackStaging m_pixel_unpack_staging;
 };
 
 ///////////////////////////////////////
@@ -490,6 +681,41 @@ TextureGLGeneric<texture_target>::
     }
 }
 
+template<GLenum texture_target>
+void
+TextureGLGeneric<texture_target>::
+copy_data(int mipmap_level, vecN<int, N> src, vecN<int, N> dst,
+          vecN<int, N> size)
+{
+  vecN<GLint, 3> src3(0, 0, 0), dst3(0, 0, 0), size3(1, 1, 1);
+
+  flush();
+  for(unsigned int i = 0; i < N; ++i)
+    {
+      src3[i] = src[i];
+      dst3[i] = dst[i];
+      size3[i] = size[i];
+    }
+
+  #ifdef GL_TEXTURE_1D_ARRAY
+    {
+      /* see flush_size_change() */
+      if (texture_target == GL_TEXTURE_1D_ARRAY)
+        {
+          std::swap(src3[1], src3[2]);
+          std::swap(dst3[1], dst3[2]);
+          std::swap(size3[1], size3[2]);
+        }
+    }
+  #endif
+
+  m_blitter(m_texture, texture_target, mipmap_level,
+            src3[0], src3[1], src3[2],
+            m_texture, texture_target, mipmap_level,
+            dst3[0], dst3[1], dst3[2],
+            size3[0], size3[1], size3[2]);
+}
+
 template<GLenum texture_target>
 void
 TextureGLGeneric<texture_target>::
@@ -511,41 +737,52 @@ flush_size_change(void)
           m_texture = 0;
           create_texture();
 
-          /* copy the contents of old_texture to m_texture
+          /* copy the contents of old_texture to m_texture,
+           * every mipmap level
            */
-          vecN<GLint, 3> blit_dims;
+          vecN<GLsizei, N> level_dims;
           for(unsigned int i = 0; i < N; ++i)
             {
-              blit_dims[i] = std::min(m_dims[i], m_texture_dimension[i]);
-            }
-          for(unsigned int i = N; i < 3; ++i)
-            {
-              blit_dims[i] = 1;
+              level_dims[i] = std::min(m_dims[i], m_texture_dimension[i]);
             }
 
-          #ifdef GL_TEXTURE_1D_ARRAY
+          for(unsigned int level = 0; level < m_num_mipmaps; ++level)
             {
-              /* Sighs. The GL API is utterly wonky. For GL_TEXTURE_1D_ARRAY,
-               * we need to permute [2] and [1].
-               * "Slices of a TEXTURE_1D_ARRAY, TEXTURE_2D_ARRAY, TEXTURE_CUBE_MAP_ARRAY
-               * TEXTURE_3D and faces of TEXTURE_CUBE_MAP are all compatible provided
-               * they share a compatible internal format, and multiple slices or faces
-               * may be copied between these objects with a single call by specifying the
-               * starting slice with <srcZ> and <dstZ>, and the number of slices to
-               * be copied with <srcDepth>.
-               */
-              if (texture_target == GL_TEXTURE_1D_ARRAY)
+              vecN<GLint, 3> blit_dims;
+              for(unsigned int i = 0; i < N; ++i)
                 {
-                  std::swap(blit_dims[1], blit_dims[2]);
+                  blit_dims[i] = level_dims[i];
+                }
+              for(unsigned int i = N; i < 3; ++i)
+                {
+                  blit_dims[i] = 1;
                 }
-            }
-          #endif
 
-          m_blitter(old_texture, texture_target, 0,
-                    0, 0, 0, //src
-                    m_texture, texture_target, 0,
-                    0, 0, 0, //dst
-                    blit_dims[0], blit_dims[1], blit_dims[2]);
+              #ifdef GL_TEXTURE_1D_ARRAY
+                {
+                  /* Sighs. The GL API is utterly wonky. For GL_TEXTURE_1D_ARRAY,
+                   * we need to permute [2] and [1].
+                   * "Slices of a TEXTURE_1D_ARRAY, TEXTURE_2D_ARRAY, TEXTURE_CUBE_MAP_ARRAY
+                   * TEXTURE_3D and faces of TEXTURE_CUBE_MAP are all compatible provided
+                   * they share a compatible internal format, and multiple slices or faces
+                   * may be copied between these objects with a single call by specifying the
+                   * starting slice with <srcZ> and <dstZ>, and the number of slices to
+                   * be copied with <srcDepth>.
+                   */
+                  if (texture_target == GL_TEXTURE_1D_ARRAY)
+                    {
+                      std::swap(blit_dims[1], blit_dims[2]);
+                    }
+                }
+              #endif
+
+              m_blitter(old_texture, texture_target, level,
+                        0, 0, 0, //src
+                        m_texture, texture_target, level,
+                        0, 0, 0, //dst
+                        blit_dims[0], blit_dims[1], blit_dims[2]);
+              level_dims = TextureTargetDimension<texture_target>::next_lod_size(level_dims);
+            }
 
           /* now delete old_texture
            */
@@ -612,53 +849,298 @@ flush(void)
 
   if (!m_unflushed_commands.empty())
     {
+      uint8_t *dst;
+      const uint8_t *src_base;
+
+      /* the merged uploads take the same total space as
+       * the uploads they are made from.
+       */
+
+      compute_merged_uploads();
+      dst = m_pixel_unpack_staging.begin_upload(m_staging.size());
+      if (dst)
+        {
+          /* sourcing from a buffer object, the pixel
+           * pointer is an offset into the buffer.
+           */
+          src_base = nullptr;
+        }
+      else
+        {
+          m_client_upload.resize(m_staging.size());
+          dst = &m_client_upload[0];
+          src_base = dst;
+        }
+
+      for (const MergedUpload &M : m_merged_uploads)
+        {
+          write_merged_upload(M, dst + M.m_offset);
+        }
+      m_pixel_unpack_staging.end_writes();
+
       fastuidraw_glBindTexture(texture_target, m_texture);
       fastuidraw_glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-      for(const auto &cmd : m_unflushed_commands)
+      for (const MergedUpload &M : m_merged_uploads)
         {
-          FASTUIDRAWassert(!cmd.second.empty());
-          tex_sub_image<texture_target>(cmd.first.m_mipmap_level,
-                                        cmd.first.m_location,
-                                        cmd.first.m_size,
+          tex_sub_image<texture_target>(M.m_loc.m_mipmap_level,
+                                        M.m_loc.m_location,
+                                        M.m_loc.m_size,
                                         m_external_format, m_external_type,
-                                        &cmd.second[0]);
+                                        src_base + M.m_offset);
         }
+      m_pixel_unpack_staging.end_upload();
+
       m_unflushed_commands.clear();
+      m_upload_order.clear();
+      m_merged_uploads.clear();
+      m_staging.clear();
+      release_staging();
     }
 }
 
+template<GLenum texture_target>
+void
+TextureGLGeneric<texture_target>::
+release_staging(void)
+{
+  if (m_staging.capacity() > max_retained_staging_bytes)
+    {
+      std::vector<uint8_t>().swap(m_staging);
+    }
+
+  if (m_client_upload.capacity() > max_retained_staging_bytes)
+    {
+      std::vector<uint8_t>().swap(m_client_upload);
+    }
+}
+
+template<GLenum texture_target>
+int
+TextureGLGeneric<texture_target>::UploadOrder::
+compare(const EntryLocation &a, const EntryLocation &b, bool include_x)
+{
+  if (a.m_mipmap_level != b.m_mipmap_level)
+    {
+      return (a.m_mipmap_level < b.m_mipmap_level) ? -1 : 1;
+    }
+
+  for (unsigned int i = N - 1; i > 0; --i)
+    {
+      if (a.m_location[i] != b.m_location[i])
+        {
+          return (a.m_location[i] < b.m_location[i]) ? -1 : 1;
+        }
+
+      if (a.m_size[i] != b.m_size[i])
+        {
+          return (a.m_size[i] < b.m_size[i]) ? -1 : 1;
+        }
+    }
+
+  if (include_x && a.m_location[0] != b.m_location[0])
+    {
+      return (a.m_location[0] < b.m_location[0]) ? -1 : 1;
+    }
+
+  return 0;
+}
+
+template<GLenum texture_target>
+bool
+TextureGLGeneric<texture_target>::
+ordered_uploads_disjoint(void) const
+{
+  /* m_upload_order is sorted by UploadOrder; call the uploads
+   * that only differ in their x-range a band. Uploads of the
+   * same band overlap exactly when their x-ranges overlap,
+   * which in sorted order shows up between neighbours. The
+   * bands of a mipmap level are sorted by their location along
+   * the last axis, so a band can only intersect the bands that
+   * follow it until one starts past its end along that axis.
+   */
+  std::vector<unsigned int> bands;
+  for (unsigned int i = 0, endi = m_upload_order.size(); i < endi; ++i)
+    {
+      const EntryLocation &loc(m_unflushed_commands[m_upload_order[i]].m_loc);
+
+      if (i != 0)
+        {
+          const EntryLocation &prev(m_unflushed_commands[m_upload_order[i - 1]].m_loc);
+          if (UploadOrder::compare(prev, loc, false) == 0)
+            {
+              if (prev.m_location[0] + prev.m_size[0] > loc.m_location[0])
+                {
+                  return false;
+                }
+              continue;
+            }
+        }
+      bands.push_back(m_upload_order[i]);
+    }
+
+  for (unsigned int b = 0, endb = bands.size(); b < endb && N > 1; ++b)
+    {
+      const EntryLocation &B(m_unflushed_commands[bands[b]].m_loc);
+      for (unsigned int c = b + 1; c < endb; ++c)
+        {
+          const EntryLocation &C(m_unflushed_commands[bands[c]].m_loc);
+          bool intersect(true);
+
+          if (C.m_mipmap_level != B.m_mipmap_level
+              || C.m_location[N - 1] >= B.m_location[N - 1] + B.m_size[N - 1])
+            {
+              break;
+            }
+
+          for (unsigned int i = 1; i < N && intersect; ++i)
+            {
+              intersect = B.m_location[i] < C.m_location[i] + C.m_size[i]
+                && C.m_location[i] < B.m_location[i] + B.m_size[i];
+            }
+
+          if (intersect)
+            {
+              return false;
+            }
+        }
+    }
+
+  return true;
+}
 
 template<GLenum texture_target>
 void
 TextureGLGeneric<texture_target>::
-set_data_vector(const EntryLocation &loc,
-                std::vector<uint8_t> &data)
+compute_merged_uploads(void)
 {
-  if (data.empty())
+  unsigned int offset(0);
+
+  /* bucket the uploads by mipmap level, layer and row so that
+   * uploads that abut along the x-axis become neighbours even
+   * if they were not requested one after the other. If any two
+   * uploads overlap, the order in which they are made matters,
+   * so then the uploads keep the order in which they were
+   * requested and only consecutive uploads are merged.
+   */
+  m_upload_order.resize(m_unflushed_commands.size());
+  for (unsigned int i = 0, endi = m_upload_order.size(); i < endi; ++i)
+    {
+      m_upload_order[i] = i;
+    }
+
+  std::stable_sort(m_upload_order.begin(), m_upload_order.end(),
+                   UploadOrder(m_unflushed_commands));
+  if (!ordered_uploads_disjoint())
     {
+      for (unsigned int i = 0, endi = m_upload_order.size(); i < endi; ++i)
+        {
+          m_upload_order[i] = i;
+        }
+    }
+
+  m_merged_uploads.clear();
+  for (unsigned int i = 0, endi = m_upload_order.size(); i < endi; ++i)
+    {
+      const PendingUpload &U(m_unflushed_commands[m_upload_order[i]]);
+
+      if (!m_merged_uploads.empty()
+          && m_merged_uploads.back().m_loc.followed_by(U.m_loc))
+        {
+          MergedUpload &M(m_merged_uploads.back());
+
+          M.m_loc.m_size[0] += U.m_loc.m_size[0];
+          M.m_end = i + 1;
+        }
+      else
+        {
+          MergedUpload M;
+
+          M.m_loc = U.m_loc;
+          M.m_begin = i;
+          M.m_end = i + 1;
+          M.m_offset = offset;
+          m_merged_uploads.push_back(M);
+        }
+      offset += U.m_bytes;
+    }
+  FASTUIDRAWassert(offset == m_staging.size());
+}
+
+template<GLenum texture_target>
+void
+TextureGLGeneric<texture_target>::
+write_merged_upload(const MergedUpload &M, uint8_t *dst) const
+{
+  unsigned int num_rows, bytes_per_texel;
+
+  /* the uploads of M only differ in their x-range, so the
+   * merged data is for each row, the rows of each upload
+   * of M one after the other.
+   */
+  FASTUIDRAWassert(M.m_begin < M.m_end);
+  if (M.m_end == M.m_begin + 1)
+    {
+      const PendingUpload &U(m_unflushed_commands[m_upload_order[M.m_begin]]);
+      std::copy(m_staging.begin() + U.m_offset,
+                m_staging.begin() + U.m_offset + U.m_bytes,
+                dst);
       return;
     }
 
-  if (m_delayed)
+  num_rows = 1;
+  for (unsigned int i = 1; i < N; ++i)
     {
-      m_unflushed_commands.push_back(typename EntryLocation::with_data());
-      typename EntryLocation::with_data &R(m_unflushed_commands.back());
-      R.first = loc;
-      R.second.swap(data);
+      num_rows *= M.m_loc.m_size[i];
     }
-  else
+
+  bytes_per_texel = m_unflushed_commands[m_upload_order[M.m_begin]].m_bytes
+    / m_unflushed_commands[m_upload_order[M.m_begin]].m_loc.number_texels();
+
+  for (unsigned int r = 0; r < num_rows; ++r)
     {
-      flush_size_change();
-      fastuidraw_glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-      fastuidraw_glBindTexture(texture_target, m_texture);
-      tex_sub_image<texture_target>(loc.m_mipmap_level,
-                                    loc.m_location,
-                                    loc.m_size,
-                                    m_external_format, m_external_type,
-                                    &data[0]);
+      for (unsigned int k = M.m_begin; k < M.m_end; ++k)
+        {
+          const PendingUpload &U(m_unflushed_commands[m_upload_order[k]]);
+          unsigned int row_bytes;
+          const uint8_t *src;
+
+          row_bytes = bytes_per_texel * U.m_loc.m_size[0];
+          src = &m_staging[U.m_offset + r * row_bytes];
+          std::copy(src, src + row_bytes, dst);
+          dst += row_bytes;
+        }
     }
 }
 
+template<GLenum texture_target>
+void
+TextureGLGeneric<texture_target>::
+add_pending_upload(const EntryLocation &loc,
+                   c_array<const uint8_t> data)
+{
+  PendingUpload U;
+
+  FASTUIDRAWassert(loc.number_texels() > 0);
+  FASTUIDRAWassert(data.size() % loc.number_texels() == 0);
+
+  U.m_loc = loc;
+  U.m_offset = m_staging.size();
+  U.m_bytes = data.size();
+  m_staging.insert(m_staging.end(), data.begin(), data.end());
+  m_unflushed_commands.push_back(U);
+}
+
+
+template<GLenum texture_target>
+void
+TextureGLGeneric<texture_target>::
+set_data_vector(const EntryLocation &loc,
+                std::vector<uint8_t> &data)
+{
+  c_array<const uint8_t> data_array(make_c_array(data));
+  set_data_c_array(loc, data_array);
+}
+
 template<GLenum texture_target>
 void
 TextureGLGeneric<texture_target>::
@@ -672,10 +1154,7 @@ set_data_c_array(const EntryLocation &loc,
 
   if (m_delayed)
     {
-      std::vector<uint8_t> data_copy;
-      data_copy.resize(data.size());
-      std::copy(data.begin(), data.end(), data_copy.begin());
-      set_data_vector(loc, data_copy);
+      add_pending_upload(loc, data);
     }
   else
     {
@@ -987,6 +987,7 @@ create_gradient_brush_shader(enum PainterBrushEnums::gradient_type_t tp)
 
     .add_macro_u32("fastuidraw_brush_gradient_spread_type_bit0", PainterGradientBrushShader::spread_type_bit0)
     .add_macro_u32("fastuidraw_brush_gradient_spread_type_num_bits", PainterGradientBrushShader::spread_type_num_bits)
+    .add_macro_u32("fastuidraw_brush_gradient_analytic_color_stops_bit", PainterGradientBrushShader::analytic_color_stops_bit)
     .add_macro_u32("fastuidraw_brush_spread_clamp", PainterBrushEnums::spread_clamp)
     .add_macro_u32("fastuidraw_brush_spread_repeat", PainterBrushEnums::spread_repeat)
     .add_macro_u32("fastuidraw_brush_spread_mirror_repeat", PainterBrushEnums::spread_mirror_repeat)
@@ -995,7 +996,11 @@ create_gradient_brush_shader(enum PainterBrushEnums::gradient_type_t tp)
     .add_macro_u32("fastuidraw_brush_colorstop_x_bit0",     PainterGradientBrushShaderData::color_stop_x_bit0)
     .add_macro_u32("fastuidraw_brush_colorstop_x_num_bits", PainterGradientBrushShaderData::color_stop_x_num_bits)
     .add_macro_u32("fastuidraw_brush_colorstop_y_bit0",     PainterGradientBrushShaderData::color_stop_y_bit0)
-    .add_macro_u32("fastuidraw_brush_colorstop_y_num_bits", PainterGradientBrushShaderData::color_stop_y_num_bits);
+    .add_macro_u32("fastuidraw_brush_colorstop_y_num_bits", PainterGradientBrushShaderData::color_stop_y_num_bits)
+    .add_macro_u32("fastuidraw_brush_analytic_color_stop_red_bit0", PainterGradientBrushShaderData::analytic_color_stop_red_bit0)
+    .add_macro_u32("fastuidraw_brush_analytic_color_stop_green_bit0", PainterGradientBrushShaderData::analytic_color_stop_green_bit0)
+    .add_macro_u32("fastuidraw_brush_analytic_color_stop_blue_bit0", PainterGradientBrushShaderData::analytic_color_stop_blue_bit0)
+    .add_macro_u32("fastuidraw_brush_analytic_color_stop_alpha_bit0", PainterGradientBrushShaderData::analytic_color_stop_alpha_bit0);
 
   return FASTUIDRAWnew PainterBrushShaderGLSL(0, /* for the single image */
                                               ShaderSource()
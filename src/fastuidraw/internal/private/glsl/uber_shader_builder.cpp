@@ -174,6 +174,14 @@ namespace
         }
     }
 
+    void
+    stream_signature(std::ostream &str,
+                     const fastuidraw::reference_counted_ptr<const T> &sh) const
+    {
+      str << m_for_fragment_shadering << ":" << m_shareable_label << ":";
+      m_src.stream_alias_signature(str, sh->varyings(), m_datum);
+    }
+
     const fastuidraw::glsl::shareable_value_list&
     fetch_shareables(const fastuidraw::reference_counted_ptr<const T> &sh) const
     {
@@ -407,6 +415,11 @@ namespace
                        fastuidraw::c_array<const fastuidraw::reference_counted_ptr<fastuidraw::glsl::PainterBlendShaderGLSL> >) const
     {}
 
+    void
+    stream_signature(std::ostream &,
+                     const fastuidraw::reference_counted_ptr<const fastuidraw::glsl::PainterBlendShaderGLSL> &) const
+    {}
+
     void
     before_shader(fastuidraw::glsl::ShaderSource&,
                   const fastuidraw::reference_counted_ptr<const fastuidraw::glsl::PainterBlendShaderGLSL> &) const
@@ -454,6 +467,16 @@ namespace
     void
     post_source(fastuidraw::glsl::ShaderSource&) const
     {}
+
+    unsigned int
+    surround_state(void) const
+    {
+      return 0;
+    }
+
+    void
+    set_surround_state(unsigned int) const
+    {}
   };
 
   template<>
@@ -482,6 +505,18 @@ namespace
           << "#undef fastuidraw_brush_context_texture\n";
     }
 
+    unsigned int
+    surround_state(void) const
+    {
+      return m_count;
+    }
+
+    void
+    set_surround_state(unsigned int v) const
+    {
+      m_count = v;
+    }
+
   private:
     mutable unsigned int m_count;
   };
@@ -584,9 +619,20 @@ namespace
                 const std::string &uber_func_with_args,
                 const std::string &shader_args, //of the form ", arg1, arg2,..,argN" or empty string
                 const std::string &shader_id,
-                const fastuidraw::PainterShaderRegistrar &rp);
+                const fastuidraw::PainterShaderRegistrar &rp,
+                fastuidraw::glsl::detail::StreamedShaderCache *cache,
+                fastuidraw::c_string cache_tag);
 
   private:
+    static
+    void
+    stream_top_level_shader(ShaderSource &dst,
+                            get_src_type get_src, get_main_name_type get_main_name,
+                            const StreamVaryingsHelper<T> &stream_varyings_helper,
+                            const StreamSurroundSrcHelper<T> &stream_surround_src,
+                            const fastuidraw::reference_counted_ptr<const T> &shader,
+                            const fastuidraw::PainterShaderRegistrar &rp);
+
     static
     void
     stream_source(ShaderSource &dst, const std::string &prefix,
@@ -740,6 +786,32 @@ stream_dependency(ShaderSource &dst, const std::string &in_prefix, int idx,
   return nm;
 }
 
+template<typename T>
+void
+UberShaderStreamer<T>::
+stream_top_level_shader(ShaderSource &dst,
+                        get_src_type get_src, get_main_name_type get_main_name,
+                        const StreamVaryingsHelper<T> &stream_varyings_helper,
+                        const StreamSurroundSrcHelper<T> &stream_surround_src,
+                        const fastuidraw::reference_counted_ptr<const T> &sh,
+                        const fastuidraw::PainterShaderRegistrar &rp)
+{
+  std::ostringstream str;
+
+  dst << "\n/////////////////////////////////////////\n"
+      << "// Start Shader #" << sh->ID(rp) << " with "
+      << sh->number_sub_shaders() << " sub-shaers\n";
+
+  str << get_main_name(sh) << sh->ID(rp);
+  stream_varyings_helper.before_shader(dst, sh);
+  stream_shader(dst, str.str(), "",
+                get_src, get_main_name,
+                stream_varyings_helper,
+                stream_surround_src,
+                sh, 0);
+  stream_varyings_helper.after_shader(dst, sh);
+}
+
 template<typename T>
 void
 UberShaderStreamer<T>::
@@ -751,28 +823,45 @@ stream_uber(bool use_switch, ShaderSource &dst, array_type shaders,
             const std::string &uber_func_with_args,
             const std::string &shader_args, //of the form ", arg1, arg2,..,argN" or empty string
             const std::string &shader_id,
-            const fastuidraw::PainterShaderRegistrar &rp)
+            const fastuidraw::PainterShaderRegistrar &rp,
+            fastuidraw::glsl::detail::StreamedShaderCache *cache,
+            fastuidraw::c_string cache_tag)
 {
   using namespace fastuidraw;
+  using namespace fastuidraw::glsl::detail;
 
   /* first stream all of the shaders with predefined macros. */
   stream_varyings_helper.declare_shareables(dst, shaders);
   for(const auto &sh : shaders)
     {
-      std::ostringstream str;
-
-      dst << "\n/////////////////////////////////////////\n"
-          << "// Start Shader #" << sh->ID(rp) << " with "
-          << sh->number_sub_shaders() << " sub-shaers\n";
-
-      str << get_main_name(sh) << sh->ID(rp);
-      stream_varyings_helper.before_shader(dst, sh);
-      stream_shader(dst, str.str(), "",
-                    get_src, get_main_name,
-                    stream_varyings_helper,
-                    stream_surround_src,
-                    sh, 0);
-      stream_varyings_helper.after_shader(dst, sh);
+      if (cache)
+        {
+          const StreamedShaderCache::Entry *entry;
+          std::ostringstream key;
+
+          key << cache_tag << "#" << sh->ID(rp)
+              << "#" << stream_surround_src.surround_state() << "#";
+          stream_varyings_helper.stream_signature(key, sh);
+
+          entry = cache->fetch(key.str());
+          if (!entry)
+            {
+              ShaderSource src;
+
+              stream_top_level_shader(src, get_src, get_main_name,
+                                      stream_varyings_helper,
+                                      stream_surround_src, sh, rp);
+              entry = &cache->store(key.str(), src, stream_surround_src.surround_state());
+            }
+          dst.add_source(entry->m_src);
+          stream_surround_src.set_surround_state(entry->m_surround_state);
+        }
+      else
+        {
+          stream_top_level_shader(dst, get_src, get_main_name,
+                                  stream_varyings_helper,
+                                  stream_surround_src, sh, rp);
+        }
     }
 
   bool has_sub_shaders(false), has_return_value(return_type != "void");
@@ -788,109 +877,127 @@ stream_uber(bool use_switch, ShaderSource &dst, array_type shaders,
       dst << "    " << return_type << " p;\n";
     }
 
-  for(const auto &sh : shaders)
+  if (!use_switch)
     {
-      if (sh->number_sub_shaders() > 1)
+      /* a single if/else chain that tests the shaders in the
+       * order they are given; this allows a caller to place the
+       * most frequently used shaders first.
+       */
+      for(const auto &sh : shaders)
         {
-          unsigned int start, end;
+          unsigned int start;
+
           start = sh->ID(rp);
-          end = start + sh->number_sub_shaders();
-          if (has_sub_shaders)
+          dst << "    ";
+          if (!first_entry)
+            {
+              dst << "else ";
+            }
+
+          if (sh->number_sub_shaders() > 1)
             {
-              dst << "    else ";
+              dst << "if (" << shader_id << " >= uint(" << start
+                  << ") && " << shader_id << " < uint(" << start + sh->number_sub_shaders() << "))\n";
             }
           else
             {
-              dst << "    ";
+              dst << "if (" << shader_id << " == uint(" << start << "))\n";
             }
 
-          dst << "if (" << shader_id << " >= uint(" << start
-              << ") && " << shader_id << " < uint(" << end << "))\n"
-              << "    {\n"
+          dst << "    {\n"
               << "        ";
           if (has_return_value)
             {
               dst << "p = ";
             }
-          dst << get_main_name(sh) << sh->ID(rp)
-              << "(" << shader_id << " - uint(" << start << ")" << shader_args << ");\n"
-              << "    }\n";
-          has_sub_shaders = true;
+
+          dst << get_main_name(sh) << start;
+          if (sh->number_sub_shaders() > 1)
+            {
+              dst << "(" << shader_id << " - uint(" << start << ")" << shader_args << ");\n";
+            }
+          else
+            {
+              dst << "(uint(0)" << shader_args << ");\n";
+            }
+          dst << "    }\n";
           first_entry = false;
         }
     }
-
-  if (has_sub_shaders && use_switch)
-    {
-      dst << "    else\n"
-          << "    {\n";
-      tab = "        ";
-    }
   else
     {
-      tab = "    ";
-    }
+      for(const auto &sh : shaders)
+        {
+          if (sh->number_sub_shaders() > 1)
+            {
+              unsigned int start, end;
+              start = sh->ID(rp);
+              end = start + sh->number_sub_shaders();
+              if (has_sub_shaders)
+                {
+                  dst << "    else ";
+                }
+              else
+                {
+                  dst << "    ";
+                }
+
+              dst << "if (" << shader_id << " >= uint(" << start
+                  << ") && " << shader_id << " < uint(" << end << "))\n"
+                  << "    {\n"
+                  << "        ";
+              if (has_return_value)
+                {
+                  dst << "p = ";
+                }
+              dst << get_main_name(sh) << sh->ID(rp)
+                  << "(" << shader_id << " - uint(" << start << ")" << shader_args << ");\n"
+                  << "    }\n";
+              has_sub_shaders = true;
+            }
+        }
+
+      if (has_sub_shaders)
+        {
+          dst << "    else\n"
+              << "    {\n";
+          tab = "        ";
+        }
+      else
+        {
+          tab = "    ";
+        }
 
-  if (use_switch)
-    {
       dst << tab << "switch(" << shader_id << ")\n"
           << tab << "{\n";
-    }
 
-  for(const auto &sh : shaders)
-    {
-      if (sh->number_sub_shaders() == 1)
+      for(const auto &sh : shaders)
         {
-          if (use_switch)
+          if (sh->number_sub_shaders() == 1)
             {
               dst << tab << "case uint(" << sh->ID(rp) << "):\n"
                   << tab << "    {\n"
                   << tab << "        ";
-            }
-          else
-            {
-              if (!first_entry)
-                {
-                  dst << tab << "else if";
-                }
-              else
+
+              if (has_return_value)
                 {
-                  dst << tab << "if";
+                  dst << "p = ";
                 }
-              dst << "(" << shader_id << " == uint(" << sh->ID(rp) << "))\n"
-                  << tab << "{\n"
-                  << tab << "    ";
-            }
 
-          if (has_return_value)
-            {
-              dst << "p = ";
-            }
-
-          dst << get_main_name(sh) << sh->ID(rp)
-              << "(uint(0)" << shader_args << ");\n";
+              dst << get_main_name(sh) << sh->ID(rp)
+                  << "(uint(0)" << shader_args << ");\n";
 
-          if (use_switch)
-            {
               dst << tab << "    }\n"
                   << tab << "    break;\n\n";
             }
-          else
-            {
-              dst << tab << "}\n";
-            }
-          first_entry = false;
         }
-    }
 
-  if (use_switch)
-    {
       dst << tab << "}\n";
-    }
 
-  if (has_sub_shaders && use_switch)
-    {
-      dst << "    }\n";
+      if (has_sub_shaders)
+        {
+          dst << "    }\n";
+        }
     }
 
   if (has_return_value)
@@ -1182,6 +1289,38 @@ stream_alias_varyings_impl(bool use_rw_copies,
     }
 }
 
+void
+UberShaderVaryings::
+stream_alias_signature(std::ostream &str, const varying_list &p,
+                       const AliasVaryingLocation &datum) const
+{
+  str << datum.m_label;
+  for (unsigned int i = 0; i < varying_list::interpolator_number_types; ++i)
+    {
+      enum varying_list::interpolator_type_t q;
+      uvec2 start(datum.m_varying_start[i]);
+
+      /* the aliases are determined by the start location and
+       * the number of components of each varying aliased to.
+       */
+      q = static_cast<enum varying_list::interpolator_type_t>(i);
+      str << "|" << start.x() << "," << start.y() << ":";
+      for (unsigned int c = 0, endc = p.varyings(q).size(); c < endc; ++c, ++start.y())
+        {
+          if (start.y() == 4)
+            {
+              ++start.x();
+              start.y() = 0;
+            }
+
+          if ((c == 0 || start.y() == 0) && start.x() < m_varyings[i].size())
+            {
+              str << m_varyings[i][start.x()].m_num_components;
+            }
+        }
+    }
+}
+
 void
 UberShaderVaryings::
 stream_alias_varyings(bool use_rw_copies,
@@ -1238,6 +1377,41 @@ stream_alias_varyings(bool use_rw_copies,
     }
 }
 
+///////////////////////////////////
+// StreamedShaderCache methods
+const StreamedShaderCache::Entry*
+StreamedShaderCache::
+fetch(const std::string &key) const
+{
+  std::lock_guard<std::mutex> m(m_mutex);
+  std::map<std::string, Entry>::const_iterator iter;
+
+  iter = m_entries.find(key);
+  return (iter != m_entries.end()) ?
+    &iter->second :
+    nullptr;
+}
+
+const StreamedShaderCache::Entry&
+StreamedShaderCache::
+store(const std::string &key, const ShaderSource &src,
+      unsigned int surround_state)
+{
+  std::lock_guard<std::mutex> m(m_mutex);
+  std::map<std::string, Entry>::iterator iter;
+
+  iter = m_entries.find(key);
+  if (iter == m_entries.end())
+    {
+      Entry &E(m_entries[key]);
+
+      E.m_src = src;
+      E.m_surround_state = surround_state;
+      return E;
+    }
+  return iter->second;
+}
+
 /////////////////////
 // non-class methods
 void
@@ -1246,7 +1420,8 @@ stream_uber_vert_shader(bool use_switch,
                         c_array<const reference_counted_ptr<PainterItemShaderGLSL> > item_shaders,
                         const UberShaderVaryings &declare_varyings,
                         const AliasVaryingLocation &datum,
-                        const PainterShaderRegistrar &rp)
+                        const PainterShaderRegistrar &rp,
+                        StreamedShaderCache *cache)
 {
   UberShaderStreamer<PainterItemShaderGLSL>::stream_uber(use_switch, vert, item_shaders,
                                                          &PainterItemShaderGLSL::vertex_src,
@@ -1259,7 +1434,7 @@ stream_uber_vert_shader(bool use_switch,
                                                          ", fastuidraw_attribute0, fastuidraw_attribute1, "
                                                          "fastuidraw_attribute2, h.item_shader_data_location, add_z, brush_p, clip_p",
                                                          "h.item_shader",
-                                                         rp);
+                                                         rp, cache, "item_vert");
 }
 
 void
@@ -1268,7 +1443,8 @@ stream_uber_frag_shader(bool use_switch,
                         c_array<const reference_counted_ptr<PainterItemShaderGLSL> > item_shaders,
                         const UberShaderVaryings &declare_varyings,
                         const AliasVaryingLocation &datum,
-                        const PainterShaderRegistrar &rp)
+                        const PainterShaderRegistrar &rp,
+                        StreamedShaderCache *cache)
 {
   UberShaderStreamer<PainterItemShaderGLSL>::stream_uber(use_switch, frag, item_shaders,
                                                          &PainterItemShaderGLSL::fragment_src,
@@ -1280,7 +1456,7 @@ stream_uber_frag_shader(bool use_switch,
                                                          "fastuidraw_run_frag_shader(in uint frag_shader, in uint frag_shader_data_location)",
                                                          ", frag_shader_data_location",
                                                          "frag_shader",
-                                                         rp);
+                                                         rp, cache, "item_frag");
 }
 
 void
@@ -1289,7 +1465,8 @@ stream_uber_vert_shader(bool use_switch,
                         c_array<const reference_counted_ptr<PainterItemCoverageShaderGLSL> > item_shaders,
                         const UberShaderVaryings &declare_varyings,
                         const AliasVaryingLocation &datum,
-                        const PainterShaderRegistrar &rp)
+                        const PainterShaderRegistrar &rp,
+                        StreamedShaderCache *cache)
 {
   UberShaderStreamer<PainterItemCoverageShaderGLSL>::stream_uber(use_switch, vert, item_shaders,
                                                                  &PainterItemCoverageShaderGLSL::vertex_src,
@@ -1302,7 +1479,7 @@ stream_uber_vert_shader(bool use_switch,
                                                                  ", fastuidraw_attribute0, fastuidraw_attribute1, "
                                                                  "fastuidraw_attribute2, h.item_shader_data_location, clip_p",
                                                                  "h.item_shader",
-                                                                 rp);
+                                                                 rp, cache, "coverage_vert");
 }
 
 void
@@ -1311,7 +1488,8 @@ stream_uber_frag_shader(bool use_switch,
                         c_array<const reference_counted_ptr<PainterItemCoverageShaderGLSL> > item_shaders,
                         const UberShaderVaryings &declare_varyings,
                         const AliasVaryingLocation &datum,
-                        const PainterShaderRegistrar &rp)
+                        const PainterShaderRegistrar &rp,
+                        StreamedShaderCache *cache)
 {
   UberShaderStreamer<PainterItemCoverageShaderGLSL>::stream_uber(use_switch, frag, item_shaders,
                                                                  &PainterItemCoverageShaderGLSL::fragment_src,
@@ -1323,7 +1501,7 @@ stream_uber_frag_shader(bool use_switch,
                                                                  "fastuidraw_run_frag_shader(in uint frag_shader, in uint frag_shader_data_location)",
                                                                  ", frag_shader_data_location",
                                                                  "frag_shader",
-                                                                 rp);
+                                                                 rp, cache, "coverage_frag");
 }
 
 void
@@ -1331,7 +1509,8 @@ stream_uber_blend_shader(bool use_switch,
                          ShaderSource &frag,
                          c_array<const reference_counted_ptr<PainterBlendShaderGLSL> > shaders,
                          enum PainterBlendShader::shader_type tp,
-                         const PainterShaderRegistrar &rp)
+                         const PainterShaderRegistrar &rp,
+                         StreamedShaderCache *cache)
 {
   std::string sub_func_args, func_name;
 
@@ -1375,7 +1554,7 @@ stream_uber_blend_shader(bool use_switch,
                                                           StreamVaryingsHelper<PainterBlendShaderGLSL>(),
                                                           StreamSurroundSrcHelper<PainterBlendShaderGLSL>(),
                                                           "void", func_name,
-                                                          sub_func_args, "blend_shader", rp);
+                                                          sub_func_args, "blend_shader", rp, cache, "blend");
 }
 
 void
@@ -1384,7 +1563,8 @@ stream_uber_brush_vert_shader(bool use_switch,
                               c_array<const reference_counted_ptr<PainterBrushShaderGLSL> > brush_shaders,
                               const UberShaderVaryings &declare_varyings,
                               const AliasVaryingLocation &datum,
-                              const PainterShaderRegistrar &rp)
+                              const PainterShaderRegistrar &rp,
+                              StreamedShaderCache *cache)
 {
   UberShaderStreamer<PainterBrushShaderGLSL>::stream_uber(use_switch, vert, brush_shaders,
                                                           &PainterBrushShaderGLSL::vertex_src,
@@ -1396,7 +1576,7 @@ stream_uber_brush_vert_shader(bool use_switch,
                                                           "fastuidraw_run_brush_vert_shader(in fastuidraw_header h, in vec2 brush_p)",
                                                           ", h.brush_shader_data_location, brush_p",
                                                           "h.brush_shader",
-                                                          rp);
+                                                          rp, cache, "brush_vert");
 }
 
 void
@@ -1405,7 +1585,8 @@ stream_uber_brush_frag_shader(bool use_switch,
                               c_array<const reference_counted_ptr<PainterBrushShaderGLSL> > brush_shaders,
                               const UberShaderVaryings &declare_varyings,
                               const AliasVaryingLocation &datum,
-                              const PainterShaderRegistrar &rp)
+                              const PainterShaderRegistrar &rp,
+                              StreamedShaderCache *cache)
 {
   UberShaderStreamer<PainterBrushShaderGLSL>::stream_uber(use_switch, frag, brush_shaders,
                                                           &PainterBrushShaderGLSL::fragment_src,
@@ -1417,7 +1598,7 @@ stream_uber_brush_frag_shader(bool use_switch,
                                                           "fastuidraw_run_brush_frag_shader(in uint frag_shader, in uint frag_shader_data_location)",
                                                           ", frag_shader_data_location",
                                                           "frag_shader",
-                                                          rp);
+                                                          rp, cache, "brush_frag");
 }
 
 }}}
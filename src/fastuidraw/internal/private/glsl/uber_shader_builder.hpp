@@ -21,6 +21,8 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <mutex>
 #include <fastuidraw/util/vecN.hpp>
 #include <fastuidraw/util/c_array.hpp>
 #include <fastuidraw/util/util.hpp>
@@ -123,6 +125,14 @@ public:
                         bool add_aliases,
                         const AliasVaryingLocation &datum,
                         filter_varying_t filter_varying = &accept_all_varyings) const;
+
+  /* Stream to a std::ostream a string that uniquely identifies
+   * what stream_alias_varyings() streams for the passed varying_list
+   * and AliasVaryingLocation (not counting the varying_list names).
+   */
+  void
+  stream_alias_signature(std::ostream &str, const varying_list &p,
+                         const AliasVaryingLocation &datum) const;
 private:
   class per_varying
   {
@@ -164,53 +174,101 @@ private:
   vecN<std::vector<per_varying>, varying_list::interpolator_number_types> m_varyings;
 };
 
+/* Caches, for each shader, the GLSL streamed by the
+ * stream_uber_*() functions for the shader and its dependencies
+ * so that constructing many uber-shaders (or single shader
+ * programs) from the same shaders streams each shader only once.
+ * An entry is keyed by the ID of the shader together with
+ * everything that changes how it is streamed, i.e. which
+ * function of the shader is streamed and where its varyings
+ * are aliased; thus entries never become stale when more shaders
+ * are registered.
+ */
+class StreamedShaderCache:fastuidraw::noncopyable
+{
+public:
+  class Entry
+  {
+  public:
+    /* the streamed source of the shader */
+    ShaderSource m_src;
+
+    /* state of the StreamSurroundSrcHelper after
+     * the shader was streamed.
+     */
+    unsigned int m_surround_state;
+  };
+
+  /* Returns nullptr if there is no entry for the key. */
+  const Entry*
+  fetch(const std::string &key) const;
+
+  /* Adds an entry, if an entry already exists with
+   * the same key, that entry is kept and returned.
+   */
+  const Entry&
+  store(const std::string &key, const ShaderSource &src,
+        unsigned int surround_state);
+
+private:
+  mutable std::mutex m_mutex;
+  std::map<std::string, Entry> m_entries;
+};
+
 void
 stream_uber_vert_shader(bool use_switch, ShaderSource &vert,
                         c_array<const reference_counted_ptr<PainterItemShaderGLSL> > item_shaders,
                         const UberShaderVaryings &declare_varyings,
                         const AliasVaryingLocation &datum,
-                        const PainterShaderRegistrar &rp);
+                        const PainterShaderRegistrar &rp,
+                        StreamedShaderCache *cache);
 
 void
 stream_uber_frag_shader(bool use_switch, ShaderSource &frag,
                         c_array<const reference_counted_ptr<PainterItemShaderGLSL> > item_shaders,
                         const UberShaderVaryings &declare_varyings,
                         const AliasVaryingLocation &datum,
-                        const PainterShaderRegistrar &rp);
+                        const PainterShaderRegistrar &rp,
+                        StreamedShaderCache *cache);
 
 void
 stream_uber_vert_shader(bool use_switch, ShaderSource &vert,
                         c_array<const reference_counted_ptr<PainterItemCoverageShaderGLSL> > item_shaders,
                         const UberShaderVaryings &declare_varyings,
                         const AliasVaryingLocation &datum,
-                        const PainterShaderRegistrar &rp);
+                        const PainterShaderRegistrar &rp,
+                        StreamedShaderCache *cache);
 
 void
 stream_uber_frag_shader(bool use_switch, ShaderSource &frag,
                         c_array<const reference_counted_ptr<PainterItemCoverageShaderGLSL> > item_shaders,
                         const UberShaderVaryings &declare_varyings,
                         const AliasVaryingLocation &datum,
-                        const PainterShaderRegistrar &rp);
+                        const PainterShaderRegistrar &rp,
+                        StreamedShaderCache *cache);
 
 void
 stream_uber_brush_vert_shader(bool use_switch, ShaderSource &vert,
                               c_array<const reference_counted_ptr<PainterBrushShaderGLSL> > brush_shaders,
                               const UberShaderVaryings &declare_varyings,
                               const AliasVaryingLocation &datum,
-                              const PainterShaderRegistrar &rp);
+                              const PainterShaderRegistrar &rp,
+                              StreamedShaderCache *cache);
 
 void
 stream_uber_brush_frag_shader(bool use_switch, ShaderSource &frag,
                               c_array<const reference_counted_ptr<PainterBrushShaderGLSL> > brush_shaders,
                               const UberShaderVaryings &declare_varyings,
                               const AliasVaryingLocation &datum,
-                              const PainterShaderRegistrar &rp);
+                              const PainterShaderRegistrar &rp,
+                              StreamedShaderCache *cache);
 
 void
 stream_uber_blend_shader(bool use_switch, ShaderSource &frag,
                          c_array<const reference_counted_ptr<PainterBlendShaderGLSL> > blend_shaders,
                          enum PainterBlendShader::shader_type tp,
-                         const PainterShaderRegistrar &rp);
+                         const PainterShaderRegistrar &rp,
+                         StreamedShaderCache *cache);
 
 
 }}}
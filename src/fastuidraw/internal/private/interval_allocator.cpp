@@ -22,6 +22,45 @@
 #include <fastuidraw/util/math.hpp>
 #include <private/interval_allocator.hpp>
 
+namespace
+{
+#if defined(__GNUC__)
+  /* index of the highest bit up of a non-zero value */
+  inline
+  int
+  highest_bit(uint32_t v)
+  {
+    FASTUIDRAWassert(v != 0u);
+    return 31 - __builtin_clz(v);
+  }
+
+  /* index of the lowest bit up of a non-zero value */
+  inline
+  int
+  lowest_bit(uint32_t v)
+  {
+    FASTUIDRAWassert(v != 0u);
+    return __builtin_ctz(v);
+  }
+#else
+  inline
+  int
+  highest_bit(uint32_t v)
+  {
+    FASTUIDRAWassert(v != 0u);
+    return fastuidraw::uint32_log2(v);
+  }
+
+  inline
+  int
+  lowest_bit(uint32_t v)
+  {
+    FASTUIDRAWassert(v != 0u);
+    return fastuidraw::uint32_log2(v & (~v + 1u));
+  }
+#endif
+}
+
 fastuidraw::interval_allocator::
 interval_allocator(int size)
 {
@@ -35,8 +74,21 @@ reset(int size)
   FASTUIDRAWassert(size >= 0);
 
   m_size = t_max(0, size);
-  m_sorted.clear();
-  m_free_intervals.clear();
+  m_total_free = 0;
+  m_blocks.clear();
+  m_unused_blocks.clear();
+  m_block_by_begin.clear();
+  m_block_by_end.clear();
+  m_fl_bitmap = 0u;
+  for (int fl = 0; fl < number_first_level_classes; ++fl)
+    {
+      m_sl_bitmap[fl] = 0u;
+      for (int sl = 0; sl < number_second_level_classes; ++sl)
+        {
+          m_heads[fl][sl] = -1;
+        }
+    }
+
   if (m_size > 0)
     {
       free_interval(0, m_size);
@@ -56,228 +108,321 @@ resize(int size)
     }
 }
 
-fastuidraw::interval_allocator::interval_status_t
+void
 fastuidraw::interval_allocator::
-interval_status(int begin, int size) const
+mapping_insert(int size, int *fl, int *sl)
 {
-  FASTUIDRAWassert(begin >= 0);
   FASTUIDRAWassert(size > 0);
+  if (size < number_second_level_classes)
+    {
+      *fl = 0;
+      *sl = size;
+    }
+  else
+    {
+      int m;
 
-  int end(begin + size);
-  FASTUIDRAWassert(end <= m_size);
-
-  std::map<int, interval>::const_iterator begin_iter;
+      m = highest_bit(size);
+      *fl = m - second_level_log2 + 1;
+      *sl = (size >> (m - second_level_log2)) - number_second_level_classes;
+    }
+  FASTUIDRAWassert(*fl < number_first_level_classes);
+}
 
-  /* begin_iter points to the first free interval I
-   * for which I.m_end >= begin
+bool
+fastuidraw::interval_allocator::
+mapping_search(int size, int *fl, int *sl)
+{
+  /* round size up to the start of the next class so that
+   * every interval of the class found can hold size
    */
-  begin_iter = m_free_intervals.upper_bound(begin);
-
-  if (begin_iter == m_free_intervals.end())
+  uint32_t rounded(size);
+  if (size >= number_second_level_classes)
     {
-      /* All free intervals end at or before begin,
-       * thus the interval is completely allocated
-       */
-      return completely_allocated;
+      rounded += (1u << (highest_bit(size) - second_level_log2)) - 1u;
     }
 
-  interval I(begin_iter->second);
-  FASTUIDRAWassert(I.m_end > begin);
-
-  if (I.m_end >= end && I.m_begin <= begin)
+  if (rounded > static_cast<uint32_t>(INT32_MAX))
     {
-      /* the free Interval I completely contains
-       * the interval [begin, end)
-       */
-      return completely_free;
+      return false;
     }
 
-  if (I.m_begin > begin)
+  mapping_insert(rounded, fl, sl);
+  return true;
+}
+
+int
+fastuidraw::interval_allocator::
+find_suitable_block(int fl, int sl) const
+{
+  uint32_t sl_map;
+
+  sl_map = m_sl_bitmap[fl] & (~0u << sl);
+  if (sl_map == 0u)
     {
-      /* the queried interval begins before I.
-       * Note that the free interval previous
-       * to I (call it J) has that J.m_end < begin,
-       * i.e. J ends before begin, and the range
-       * [J.m_end, I.m_begin) is completely
-       * allocated.
-       */
-      if (end <= I.m_begin)
-        {
-          /* end is before I even starts, thus
-           * [begin, end) is completely allocated
-           */
-          return completely_allocated;
-        }
-      else
+      uint32_t fl_map;
+
+      fl_map = (fl + 1 < 32) ? m_fl_bitmap & (~0u << (fl + 1)) : 0u;
+      if (fl_map == 0u)
         {
-          return partially_allocated;
+          return -1;
         }
+      fl = lowest_bit(fl_map);
+      sl_map = m_sl_bitmap[fl];
+      FASTUIDRAWassert(sl_map != 0u);
     }
 
-  FASTUIDRAWassert(I.m_end < end);
-  return partially_allocated;
-
+  sl = lowest_bit(sl_map);
+  FASTUIDRAWassert(m_heads[fl][sl] != -1);
+  return m_heads[fl][sl];
 }
 
 int
 fastuidraw::interval_allocator::
-allocate_interval(int size)
+lowest_fit_in_list(int block, int size, int max_candidates) const
 {
-  if (size <= 0)
+  int return_value(-1);
+
+  for (int count = 0; block != -1 && count < max_candidates; block = m_blocks[block].m_next, ++count)
     {
-      return -1;
+      if (m_blocks[block].m_end - m_blocks[block].m_begin >= size
+          && (return_value == -1 || m_blocks[block].m_begin < m_blocks[return_value].m_begin))
+        {
+          return_value = block;
+        }
     }
+  return return_value;
+}
 
-  std::map<int, interval_ref_set>::iterator iter;
+int
+fastuidraw::interval_allocator::
+create_block(int begin, int end)
+{
+  int return_value;
 
-  iter = m_sorted.lower_bound(size);
-  if (iter == m_sorted.end())
+  FASTUIDRAWassert(begin < end);
+  if (m_unused_blocks.empty())
     {
-      return -1;
+      return_value = m_blocks.size();
+      m_blocks.push_back(free_block());
+    }
+  else
+    {
+      return_value = m_unused_blocks.back();
+      m_unused_blocks.pop_back();
     }
 
-  interval_ref interval_reference(*iter->second.begin());
-  interval I(interval_reference->second);
-  interval return_value(I.m_begin, I.m_begin + size);
+  m_blocks[return_value].m_begin = begin;
+  m_blocks[return_value].m_end = end;
+  m_block_by_begin[begin] = return_value;
+  m_block_by_end[end] = return_value;
+  m_total_free += end - begin;
+  insert_into_class(return_value);
 
-  FASTUIDRAWassert(interval_reference->second.m_end == interval_reference->first);
-  FASTUIDRAWassert(I.m_end - I.m_begin == iter->first);
+  return return_value;
+}
 
-  iter->second.erase(iter->second.begin());
-  if (iter->second.empty())
+void
+fastuidraw::interval_allocator::
+destroy_block(int block)
+{
+  remove_from_class(block);
+  m_block_by_begin.erase(m_blocks[block].m_begin);
+  m_block_by_end.erase(m_blocks[block].m_end);
+  m_total_free -= m_blocks[block].m_end - m_blocks[block].m_begin;
+  m_unused_blocks.push_back(block);
+}
+
+void
+fastuidraw::interval_allocator::
+insert_into_class(int block)
+{
+  int fl, sl;
+  free_block &B(m_blocks[block]);
+
+  mapping_insert(B.m_end - B.m_begin, &fl, &sl);
+  B.m_prev = -1;
+  B.m_next = m_heads[fl][sl];
+  if (B.m_next != -1)
     {
-      m_sorted.erase(iter);
+      m_blocks[B.m_next].m_prev = block;
     }
+  m_heads[fl][sl] = block;
+  m_sl_bitmap[fl] |= (1u << sl);
+  m_fl_bitmap |= (1u << fl);
+}
 
-  /* Now take away the room from the interval
-   * pointed to by interval_reference that
-   * we used in the allocation. We can do
-   * this because the map is keyed by
-   * m_end of interval.
-   */
-  interval_reference->second.m_begin += size;
+void
+fastuidraw::interval_allocator::
+remove_from_class(int block)
+{
+  int fl, sl;
+  free_block &B(m_blocks[block]);
 
-  FASTUIDRAWassert(interval_reference->second.m_begin <= interval_reference->second.m_end);
-  if (interval_reference->second.m_begin == interval_reference->second.m_end)
+  mapping_insert(B.m_end - B.m_begin, &fl, &sl);
+  if (B.m_next != -1)
     {
-      /* if the new interval is empty, then we delete it */
-      m_free_intervals.erase(interval_reference);
+      m_blocks[B.m_next].m_prev = B.m_prev;
+    }
+
+  if (B.m_prev != -1)
+    {
+      m_blocks[B.m_prev].m_next = B.m_next;
     }
   else
     {
-      /* is not empty, we need to add it to m_sorted */
-      int sz(interval_reference->second.m_end - interval_reference->second.m_begin);
-      m_sorted[sz].insert(interval_reference);
+      FASTUIDRAWassert(m_heads[fl][sl] == block);
+      m_heads[fl][sl] = B.m_next;
+      if (B.m_next == -1)
+        {
+          m_sl_bitmap[fl] &= ~(1u << sl);
+          if (m_sl_bitmap[fl] == 0u)
+            {
+              m_fl_bitmap &= ~(1u << fl);
+            }
+        }
     }
-
-  return return_value.m_begin;
 }
 
-void
+int
 fastuidraw::interval_allocator::
-free_interval(int location, int size)
+largest_free_interval(void) const
 {
-  FASTUIDRAWassert(size > 0);
-  FASTUIDRAWassert(interval_status(location, size) == completely_allocated);
+  if (m_fl_bitmap == 0u)
+    {
+      return 0;
+    }
 
-  int end(location + size);
+  int fl, sl, return_value(0);
 
-  /* see if location corresponds to m_end
-   * of an existing free block.
-   */
-  interval_ref iter;
-  iter = m_free_intervals.find(location);
-  if (iter != m_free_intervals.end())
+  fl = highest_bit(m_fl_bitmap);
+  sl = highest_bit(m_sl_bitmap[fl]);
+  for (int b = m_heads[fl][sl]; b != -1; b = m_blocks[b].m_next)
     {
-      /* in this case we need to enlarge
-       * the block pointed to by iter,
-       * however that means we need to
-       * remove it since we are changing
-       * m_end to end;
-       */
-      location = iter->second.m_begin;
-      size = end - location;
-      remove_free_interval(iter);
+      return_value = t_max(return_value, m_blocks[b].m_end - m_blocks[b].m_begin);
     }
+  return return_value;
+}
+
+fastuidraw::interval_allocator::interval_status_t
+fastuidraw::interval_allocator::
+interval_status(int begin, int size) const
+{
+  FASTUIDRAWassert(begin >= 0);
+  FASTUIDRAWassert(size > 0);
+
+  int end(begin + size), free_length(0);
+  FASTUIDRAWassert(end <= m_size);
 
-  iter = m_free_intervals.lower_bound(end);
-  if (iter != m_free_intervals.end() && iter->second.m_begin == end)
+  for (const auto &entry : m_block_by_begin)
     {
-      /* end is the start of an existing block,
-       * so just make that existing block bigger.
-       * First, remove it from m_sorted.
-       */
-      remove_free_interval_from_sorted_only(iter);
+      const free_block &B(m_blocks[entry.second]);
+      int b, e;
 
-      /* Second, make it bigger and add it to m_sorted
-       */
-      iter->second.m_begin = location;
-      m_sorted[iter->second.m_end - iter->second.m_begin].insert(iter);
-      return;
+      b = t_max(B.m_begin, begin);
+      e = t_min(B.m_end, end);
+      if (b < e)
+        {
+          free_length += e - b;
+        }
     }
 
-  /* the element to add has that its end is not
-   * the start of an existing free interval and
-   * that its beginning is not the end of an
-   * existing one either, so just add it:
-   */
-  interval I(location, end);
-  std::pair<interval_ref, bool> R;
+  if (free_length == 0)
+    {
+      return completely_allocated;
+    }
 
-  R = m_free_intervals.insert(std::pair<int, interval>(end, I));
-  FASTUIDRAWassert(R.second);
-  m_sorted[size].insert(R.first);
+  return (free_length == size) ?
+    completely_free :
+    partially_allocated;
 }
 
-void
+int
 fastuidraw::interval_allocator::
-remove_free_interval(interval_ref iter)
+allocate_interval(int size)
 {
-  int sz(iter->second.m_end - iter->second.m_begin);
-  std::map<int, interval_ref_set>::iterator sorted_iter;
-
-  sorted_iter = m_sorted.find(sz);
-  FASTUIDRAWassert(sorted_iter != m_sorted.end());
+  if (size <= 0)
+    {
+      return -1;
+    }
 
-  remove_free_interval(sorted_iter, iter);
-}
+  int fl, sl, block;
 
-void
-fastuidraw::interval_allocator::
-remove_free_interval(std::map<int, interval_ref_set>::iterator sorted_iter,
-                     interval_ref iter)
-{
-  /* we need to remove iter from m_sorted
-   * and m_free_intervals
+  /* the class of size itself holds intervals both smaller and
+   * larger than size; taking one that fits from there keeps the
+   * larger classes for larger requests.
    */
-  remove_free_interval_from_sorted_only(sorted_iter, iter);
-  m_free_intervals.erase(iter);
-}
+  mapping_insert(size, &fl, &sl);
+  block = lowest_fit_in_list(m_heads[fl][sl], size, max_fit_candidates);
 
-void
-fastuidraw::interval_allocator::
-remove_free_interval_from_sorted_only(std::map<int, interval_ref_set>::iterator sorted_iter,
-                                      interval_ref iter)
-{
-  FASTUIDRAWassert(iter->second.m_end == iter->first);
-  FASTUIDRAWassert(iter->second.m_end - iter->second.m_begin == sorted_iter->first);
-  FASTUIDRAWassert(sorted_iter != m_sorted.end());
-  FASTUIDRAWassert(sorted_iter->second.find(iter) != sorted_iter->second.end());
+  if (block == -1 && mapping_search(size, &fl, &sl))
+    {
+      block = find_suitable_block(fl, sl);
+      block = lowest_fit_in_list(block, size, max_fit_candidates);
+    }
+
+  if (block == -1)
+    {
+      /* the lists are only walked for max_fit_candidates
+       * intervals above, the class of size itself may
+       * still have an interval large enough further down.
+       */
+      mapping_insert(size, &fl, &sl);
+      block = lowest_fit_in_list(m_heads[fl][sl], size, static_cast<int>(m_blocks.size()));
+      if (block == -1)
+        {
+          return -1;
+        }
+    }
 
-  sorted_iter->second.erase(iter);
-  if (sorted_iter->second.empty())
+  int begin(m_blocks[block].m_begin), end(m_blocks[block].m_end);
+
+  FASTUIDRAWassert(end - begin >= size);
+  destroy_block(block);
+  if (begin + size < end)
     {
-      m_sorted.erase(sorted_iter);
+      create_block(begin + size, end);
     }
+
+  return begin;
 }
 
 void
 fastuidraw::interval_allocator::
-remove_free_interval_from_sorted_only(interval_ref iter)
+free_interval(int location, int size)
 {
-  int sz(iter->second.m_end - iter->second.m_begin);
-  std::map<int, interval_ref_set>::iterator sorted_iter;
+  int begin(location), end(location + size);
+  std::unordered_map<int, int>::iterator iter;
+
+  /* an allocated interval neither starts where a free interval
+   * starts nor ends where a free interval ends; checking the
+   * whole range with interval_status() would walk all the free
+   * intervals.
+   */
+  FASTUIDRAWassert(size > 0);
+  FASTUIDRAWassert(begin >= 0 && end <= m_size);
+  FASTUIDRAWassert(m_block_by_begin.find(begin) == m_block_by_begin.end());
+  FASTUIDRAWassert(m_block_by_end.find(end) == m_block_by_end.end());
+
+  /* merge with the free interval that ends at location */
+  iter = m_block_by_end.find(begin);
+  if (iter != m_block_by_end.end())
+    {
+      int block(iter->second);
+
+      begin = m_blocks[block].m_begin;
+      destroy_block(block);
+    }
+
+  /* merge with the free interval that starts at end */
+  iter = m_block_by_begin.find(end);
+  if (iter != m_block_by_begin.end())
+    {
+      int block(iter->second);
+
+      end = m_blocks[block].m_end;
+      destroy_block(block);
+    }
 
-  sorted_iter = m_sorted.find(sz);
-  remove_free_interval_from_sorted_only(sorted_iter, iter);
+  create_block(begin, end);
 }
@@ -20,21 +20,32 @@
 #ifndef FASTUIDRAW_INTERVAL_ALLOCATOR_HPP
 #define FASTUIDRAW_INTERVAL_ALLOCATOR_HPP
 
-#include <map>
-#include <set>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
 #include <fastuidraw/util/util.hpp>
 
 namespace fastuidraw
 {
   /*!\class interval_allocator
    * An interval_allocator gives a means to allocate and deallocate
-   * ranges from a linear range. The implementation is simply
-   * to make a list of free intervals sorted by size. Allocation
-   * means taking from the list the smallest interval that can
-   * accomodate the request. From that interval take the portion
-   * needed and return the remainder as a new entry on the free
-   * list. All operations are O(log N) where N is the number of
-   * free intervals.
+   * ranges from a linear range. The implementation is a two-level
+   * segregated fit allocator (TLSF): the free intervals are kept
+   * in lists, one list per size class where the classes are the
+   * powers of two each split into \ref number_second_level_classes
+   * sub-ranges. Bitmaps of the non-empty lists give the smallest
+   * class that can accomodate a request with two bit scans. An
+   * interval that fits is first looked for in the class of the
+   * request itself and then in that smallest class; in either list
+   * only the first \ref max_fit_candidates intervals are looked at
+   * and the one lowest in the range is taken, which keeps the free
+   * space towards the end of the range in large intervals. The
+   * remainder is placed back on the list of its class. Neighbouring
+   * free intervals are merged on free_interval() through hash tables
+   * keyed by the start and end of the free intervals. Allocation
+   * and freeing are O(1) save for the rare case where only intervals
+   * deeper in the list of the class of the request are large enough,
+   * in which case that one list is walked.
    */
   class interval_allocator:fastuidraw::noncopyable
   {
@@ -60,6 +71,36 @@ namespace fastuidraw
         partially_allocated,
       };
 
+    enum
+      {
+        /*!
+         * log2 of \ref number_second_level_classes
+         */
+        second_level_log2 = 4,
+
+        /*!
+         * Number of classes each power of two is split into;
+         * an interval is given from a class whose sizes are
+         * within a factor of 1 + 1 / number_second_level_classes
+         * of the request.
+         */
+        number_second_level_classes = 1 << second_level_log2,
+
+        /*!
+         * Number of first level classes; sizes less than
+         * \ref number_second_level_classes have first level
+         * 0 and are each their own class.
+         */
+        number_first_level_classes = 32 - second_level_log2,
+
+        /*!
+         * Number of intervals of a size class list looked at
+         * by allocate_interval() to take the one lowest in
+         * the range.
+         */
+        max_fit_candidates = 8,
+      };
+
     /*!\fn
      * Ctor.
      * \param size gives the size from which to allocate intervals, essentially
@@ -115,15 +156,32 @@ namespace fastuidraw
      * and not fail.
      */
     int
-    largest_free_interval(void) const
+    largest_free_interval(void) const;
+
+    /*!\fn
+     * Returns the number of free intervals; together with
+     * largest_free_interval() and total_free() this gives
+     * a measure of the fragmentation of the free space.
+     */
+    int
+    number_free_intervals(void) const
     {
-      return m_sorted.empty() ?
-        0 :
-        m_sorted.rbegin()->first;
+      return static_cast<int>(m_block_by_begin.size());
     }
 
     /*!\fn
-     * Returns the allocation status of an interval
+     * Returns the sum of the lengths of the free intervals.
+     */
+    int
+    total_free(void) const
+    {
+      return m_total_free;
+    }
+
+    /*!\fn
+     * Returns the allocation status of an interval. The
+     * query walks all the free intervals, it is intended
+     * for checking the correctness of the callers.
      * \param begin start of interval
      * \param size length of interval
      */
@@ -131,49 +189,62 @@ namespace fastuidraw
     interval_status(int begin, int size) const;
 
   private:
-    typedef range_type<int> interval;
-    typedef std::map<int, interval>::iterator interval_ref;
-
-    class compare_interval_ref
+    class free_block
     {
     public:
-      bool
-      operator()(interval_ref lhs, interval_ref rhs) const
-      {
-        FASTUIDRAWassert(lhs->first == lhs->second.m_end);
-        FASTUIDRAWassert(rhs->first == rhs->second.m_end);
-        return lhs->second.m_end < rhs->second.m_end;
-      }
+      int m_begin, m_end;
+
+      /* links of the list of the size class of the block */
+      int m_prev, m_next;
     };
-    typedef std::set<interval_ref, compare_interval_ref> interval_ref_set;
 
+    static
     void
-    remove_free_interval(interval_ref iter);
+    mapping_insert(int size, int *fl, int *sl);
+
+    static
+    bool
+    mapping_search(int size, int *fl, int *sl);
+
+    int
+    find_suitable_block(int fl, int sl) const;
+
+    int
+    lowest_fit_in_list(int block, int size, int max_candidates) const;
+
+    int
+    create_block(int begin, int end);
 
     void
-    remove_free_interval(std::map<int, interval_ref_set>::iterator,
-                         interval_ref iter);
+    destroy_block(int block);
 
     void
-    remove_free_interval_from_sorted_only(std::map<int, interval_ref_set>::iterator sorted_iter,
-                                          interval_ref iter);
+    insert_into_class(int block);
 
     void
-    remove_free_interval_from_sorted_only(interval_ref iter);
+    remove_from_class(int block);
 
-    int m_size;
+    int m_size, m_total_free;
+
+    /* pool of free_block values, blocks no longer used
+     * are placed on m_unused_blocks for reuse
+     */
+    std::vector<free_block> m_blocks;
+    std::vector<int> m_unused_blocks;
 
-    /* List of free intervals, stored in a map
-     * keyed by interval::m_end
+    /* free blocks keyed by free_block::m_begin and
+     * by free_block::m_end, used to merge neighbours
      */
-    std::map<int, interval> m_free_intervals;
+    std::unordered_map<int, int> m_block_by_begin;
+    std::unordered_map<int, int> m_block_by_end;
 
-    /* Each element of m_sorted[size] refers
-     * to an element in m_free_intervals. Map
-     * is keyed by the size of the interval
-     * pointed to by the elements in second.
+    /* bit fl of m_fl_bitmap is up if and only if
+     * m_sl_bitmap[fl] is non-zero; bit sl of m_sl_bitmap[fl]
+     * is up if and only if m_heads[fl][sl] is not -1.
      */
-    std::map<int, interval_ref_set> m_sorted;
+    uint32_t m_fl_bitmap;
+    uint32_t m_sl_bitmap[number_first_level_classes];
+    int m_heads[number_first_level_classes][number_second_level_classes];
   };
 
 }
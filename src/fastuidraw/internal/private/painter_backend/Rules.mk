@@ -4,7 +4,8 @@ dirstack_$(sp)	:= $(d)
 d		:= $(dir)
 # End standard header
 
-FASTUIDRAW_PRIVATE_SOURCES += $(call filelist, painter_packer.cpp)
+FASTUIDRAW_PRIVATE_SOURCES += $(call filelist, painter_packer.cpp painter_opaque_draws.cpp \
+	painter_draw_regrouper.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
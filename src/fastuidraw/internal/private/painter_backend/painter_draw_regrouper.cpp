@@ -0,0 +1,164 @@
+/*!
+ * \file painter_draw_regrouper.cpp
+ * \brief file painter_draw_regrouper.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+#include <algorithm>
+#include <private/painter_backend/painter_draw_regrouper.hpp>
+
+namespace
+{
+  /* value of DrawRegrouper::m_blockers[] for a draw already placed */
+  const unsigned int placed = ~0u;
+}
+
+/////////////////////////////////////////
+// fastuidraw::detail::DrawRegrouper methods
+unsigned int
+fastuidraw::detail::DrawRegrouper::
+number_state_changes(c_array<const Entry> entries,
+                     unsigned int current_state)
+{
+  unsigned int return_value(0);
+
+  for (const Entry &E : entries)
+    {
+      if (E.m_state != current_state)
+        {
+          ++return_value;
+          current_state = E.m_state;
+        }
+    }
+  return return_value;
+}
+
+void
+fastuidraw::detail::DrawRegrouper::
+compute_order(c_array<const Entry> entries,
+              unsigned int current_state)
+{
+  unsigned int n(entries.size());
+
+  /* m_blockers[j] is the number of draws before draw j that
+   * draw j cannot be moved across and that are not yet placed.
+   */
+  m_blockers.assign(n, 0u);
+  for (unsigned int j = 1; j < n; ++j)
+    {
+      for (unsigned int i = 0; i < j; ++i)
+        {
+          if (must_keep_order(entries[i], entries[j]))
+            {
+              ++m_blockers[j];
+            }
+        }
+    }
+
+  /* Greedily place the first draw that is free to be placed
+   * and uses the current state; if there is no such draw,
+   * place the first draw that is free to be placed. The first
+   * draw not yet placed is always free to be placed.
+   */
+  m_order.clear();
+  while (m_order.size() < n)
+    {
+      unsigned int pick(n);
+
+      for (unsigned int j = 0; j < n; ++j)
+        {
+          if (m_blockers[j] == 0u)
+            {
+              if (entries[j].m_state == current_state)
+                {
+                  pick = j;
+                  break;
+                }
+              pick = t_min(pick, j);
+            }
+        }
+
+      FASTUIDRAWassert(pick < n);
+      m_order.push_back(pick);
+      m_blockers[pick] = placed;
+      current_state = entries[pick].m_state;
+
+      for (unsigned int j = pick + 1; j < n; ++j)
+        {
+          if (m_blockers[j] != placed && must_keep_order(entries[pick], entries[j]))
+            {
+              FASTUIDRAWassert(m_blockers[j] > 0u);
+              --m_blockers[j];
+            }
+        }
+    }
+}
+
+bool
+fastuidraw::detail::DrawRegrouper::
+regroup(c_array<PainterIndex> indices,
+        c_array<Entry> entries, unsigned int end,
+        unsigned int current_state)
+{
+  unsigned int range_begin, dst, reordered_changes, state;
+
+  if (entries.size() < 2)
+    {
+      return false;
+    }
+
+  compute_order(entries, current_state);
+
+  /* the greedy order is not guaranteed to be better */
+  reordered_changes = 0;
+  state = current_state;
+  for (unsigned int idx : m_order)
+    {
+      if (entries[idx].m_state != state)
+        {
+          ++reordered_changes;
+          state = entries[idx].m_state;
+        }
+    }
+
+  if (reordered_changes >= number_state_changes(entries, current_state))
+    {
+      return false;
+    }
+
+  range_begin = entries.front().m_begin;
+  FASTUIDRAWassert(range_begin <= end && end <= indices.size());
+  m_work_room.assign(indices.begin() + range_begin, indices.begin() + end);
+  m_entries.assign(entries.begin(), entries.end());
+
+  dst = range_begin;
+  for (unsigned int k = 0; k < m_order.size(); ++k)
+    {
+      unsigned int idx(m_order[k]), begin, draw_end;
+
+      begin = m_entries[idx].m_begin;
+      draw_end = (idx + 1 < m_entries.size()) ? m_entries[idx + 1].m_begin : end;
+      std::copy(m_work_room.begin() + (begin - range_begin),
+                m_work_room.begin() + (draw_end - range_begin),
+                indices.begin() + dst);
+
+      entries[k] = m_entries[idx];
+      entries[k].m_begin = dst;
+      dst += draw_end - begin;
+    }
+  FASTUIDRAWassert(dst == end);
+
+  return true;
+}
@@ -0,0 +1,122 @@
+/*!
+ * \file painter_draw_regrouper.hpp
+ * \brief file painter_draw_regrouper.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+
+#ifndef FASTUIDRAW_PAINTER_DRAW_REGROUPER_HPP
+#define FASTUIDRAW_PAINTER_DRAW_REGROUPER_HPP
+
+#include <vector>
+
+#include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/painter/attribute_data/painter_attribute.hpp>
+#include <private/bounding_box.hpp>
+
+namespace fastuidraw
+{
+  namespace detail
+  {
+    /*!
+     * A DrawRegrouper reorders the index data of a window of
+     * consecutive draws so that draws with the same shader state
+     * are adjacent, reducing the number of state changes needed
+     * to draw the window. A draw is never moved across an earlier
+     * draw whose bounding box intersects its own, so the rendered
+     * output is not changed.
+     */
+    class DrawRegrouper
+    {
+    public:
+      /*!
+       * A draw of the window
+       */
+      class Entry
+      {
+      public:
+        /*!
+         * Index into the index data where the draw starts;
+         * the draw ends where the next Entry starts.
+         */
+        unsigned int m_begin;
+
+        /*!
+         * Key of the shader state of the draw; draws with the
+         * same key can be drawn without a state change between
+         * them.
+         */
+        unsigned int m_state;
+
+        /*!
+         * Bounding box containing all fragments of the draw;
+         * if empty, the bounds are unknown and the draw is
+         * regarded as intersecting every other draw.
+         */
+        BoundingBox<float> m_bounds;
+      };
+
+      /*!
+       * Reorder a window of draws if doing so reduces the number
+       * of state changes; returns true if the draws were reordered.
+       * If reordered, on return entries is sorted in the order the
+       * draws are to be drawn with Entry::m_begin updated to where
+       * the index data of each draw was moved.
+       * \param indices index data to reorder in place
+       * \param entries the draws of the window, sorted by Entry::m_begin
+       * \param end where the index data of the last draw ends
+       * \param current_state key of the state active before the
+       *                      first draw of the window
+       */
+      bool
+      regroup(c_array<PainterIndex> indices,
+              c_array<Entry> entries, unsigned int end,
+              unsigned int current_state);
+
+      /*!
+       * Returns the number of state changes needed to draw
+       * a sequence of draws in order.
+       * \param entries the draws
+       * \param current_state key of the state active before the
+       *                      first draw
+       */
+      static
+      unsigned int
+      number_state_changes(c_array<const Entry> entries,
+                           unsigned int current_state);
+
+    private:
+      static
+      bool
+      must_keep_order(const Entry &a, const Entry &b)
+      {
+        return a.m_bounds.empty()
+          || b.m_bounds.empty()
+          || a.m_bounds.intersects(b.m_bounds);
+      }
+
+      void
+      compute_order(c_array<const Entry> entries,
+                    unsigned int current_state);
+
+      std::vector<unsigned int> m_blockers;
+      std::vector<unsigned int> m_order;
+      std::vector<Entry> m_entries;
+      std::vector<PainterIndex> m_work_room;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,159 @@
+/*!
+ * \file painter_opaque_draws.cpp
+ * \brief file painter_opaque_draws.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+#include <algorithm>
+#include <fastuidraw/painter/painter_brush.hpp>
+#include <private/painter_backend/painter_opaque_draws.hpp>
+
+////////////////////////////////////////////
+// fastuidraw::detail::OpaqueDrawClassifier methods
+fastuidraw::detail::OpaqueDrawClassifier::
+OpaqueDrawClassifier(const PainterShaderSet &shaders):
+  m_full_coverage_item_shader(shaders.fill_shader().item_shader().get()),
+  m_src_over_blend_shader(shaders.blend_shaders().shader(PainterEnums::blend_porter_duff_src_over).get()),
+  m_src_blend_shader(shaders.blend_shaders().shader(PainterEnums::blend_porter_duff_src).get())
+{
+}
+
+bool
+fastuidraw::detail::OpaqueDrawClassifier::
+brush_is_opaque(const PainterData::brush_value &brush)
+{
+  const PainterBrush *br;
+  uint32_t features;
+
+  /* only an unpacked PainterBrush can be inspected */
+  if (brush.brush_shader() || brush.packed() || !brush.brush_shader_data().m_value)
+    {
+      return false;
+    }
+
+  br = dynamic_cast<const PainterBrush*>(brush.brush_shader_data().m_value);
+  if (!br)
+    {
+      return false;
+    }
+
+  /* an Image does not record if all of its texels are opaque
+   * and the color stops of a gradient can have any alpha.
+   */
+  features = br->features();
+  return br->color().w() >= 1.0f
+    && (features & (PainterBrush::image_mask | PainterBrush::gradient_mask)) == 0u;
+}
+
+bool
+fastuidraw::detail::OpaqueDrawClassifier::
+is_opaque(const PainterItemShader *item_shader,
+          const PainterBlendShader *blend_shader,
+          const PainterData::brush_value &brush) const
+{
+  if (!item_shader
+      || !blend_shader
+      || item_shader != m_full_coverage_item_shader
+      || item_shader->coverage_shader())
+    {
+      return false;
+    }
+
+  /* Porter-Duff src ignores the destination whatever the
+   * brush emits, Porter-Duff src-over only does when the
+   * brush emits an alpha of 1.
+   */
+  return blend_shader == m_src_blend_shader
+    || (blend_shader == m_src_over_blend_shader && brush_is_opaque(brush));
+}
+
+////////////////////////////////////////////
+// fastuidraw::detail::OpaqueChunkReverser methods
+void
+fastuidraw::detail::OpaqueChunkReverser::
+reverse_chunks(c_array<PainterIndex> indices,
+               c_array<const Chunk> chunks,
+               c_array<const unsigned int> segment_begins)
+{
+  unsigned int segment_begin(0), segment(0);
+  const Chunk *chunk(chunks.begin());
+
+  while (segment_begin < indices.size())
+    {
+      unsigned int segment_end;
+
+      segment_end = (segment < segment_begins.size()) ?
+        t_min(segment_begins[segment++], static_cast<unsigned int>(indices.size())) :
+        indices.size();
+
+      if (segment_end <= segment_begin)
+        {
+          continue;
+        }
+
+      /* the boundaries between the groups of chunks of the
+       * segment; a group is a run of consecutive chunks with
+       * the same z-value. The data of the segment before its
+       * first chunk is not part of any group and stays in place.
+       */
+      bool have_z(false);
+      int last_z(0);
+
+      m_bounds.clear();
+      m_bounds.push_back(segment_begin);
+      for (; chunk != chunks.end() && chunk->m_begin < segment_end; ++chunk)
+        {
+          if (!have_z)
+            {
+              m_bounds.back() = t_max(chunk->m_begin, segment_begin);
+            }
+          else if (chunk->m_begin > m_bounds.back() && chunk->m_z != last_z)
+            {
+              m_bounds.push_back(chunk->m_begin);
+            }
+          have_z = true;
+          last_z = chunk->m_z;
+        }
+      m_bounds.push_back(segment_end);
+
+      if (m_bounds.size() > 2)
+        {
+          reverse_groups(indices);
+        }
+      segment_begin = segment_end;
+    }
+}
+
+void
+fastuidraw::detail::OpaqueChunkReverser::
+reverse_groups(c_array<PainterIndex> indices)
+{
+  unsigned int range_begin(m_bounds.front()), dst(m_bounds.front());
+
+  m_work_room.assign(indices.begin() + m_bounds.front(),
+                     indices.begin() + m_bounds.back());
+  for (unsigned int k = m_bounds.size() - 1; k > 0; --k)
+    {
+      unsigned int begin, end;
+
+      begin = m_bounds[k - 1] - range_begin;
+      end = m_bounds[k] - range_begin;
+      std::copy(m_work_room.begin() + begin,
+                m_work_room.begin() + end,
+                indices.begin() + dst);
+      dst += end - begin;
+    }
+  FASTUIDRAWassert(dst == m_bounds.back());
+}
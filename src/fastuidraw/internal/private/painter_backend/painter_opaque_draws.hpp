@@ -0,0 +1,148 @@
+/*!
+ * \file painter_opaque_draws.hpp
+ * \brief file painter_opaque_draws.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+
+#ifndef FASTUIDRAW_PAINTER_OPAQUE_DRAWS_HPP
+#define FASTUIDRAW_PAINTER_OPAQUE_DRAWS_HPP
+
+#include <vector>
+
+#include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/painter/shader_data/painter_data.hpp>
+#include <fastuidraw/painter/shader/painter_shader_set.hpp>
+#include <fastuidraw/painter/attribute_data/painter_attribute.hpp>
+
+namespace fastuidraw
+{
+  namespace detail
+  {
+    /*!
+     * An OpaqueDrawClassifier decides if a draw is opaque,
+     * i.e. if the color the draw writes to each fragment it
+     * covers does not depend on the color already in the
+     * color buffer. Such draws can be drawn in any order
+     * (relying on the depth test to resolve which is on top)
+     * as long as draws with the same z-value are drawn in
+     * the order they were issued.
+     */
+    class OpaqueDrawClassifier
+    {
+    public:
+      /*!
+       * Ctor to classify no draw as opaque.
+       */
+      OpaqueDrawClassifier(void):
+        m_full_coverage_item_shader(nullptr),
+        m_src_over_blend_shader(nullptr),
+        m_src_blend_shader(nullptr)
+      {}
+
+      /*!
+       * Ctor.
+       * \param shaders default shaders of the Painter; a draw can
+       *                only be opaque if it uses the item shader of
+       *                PainterShaderSet::fill_shader() (which covers
+       *                its fragments completely) together with the
+       *                blend shader of \ref PainterEnums::blend_porter_duff_src
+       *                or of \ref PainterEnums::blend_porter_duff_src_over
+       */
+      explicit
+      OpaqueDrawClassifier(const PainterShaderSet &shaders);
+
+      /*!
+       * Returns true if a draw is opaque.
+       * \param item_shader item shader of the draw
+       * \param blend_shader blend shader of the draw
+       * \param brush brush of the draw
+       */
+      bool
+      is_opaque(const PainterItemShader *item_shader,
+                const PainterBlendShader *blend_shader,
+                const PainterData::brush_value &brush) const;
+
+      /*!
+       * Returns true if the brush emits an alpha of 1 everywhere;
+       * a brush is only recognized as opaque if it is an unpacked
+       * \ref PainterBrush with an opaque color and with neither an
+       * image nor a gradient.
+       */
+      static
+      bool
+      brush_is_opaque(const PainterData::brush_value &brush);
+
+    private:
+      const PainterItemShader *m_full_coverage_item_shader;
+      const PainterBlendShader *m_src_over_blend_shader;
+      const PainterBlendShader *m_src_blend_shader;
+    };
+
+    /*!
+     * An OpaqueChunkReverser reorders the index data of opaque
+     * draws so that they are drawn front to back. The index
+     * data is viewed as a sequence of chunks, each chunk the
+     * indices of a single draw, which are partitioned into
+     * segments by draw breaks. Within each segment, the order
+     * of the chunks is reversed except that consecutive chunks
+     * with the same z-value keep their order. Because the
+     * segments do not move, the draw breaks stay valid.
+     */
+    class OpaqueChunkReverser
+    {
+    public:
+      /*!
+       * Start of a chunk
+       */
+      class Chunk
+      {
+      public:
+        /*!
+         * Index into the index data where the chunk starts
+         */
+        unsigned int m_begin;
+
+        /*!
+         * z-value of the draw of the chunk
+         */
+        int m_z;
+      };
+
+      /*!
+       * Reverse the chunks of index data.
+       * \param indices index data to reorder in place
+       * \param chunks the starts of the chunks, sorted by
+       *               Chunk::m_begin; any indices before the
+       *               first chunk are left in place
+       * \param segment_begins the locations of the draw breaks,
+       *                       sorted in increasing order
+       */
+      void
+      reverse_chunks(c_array<PainterIndex> indices,
+                     c_array<const Chunk> chunks,
+                     c_array<const unsigned int> segment_begins);
+
+    private:
+      void
+      reverse_groups(c_array<PainterIndex> indices);
+
+      std::vector<unsigned int> m_bounds;
+      std::vector<PainterIndex> m_work_room;
+    };
+  }
+}
+
+#endif
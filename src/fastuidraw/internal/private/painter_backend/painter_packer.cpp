@@ -20,6 +20,8 @@
 #include <vector>
 #include <list>
 #include <cstring>
+#include <limits>
+#include <algorithm>
 
 #include <private/painter_backend/painter_packer.hpp>
 #include <private/painter_backend/painter_packed_value_pool_private.hpp>
@@ -91,6 +93,23 @@ namespace
     return (state.m_item_coverage_shader_override) ? state.m_item_coverage_shader_override : shader;
   }
 
+  /* returns true if going from the state prev to the state
+   * current requires a call to PainterDraw::draw_break().
+   */
+  inline
+  bool
+  state_changes(enum fastuidraw::PainterSurface::render_type_t render_type,
+                const PainterShaderGroupPrivate &prev,
+                const PainterShaderGroupPrivate &current)
+  {
+    return current.m_item_group != prev.m_item_group
+      || current.m_blend_mode != prev.m_blend_mode
+      || (render_type == fastuidraw::PainterSurface::color_buffer_type &&
+          (current.m_blend_group != prev.m_blend_group
+           || current.m_blend_shader_type != prev.m_blend_shader_type
+           || current.m_brush_group != prev.m_brush_group));
+  }
+
   class AttributeIndexSrcFromArray
   {
   public:
@@ -285,6 +304,24 @@ namespace
     fastuidraw::c_array<const int> m_index_adjusts;
     fastuidraw::c_array<const unsigned int> m_attrib_chunk_selector;
   };
+
+  /* Only draws from arrays of attributes and indices can be
+   * classified as opaque; the draws of a PainterAttributeWriter
+   * can change the item shader and z-value as they progress.
+   */
+  inline
+  bool
+  source_allows_reorder(const AttributeIndexSrcFromArray&)
+  {
+    return true;
+  }
+
+  inline
+  bool
+  source_allows_reorder(const fastuidraw::PainterAttributeWriter&)
+  {
+    return false;
+  }
 }
 
 class fastuidraw::PainterPacker::per_draw_command
@@ -292,7 +329,10 @@ class fastuidraw::PainterPacker::per_draw_command
 public:
   explicit
   per_draw_command(PainterShaderRegistrar &rp,
-                   const reference_counted_ptr<PainterDraw> &r);
+                   const reference_counted_ptr<PainterDraw> &r,
+                   unsigned int id, bool opaque,
+                   detail::DrawRegrouper *regrouper,
+                   unsigned int regroup_window);
 
   unsigned int
   attribute_room(void) const
@@ -326,9 +366,16 @@ public:
   void
   unmap(void)
   {
+    FASTUIDRAWassert(m_window.empty());
     m_draw_command->unmap(m_attributes_written, m_indices_written, store_written());
   }
 
+  bool
+  has_content(void) const
+  {
+    return m_indices_written > 0 || store_written() > 0 || m_has_action;
+  }
+
   void
   pack_painter_state(enum fastuidraw::PainterSurface::render_type_t render_type,
                      const PainterPackerData &state,
@@ -346,6 +393,7 @@ public:
               int z,
               const painter_state_location &loc,
               const std::list<reference_counted_ptr<PainterPacker::DataCallBack> > &call_backs,
+              const BoundingBox<float> &bounds,
               unsigned int *header_location);
 
   bool
@@ -353,7 +401,16 @@ public:
   {
     if (action)
       {
-        return m_draw_command->draw_break(action, m_indices_written);
+        bool return_value;
+
+        flush_window();
+        m_has_action = true;
+        return_value = m_draw_command->draw_break(action, m_indices_written);
+        if (return_value && m_opaque)
+          {
+            m_segment_begins.push_back(m_indices_written);
+          }
+        return return_value;
       }
     return false;
   }
@@ -361,7 +418,32 @@ public:
   reference_counted_ptr<PainterDraw> m_draw_command;
   unsigned int m_attributes_written, m_indices_written;
 
+  /* identifies the command for the packed values of
+   * detail::PackedValuePool placed on its store.
+   */
+  unsigned int m_id;
+
+  /* if true, the command holds opaque draws whose index
+   * chunks are reordered front to back when unmapped.
+   */
+  bool m_opaque;
+  std::vector<detail::OpaqueChunkReverser::Chunk> m_chunks;
+  std::vector<unsigned int> m_segment_begins;
+
+  /* number of draw breaks added by flush_window() and the
+   * number of draw breaks it avoided by regrouping draws.
+   */
+  unsigned int m_window_breaks_added, m_window_breaks_saved;
+
+  /* regroup the draws of the window and issue their draw breaks */
+  void
+  flush_window(void);
+
 private:
+  void
+  add_to_window(const PainterShaderGroupPrivate &state,
+                const BoundingBox<float> &bounds);
+
   c_array<uvec4>
   allocate_store(unsigned int num_elements);
 
@@ -383,20 +465,43 @@ private:
                   uint32_t &location);
 
   unsigned int m_store_blocks_written;
+  bool m_has_action;
   PainterShaderGroupPrivate m_prev_state;
-  PainterShaderRegistrar &m_registrar;
+  PainterShaderRegistrar *m_registrar;
+
+  /* If m_regrouper is non-null, the draw breaks between draws
+   * are not issued when the headers are packed; instead the
+   * draws are accumulated into a window that flush_window()
+   * regroups by state before issuing the draw breaks.
+   * The values of detail::DrawRegrouper::Entry::m_state
+   * index into m_window_states.
+   */
+  detail::DrawRegrouper *m_regrouper;
+  unsigned int m_regroup_window;
+  std::vector<detail::DrawRegrouper::Entry> m_window;
+  std::vector<PainterShaderGroupPrivate> m_window_states;
 };
 
 //////////////////////////////////////////
 // fastuidraw::PainterPacker::per_draw_command methods
 fastuidraw::PainterPacker::per_draw_command::
 per_draw_command(PainterShaderRegistrar &rp,
-                 const reference_counted_ptr<PainterDraw> &r):
+                 const reference_counted_ptr<PainterDraw> &r,
+                 unsigned int id, bool opaque,
+                 detail::DrawRegrouper *regrouper,
+                 unsigned int regroup_window):
   m_draw_command(r),
   m_attributes_written(0),
   m_indices_written(0),
+  m_id(id),
+  m_opaque(opaque),
+  m_window_breaks_added(0),
+  m_window_breaks_saved(0),
   m_store_blocks_written(0),
-  m_registrar(rp)
+  m_has_action(false),
+  m_registrar(&rp),
+  m_regrouper(regrouper),
+  m_regroup_window(regroup_window)
 {
   m_prev_state.m_item_group = 0;
   m_prev_state.m_brush_group = 0;
@@ -405,6 +510,83 @@ per_draw_command(PainterShaderRegistrar &rp,
   m_prev_state.m_blend_shader_type = fastuidraw::PainterBlendShader::number_types;
 }
 
+void
+fastuidraw::PainterPacker::per_draw_command::
+add_to_window(const PainterShaderGroupPrivate &state,
+              const BoundingBox<float> &bounds)
+{
+  detail::DrawRegrouper::Entry E;
+
+  if (m_window.size() >= m_regroup_window)
+    {
+      flush_window();
+    }
+
+  for (E.m_state = 0; E.m_state < m_window_states.size(); ++E.m_state)
+    {
+      if (!state_changes(PainterSurface::color_buffer_type, m_window_states[E.m_state], state))
+        {
+          break;
+        }
+    }
+
+  if (E.m_state == m_window_states.size())
+    {
+      m_window_states.push_back(state);
+    }
+
+  E.m_begin = m_indices_written;
+  E.m_bounds = bounds;
+  m_window.push_back(E);
+}
+
+void
+fastuidraw::PainterPacker::per_draw_command::
+flush_window(void)
+{
+  unsigned int prev_state, changes_before;
+
+  if (m_window.empty())
+    {
+      return;
+    }
+
+  /* if m_prev_state is not a state of the window, prev_state
+   * is a key that does not match any draw of the window.
+   */
+  for (prev_state = 0; prev_state < m_window_states.size(); ++prev_state)
+    {
+      if (!state_changes(PainterSurface::color_buffer_type, m_window_states[prev_state], m_prev_state))
+        {
+          break;
+        }
+    }
+
+  changes_before = detail::DrawRegrouper::number_state_changes(make_c_array(m_window), prev_state);
+  if (m_regrouper->regroup(m_draw_command->m_indices, make_c_array(m_window),
+                           m_indices_written, prev_state))
+    {
+      m_window_breaks_saved += changes_before
+        - detail::DrawRegrouper::number_state_changes(make_c_array(m_window), prev_state);
+    }
+
+  for (const detail::DrawRegrouper::Entry &E : m_window)
+    {
+      const PainterShaderGroupPrivate &current(m_window_states[E.m_state]);
+
+      if (state_changes(PainterSurface::color_buffer_type, m_prev_state, current)
+          && m_draw_command->draw_break(PainterSurface::color_buffer_type,
+                                        m_prev_state, current, E.m_begin))
+        {
+          ++m_window_breaks_added;
+        }
+      m_prev_state = current;
+    }
+
+  m_window.clear();
+  m_window_states.clear();
+}
+
 fastuidraw::c_array<fastuidraw::uvec4>
 fastuidraw::PainterPacker::per_draw_command::
 allocate_store(unsigned int num_elements)
@@ -470,7 +652,7 @@ pack_state_data(enum fastuidraw::PainterSurface::render_type_t render_type,
       return;
     }
 
-  if (d->m_painter[render_type] == p && d->m_draw_command_id[render_type] == p->m_number_commands)
+  if (d->m_painter[render_type] == p && d->m_draw_command_id[render_type] == m_id)
     {
       location = d->m_offset[render_type];
       return;
@@ -488,7 +670,7 @@ pack_state_data(enum fastuidraw::PainterSurface::render_type_t render_type,
   std::copy(src.begin(), src.end(), dst.begin());
 
   d->m_painter[render_type] = p;
-  d->m_draw_command_id[render_type] = p->m_accumulated_draws.size();
+  d->m_draw_command_id[render_type] = m_id;
   d->m_offset[render_type] = location;
 }
 
@@ -529,6 +711,7 @@ pack_header(enum PainterSurface::render_type_t render_type,
             int z,
             const painter_state_location &loc,
             const std::list<reference_counted_ptr<PainterPacker::DataCallBack> > &call_backs,
+            const BoundingBox<float> &bounds,
             unsigned int *header_location)
 {
   bool return_value(false);
@@ -548,13 +731,13 @@ pack_header(enum PainterSurface::render_type_t render_type,
     {
       if (blend_shader)
         {
-          blend = blend_shader->tag(m_registrar);
+          blend = blend_shader->tag(*m_registrar);
           current.m_blend_shader_type = blend_shader->type();
         }
 
       if (brush_shader)
         {
-          brush = brush_shader->tag(m_registrar);
+          brush = brush_shader->tag(*m_registrar);
         }
     }
   else
@@ -569,7 +752,7 @@ pack_header(enum PainterSurface::render_type_t render_type,
         .func_dst(BlendMode::ONE);
     }
 
-  current.m_item_group = item_shader->group(m_registrar);
+  current.m_item_group = item_shader->group(*m_registrar);
   current.m_brush_group = brush.m_group;
   current.m_blend_group = blend.m_group;
   current.m_blend_mode = blend_mode;
@@ -580,7 +763,7 @@ pack_header(enum PainterSurface::render_type_t render_type,
   header.m_item_shader_data_location = loc.m_item_shader_data_loc;
   header.m_blend_shader_data_location = loc.m_blend_shader_data_loc;
   header.m_brush_adjust_location = loc.m_brush_adjust_data_loc;
-  header.m_item_shader = item_shader->ID(m_registrar);
+  header.m_item_shader = item_shader->ID(*m_registrar);
   header.m_brush_shader = brush.m_ID;
   header.m_blend_shader = blend.m_ID;
   header.m_z = z;
@@ -589,19 +772,33 @@ pack_header(enum PainterSurface::render_type_t render_type,
   header.m_deferred_coverage_max = deferred_params.m_deferred_coverage_max;
   header.pack_data(dst);
 
-  if (current.m_item_group != m_prev_state.m_item_group
-      || current.m_blend_mode != m_prev_state.m_blend_mode
-      || (render_type == PainterSurface::color_buffer_type &&
-          (current.m_blend_group != m_prev_state.m_blend_group
-           || current.m_blend_shader_type != m_prev_state.m_blend_shader_type
-           || current.m_brush_group != m_prev_state.m_brush_group) != 0u))
+  if (m_regrouper && render_type == PainterSurface::color_buffer_type)
+    {
+      add_to_window(current, bounds);
+    }
+  else
     {
-      return_value = m_draw_command->draw_break(render_type,
-                                                m_prev_state, current,
-                                                m_indices_written);
+      if (state_changes(render_type, m_prev_state, current))
+        {
+          return_value = m_draw_command->draw_break(render_type,
+                                                    m_prev_state, current,
+                                                    m_indices_written);
+        }
+      m_prev_state = current;
     }
 
-  m_prev_state = current;
+  if (m_opaque)
+    {
+      detail::OpaqueChunkReverser::Chunk C;
+
+      if (return_value)
+        {
+          m_segment_begins.push_back(m_indices_written);
+        }
+      C.m_begin = m_indices_written;
+      C.m_z = z;
+      m_chunks.push_back(C);
+    }
 
   for (const auto &call_back: call_backs)
     {
@@ -642,21 +839,36 @@ active(void) const
 ////////////////////////////////////////////
 // fastuidraw::PainterPacker methods
 fastuidraw::PainterPacker::
-PainterPacker(PainterBrushShader *default_brush_shader,
+PainterPacker(const PainterShaderSet &default_shaders,
               vecN<unsigned int, num_stats> &stats,
+              const reference_counted_ptr<PainterProfiler> &profiler,
               reference_counted_ptr<PainterBackend> backend,
               PainterShaderRegistrar &registrar,
               const PainterEngine::ConfigurationBase &config):
-  m_default_brush_shader(default_brush_shader),
+  m_default_brush_shader(default_shaders.brush_shaders().standard_brush().get()),
   m_backend(backend),
   m_registrar(registrar),
   m_blend_shader(nullptr),
   m_number_commands(0),
   m_clear_color_buffer(false),
-  m_stats(stats)
+  m_reorder_opaque_draws(config.reorder_opaque_draws()),
+  m_reorder_active(false),
+  m_epoch_open(false),
+  m_epoch_begin(0),
+  m_epoch_max_opaque_z(0),
+  m_epoch_max_other_z(0),
+  m_draw_reorder_window(config.draw_reorder_window()),
+  m_stats(stats),
+  m_profiler(profiler),
+  m_record_shader_usage(false)
 {
   m_header_size = PainterHeader::data_size();
   m_binded_images.resize(config.number_context_textures());
+  if (m_reorder_opaque_draws)
+    {
+      m_opaque_classifier = detail::OpaqueDrawClassifier(default_shaders);
+      m_opaque_binded_images.resize(config.number_context_textures());
+    }
 }
 
 fastuidraw::PainterPacker::
@@ -666,35 +878,175 @@ fastuidraw::PainterPacker::
 
 void
 fastuidraw::PainterPacker::
-start_new_command(void)
+unmap_command(per_draw_command &c)
 {
-  if (!m_accumulated_draws.empty())
+  m_stats[PainterEnums::num_attributes] += c.m_attributes_written;
+  m_stats[PainterEnums::num_indices] += c.m_indices_written;
+  m_stats[PainterEnums::num_datas] += c.store_written();
+
+  c.flush_window();
+  m_stats[PainterEnums::num_draws] += c.m_window_breaks_added;
+  m_stats[PainterEnums::num_draw_breaks_saved] += c.m_window_breaks_saved;
+
+  if (c.m_opaque)
     {
-      per_draw_command &c(m_accumulated_draws.back());
+      m_chunk_reverser.reverse_chunks(c.m_draw_command->m_indices.sub_array(0, c.m_indices_written),
+                                      make_c_array(c.m_chunks),
+                                      make_c_array(c.m_segment_begins));
+    }
+  c.unmap();
+}
 
-      m_stats[PainterEnums::num_attributes] += c.m_attributes_written;
-      m_stats[PainterEnums::num_indices] += c.m_indices_written;
-      m_stats[PainterEnums::num_datas] += c.store_written();
+void
+fastuidraw::PainterPacker::
+map_command(bool opaque)
+{
+  std::vector<per_draw_command> &stream(command_stream(opaque));
+  bool regroup;
 
-      c.unmap();
+  if (!stream.empty())
+    {
+      unmap_command(stream.back());
     }
 
+  /* the draws of an opaque command are reordered by z instead */
+  regroup = !opaque
+    && m_draw_reorder_window > 1
+    && m_render_type == PainterSurface::color_buffer_type;
+
   reference_counted_ptr<PainterDraw> r;
   r = m_backend->map_draw();
   ++m_number_commands;
-  m_accumulated_draws.push_back(per_draw_command(m_registrar, r));
+  stream.push_back(per_draw_command(m_registrar, r, m_number_commands, opaque,
+                                    (regroup) ? &m_regrouper : nullptr,
+                                    m_draw_reorder_window));
+
+  if (opaque)
+    {
+      /* the command is drawn before commands created before it,
+       * so it cannot rely on the images they bind.
+       */
+      std::fill(m_opaque_binded_images.begin(), m_opaque_binded_images.end(), nullptr);
+    }
+}
+
+void
+fastuidraw::PainterPacker::
+start_new_command(bool opaque)
+{
+  if (opaque)
+    {
+      /* the chunks of a command are only reordered within the
+       * command, so if a draw spans more than one command
+       * the commands must be in separate epochs.
+       */
+      reorder_barrier();
+      open_epoch();
+    }
+  else
+    {
+      map_command(false);
+    }
+}
+
+void
+fastuidraw::PainterPacker::
+open_epoch(void)
+{
+  FASTUIDRAWassert(m_reorder_active);
+  FASTUIDRAWassert(!m_epoch_open);
+  FASTUIDRAWassert(m_opaque_draws.empty());
+
+  /* the draws already in the last command come before
+   * all draws of the new epoch.
+   */
+  if (m_accumulated_draws.back().has_content())
+    {
+      map_command(false);
+    }
+
+  /* the opaque command binds images of its own which are
+   * bound when the commands of the epoch are drawn.
+   */
+  std::fill(m_binded_images.begin(), m_binded_images.end(), nullptr);
+
+  m_epoch_open = true;
+  m_epoch_begin = m_accumulated_draws.size() - 1;
+  m_epoch_max_opaque_z = m_epoch_max_other_z = std::numeric_limits<int>::min();
+  map_command(true);
+}
+
+void
+fastuidraw::PainterPacker::
+reorder_barrier(void)
+{
+  if (!m_epoch_open)
+    {
+      return;
+    }
+
+  FASTUIDRAWassert(m_opaque_draws.size() == 1);
+  unmap_command(m_opaque_draws.back());
+  m_accumulated_draws.insert(m_accumulated_draws.begin() + m_epoch_begin,
+                             m_opaque_draws.back());
+  m_opaque_draws.clear();
+  m_epoch_open = false;
+}
+
+void
+fastuidraw::PainterPacker::
+begin_opaque_draw(int z)
+{
+  /* The opaque draws of an epoch are drawn before its other
+   * draws and in reverse order; this is only correct if
+   * the depth test gives the same result, i.e. if a later
+   * opaque draw has a z-value that is not smaller than
+   * the z-value of the previous opaque draws and larger
+   * than the z-value of the previous other draws.
+   */
+  if (m_epoch_open
+      && (z < m_epoch_max_opaque_z || z <= m_epoch_max_other_z))
+    {
+      reorder_barrier();
+    }
+
+  if (!m_epoch_open)
+    {
+      open_epoch();
+    }
+  m_epoch_max_opaque_z = t_max(m_epoch_max_opaque_z, z);
+}
+
+void
+fastuidraw::PainterPacker::
+note_shader_usage(PainterItemShader *shader, unsigned int num_indices)
+{
+  unsigned int ID;
+
+  if (!m_record_shader_usage)
+    {
+      return;
+    }
+
+  ID = shader->ID(m_registrar);
+  if (ID >= m_item_shader_usage.size())
+    {
+      m_item_shader_usage.resize(ID + 1, 0u);
+    }
+  m_item_shader_usage[ID] += num_indices;
 }
 
 template<typename T>
 unsigned int
 fastuidraw::PainterPacker::
-compute_room_needed_for_packing(const PainterDataValue<T> &obj)
+compute_room_needed_for_packing(const PainterDataValue<T> &obj,
+                                unsigned int command_id)
 {
   if (obj.m_packed_value)
     {
       detail::PackedValuePoolBase::ElementBase *d;
       d = static_cast<detail::PackedValuePoolBase::ElementBase*>(obj.m_packed_value.opaque_data());
-      if (d->m_painter[m_render_type] == this && d->m_draw_command_id[m_render_type] == m_number_commands)
+      if (d->m_painter[m_render_type] == this && d->m_draw_command_id[m_render_type] == command_id)
         {
           return 0;
         }
@@ -722,54 +1074,57 @@ compute_room_needed_for_packing(const detail::PackedValuePoolBase::ElementBase*
 
 unsigned int
 fastuidraw::PainterPacker::
-compute_room_needed_for_packing(const PainterPackerData &draw_state)
+compute_room_needed_for_packing(const PainterPackerData &draw_state,
+                                unsigned int command_id)
 {
   unsigned int R(0);
   R += compute_room_needed_for_packing(draw_state.m_clip);
   R += compute_room_needed_for_packing(draw_state.m_matrix);
-  R += compute_room_needed_for_packing(draw_state.m_item_shader_data);
+  R += compute_room_needed_for_packing(draw_state.m_item_shader_data, command_id);
 
   if (m_render_type == PainterSurface::color_buffer_type)
     {
-      R += compute_room_needed_for_packing(draw_state.m_brush.brush_shader_data());
-      R += compute_room_needed_for_packing(draw_state.m_blend_shader_data);
+      R += compute_room_needed_for_packing(draw_state.m_brush.brush_shader_data(), command_id);
+      R += compute_room_needed_for_packing(draw_state.m_blend_shader_data, command_id);
     }
   return R;
 }
 
 bool
 fastuidraw::PainterPacker::
-upload_draw_state(const PainterPackerData &draw_state)
+upload_draw_state(const PainterPackerData &draw_state, bool opaque)
 {
   unsigned int needed_room;
   bool return_value(false);
+  std::vector<per_draw_command> &stream(command_stream(opaque));
 
-  FASTUIDRAWassert(!m_accumulated_draws.empty());
-  needed_room = compute_room_needed_for_packing(draw_state);
-  if (needed_room > m_accumulated_draws.back().store_room())
+  FASTUIDRAWassert(!stream.empty());
+  needed_room = compute_room_needed_for_packing(draw_state, stream.back().m_id);
+  if (needed_room > stream.back().store_room())
     {
-      start_new_command();
+      start_new_command(opaque);
       return_value = true;
     }
-  m_accumulated_draws.back().pack_painter_state(m_render_type, draw_state,
-                                                this, m_painter_state_location);
+  stream.back().pack_painter_state(m_render_type, draw_state,
+                                   this, m_painter_state_location);
 
   if (m_render_type == PainterSurface::color_buffer_type)
     {
       c_array<const reference_counted_ptr<const Image> > images;
+      std::vector<const Image*> &bound(binded_images(opaque));
 
       images = draw_state.m_brush.brush_shader_data().bind_images();
-      for (unsigned int i = 0, endi = t_min(images.size(), m_binded_images.size()); i < endi; ++i)
+      for (unsigned int i = 0, endi = t_min(images.size(), bound.size()); i < endi; ++i)
         {
           if (images[i]
-              && m_binded_images[i] != images[i].get()
+              && bound[i] != images[i].get()
               && images[i]->type() == Image::context_texture2d)
             {
               reference_counted_ptr<PainterDrawBreakAction> action;
 
-              m_binded_images[i] = images[i].get();
+              bound[i] = images[i].get();
               action = m_backend->bind_image(i, images[i]);
-              if (m_accumulated_draws.back().draw_break(action))
+              if (stream.back().draw_break(action))
                 {
                   ++m_stats[PainterEnums::num_draws];
                 }
@@ -794,6 +1149,18 @@ draw_generic_implement(const DeferredCoverageReadParams &deferred_params,
   PainterAttributeWriter::WriteState write_state;
   int last_z_begin(0), max_z_end(0);
   ShaderType *shader;
+  bool opaque;
+  BlendMode blend_mode;
+  BoundingBox<float> bounds;
+  const PainterBrushShader *brush_shader;
+  const PainterShader *first_shader;
+  uint64_t pack_start(0);
+  unsigned int number_headers(0), number_indices(0);
+
+  if (m_profiler)
+    {
+      pack_start = m_profiler->time_now();
+    }
 
   state_length = src.state_length();
   m_work_room.m_state_values.resize(state_length);
@@ -814,8 +1181,47 @@ draw_generic_implement(const DeferredCoverageReadParams &deferred_params,
       /* should we emit a warning message that there was no shader? */
       return 0;
     }
+  first_shader = shader;
+
+  brush_shader = draw.m_brush.brush_shader();
+  if (!brush_shader)
+    {
+      brush_shader = m_default_brush_shader;
+    }
+
+  /* A draw is only reordered if it is opaque and its z-value
+   * is not changed later by a DataCallBack (which is how the
+   * z-values of occluders are set).
+   */
+  opaque = m_reorder_active
+    && m_callback_list.empty()
+    && source_allows_reorder(src)
+    && is_opaque_draw(shader, draw);
+
+  blend_mode = m_blend_mode;
+  if (opaque)
+    {
+      begin_opaque_draw(z + write_state.m_z_range.m_begin);
+      if (m_blend_shader->type() == PainterBlendShader::single_src)
+        {
+          /* the draw ignores the destination, so blending
+           * can be skipped by the 3D API.
+           */
+          blend_mode = BlendMode().blending_on(false);
+        }
+    }
+
+  std::vector<per_draw_command> &stream(command_stream(opaque));
+
+  /* the draws of occluders are regarded as covering everything
+   * so that draws are not regrouped across them.
+   */
+  if (m_callback_list.empty())
+    {
+      bounds = draw.m_bounds;
+    }
 
-  upload_draw_state(draw);
+  upload_draw_state(draw, opaque);
   allocate_header = true;
   data_to_write = true;
 
@@ -824,20 +1230,20 @@ draw_generic_implement(const DeferredCoverageReadParams &deferred_params,
       unsigned int attrib_room, index_room, data_room;
       bool started_new_command;
 
-      attrib_room = m_accumulated_draws.back().attribute_room();
-      index_room = m_accumulated_draws.back().index_room();
-      data_room = m_accumulated_draws.back().store_room();
+      attrib_room = stream.back().attribute_room();
+      index_room = stream.back().index_room();
+      data_room = stream.back().store_room();
 
       if (attrib_room < write_state.m_min_attributes_for_next
           || index_room < write_state.m_min_indices_for_next
           || (allocate_header && data_room < m_header_size))
         {
-          start_new_command();
+          start_new_command(opaque);
 
           src.on_new_store(&write_state);
-          attrib_room = m_accumulated_draws.back().attribute_room();
-          index_room = m_accumulated_draws.back().index_room();
-          data_room = m_accumulated_draws.back().store_room();
+          attrib_room = stream.back().attribute_room();
+          index_room = stream.back().index_room();
+          data_room = stream.back().store_room();
           allocate_header = true;
 
           if (attrib_room < write_state.m_min_attributes_for_next
@@ -848,36 +1254,37 @@ draw_generic_implement(const DeferredCoverageReadParams &deferred_params,
               return max_z_end;
             }
 
-          started_new_command = upload_draw_state(draw);
+          started_new_command = upload_draw_state(draw, opaque);
           FASTUIDRAWassert(!started_new_command);
           FASTUIDRAWunused(started_new_command);
           FASTUIDRAWassert(data_room >= m_header_size);
         }
 
-      per_draw_command &cmd(m_accumulated_draws.back());
+      per_draw_command &cmd(stream.back());
       if (allocate_header)
         {
           bool draw_break_added;
-          const PainterBrushShader *brush_shader;
 
           ++m_stats[PainterEnums::num_headers];
+          ++number_headers;
           allocate_header = false;
-          brush_shader = draw.m_brush.brush_shader();
-          if (!brush_shader)
-            {
-              brush_shader = m_default_brush_shader;
-            }
           draw_break_added = cmd.pack_header(m_render_type, m_header_size,
                                              deferred_params,
                                              brush_shader,
-                                             m_blend_shader, m_blend_mode,
+                                             m_blend_shader, blend_mode,
                                              shader,
                                              z + write_state.m_z_range.m_begin,
                                              m_painter_state_location,
                                              m_callback_list,
+                                             bounds,
                                              &header_loc);
           last_z_begin = write_state.m_z_range.m_begin;
           max_z_end = t_max(max_z_end, write_state.m_z_range.m_end);
+          if (m_epoch_open && !opaque)
+            {
+              m_epoch_max_other_z = t_max(m_epoch_max_other_z,
+                                          z + write_state.m_z_range.m_begin);
+            }
           if (draw_break_added)
             {
               ++m_stats[PainterEnums::num_draws];
@@ -909,6 +1316,8 @@ draw_generic_implement(const DeferredCoverageReadParams &deferred_params,
       /* update how many indices and attributes have been written to cmd */
       cmd.m_attributes_written += num_attribs_written;
       cmd.m_indices_written += num_indices_written;
+      number_indices += num_indices_written;
+      note_shader_usage(shader, num_indices_written);
 
       ShaderType *next_shader;
       next_shader = get_shader<ShaderType>(pshader, write_state);
@@ -921,6 +1330,17 @@ draw_generic_implement(const DeferredCoverageReadParams &deferred_params,
         }
     }
 
+  if (m_profiler)
+    {
+      /* the draw is attributed to the shader it started
+       * with even if the source changed the shader while
+       * writing its data.
+       */
+      m_profiler->add_pack_sample(first_shader, first_shader->group(m_registrar), brush_shader,
+                                  number_headers, number_indices,
+                                  m_profiler->time_now() - pack_start);
+    }
+
   return max_z_end;
 }
 
@@ -936,6 +1356,11 @@ add_callback(const reference_counted_ptr<DataCallBack> &callback)
       return;
     }
 
+  /* the callback can change the z-values of the draws
+   * packed while it is active, see begin_opaque_draw().
+   */
+  reorder_barrier();
+
   cd = static_cast<DataCallBackPrivate*>(callback->m_d);
   cd->m_list = &m_callback_list;
   cd->m_iterator = cd->m_list->insert(cd->m_list->begin(), callback);
@@ -978,6 +1403,11 @@ begin(const reference_counted_ptr<PainterSurface> &surface,
   m_render_type = m_surface->render_type();
   m_clear_color_buffer = clear_color_buffer;
   m_begin_new_target = true;
+  m_reorder_active = m_reorder_opaque_draws
+    && m_render_type == PainterSurface::color_buffer_type;
+  m_record_shader_usage = m_registrar.record_item_shader_usage()
+    && m_render_type == PainterSurface::color_buffer_type;
+  m_epoch_open = false;
   start_new_command();
   m_last_binded_cvg_image = nullptr;
 }
@@ -986,13 +1416,10 @@ void
 fastuidraw::PainterPacker::
 flush_implement(void)
 {
+  reorder_barrier();
   if (!m_accumulated_draws.empty())
     {
-      per_draw_command &c(m_accumulated_draws.back());
-      m_stats[PainterEnums::num_attributes] += c.m_attributes_written;
-      m_stats[PainterEnums::num_indices] += c.m_indices_written;
-      m_stats[PainterEnums::num_datas] += c.store_written();
-      c.unmap();
+      unmap_command(m_accumulated_draws.back());
     }
 
   m_stats[PainterEnums::num_draws] += m_accumulated_draws.size();
@@ -1014,7 +1441,8 @@ void
 fastuidraw::PainterPacker::
 flush(bool clear_z)
 {
-  if (m_accumulated_draws.size() > 1
+  if (m_epoch_open
+      || m_accumulated_draws.size() > 1
       || m_accumulated_draws.back().m_attributes_written > 0
       || m_accumulated_draws.back().m_indices_written > 0)
     {
@@ -1031,6 +1459,12 @@ end(void)
   flush_implement();
   m_backend->on_post_draw();
   m_surface.clear();
+
+  if (!m_item_shader_usage.empty())
+    {
+      m_registrar.add_item_shader_usage(make_c_array(m_item_shader_usage));
+      std::fill(m_item_shader_usage.begin(), m_item_shader_usage.end(), 0u);
+    }
 }
 
 const fastuidraw::reference_counted_ptr<fastuidraw::PainterSurface>&
@@ -1044,6 +1478,10 @@ void
 fastuidraw::PainterPacker::
 draw_break(const reference_counted_ptr<const PainterDrawBreakAction> &action)
 {
+  /* the action must execute after the opaque draws packed
+   * before it and before those packed after it.
+   */
+  reorder_barrier();
   if (m_accumulated_draws.back().draw_break(action))
     {
       ++m_stats[PainterEnums::num_draws];
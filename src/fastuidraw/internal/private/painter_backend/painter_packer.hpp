@@ -44,6 +44,8 @@
 #include <fastuidraw/painter/backend/painter_header.hpp>
 
 #include <private/painter_backend/painter_packer_data.hpp>
+#include <private/painter_backend/painter_opaque_draws.hpp>
+#include <private/painter_backend/painter_draw_regrouper.hpp>
 
 namespace fastuidraw
 {
@@ -66,7 +68,7 @@ namespace fastuidraw
          * supported. Sync this with the last enumeration
          * in PainterEnums::query_stats_t
          */
-        num_stats = PainterEnums::num_deferred_coverages + 1
+        num_stats = PainterEnums::num_draw_breaks_saved + 1
       };
 
     /*!
@@ -131,13 +133,21 @@ namespace fastuidraw
 
     /*!
      * Ctor.
+     * \param default_shaders default shaders of the Painter; provides
+     *                        the brush shader to use when a brush does
+     *                        not specify one and the shaders with which
+     *                        draws can be opaque
      * \param stats location to which to update stat values
+     * \param profiler reference to the profiler to which to report
+     *                 the packing of each draw; the reference must
+     *                 stay valid for the lifetime of the PainterPacker
      * \param backend handle to PainterBackend for the constructed PainterPacker
      * \param config configuration from PainterEngine
      */
     explicit
-    PainterPacker(PainterBrushShader *default_brush_shader,
+    PainterPacker(const PainterShaderSet &default_shaders,
                   vecN<unsigned int, num_stats> &stats,
+                  const reference_counted_ptr<PainterProfiler> &profiler,
                   reference_counted_ptr<PainterBackend> backend,
                   PainterShaderRegistrar &registrar,
                   const PainterEngine::ConfigurationBase &config);
@@ -414,18 +424,87 @@ namespace fastuidraw
       std::vector<unsigned int> m_state_values;
     };
 
+    /* Unmap the last command of the opaque stream (if opaque is
+     * true) or of m_accumulated_draws and map a new command for it.
+     */
+    void
+    map_command(bool opaque);
+
+    /* Start a new command to which to add draws; when opaque is
+     * true, the current epoch is closed and a new one opened so
+     * that an epoch only ever has one opaque command.
+     */
+    void
+    start_new_command(bool opaque = false);
+
+    void
+    unmap_command(per_draw_command &c);
+
+    /* Open an epoch: the draws of an epoch classified as opaque
+     * are drawn (front to back) before the other draws of the
+     * epoch; the opaque draws go to m_opaque_draws and the other
+     * draws go to the commands of m_accumulated_draws starting at
+     * m_epoch_begin.
+     */
+    void
+    open_epoch(void);
+
+    /* Close the current epoch by placing its opaque command
+     * into m_accumulated_draws at m_epoch_begin; to be called
+     * before adding anything whose order relative to the
+     * draws before and after it must not change.
+     */
+    void
+    reorder_barrier(void);
+
+    /* To be called before a draw classified as opaque of the
+     * given z-value is added.
+     */
+    void
+    begin_opaque_draw(int z);
+
+    bool
+    is_opaque_draw(PainterItemShader *shader, const PainterPackerData &data) const
+    {
+      return m_opaque_classifier.is_opaque(shader, m_blend_shader, data.m_brush);
+    }
+
+    bool
+    is_opaque_draw(PainterItemCoverageShader*, const PainterPackerData&) const
+    {
+      return false;
+    }
+
+    std::vector<per_draw_command>&
+    command_stream(bool opaque)
+    {
+      return (opaque) ? m_opaque_draws : m_accumulated_draws;
+    }
+
+    std::vector<const Image*>&
+    binded_images(bool opaque)
+    {
+      return (opaque) ? m_opaque_binded_images : m_binded_images;
+    }
+
     void
-    start_new_command(void);
+    note_shader_usage(PainterItemShader *shader, unsigned int num_indices);
+
+    void
+    note_shader_usage(PainterItemCoverageShader*, unsigned int)
+    {}
 
     bool //return true if it started a new command
-    upload_draw_state(const PainterPackerData &draw_state);
+    upload_draw_state(const PainterPackerData &draw_state, bool opaque);
 
     unsigned int
-    compute_room_needed_for_packing(const PainterPackerData &draw_state);
+    compute_room_needed_for_packing(const PainterPackerData &draw_state,
+                                    unsigned int command_id);
 
     template<typename T>
     unsigned int
-    compute_room_needed_for_packing(const PainterDataValue<T> &obj);
+    compute_room_needed_for_packing(const PainterDataValue<T> &obj,
+                                    unsigned int command_id);
 
     unsigned int
     compute_room_needed_for_packing(const detail::PackedValuePoolBase::ElementBase* d);
@@ -459,8 +538,36 @@ namespace fastuidraw
     std::vector<per_draw_command> m_accumulated_draws;
     reference_counted_ptr<PainterSurface> m_last_binded_cvg_image;
 
+    /* state for drawing opaque draws front to back, see
+     * PainterEngine::ConfigurationBase::reorder_opaque_draws().
+     * m_opaque_draws holds at most one command, the opaque
+     * command of the current epoch.
+     */
+    bool m_reorder_opaque_draws, m_reorder_active;
+    detail::OpaqueDrawClassifier m_opaque_classifier;
+    detail::OpaqueChunkReverser m_chunk_reverser;
+    std::vector<per_draw_command> m_opaque_draws;
+    std::vector<const Image*> m_opaque_binded_images;
+    bool m_epoch_open;
+    unsigned int m_epoch_begin;
+    int m_epoch_max_opaque_z, m_epoch_max_other_z;
+
+    /* state for regrouping draws by shader state, see
+     * PainterEngine::ConfigurationBase::draw_reorder_window().
+     */
+    unsigned int m_draw_reorder_window;
+    detail::DrawRegrouper m_regrouper;
+
     Workroom m_work_room;
     vecN<unsigned int, num_stats> &m_stats;
+    const reference_counted_ptr<PainterProfiler> &m_profiler;
+
+    /* item shader usage is recorded only if the registrar
+     * asks for it, see PainterShaderRegistrar::record_item_shader_usage();
+     * the value is fetched at begin().
+     */
+    bool m_record_shader_usage;
+    std::vector<uint64_t> m_item_shader_usage;
 
     std::list<reference_counted_ptr<PainterPacker::DataCallBack> > m_callback_list;
   };
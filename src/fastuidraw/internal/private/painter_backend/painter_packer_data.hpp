@@ -22,6 +22,7 @@
 #include <fastuidraw/painter/shader_data/painter_data.hpp>
 #include <fastuidraw/painter/backend/painter_brush_adjust.hpp>
 #include <private/painter_backend/painter_packed_value_pool_private.hpp>
+#include <private/bounding_box.hpp>
 
 namespace fastuidraw
 {
@@ -67,6 +68,13 @@ namespace fastuidraw
      * value for the brush adjust
      */
     detail::PackedValuePool<fastuidraw::PainterBrushAdjust>::ElementHandle m_brush_adjust;
+
+    /*!
+     * Bounding box, in normalized device coordinates, that
+     * contains all fragments of the draw. An empty box indicates
+     * that the bounds are not known.
+     */
+    BoundingBox<float> m_bounds;
   };
 
 /*! @} */
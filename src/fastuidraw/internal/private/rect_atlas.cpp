@@ -18,319 +18,194 @@
  */
 
 #include <algorithm>
-#include <ciso646>
 
 #include <private/rect_atlas.hpp>
 
-
-namespace
+////////////////////////////////////////
+// fastuidraw::detail::RectAtlas methods
+fastuidraw::detail::RectAtlas::
+RectAtlas(const ivec2 &dimensions):
+  m_dimensions(dimensions),
+  m_next_shelf_y(0),
+  m_replaying(true),
+  m_number_replayed(0)
 {
-  /*
-   * Tree structure to construct the texture atlas,
-   * basic idea is very simple: walk the tree until one finds
-   * a node where the image can fit.
-   *
-   * if .second is routine_fail, then the routine
-   * failed.
-   *
-   * If .first of the return value of add or remove
-   * is not the same as the object, then the return value
-   * represents a new child and the old object should be deleted.
-   *
-   * if .first of the return value of add or remove
-   * is the same as the object, then the routine succeeded
-   * and the object should not be deleted.
-   */
-
-  /* a NodeWithoutChildren represents
-   * a Node which has NO child Node's
-   * but may or maynot have a rectangle.
-   */
-
-  /* a tree node with children has _3_ children.
-   * they are spawned when a tree_node_wihout_children
-   * has a rectangle added but it already has a rectangle.
-   */
 }
 
-////////////////////////////////
-// fastuidraw::detail::RectAtlas::NodeBase methods
-fastuidraw::detail::RectAtlas::NodeBase*
-fastuidraw::detail::RectAtlas::NodeBase::
-add(MemoryPool &pool, Rectangle *rect)
+int
+fastuidraw::detail::RectAtlas::
+height_class(int h) const
 {
-  /* We are doing a very, very simple quick rejection
-   * test where we reject any rectangle which has
-   * area larger than this's area() or if any of the
-   * dimensions are greater than this's size. This
-   * is far from ideal, and the correct thing would be
-   * to create bins (perhaps keyed by log2) in each
-   * dimension to quickly choose a node to split.
-   * This would prevent the tree walk entirely and
-   * then the root would need a list of nodes
-   * available and the ability to remove elements
-   * from the lists fast (perhaps std::map<K, std::list>)
-   * would work. Only the creation of objects of
-   * type NodeWithoutChildren would modify the
-   * list, as would their deconsuction.
-   */
-  if (rect->area() <= biggest_possible_rectangle()->biggest_possible()
-      && rect->size().x() <= widest_possible_rectangle()->widest_possible()
-      && rect->size().y() <= tallest_possible_rectangle()->tallest_possible())
-    {
-      NodeBase *return_value;
+  int granularity(1);
 
-      return_value = add_implement(pool, rect);
-      return return_value;
-    }
-  else
+  /* round up to a multiple of the largest power of 2
+   * that is no more than h / 8, so that the height
+   * wasted in a shelf is at most 1/8 of its height.
+   */
+  while (8 * granularity * 2 <= h)
     {
-      return nullptr;
+      granularity *= 2;
     }
-}
 
-//////////////////////////////////////
-// fastuidraw::detail::RectAtlas::NodeWithoutChildren methods
-fastuidraw::detail::RectAtlas::NodeWithoutChildren::
-NodeWithoutChildren(const ivec2 &bl, const ivec2 &sz, Rectangle *rect):
-  NodeBase(bl, sz),
-  m_rectangle(rect)
-{
-  m_widest = m_tallest = m_biggest = this;
+  h = granularity * ((h + granularity - 1) / granularity);
+  return t_min(h, m_dimensions.y());
 }
 
-fastuidraw::detail::RectAtlas::Rectangle*
-fastuidraw::detail::RectAtlas::NodeWithoutChildren::
-data(void)
+void
+fastuidraw::detail::RectAtlas::
+reset_packer(void)
 {
-  return m_rectangle;
+  m_shelves.clear();
+  m_classes.clear();
+  m_next_shelf_y = 0;
 }
 
-fastuidraw::detail::RectAtlas::NodeBase*
-fastuidraw::detail::RectAtlas::NodeWithoutChildren::
-add_implement(MemoryPool &pool, Rectangle *im)
+void
+fastuidraw::detail::RectAtlas::
+clear(void)
 {
-  FASTUIDRAWassert(im->size().x() <= size().x());
-  FASTUIDRAWassert(im->size().y() <= size().y());
-
-  if (m_rectangle == nullptr)
-    {
-      //do not have a rect so we take it (and move it).
-      m_rectangle = im;
-      m_rectangle->move(minX_minY());
-
-      return this;
-    }
-
-  //we have a rectangle already, we need to check
-  //if we can split in such a way to take im:
-  int dx, dy;
-  bool split_y_works, split_x_works;
-
-  dx = size().x() - m_rectangle->size().x();
-  dy = size().y() - m_rectangle->size().y();
-
-  split_y_works = (dy >= im->size().y());
-  split_x_works = (dx >= im->size().x());
-
-  if (!split_x_works && !split_y_works)
-    {
-      return nullptr;
-    }
-
-  if (split_x_works && split_y_works)
-    {
-      //choose a split that is nicest
-      //by making the other split false.
-
-      //whoever has the most room left over is the split.
-      if (dx > dy)
-        {
-          split_y_works = false;
-        }
-      else
-        {
-          split_x_works = false;
-        }
-    }
-
-  NodeBase *new_node;
-
-  //new_node will hold this->m_rectange:
-  new_node = pool.create_node_with_children(this, split_x_works, split_y_works);
-
-  //add the new rectangle im to new_node:
-  new_node = new_node->add(pool, im);
-  FASTUIDRAWassert(new_node);
-
-  return new_node;
+  clear(m_dimensions);
 }
 
-////////////////////////////////////
-// NodeWithChildren methods
-fastuidraw::detail::RectAtlas::NodeWithChildren::
-NodeWithChildren(MemoryPool &pool,
-                 NodeWithoutChildren *src,
-                 bool split_x_works, bool split_y_works):
-  NodeBase(src->minX_minY(), src->size()),
-  m_children(nullptr, nullptr, nullptr)
+void
+fastuidraw::detail::RectAtlas::
+clear(ivec2 dimensions)
 {
-  Rectangle *R(src->data());
-  FASTUIDRAWassert(R != nullptr);
-
-  m_children[2] = pool.create_node_without_children(R->minX_minY(), R->size(), R);
-
-  /* Perhaps we should consider delaying creating m_children[0] and m_children[1]
-   * until the first request come to this to add a rectangle so that we can
-   * possibly take a bigger rectangle.
-   */
-  if (split_x_works)
+  reset_packer();
+  if (dimensions == m_dimensions)
     {
-      m_children[0]
-        = pool.create_node_without_children(ivec2(minX_minY().x(), minX_minY().y() + R->size().y()),
-                                            ivec2(R->size().x(), size().y() - R->size().y()) );
-
-      m_children[1]
-        = pool.create_node_without_children(ivec2(minX_minY().x() + R->size().x(), minX_minY().y()),
-                                            ivec2(size().x() - R->size().x(), size().y()) );
+      m_previous_allocations.swap(m_allocations);
     }
   else
     {
-      FASTUIDRAWassert(split_y_works);
-      FASTUIDRAWunused(split_y_works);
-
-      m_children[0]
-        = pool.create_node_without_children(ivec2(minX_minY().x() + R->size().x(), minX_minY().y()),
-                                            ivec2(size().x() - R->size().x(), R->size().y()) );
-
-      m_children[1]
-        = pool.create_node_without_children(ivec2(minX_minY().x(), minX_minY().y() + R->size().y()),
-                                            ivec2(size().x(), size().y() - R->size().y()) );
+      m_previous_allocations.clear();
+      m_dimensions = dimensions;
     }
-
-  std::sort(m_children.begin(), m_children.end(), NodeSorter());
-  recompute_possible();
+  m_allocations.clear();
+  m_replaying = true;
+  m_number_replayed = 0;
 }
 
-fastuidraw::detail::RectAtlas::NodeBase*
-fastuidraw::detail::RectAtlas::NodeWithChildren::
-add_implement(MemoryPool &pool, Rectangle *im)
+fastuidraw::ivec2
+fastuidraw::detail::RectAtlas::
+add_rectangle(const ivec2 &dimensions)
 {
-  NodeBase *R;
-  for(int i = 0; i < 3; ++i)
+  ivec2 return_value;
+
+  if (dimensions.x() <= 0 || dimensions.y() <= 0)
     {
-      R = m_children[i]->add(pool, im);
-      if (R)
-        {
-          m_children[i] = R;
-          recompute_possible();
-          return this;
-        }
+      return ivec2(0, 0);
     }
 
-  return nullptr;
-}
-
-void
-fastuidraw::detail::RectAtlas::NodeWithChildren::
-recompute_possible(void)
-{
-  m_widest = m_children[0]->widest_possible_rectangle();
-  m_tallest = m_children[0]->tallest_possible_rectangle();
-  m_biggest = m_children[0]->biggest_possible_rectangle();
-
-  for (int i = 1; i < 3; ++i)
+  if (m_replaying)
     {
-      NodeWithoutChildren *p;
+      unsigned int idx(m_allocations.size());
 
-      p = m_children[i]->widest_possible_rectangle();
-      if (p->widest_possible() > m_widest->widest_possible())
+      if (idx < m_previous_allocations.size()
+          && m_previous_allocations[idx].m_size == dimensions)
         {
-          m_widest = p;
+          return_value = m_previous_allocations[idx].m_location;
+          m_allocations.push_back(Allocation(dimensions, return_value));
+          return return_value;
         }
 
-      p = m_children[i]->tallest_possible_rectangle();
-      if (p->tallest_possible() > m_tallest->tallest_possible())
+      /* the sequence differs from the previous one, bring the
+       * packer state up to date with the rectangles so far;
+       * the packer is deterministic, so it places them where
+       * they were taken from.
+       */
+      m_replaying = false;
+      m_number_replayed = m_allocations.size();
+      for (const Allocation &A : m_allocations)
         {
-          m_tallest = p;
-        }
+          ivec2 R;
 
-      p = m_children[i]->biggest_possible_rectangle();
-      if (p->biggest_possible() > m_biggest->biggest_possible())
-        {
-          m_biggest = p;
+          R = pack_rectangle(A.m_size);
+          FASTUIDRAWassert(R == A.m_location);
+          FASTUIDRAWunused(R);
         }
     }
-}
 
-////////////////////////////////////
-// fastuidraw::detail::RectAtlas methods
-fastuidraw::detail::RectAtlas::
-RectAtlas(const ivec2 &dimensions)
-{
-  m_root = m_pool.create_node_without_children(ivec2(0,0), dimensions, nullptr);
-}
-
-fastuidraw::detail::RectAtlas::
-~RectAtlas()
-{
+  return_value = pack_rectangle(dimensions);
+  m_allocations.push_back(Allocation(dimensions, return_value));
+  return return_value;
 }
 
 fastuidraw::ivec2
 fastuidraw::detail::RectAtlas::
-size(void) const
+pack_rectangle(const ivec2 &dimensions)
 {
-  return m_root->size();
-}
+  std::vector<ShelfClass>::iterator iter;
+  int h;
 
-void
-fastuidraw::detail::RectAtlas::
-clear(void)
-{
-  clear(size());
-}
+  if (dimensions.x() > m_dimensions.x() || dimensions.y() > m_dimensions.y())
+    {
+      return ivec2(-1, -1);
+    }
 
-void
-fastuidraw::detail::RectAtlas::
-clear(ivec2 dimensions)
-{
-  m_pool.clear();
-  m_root = m_pool.create_node_without_children(ivec2(0,0), dimensions, nullptr);
-}
+  h = height_class(dimensions.y());
+  iter = std::lower_bound(m_classes.begin(), m_classes.end(), ShelfClass(h, 0));
+  if (iter != m_classes.end() && iter->m_height == h
+      && m_shelves[iter->m_shelf].m_used_width + dimensions.x() <= m_dimensions.x())
+    {
+      Shelf &shelf(m_shelves[iter->m_shelf]);
+      ivec2 return_value(shelf.m_used_width, shelf.m_y);
 
-fastuidraw::ivec2
-fastuidraw::detail::RectAtlas::
-add_rectangle(const ivec2 &dimensions)
-{
-  Rectangle *return_value(nullptr);
-  NodeBase *R;
+      shelf.m_used_width += dimensions.x();
+      return return_value;
+    }
 
-  if (dimensions.x() > 0 && dimensions.y() > 0)
+  if (m_next_shelf_y + h <= m_dimensions.y())
     {
-      //attempt to add the rect:
-      return_value = m_pool.create_rectangle(dimensions);
-      R = m_root->add(m_pool, return_value);
+      unsigned int shelf_idx(m_shelves.size());
 
-      if (R)
+      m_shelves.push_back(Shelf(m_next_shelf_y, h));
+      m_shelves.back().m_used_width = dimensions.x();
+      m_next_shelf_y += h;
+
+      if (iter != m_classes.end() && iter->m_height == h)
         {
-          m_root = R;
+          iter->m_shelf = shelf_idx;
         }
       else
         {
-          return_value = nullptr;
+          m_classes.insert(iter, ShelfClass(h, shelf_idx));
         }
+      return ivec2(0, m_shelves.back().m_y);
     }
-  else
+
+  /* a last shelf of just the height left, which is not
+   * made the current shelf of its height class
+   */
+  if (m_next_shelf_y + dimensions.y() <= m_dimensions.y())
     {
-      return ivec2(0, 0);
+      m_shelves.push_back(Shelf(m_next_shelf_y, m_dimensions.y() - m_next_shelf_y));
+      m_shelves.back().m_used_width = dimensions.x();
+      m_next_shelf_y = m_dimensions.y();
+      return ivec2(0, m_shelves.back().m_y);
     }
 
-  if (return_value)
+  /* no room for a new shelf, take the shortest shelf
+   * that has room for the rectangle.
+   */
+  Shelf *best(nullptr);
+  for (Shelf &shelf : m_shelves)
     {
-      return return_value->minX_minY();
+      if (shelf.m_height >= dimensions.y()
+          && shelf.m_used_width + dimensions.x() <= m_dimensions.x()
+          && (!best || shelf.m_height < best->m_height))
+        {
+          best = &shelf;
+        }
     }
-  else
+
+  if (best)
     {
-      return ivec2(-1, -1);
+      ivec2 return_value(best->m_used_width, best->m_y);
+
+      best->m_used_width += dimensions.x();
+      return return_value;
     }
+
+  return ivec2(-1, -1);
 }
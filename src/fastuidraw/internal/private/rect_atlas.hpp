@@ -20,25 +20,34 @@
 #ifndef FASTUIDRAW_RECT_ATLAS_HPP
 #define FASTUIDRAW_RECT_ATLAS_HPP
 
-#include <list>
-#include <map>
+#include <vector>
 
-#include <fastuidraw/util/util.hpp>
-#include <fastuidraw/util/reference_counted.hpp>
 #include <fastuidraw/util/util.hpp>
 #include <fastuidraw/util/vecN.hpp>
 #include <fastuidraw/util/c_array.hpp>
 
-#include <private/util_private.hpp>
-#include <private/simple_pool.hpp>
-
 
 namespace fastuidraw {
 namespace detail {
 
 /*!\class RectAtlas
- * Provides an interface to allocate and free rectangle
- * regions from a large rectangle.
+ * Provides an interface to allocate rectangle regions from a
+ * large rectangle; regions are freed all at once by clear().
+ *
+ * The regions are packed into horizontal shelves. The height of
+ * a rectangle is rounded up to a height class (within 1/8 of the
+ * height) and each height class has a current shelf to which the
+ * rectangles of the class are added left to right, so that finding
+ * where to place a rectangle is a binary search over the height
+ * classes. Only when no new shelf fits, is every shelf searched.
+ * All the book-keeping is in arrays whose memory is kept across
+ * clear().
+ *
+ * In addition, the sequence of rectangles added between two calls
+ * to clear() is remembered; if after clear() the same sizes are
+ * requested in the same order, the same locations are returned
+ * without running the packer at all. The packer is only run (on
+ * the rectangles added so far) when a request first differs.
  */
 class RectAtlas:public fastuidraw::noncopyable
 {
@@ -50,9 +59,6 @@ public:
   explicit
   RectAtlas(const ivec2 &dimensions);
 
-  virtual
-  ~RectAtlas();
-
   /*!
    * Returns the location where the rectangle is palced
    * in the RectAtlas. Failure is indicated by if any
@@ -63,21 +69,17 @@ public:
   add_rectangle(const ivec2 &dimension);
 
   /*!
-   * Clears the RectAtlas, in doing so deleting
-   * all recranges allocated by \ref add_rectangle().
-   * After clear(), all rectangle objects
-   * returned by add_rectangle() are deleted, and as
-   * such the pointers are then wild-invalid.
+   * Clears the RectAtlas, in doing so freeing all
+   * regions allocated by \ref add_rectangle().
    */
   void
   clear(void);
 
   /*!
-   * Clears the RectAtlas, in doing so deleting
-   * all recranges allocated by \ref add_rectangle().
-   * After clear(), all rectangle objects
-   * returned by add_rectangle() are deleted, and as
-   * such the pointers are then wild-invalid.
+   * Clears the RectAtlas, in doing so freeing all
+   * regions allocated by \ref add_rectangle().
+   * If the dimensions change, the remembered
+   * sequence of rectangles is dropped.
    * \param new_dimensions new dimensions of the RectAtlas.
    */
   void
@@ -89,261 +91,96 @@ public:
    * in RectAtlas().
    */
   ivec2
-  size(void) const;
-
-private:
-  enum node_num_t
-    {
-      num_rects,
-      num_with_children,
-      num_without_children,
-
-      node_num_count
-    };
+  size(void) const
+  {
+    return m_dimensions;
+  }
 
-  class Rectangle;
-  class NodeBase;
-  class NodeWithoutChildren;
-  class NodeWithChildren;
-  class MemoryPool;
-  typedef vecN<int, node_num_count> NodeSizeCount;
+  /*!
+   * Returns the number of rectangles added since the
+   * last clear() whose location was taken from the
+   * sequence of rectangles before that clear().
+   */
+  unsigned int
+  number_replayed(void) const
+  {
+    return m_replaying ? m_allocations.size() : m_number_replayed;
+  }
 
-  class Rectangle:public fastuidraw::noncopyable
+private:
+  class Shelf
   {
   public:
-    explicit
-    Rectangle(const ivec2 &psize):
-      m_minX_minY(0, 0),
-      m_size(psize)
+    Shelf(int y, int height):
+      m_y(y),
+      m_height(height),
+      m_used_width(0)
     {}
 
-    const fastuidraw::ivec2&
-    minX_minY(void) const
-    {
-      return m_minX_minY;
-    }
-
-    int
-    area(void) const
-    {
-      return m_size.x() * m_size.y();
-    }
-
-    const ivec2&
-    size(void) const
-    {
-      return m_size;
-    }
-
-    void
-    move(const ivec2 &moveby)
-    {
-      m_minX_minY += moveby;
-    }
-
-  private:
-    ivec2 m_minX_minY, m_size;
+    int m_y, m_height, m_used_width;
   };
 
-  class NodeBase
+  class ShelfClass
   {
   public:
-    NodeBase(const ivec2 &bl, const ivec2 &sz):
-      m_minX_minY(bl), m_size(sz)
+    ShelfClass(int height, unsigned int shelf):
+      m_height(height),
+      m_shelf(shelf)
     {}
 
-    const ivec2&
-    size(void) const
-    {
-      return m_size;
-    }
-
-    int
-    area(void) const
-    {
-      return m_size.x() * m_size.y();
-    }
-
-    const ivec2&
-    minX_minY(void) const
+    bool
+    operator<(const ShelfClass &rhs) const
     {
-      return m_minX_minY;
+      return m_height < rhs.m_height;
     }
 
-    NodeWithoutChildren*
-    widest_possible_rectangle(void) { return m_widest; }
-
-    NodeWithoutChildren*
-    tallest_possible_rectangle(void) { return m_tallest; }
-
-    NodeWithoutChildren*
-    biggest_possible_rectangle(void) { return m_biggest; }
+    /* the height of the shelves of the class */
+    int m_height;
 
-    virtual
-    NodeSizeCount
-    count(void) const = 0;
-
-    /* returns nullptr if failed to add rectangle,
-     * otherwise returns what the caller pointer
-     * should be updated to.
-     */
-    NodeBase*
-    add(MemoryPool &pool, Rectangle *rect);
-
-  protected:
-    NodeWithoutChildren *m_widest, *m_tallest, *m_biggest;
-
-  private:
-    /*
-     * A return value of nullptr indicates failure;
-     * a return value of non-null but different, means
-     * change pointer to callee.
+    /* index into m_shelves of the shelf to which
+     * rectangles of the class are added
      */
-    virtual
-    NodeBase*
-    add_implement(MemoryPool&, Rectangle*) = 0;
-
-    ivec2 m_minX_minY, m_size;
+    unsigned int m_shelf;
   };
 
-  class NodeWithoutChildren:public NodeBase
+  class Allocation
   {
   public:
-    NodeWithoutChildren(const ivec2 &bl, const ivec2 &sz,
-                        Rectangle *rect);
-
-    Rectangle*
-    data(void);
-
-    int
-    widest_possible(void) const
-    {
-      return size().x();
-    }
-
-    int
-    tallest_possible(void) const
-    {
-      return size().y();
-    }
-
-    int
-    biggest_possible(void) const
-    {
-      int A(area());
-
-      return m_rectangle ?
-        A - m_rectangle->area() :
-        A;
-    }
-
-    virtual
-    NodeSizeCount
-    count(void) const
-    {
-      NodeSizeCount return_value;
-
-      return_value[num_rects] = (m_rectangle) ? 1u : 0u;
-      return_value[num_with_children] = 0;
-      return_value[num_without_children] = 1;
-
-      return return_value;
-    }
-
-  private:
-    virtual
-    NodeBase*
-    add_implement(MemoryPool&, Rectangle*);
-
-    Rectangle *m_rectangle;
-  };
-
-  class NodeWithChildren:public NodeBase
-  {
-  public:
-    NodeWithChildren(MemoryPool &pool,
-                     NodeWithoutChildren *src,
-                     bool split_x, bool split_y);
-
-    virtual
-    NodeSizeCount
-    count(void) const
-    {
-      NodeSizeCount return_value;
-
-      return_value[num_rects] = 0u;
-      return_value[num_with_children] = 1;
-      return_value[num_without_children] = 0;
-
-      return return_value
-        + m_children[0]->count()
-        + m_children[1]->count()
-        + m_children[2]->count();
-    }
-
-  private:
-    virtual
-    NodeBase*
-    add_implement(MemoryPool&, Rectangle*);
-
-    void
-    recompute_possible(void);
+    Allocation(ivec2 sz, ivec2 location):
+      m_size(sz),
+      m_location(location)
+    {}
 
-    vecN<NodeBase*, 3> m_children;
+    ivec2 m_size, m_location;
   };
 
-  class NodeSorter
-  {
-  public:
-    bool
-    operator()(NodeBase *lhs, NodeBase *rhs) const
-    {
-      /* we want to list the smallest "size" first
-       * to avoid splitting large elements
-       */
-      return lhs->area() < rhs->area();
-    }
-  };
+  int
+  height_class(int h) const;
 
-  class MemoryPool:fastuidraw::noncopyable
-  {
-  public:
-    Rectangle*
-    create_rectangle(const ivec2 &psize)
-    {
-      return m_rect_allocator.create(psize);
-    }
+  ivec2
+  pack_rectangle(const ivec2 &dimension);
 
-    NodeWithoutChildren*
-    create_node_without_children(const ivec2 &bl, const ivec2 &sz,
-                                 Rectangle *rect = nullptr)
-    {
-      return m_node_without_children_allocator.create(bl, sz, rect);
-    }
+  void
+  reset_packer(void);
 
-    NodeWithChildren*
-    create_node_with_children(NodeWithoutChildren *src,
-                              bool split_x, bool split_y)
-    {
-      return m_node_with_children_allocator.create(*this, src, split_x, split_y);
-    }
+  ivec2 m_dimensions;
 
-    void
-    clear(void)
-    {
-      m_rect_allocator.clear();
-      m_node_without_children_allocator.clear();
-      m_node_with_children_allocator.clear();
-    }
+  /* packer state */
+  std::vector<Shelf> m_shelves;
+  std::vector<ShelfClass> m_classes;
+  int m_next_shelf_y;
 
-  private:
-    SimplePool<Rectangle, 512> m_rect_allocator;
-    SimplePool<NodeWithoutChildren, 512> m_node_without_children_allocator;
-    SimplePool<NodeWithChildren, 512> m_node_with_children_allocator;
-  };
+  /* rectangles added since the last clear() and those
+   * added between the two previous calls to clear()
+   */
+  std::vector<Allocation> m_allocations, m_previous_allocations;
 
-  NodeBase *m_root;
-  MemoryPool m_pool;
+  /* true while every rectangle added since the last clear()
+   * was taken from m_previous_allocations; while true the
+   * packer state does not reflect m_allocations.
+   */
+  bool m_replaying;
+  unsigned int m_number_replayed;
 };
 
 } //namespace detail
@@ -21,7 +21,9 @@
 
 #include <iostream>
 #include <vector>
+#include <string>
 #include <iterator>
+#include <stdint.h>
 #include <fastuidraw/util/c_array.hpp>
 
 #define FASTUIDRAWwarn_assert(X) do {                           \
@@ -79,6 +81,55 @@ namespace fastuidraw
   {
     return std::reverse_iterator<iterator>(iter);
   }
+
+  /* 64-bit FNV-1a hash of a sequence of bytes; the hash of
+   * a sequence does not depend on how it is split between
+   * calls to add().
+   */
+  class FNV1aHash
+  {
+  public:
+    explicit
+    FNV1aHash(uint64_t seed = 14695981039346656037ull):
+      m_value(seed)
+    {}
+
+    FNV1aHash&
+    add(uint8_t v)
+    {
+      m_value = (m_value ^ static_cast<uint64_t>(v)) * 1099511628211ull;
+      return *this;
+    }
+
+    FNV1aHash&
+    add(c_array<const uint8_t> bytes)
+    {
+      for (uint8_t v : bytes)
+        {
+          add(v);
+        }
+      return *this;
+    }
+
+    FNV1aHash&
+    add(const std::string &str)
+    {
+      for (char c : str)
+        {
+          add(static_cast<uint8_t>(c));
+        }
+      return *this;
+    }
+
+    uint64_t
+    value(void) const
+    {
+      return m_value;
+    }
+
+  private:
+    uint64_t m_value;
+  };
 }
 
 #define get_implement(class_name, class_name_private, type_name, member_name) \
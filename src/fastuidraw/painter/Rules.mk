@@ -22,6 +22,7 @@ include $(dir)/Rules.mk
 FASTUIDRAW_SOURCES += $(call filelist, fill_rule.cpp \
 	painter_brush.cpp \
 	painter.cpp painter_enums.cpp \
+	painter_profiler.cpp \
 	shader_filled_path.cpp)
 
 # Begin standard footer
@@ -992,8 +992,8 @@ namespace
   class StrokedPathPrivate:fastuidraw::noncopyable
   {
   public:
-    explicit
-    StrokedPathPrivate(const fastuidraw::TessellatedPath &P);
+    StrokedPathPrivate(const fastuidraw::TessellatedPath &P,
+                       const fastuidraw::PartitionedTessellatedPath &partitioned);
     ~StrokedPathPrivate();
 
     template<typename T>
@@ -1700,11 +1700,12 @@ set_chunks(const SubsetPrivate *st,
 /////////////////////////////////////////////
 // StrokedPathPrivate methods
 StrokedPathPrivate::
-StrokedPathPrivate(const fastuidraw::TessellatedPath &P):
+StrokedPathPrivate(const fastuidraw::TessellatedPath &P,
+                   const fastuidraw::PartitionedTessellatedPath &partitioned):
   m_has_arcs(P.has_arcs()),
   m_root(nullptr)
 {
-  m_path_partioned = &P.partitioned();
+  m_path_partioned = &partitioned;
   m_subsets.resize(m_path_partioned->number_subsets());
   m_root = SubsetPrivate::create_root_subset(m_has_arcs, m_cap_join_tracking, *m_path_partioned, m_subsets);
 }
@@ -1968,9 +1969,10 @@ join_chunk(void) const
 //////////////////////////////////////////////////////////////
 // fastuidraw::StrokedPath methods
 fastuidraw::StrokedPath::
-StrokedPath(const fastuidraw::TessellatedPath &P)
+StrokedPath(const fastuidraw::TessellatedPath &P,
+            const PartitionedTessellatedPath &partitioned)
 {
-  m_d = FASTUIDRAWnew StrokedPathPrivate(P);
+  m_d = FASTUIDRAWnew StrokedPathPrivate(P, partitioned);
 }
 
 fastuidraw::StrokedPath::
@@ -1982,6 +1984,79 @@ fastuidraw::StrokedPath::
   m_d = nullptr;
 }
 
+void
+fastuidraw::StrokedPath::
+prepare(const TessellatedPath::StrokingPreparationParams &params) const
+{
+  StrokedPathPrivate *d;
+  d = static_cast<StrokedPathPrivate*>(m_d);
+
+  if (params.join_style(PainterEnums::rounded_joins))
+    {
+      if (d->m_has_arcs)
+        {
+          arc_rounded_joins();
+        }
+      else
+        {
+          for (float thresh : params.rounding_thresholds())
+            {
+              rounded_joins(thresh);
+            }
+        }
+    }
+
+  if (params.join_style(PainterEnums::bevel_joins))
+    {
+      bevel_joins();
+    }
+
+  if (params.join_style(PainterEnums::miter_clip_joins))
+    {
+      miter_clip_joins();
+    }
+
+  if (params.join_style(PainterEnums::miter_bevel_joins))
+    {
+      miter_bevel_joins();
+    }
+
+  if (params.join_style(PainterEnums::miter_joins))
+    {
+      miter_joins();
+    }
+
+  if (params.cap_style(PainterEnums::rounded_caps))
+    {
+      if (d->m_has_arcs)
+        {
+          arc_rounded_caps();
+        }
+      else
+        {
+          for (float thresh : params.rounding_thresholds())
+            {
+              rounded_caps(thresh);
+            }
+        }
+    }
+
+  if (params.cap_style(PainterEnums::square_caps))
+    {
+      square_caps();
+    }
+
+  if (params.cap_style(PainterEnums::flat_caps))
+    {
+      flat_caps();
+    }
+
+  if (params.adjustable_caps())
+    {
+      adjustable_caps();
+    }
+}
+
 bool
 fastuidraw::StrokedPath::
 has_arcs(void) const
@@ -67,11 +67,15 @@ namespace
   public:
     ConfigurationPrivate(void):
       m_supports_bindless_texturing(false),
-      m_number_context_textures(8)
+      m_number_context_textures(8),
+      m_reorder_opaque_draws(false),
+      m_draw_reorder_window(0)
     {}
 
     bool m_supports_bindless_texturing;
     unsigned int m_number_context_textures;
+    bool m_reorder_opaque_draws;
+    unsigned int m_draw_reorder_window;
   };
 }
 
@@ -140,6 +144,12 @@ setget_implement(fastuidraw::PainterEngine::ConfigurationBase,
 setget_implement(fastuidraw::PainterEngine::ConfigurationBase,
                  ConfigurationPrivate,
                  unsigned int, number_context_textures)
+setget_implement(fastuidraw::PainterEngine::ConfigurationBase,
+                 ConfigurationPrivate,
+                 bool, reorder_opaque_draws)
+setget_implement(fastuidraw::PainterEngine::ConfigurationBase,
+                 ConfigurationPrivate,
+                 unsigned int, draw_reorder_window)
 
 ////////////////////////////////////
 // fastuidraw::PainterEngine methods
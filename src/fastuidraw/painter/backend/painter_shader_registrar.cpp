@@ -19,6 +19,7 @@
 #include <fastuidraw/painter/backend/painter_shader_registrar.hpp>
 #include <private/util_private.hpp>
 #include <algorithm>
+#include <vector>
 #include <mutex>
 
 namespace
@@ -49,11 +50,21 @@ namespace
   {
   public:
     PainterShaderRegistrarPrivate(void):
-      m_unique_id(IDGenerator::new_value())
+      m_unique_id(IDGenerator::new_value()),
+      m_record_item_shader_usage(false)
     {}
 
     fastuidraw::Mutex m_mutex;
     unsigned int m_unique_id;
+
+    /* the usage counts have their own lock because they
+     * are read while m_mutex is locked (when a backend
+     * builds its shaders) and written by Painter outside
+     * of it.
+     */
+    mutable fastuidraw::Mutex m_usage_mutex;
+    std::vector<uint64_t> m_item_shader_usage;
+    bool m_record_item_shader_usage;
   };
 }
 
@@ -341,3 +352,79 @@ register_shader(const PainterDashedStrokeShaderSet &p)
       register_shader(p.shader(c));
     }
 }
+
+void
+fastuidraw::PainterShaderRegistrar::
+record_item_shader_usage(bool v)
+{
+  PainterShaderRegistrarPrivate *d;
+  d = static_cast<PainterShaderRegistrarPrivate*>(m_d);
+
+  Mutex::Guard m(d->m_usage_mutex);
+  d->m_record_item_shader_usage = v;
+}
+
+bool
+fastuidraw::PainterShaderRegistrar::
+record_item_shader_usage(void) const
+{
+  PainterShaderRegistrarPrivate *d;
+  d = static_cast<PainterShaderRegistrarPrivate*>(m_d);
+
+  Mutex::Guard m(d->m_usage_mutex);
+  return d->m_record_item_shader_usage;
+}
+
+void
+fastuidraw::PainterShaderRegistrar::
+add_item_shader_usage(c_array<const uint64_t> counts)
+{
+  PainterShaderRegistrarPrivate *d;
+  d = static_cast<PainterShaderRegistrarPrivate*>(m_d);
+
+  Mutex::Guard m(d->m_usage_mutex);
+  if (counts.size() > d->m_item_shader_usage.size())
+    {
+      d->m_item_shader_usage.resize(counts.size(), 0u);
+    }
+
+  for (unsigned int i = 0; i < counts.size(); ++i)
+    {
+      d->m_item_shader_usage[i] += counts[i];
+    }
+}
+
+uint64_t
+fastuidraw::PainterShaderRegistrar::
+item_shader_usage(unsigned int shader_id) const
+{
+  PainterShaderRegistrarPrivate *d;
+  d = static_cast<PainterShaderRegistrarPrivate*>(m_d);
+
+  Mutex::Guard m(d->m_usage_mutex);
+  return (shader_id < d->m_item_shader_usage.size()) ?
+    d->m_item_shader_usage[shader_id] :
+    0u;
+}
+
+unsigned int
+fastuidraw::PainterShaderRegistrar::
+item_shader_usage_size(void) const
+{
+  PainterShaderRegistrarPrivate *d;
+  d = static_cast<PainterShaderRegistrarPrivate*>(m_d);
+
+  Mutex::Guard m(d->m_usage_mutex);
+  return d->m_item_shader_usage.size();
+}
+
+void
+fastuidraw::PainterShaderRegistrar::
+clear_item_shader_usage(void)
+{
+  PainterShaderRegistrarPrivate *d;
+  d = static_cast<PainterShaderRegistrarPrivate*>(m_d);
+
+  Mutex::Guard m(d->m_usage_mutex);
+  d->m_item_shader_usage.clear();
+}
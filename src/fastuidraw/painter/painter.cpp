@@ -27,6 +27,7 @@
 #include <fastuidraw/painter/backend/painter_header.hpp>
 #include <fastuidraw/painter/attribute_data/stroking_attribute_writer.hpp>
 #include <fastuidraw/painter/effects/painter_effect_brush.hpp>
+#include <fastuidraw/path_dash_effect.hpp>
 #include <fastuidraw/painter/painter.hpp>
 
 #include <private/util_private.hpp>
@@ -504,6 +505,12 @@ namespace
       m_override_matrix_state.reset();
     }
 
+    bool
+    item_matrix_state_overridden(void) const
+    {
+      return m_override_matrix_state ? true : false;
+    }
+
     const ExtendedPool::PackedItemMatrix&
     current_item_matrix_coverage_buffer_state(ExtendedPool &pool)
     {
@@ -768,10 +775,21 @@ namespace
   private:
     typedef std::vector<fastuidraw::reference_counted_ptr<EffectsBuffer> > PerActiveDepth;
 
+    fastuidraw::reference_counted_ptr<EffectsBuffer>
+    take_buffer(unsigned int depth);
+
     fastuidraw::PainterSurface::Viewport m_effects_buffer_viewport;
     fastuidraw::ivec2 m_current_backing_size, m_current_backing_useable_size;
     std::vector<fastuidraw::reference_counted_ptr<EffectsBuffer> > m_unused_buffers;
     std::vector<PerActiveDepth> m_per_active_depth;
+
+    /* the buffers used at each depth by the previous begin()/end(),
+     * in reverse order; a depth takes the buffers it used before in
+     * the same order so that, when the layers repeat, each buffer
+     * sees the same sequence of rectangles and its RectAtlas gives
+     * back the same regions.
+     */
+    std::vector<PerActiveDepth> m_reuse_per_depth;
   };
 
   class DeferredCoverageBuffer:
@@ -931,6 +949,13 @@ namespace
     fastuidraw::ivec2 m_current_backing_size, m_current_backing_useable_size;
     std::vector<fastuidraw::reference_counted_ptr<DeferredCoverageBuffer> > m_unused_buffers;
     std::vector<fastuidraw::reference_counted_ptr<DeferredCoverageBuffer> > m_active_buffers;
+
+    /* the buffers used by the previous begin()/end() in reverse
+     * order, taken before those of m_unused_buffers so that the
+     * buffers are used in the same order each frame, see
+     * EffectsLayerFactory::m_reuse_per_depth.
+     */
+    std::vector<fastuidraw::reference_counted_ptr<DeferredCoverageBuffer> > m_reuse_buffers;
   };
 
   class ComplementFillRule:public fastuidraw::CustomFillRuleBase
@@ -1332,11 +1357,41 @@ namespace
     int m_fuzz_increment_z;
   };
 
+  /* Holds a PathDashEffect for each of the most recently used dash
+   * patterns of CPU dashing; reusing the same PathDashEffect for the
+   * same dash pattern keeps its PathEffect::ID() and version()
+   * unchanged so that the results cached on PartitionedTessellatedPath
+   * are found again.
+   */
+  class DashEffectPool:fastuidraw::noncopyable
+  {
+  public:
+    enum
+      {
+        max_number_effects = 4
+      };
+
+    ~DashEffectPool();
+
+    const fastuidraw::PathDashEffect&
+    fetch(const fastuidraw::PainterDashedStrokeParams &params);
+
+  private:
+    static
+    bool
+    matches(const fastuidraw::PathDashEffect &effect,
+            const fastuidraw::PainterDashedStrokeParams &params);
+
+    /* ordered from most recently used to least recently used */
+    std::vector<fastuidraw::PathDashEffect*> m_effects;
+  };
+
   class EffectStrokerWorkRoom:public fastuidraw::StrokingAttributeWriter
   {
   public:
     fastuidraw::PathEffect::Storage m_storage;
     fastuidraw::PartitionedTessellatedPath::SubsetSelection m_selection;
+    DashEffectPool m_dash_effects;
   };
 
   class NonEffectStroker:public fastuidraw::PainterAttributeWriter
@@ -1358,6 +1413,13 @@ namespace
       return m_requires_coverage_buffer;
     }
 
+    /* the subsets selected by init_for_stroking() */
+    const fastuidraw::StrokedPath::SubsetSelection&
+    selection(void) const
+    {
+      return m_selection;
+    }
+
     unsigned int
     state_length(void) const override
     {
@@ -1528,6 +1590,35 @@ namespace
     unsigned int m_state_stack_size;
   };
 
+  /* Records a CPU event on a PainterProfiler for the
+   * lifetime of the ProfileScope; does nothing if there
+   * is no profiler.
+   */
+  class ProfileScope:fastuidraw::noncopyable
+  {
+  public:
+    ProfileScope(const fastuidraw::reference_counted_ptr<fastuidraw::PainterProfiler> &profiler,
+                 fastuidraw::c_string name):
+      m_profiler(profiler)
+    {
+      if (m_profiler)
+        {
+          m_profiler->begin_cpu_event(name);
+        }
+    }
+
+    ~ProfileScope()
+    {
+      if (m_profiler)
+        {
+          m_profiler->end_cpu_event();
+        }
+    }
+
+  private:
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterProfiler> m_profiler;
+  };
+
   class PainterPrivate
   {
   public:
@@ -1564,6 +1655,16 @@ namespace
     compute_clip_intersect_polygon(fastuidraw::c_array<const fastuidraw::vec3> polygon,
                                    float additional_pixel_slack);
 
+    fastuidraw::BoundingBox<float>
+    compute_draw_bounds(const fastuidraw::Rect &logical_rect);
+
+    template<typename T>
+    fastuidraw::BoundingBox<float>
+    compute_stroke_draw_bounds(const T &path,
+                               fastuidraw::c_array<const float> geometry_inflation,
+                               bool select_miter_joins,
+                               const typename T::SubsetSelection &selection);
+
     void
     begin_coverage_buffer(void);
 
@@ -1628,7 +1729,8 @@ namespace
                 enum fastuidraw::Painter::join_style js,
                 bool apply_anti_aliasing,
                 enum fastuidraw::Painter::stroking_method_t stroking_method,
-                const fastuidraw::PathEffect *effect);
+                const fastuidraw::PathEffect *effect,
+                bool cache_effect);
 
     void
     stroke_path(const fastuidraw::PainterStrokeShader &shader,
@@ -1645,7 +1747,35 @@ namespace
                 enum fastuidraw::Painter::cap_style cp,
                 enum fastuidraw::Painter::join_style js,
                 bool apply_anti_aliasing,
-                const fastuidraw::PathEffect &effect);
+                const fastuidraw::PathEffect &effect,
+                bool cache_effect,
+                bool effect_within_path);
+
+    /* if dashed_params is non-null, it is the item shader data
+     * of draw and the dash pattern may be realized on the CPU
+     */
+    void
+    stroke_dashed_path(const fastuidraw::PainterDashedStrokeShaderSet &shader,
+                       const fastuidraw::PainterData &draw,
+                       const fastuidraw::Path &path,
+                       const fastuidraw::StrokingStyle &stroke_style,
+                       bool apply_shader_anti_aliasing,
+                       enum fastuidraw::Painter::stroking_method_t stroking_method,
+                       const fastuidraw::PathEffect *effect,
+                       const fastuidraw::PainterDashedStrokeParams *dashed_params);
+
+    /* dash the path on the CPU with a PathDashEffect and stroke the
+     * draw intervals with the default (non-dashed) stroke shader.
+     */
+    void
+    stroke_path_cpu_dashed(const fastuidraw::PainterDashedStrokeParams &dashed_params,
+                           const fastuidraw::PainterData &draw,
+                           const fastuidraw::Path &path,
+                           enum fastuidraw::Painter::cap_style cp,
+                           enum fastuidraw::Painter::join_style js,
+                           bool apply_anti_aliasing,
+                           enum fastuidraw::Painter::stroking_method_t stroking_method,
+                           bool cache_effect);
 
     void
     pre_draw_anti_alias_fuzz(const fastuidraw::FilledPath &filled_path,
@@ -1799,6 +1929,9 @@ namespace
     float
     compute_magnification(const fastuidraw::Rect &rect);
 
+    void
+    request_brush_residency(const fastuidraw::PainterData &draw);
+
     float
     compute_max_magnification_at_clip_points(fastuidraw::c_array<const fastuidraw::vec3> poly);
 
@@ -1885,11 +2018,19 @@ namespace
     fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker> m_root_packer;
     ExtendedPool::PackedItemMatrix m_root_identity_matrix;
     fastuidraw::vecN<unsigned int, fastuidraw::PainterPacker::num_stats> m_stats;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterProfiler> m_profiler;
     fastuidraw::PainterSurface::Viewport m_viewport;
     fastuidraw::vec2 m_viewport_dimensions;
     fastuidraw::vec2 m_one_pixel_width;
     float m_curve_flatness;
+    float m_cpu_dashing_duty_cycle;
     int m_current_z, m_draw_data_added_count;
+
+    /* amount to increment z for a fill without anti-aliasing;
+     * non-zero only when the packer reorders opaque draws so
+     * that successive opaque fills get distinct z-values.
+     */
+    int m_non_aa_fill_increment_z;
     ClipRectState m_clip_rect_state;
     std::vector<occluder_stack_entry> m_occluder_stack;
     std::vector<state_stack_entry> m_state_stack;
@@ -1909,6 +2050,16 @@ namespace
     ExtendedPool m_pool;
     fastuidraw::PainterData::brush_value m_black_brush;
     const ExtendedPool::PackedBrushAdjust *m_current_brush_adjust;
+
+    /* bounds in normalized device coordinates, intersected with
+     * the clipping region, of the geometry of the draws being
+     * issued, see DrawBoundsScope; an empty box indicates that
+     * the bounds are not known in which case draw_generic() uses
+     * the bounding box of the clipping region. The bounds are
+     * only computed if the packer regroups draws.
+     */
+    fastuidraw::BoundingBox<float> m_draw_bounds;
+    bool m_compute_draw_bounds;
     ClipEquationStore m_clip_store;
     PainterWorkRoom m_work_room;
     unsigned int m_max_attribs_per_block, m_max_indices_per_block;
@@ -1917,6 +2068,30 @@ namespace
     fastuidraw::Path m_rounded_corner_path_complement;
     fastuidraw::Path m_square_path;
   };
+
+  /* Sets PainterPrivate::m_draw_bounds for the lifetime of
+   * the object and restores the previous value afterwards.
+   */
+  class DrawBoundsScope:fastuidraw::noncopyable
+  {
+  public:
+    DrawBoundsScope(PainterPrivate *d,
+                    const fastuidraw::BoundingBox<float> &bounds):
+      m_d(d),
+      m_prev(d->m_draw_bounds)
+    {
+      m_d->m_draw_bounds = bounds;
+    }
+
+    ~DrawBoundsScope()
+    {
+      m_d->m_draw_bounds = m_prev;
+    }
+
+  private:
+    PainterPrivate *m_d;
+    fastuidraw::BoundingBox<float> m_prev;
+  };
 }
 
 /////////////////////////////////////
@@ -2875,23 +3050,70 @@ begin(fastuidraw::PainterSurface &surface)
   if (clear_buffers)
     {
       m_per_active_depth.clear();
+      m_reuse_per_depth.clear();
       m_unused_buffers.clear();
       m_current_backing_size = m_current_backing_useable_size;
     }
   else
     {
-      for (PerActiveDepth &v : m_per_active_depth)
+      /* buffers not taken since the last begin() are
+       * no longer tied to a depth
+       */
+      for (PerActiveDepth &v : m_reuse_per_depth)
+        {
+          m_unused_buffers.insert(m_unused_buffers.end(), v.begin(), v.end());
+          v.clear();
+        }
+
+      m_reuse_per_depth.resize(m_per_active_depth.size());
+      for (unsigned int depth = 0; depth < m_per_active_depth.size(); ++depth)
         {
-          for (const auto &r : v)
+          PerActiveDepth &v(m_per_active_depth[depth]);
+
+          for (auto iter = v.rbegin(); iter != v.rend(); ++iter)
             {
-              r->m_rect_atlas.clear(m_current_backing_useable_size);
-              m_unused_buffers.push_back(r);
+              (*iter)->m_rect_atlas.clear(m_current_backing_useable_size);
+              m_reuse_per_depth[depth].push_back(*iter);
             }
           v.clear();
         }
     }
 }
 
+fastuidraw::reference_counted_ptr<EffectsBuffer>
+EffectsLayerFactory::
+take_buffer(unsigned int depth)
+{
+  fastuidraw::reference_counted_ptr<EffectsBuffer> return_value;
+
+  if (depth < m_reuse_per_depth.size() && !m_reuse_per_depth[depth].empty())
+    {
+      return_value = m_reuse_per_depth[depth].back();
+      m_reuse_per_depth[depth].pop_back();
+      return return_value;
+    }
+
+  if (!m_unused_buffers.empty())
+    {
+      return_value = m_unused_buffers.back();
+      m_unused_buffers.pop_back();
+      return return_value;
+    }
+
+  /* take from the depths least likely to be reached */
+  for (auto iter = m_reuse_per_depth.rbegin(); iter != m_reuse_per_depth.rend(); ++iter)
+    {
+      if (!iter->empty())
+        {
+          return_value = iter->front();
+          iter->erase(iter->begin());
+          return return_value;
+        }
+    }
+
+  return return_value;
+}
+
 EffectsLayer
 EffectsLayerFactory::
 fetch(unsigned int effects_depth,
@@ -2924,14 +3146,15 @@ fetch(unsigned int effects_depth,
     {
       reference_counted_ptr<EffectsBuffer> TB;
 
-      if (m_unused_buffers.empty())
+      TB = take_buffer(effects_depth);
+      if (!TB)
         {
           reference_counted_ptr<PainterPacker> packer;
           reference_counted_ptr<PainterSurface> surface;
           reference_counted_ptr<const Image> image;
 
-          packer = FASTUIDRAWnew PainterPacker(d->m_default_brush_shader,
-                                               d->m_stats, d->m_backend,
+          packer = FASTUIDRAWnew PainterPacker(d->m_default_shaders,
+                                               d->m_stats, d->m_profiler, d->m_backend,
                                                d->m_backend_factory->painter_shader_registrar(),
                                                d->m_backend_factory->configuration_base());
           surface = d->m_backend_factory->create_surface(m_current_backing_size,
@@ -2940,11 +3163,6 @@ fetch(unsigned int effects_depth,
           image = surface->image(d->m_backend_factory->image_atlas());
           TB = FASTUIDRAWnew EffectsBuffer(packer, surface, image, m_current_backing_useable_size);
         }
-      else
-        {
-          TB = m_unused_buffers.back();
-          m_unused_buffers.pop_back();
-        }
 
       ++d->m_stats[Painter::num_render_targets];
       TB->m_depth = effects_depth;
@@ -3072,15 +3290,18 @@ begin(fastuidraw::PainterSurface &surface)
   if (clear_buffers)
     {
       m_active_buffers.clear();
+      m_reuse_buffers.clear();
       m_unused_buffers.clear();
       m_current_backing_size = m_current_backing_useable_size;
     }
   else
     {
-      for (const auto &r : m_active_buffers)
+      m_unused_buffers.insert(m_unused_buffers.end(), m_reuse_buffers.begin(), m_reuse_buffers.end());
+      m_reuse_buffers.clear();
+      for (auto iter = m_active_buffers.rbegin(); iter != m_active_buffers.rend(); ++iter)
         {
-          r->m_rect_atlas.clear(m_current_backing_useable_size);
-          m_unused_buffers.push_back(r);
+          (*iter)->m_rect_atlas.clear(m_current_backing_useable_size);
+          m_reuse_buffers.push_back(*iter);
         }
       m_active_buffers.clear();
     }
@@ -3111,13 +3332,18 @@ fetch(const fastuidraw::Rect &normalized_rect, PainterPrivate *d)
     {
       reference_counted_ptr<DeferredCoverageBuffer> TB;
 
-      if (m_unused_buffers.empty())
+      if (!m_reuse_buffers.empty())
+        {
+          TB = m_reuse_buffers.back();
+          m_reuse_buffers.pop_back();
+        }
+      else if (m_unused_buffers.empty())
         {
           reference_counted_ptr<PainterPacker> packer;
           reference_counted_ptr<PainterSurface> surface;
 
-          packer = FASTUIDRAWnew PainterPacker(d->m_default_brush_shader,
-                                               d->m_stats, d->m_backend,
+          packer = FASTUIDRAWnew PainterPacker(d->m_default_shaders,
+                                               d->m_stats, d->m_profiler, d->m_backend,
                                                d->m_backend_factory->painter_shader_registrar(),
                                                d->m_backend_factory->configuration_base());
           surface = d->m_backend_factory->create_surface(m_current_backing_size,
@@ -3165,6 +3391,87 @@ end(void)
     }
 }
 
+//////////////////////////////////
+// DashEffectPool methods
+DashEffectPool::
+~DashEffectPool()
+{
+  for (fastuidraw::PathDashEffect *p : m_effects)
+    {
+      FASTUIDRAWdelete(p);
+    }
+}
+
+bool
+DashEffectPool::
+matches(const fastuidraw::PathDashEffect &effect,
+        const fastuidraw::PainterDashedStrokeParams &params)
+{
+  fastuidraw::c_array<const fastuidraw::vec2> effect_pattern(effect.dash_pattern());
+  fastuidraw::c_array<const fastuidraw::PainterDashedStrokeParams::DashPatternElement> pattern(params.dash_pattern());
+
+  if (effect.dash_offset() != params.dash_offset()
+      || effect_pattern.size() != pattern.size())
+    {
+      return false;
+    }
+
+  for (unsigned int i = 0; i < pattern.size(); ++i)
+    {
+      if (effect_pattern[i].x() != pattern[i].m_draw_length
+          || effect_pattern[i].y() != pattern[i].m_space_length)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+const fastuidraw::PathDashEffect&
+DashEffectPool::
+fetch(const fastuidraw::PainterDashedStrokeParams &params)
+{
+  std::vector<fastuidraw::PathDashEffect*>::iterator iter;
+  fastuidraw::PathDashEffect *p(nullptr);
+
+  for (iter = m_effects.begin(); iter != m_effects.end(); ++iter)
+    {
+      if (matches(**iter, params))
+        {
+          p = *iter;
+          m_effects.erase(iter);
+          break;
+        }
+    }
+
+  if (!p)
+    {
+      if (m_effects.size() >= max_number_effects)
+        {
+          /* reuse the least recently used effect; changing its
+           * pattern increments its version, which invalidates
+           * the results cached for its old pattern.
+           */
+          p = m_effects.back();
+          m_effects.pop_back();
+        }
+      else
+        {
+          p = FASTUIDRAWnew fastuidraw::PathDashEffect();
+        }
+
+      p->clear();
+      for (const auto &e : params.dash_pattern())
+        {
+          p->add_dash(e.m_draw_length, e.m_space_length);
+        }
+      p->dash_offset(params.dash_offset());
+    }
+
+  m_effects.insert(m_effects.begin(), p);
+  return *p;
+}
+
 //////////////////////////////////
 // PainterPrivate methods
 PainterPrivate::
@@ -3172,10 +3479,12 @@ PainterPrivate(const fastuidraw::reference_counted_ptr<fastuidraw::PainterEngine
   m_viewport_dimensions(1.0f, 1.0f),
   m_one_pixel_width(1.0f, 1.0f),
   m_curve_flatness(0.5f),
+  m_cpu_dashing_duty_cycle(0.2f),
   m_backend_factory(backend_factory),
   m_backend(backend_factory->create_backend()),
   m_hints(backend_factory->hints()),
-  m_current_brush_adjust(nullptr)
+  m_current_brush_adjust(nullptr),
+  m_compute_draw_bounds(backend_factory->configuration_base().draw_reorder_window() > 0)
 {
   /* By calling PainterBackend::default_shaders(), we make the shaders
    * registered. By setting m_default_shaders to its return value,
@@ -3186,13 +3495,15 @@ PainterPrivate(const fastuidraw::reference_counted_ptr<fastuidraw::PainterEngine
   m_default_shaders = m_backend_factory->default_shaders();
   m_default_brush_shader = m_default_shaders.brush_shaders().standard_brush().get();
   m_brush_fx = FASTUIDRAWnew fastuidraw::PainterEffectBrush();
-  m_root_packer = FASTUIDRAWnew fastuidraw::PainterPacker(m_default_brush_shader, m_stats, m_backend,
+  m_root_packer = FASTUIDRAWnew fastuidraw::PainterPacker(m_default_shaders, m_stats,
+                                                          m_profiler, m_backend,
                                                           m_backend_factory->painter_shader_registrar(),
                                                           m_backend_factory->configuration_base());
   m_black_brush = m_pool.create_packed_brush(fastuidraw::PainterBrush()
                                              .color(0.0f, 0.0f, 0.0f, 0.0f));
   m_root_identity_matrix = m_pool.create_packed_value(fastuidraw::PainterItemMatrix());
   m_current_z = 1;
+  m_non_aa_fill_increment_z = (m_backend_factory->configuration_base().reorder_opaque_draws()) ? 1 : 0;
   m_draw_data_added_count = 0;
   m_max_attribs_per_block = m_backend->attribs_per_mapping();
   m_max_indices_per_block = m_backend->indices_per_mapping();
@@ -3407,6 +3718,52 @@ compute_clip_intersect_rect(const fastuidraw::Rect &plogical_rect,
   return compute_clip_intersect_polygon(tmp, additional_pixel_slack);
 }
 
+fastuidraw::BoundingBox<float>
+PainterPrivate::
+compute_draw_bounds(const fastuidraw::Rect &logical_rect)
+{
+  if (!m_compute_draw_bounds)
+    {
+      return fastuidraw::BoundingBox<float>();
+    }
+
+  /* anti-aliasing draws up to a pixel past the geometry */
+  return compute_clip_intersect_rect(logical_rect, 2.0f, 0.0f);
+}
+
+template<typename T>
+fastuidraw::BoundingBox<float>
+PainterPrivate::
+compute_stroke_draw_bounds(const T &path,
+                           fastuidraw::c_array<const float> geometry_inflation,
+                           bool select_miter_joins,
+                           const typename T::SubsetSelection &selection)
+{
+  using namespace fastuidraw;
+
+  vecN<float, PathEnums::path_geometry_inflation_index_count> room;
+  const float sqrt2(t_sqrt(2.0f));
+
+  if (!m_compute_draw_bounds)
+    {
+      return BoundingBox<float>();
+    }
+
+  /* The geometry inflation is the stroking radius, but a corner
+   * of a square cap is the stroking radius times sqrt(2) from
+   * the path along an axis and anti-aliasing draws up to a pixel
+   * past the stroke.
+   */
+  for (unsigned int i = 0; i < room.size(); ++i)
+    {
+      room[i] = sqrt2 * geometry_inflation[i];
+    }
+  room[PathEnums::pixel_space_distance] += 2.0f;
+  room[PathEnums::pixel_space_distance_miter_joins] += 2.0f;
+
+  return compute_bounding_box_of_path(path, room, select_miter_joins, selection);
+}
+
 void
 PainterPrivate::
 begin_coverage_buffer_normalized_rect(const fastuidraw::Rect &normalized_rect,
@@ -3839,6 +4196,13 @@ draw_generic(fastuidraw::PainterItemShader *shader,
       FASTUIDRAWassert(p.m_brush_adjust);
     }
 
+  /* all fragments of a draw are within the clipping region
+   * and within the bounds of its geometry if they are known
+   */
+  p.m_bounds = (m_draw_bounds.empty()) ?
+    m_clip_store.current_bb() :
+    m_draw_bounds;
+  request_brush_residency(draw);
   packer()->draw_generic(coverage_buffer, shader, p,
                          attrib_chunks, index_chunks, index_adjusts,
                          attrib_chunk_selector, z);
@@ -3893,11 +4257,79 @@ draw_generic(fastuidraw::PainterItemShader *shader,
       p.m_brush_adjust = *m_current_brush_adjust;
       FASTUIDRAWassert(p.m_brush_adjust);
     }
+  p.m_bounds = (m_draw_bounds.empty()) ?
+    m_clip_store.current_bb() :
+    m_draw_bounds;
+  request_brush_residency(draw);
   return_value = packer()->draw_generic(coverage_buffer, shader, p, src, z);
   ++m_draw_data_added_count;
   return return_value;
 }
 
+void
+PainterPrivate::
+request_brush_residency(const fastuidraw::PainterData &draw)
+{
+  using namespace fastuidraw;
+
+  const PainterBrushShaderData *brush;
+  const BoundingBox<float> &bb(m_clip_store.current_bb());
+  vecN<vec2, 4> corners;
+  BoundingBox<float> item_bb;
+  Rect item_rect;
+  float mag;
+
+  /* brush data that is packed cannot be asked to
+   * request residency of its sparse images.
+   */
+  brush = draw.m_brush.brush_shader_data().m_value;
+  if (!brush
+      || !brush->samples_sparse_image()
+      || bb.empty()
+      || m_clip_rect_state.item_matrix_state_overridden())
+    {
+      return;
+    }
+
+  /* map the corners of the bounding box of the clipping
+   * region from normalized device coordinates to item
+   * coordinates; a corner that no point in front of the
+   * camera maps to makes the visible region unbounded.
+   */
+  const float unbounded(1e7f);
+  const float3x3 &inverse_transpose(m_clip_rect_state.item_matrix_inverse_transpose());
+
+  corners[0] = bb.min_point();
+  corners[1] = vec2(bb.min_point().x(), bb.max_point().y());
+  corners[2] = bb.max_point();
+  corners[3] = vec2(bb.max_point().x(), bb.min_point().y());
+  for (const vec2 &c : corners)
+    {
+      vec3 q;
+
+      q = vec3(c.x(), c.y(), 1.0f) * inverse_transpose;
+      if (q.z() > 0.0f)
+        {
+          item_bb.union_point(vec2(q.x(), q.y()) / q.z());
+        }
+      else
+        {
+          item_bb.union_point(vec2(-unbounded, -unbounded));
+          item_bb.union_point(vec2(unbounded, unbounded));
+        }
+    }
+
+  item_rect
+    .min_point(item_bb.min_point())
+    .max_point(item_bb.max_point());
+
+  mag = compute_magnification(item_rect);
+  if (mag > 0.0f)
+    {
+      brush->request_residency(item_rect, mag);
+    }
+}
+
 void
 PainterPrivate::
 pre_draw_anti_alias_fuzz(const fastuidraw::FilledPath &filled_path,
@@ -4096,7 +4528,8 @@ stroke_path(const fastuidraw::PainterStrokeShader &shader,
             enum fastuidraw::Painter::join_style js,
             bool apply_anti_aliasing,
             enum fastuidraw::Painter::stroking_method_t stroking_method,
-            const fastuidraw::PathEffect *effect)
+            const fastuidraw::PathEffect *effect,
+            bool cache_effect)
 {
   using namespace fastuidraw;
   if (m_clip_rect_state.m_all_content_culled)
@@ -4127,8 +4560,12 @@ stroke_path(const fastuidraw::PainterStrokeShader &shader,
         }
       else
         {
+          /* a PathEffect can produce geometry anywhere, so
+           * the bounds of the stroke are not known.
+           */
           stroke_path(shader, draw, *tess, thresh,
-                      cp, js, apply_anti_aliasing, *effect);
+                      cp, js, apply_anti_aliasing, *effect, cache_effect,
+                      false);
         }
     }
 }
@@ -4141,7 +4578,9 @@ stroke_path(const fastuidraw::PainterStrokeShader &shader,
             enum fastuidraw::Painter::cap_style cp,
             enum fastuidraw::Painter::join_style js,
             bool apply_anti_aliasing,
-            const fastuidraw::PathEffect &effect)
+            const fastuidraw::PathEffect &effect,
+            bool cache_effect,
+            bool effect_within_path)
 {
   using namespace fastuidraw;
 
@@ -4176,12 +4615,27 @@ stroke_path(const fastuidraw::PainterStrokeShader &shader,
                  &coverage_buffer_bb);
 
   m_work_room.m_effect_stroker.m_storage.clear();
-  m_work_room.m_effect_stroker.m_selection.apply_path_effect(effect,
-                                                             m_work_room.m_effect_stroker.m_storage);
+  if (cache_effect)
+    {
+      m_work_room.m_effect_stroker.m_selection.apply_cached_path_effect(effect,
+                                                                        m_work_room.m_effect_stroker.m_storage);
+    }
+  else
+    {
+      m_work_room.m_effect_stroker.m_selection.apply_path_effect(effect,
+                                                                 m_work_room.m_effect_stroker.m_storage);
+    }
 
   m_work_room.m_effect_stroker.set_source(m_work_room.m_effect_stroker.m_storage,
                                           shader, method, tp, aa);
 
+  DrawBoundsScope draw_bounds(this, (effect_within_path) ?
+                              compute_stroke_draw_bounds(path.partitioned(),
+                                                         additional_room,
+                                                         PainterEnums::is_miter_join(js),
+                                                         m_work_room.m_effect_stroker.m_selection) :
+                              BoundingBox<float>());
+
   requires_coverage_buffer = m_work_room.m_effect_stroker.requires_coverage_buffer();
   if (requires_coverage_buffer)
     {
@@ -4200,6 +4654,105 @@ stroke_path(const fastuidraw::PainterStrokeShader &shader,
     }
 }
 
+void
+PainterPrivate::
+stroke_dashed_path(const fastuidraw::PainterDashedStrokeShaderSet &shader,
+                   const fastuidraw::PainterData &draw,
+                   const fastuidraw::Path &path,
+                   const fastuidraw::StrokingStyle &stroke_style,
+                   bool apply_shader_anti_aliasing,
+                   enum fastuidraw::Painter::stroking_method_t stroking_method,
+                   const fastuidraw::PathEffect *effect,
+                   const fastuidraw::PainterDashedStrokeParams *dashed_params)
+{
+  using namespace fastuidraw;
+
+  FASTUIDRAWmessaged_assert(0 <= stroke_style.m_cap_style && stroke_style.m_cap_style < Painter::number_cap_styles,
+                            "Painter::stroke_path: bad cap_style provided");
+  FASTUIDRAWmessaged_assert(0 <= stroke_style.m_join_style && stroke_style.m_join_style < Painter::number_join_styles,
+                            "Painter::stroke_path: bad join_style provided");
+
+  /* When the dash pattern is sparse, most of the fragments of
+   * GPU dashing are discarded; instead dash the path on the CPU
+   * and only stroke the draw intervals. This is only possible
+   * when the caller gave the PainterDashedStrokeParams and the
+   * shaders are the default shaders, so that we know the
+   * non-dashed stroke shader to use.
+   */
+  if (dashed_params
+      && !effect
+      && &shader == &m_default_shaders.dashed_stroke_shader()
+      && !dashed_params->dash_pattern().empty()
+      && dashed_params->duty_cycle() < m_cpu_dashing_duty_cycle)
+    {
+      stroke_path_cpu_dashed(*dashed_params, draw, path,
+                             stroke_style.m_cap_style,
+                             stroke_style.m_join_style,
+                             apply_shader_anti_aliasing,
+                             stroking_method,
+                             stroke_style.m_cache_path_effect);
+      return;
+    }
+
+  stroke_path(shader.shader(stroke_style.m_cap_style),
+              draw, path,
+              Painter::number_cap_styles,
+              stroke_style.m_join_style,
+              apply_shader_anti_aliasing,
+              stroking_method, effect,
+              stroke_style.m_cache_path_effect);
+}
+
+void
+PainterPrivate::
+stroke_path_cpu_dashed(const fastuidraw::PainterDashedStrokeParams &dashed_params,
+                       const fastuidraw::PainterData &pdraw,
+                       const fastuidraw::Path &path,
+                       enum fastuidraw::Painter::cap_style cp,
+                       enum fastuidraw::Painter::join_style js,
+                       bool apply_anti_aliasing,
+                       enum fastuidraw::Painter::stroking_method_t stroking_method,
+                       bool cache_effect)
+{
+  using namespace fastuidraw;
+  if (m_clip_rect_state.m_all_content_culled)
+    {
+      return;
+    }
+
+  /* The dash pattern is realized by the PathDashEffect, so the
+   * draw intervals are stroked with the non-dashed stroke shader
+   * using the stroking parameters of dashed_params.
+   */
+  const PainterStrokeShader &shader(m_default_shaders.stroke_shader());
+  PainterStrokeParams stroke_params;
+  PainterData draw(pdraw);
+  const TessellatedPath *tess;
+  float thresh;
+
+  stroke_params
+    .miter_limit(dashed_params.miter_limit())
+    .radius(dashed_params.radius())
+    .stroking_units(dashed_params.stroking_units());
+
+  draw.set(PainterDataValue<PainterItemShaderData>(&stroke_params));
+  draw.make_packed(m_pool);
+  tess = select_path_for_stroking(path, shader, draw,
+                                  apply_anti_aliasing,
+                                  stroking_method, thresh);
+  if (!tess)
+    {
+      return;
+    }
+
+  /* the dashes are pieces of the path, so they are within
+   * the bounds of the stroke of the path.
+   */
+  stroke_path(shader, draw, *tess, thresh, cp, js, apply_anti_aliasing,
+              m_work_room.m_effect_stroker.m_dash_effects.fetch(dashed_params),
+              cache_effect, true);
+}
+
 void
 PainterPrivate::
 stroke_path(const fastuidraw::PainterStrokeShader &shader,
@@ -4213,13 +4766,21 @@ stroke_path(const fastuidraw::PainterStrokeShader &shader,
 
   BoundingBox<float> coverage_buffer_bb;
   bool requires_coverage_buffer;
+  vecN<float, PathEnums::path_geometry_inflation_index_count> additional_room(0.0f);
+  c_array<const uvec4> item_shader_packed_data(draw.m_item_shader_data.m_packed_value.packed_data());
 
   requires_coverage_buffer =
     m_work_room.m_non_effect_stroker.init_for_stroking(*this, shader,
-                                                       draw.m_item_shader_data.m_packed_value.packed_data(),
+                                                       item_shader_packed_data,
                                                        path, thresh, cp, js, apply_anti_aliasing,
                                                        &coverage_buffer_bb);
 
+  shader.stroking_data_selector()->stroking_distances(item_shader_packed_data, additional_room);
+  DrawBoundsScope draw_bounds(this,
+                              compute_stroke_draw_bounds(path, additional_room,
+                                                         PainterEnums::is_miter_join(js),
+                                                         m_work_room.m_non_effect_stroker.selection()));
+
   if (requires_coverage_buffer)
     {
       if (coverage_buffer_bb.empty())
@@ -4361,6 +4922,7 @@ fill_path(const fastuidraw::PainterFillShader &shader,
       return;
     }
 
+  DrawBoundsScope draw_bounds(this, compute_draw_bounds(filled_path.bounding_box()));
   if (apply_anti_aliasing)
     {
       pre_draw_anti_alias_fuzz(filled_path,
@@ -4369,7 +4931,7 @@ fill_path(const fastuidraw::PainterFillShader &shader,
     }
   else
     {
-      m_work_room.m_fill_aa_fuzz.m_total_increment_z = 0;
+      m_work_room.m_fill_aa_fuzz.m_total_increment_z = m_non_aa_fill_increment_z;
     }
 
   draw_generic(shader.item_shader().get(), draw,
@@ -4396,6 +4958,12 @@ fill_rounded_rect(const fastuidraw::PainterFillShader &shader,
 {
   using namespace fastuidraw;
 
+  /* the bounds are in normalized device coordinates, so
+   * they stay valid as the transformation is changed to
+   * draw the pieces of the rounded rectangle.
+   */
+  DrawBoundsScope draw_bounds(this, compute_draw_bounds(R));
+
   /* Save our transformation and clipping state */
   ClipRectState m(m_clip_rect_state);
   RoundedRectTransformations rect_transforms(R, &m_pool);
@@ -4633,7 +5201,11 @@ ready_aa_polygon_attribs(fastuidraw::c_array<const fastuidraw::vec2> pts,
   using namespace fastuidraw;
 
   m_work_room.m_polygon.m_fuzz_increment_z = 0;
-  if (apply_anti_aliasing)
+  if (!apply_anti_aliasing)
+    {
+      m_work_room.m_polygon.m_fuzz_increment_z = m_non_aa_fill_increment_z;
+    }
+  else
     {
       m_work_room.m_polygon.m_aa_fuzz_attribs.clear();
       m_work_room.m_polygon.m_aa_fuzz_indices.clear();
@@ -4726,12 +5298,12 @@ fill_convex_polygon(bool allow_sw_clipping,
         }
     }
 
-  BoundingBox<float> cvg_bb;
+  BoundingBox<float> cvg_bb, in_bb;
+
+  in_bb.union_points(pts.begin(), pts.end());
+  DrawBoundsScope draw_bounds(this, compute_draw_bounds(in_bb.as_rect()));
   if (apply_anti_aliasing)
     {
-      BoundingBox<float> in_bb;
-
-      in_bb.union_points(pts.begin(), pts.end());
       cvg_bb = compute_clip_intersect_rect(in_bb.as_rect(), 1.0f, 0.0f);
       if (cvg_bb.empty())
         {
@@ -4916,6 +5488,7 @@ begin(const reference_counted_ptr<PainterSurface> &surface,
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::begin");
 
   image_atlas().lock_resources();
   colorstop_atlas().lock_resources();
@@ -4981,6 +5554,7 @@ end(void)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::end");
 
   /* All begin_layer() and begin_coverage_buffers() should
    * have a matching end_layer() and end_coverage_buffer().
@@ -5044,6 +5618,7 @@ flush(const reference_counted_ptr<PainterSurface> &new_surface)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::flush");
 
   if (!surface() || !new_surface)
     {
@@ -5168,6 +5743,7 @@ draw_generic(PainterItemShader *shader, const PainterData &draw,
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::draw_generic");
   if (!d->m_clip_rect_state.m_all_content_culled)
     {
       d->draw_generic(shader, draw, attrib_chunks, index_chunks,
@@ -5186,6 +5762,7 @@ draw_generic(PainterItemShader *shader, const PainterData &draw,
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::draw_generic");
   if (!d->m_clip_rect_state.m_all_content_culled)
     {
       d->draw_generic(shader, draw, attrib_chunks, index_chunks,
@@ -5202,6 +5779,7 @@ draw_generic(PainterItemShader *shader,
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::draw_generic");
   if (!d->m_clip_rect_state.m_all_content_culled)
     {
       d->m_current_z += d->draw_generic(shader, draw, src, d->m_current_z);
@@ -5238,6 +5816,7 @@ draw_generic(PainterItemShader *shader,
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::draw_generic");
   if (d->m_clip_rect_state.m_all_content_culled)
     {
       return;
@@ -5299,6 +5878,7 @@ fill_convex_polygon(const PainterFillShader &shader,
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::fill_convex_polygon");
   d->m_current_z += d->fill_convex_polygon(shader, draw, pts, apply_shader_anti_aliasing);
 }
 
@@ -5346,6 +5926,7 @@ fill_rounded_rect(const PainterFillShader &shader, const PainterData &draw,
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::fill_rounded_rect");
 
   if (d->m_clip_rect_state.m_all_content_culled)
     {
@@ -5434,6 +6015,7 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw, const Pa
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::stroke_path");
 
   FASTUIDRAWmessaged_assert(0 <= stroke_style.m_cap_style && stroke_style.m_cap_style < number_cap_styles,
                             "Painter::stroke_path: bad cap_style provided");
@@ -5443,7 +6025,8 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw, const Pa
                  stroke_style.m_cap_style,
                  stroke_style.m_join_style,
                  apply_shader_anti_aliasing,
-                 stroking_method, effect);
+                 stroking_method, effect,
+                 stroke_style.m_cache_path_effect);
 }
 
 void
@@ -5469,18 +6052,11 @@ stroke_dashed_path(const PainterDashedStrokeShaderSet &shader, const PainterData
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::stroke_dashed_path");
 
-  FASTUIDRAWmessaged_assert(0 <= stroke_style.m_cap_style && stroke_style.m_cap_style < number_cap_styles,
-                            "Painter::stroke_path: bad cap_style provided");
-  FASTUIDRAWmessaged_assert(0 <= stroke_style.m_join_style && stroke_style.m_join_style < number_join_styles,
-                            "Painter::stroke_path: bad join_style provided");
-
-  d->stroke_path(shader.shader(stroke_style.m_cap_style),
-                 draw, path,
-                 number_cap_styles,
-                 stroke_style.m_join_style,
-                 apply_shader_anti_aliasing,
-                 stroking_method, effect);
+  d->stroke_dashed_path(shader, draw, path, stroke_style,
+                        apply_shader_anti_aliasing,
+                        stroking_method, effect, nullptr);
 }
 
 void
@@ -5496,6 +6072,26 @@ stroke_dashed_path(const PainterData &draw, const Path &path,
                      stroking_method, effect);
 }
 
+void
+fastuidraw::Painter::
+stroke_dashed_path(const PainterBrush &brush,
+                   const PainterDashedStrokeParams &stroking_params,
+                   const Path &path, const StrokingStyle &stroke_style,
+                   bool apply_shader_anti_aliasing,
+                   enum stroking_method_t stroking_method,
+                   const PathEffect *effect)
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::stroke_dashed_path");
+
+  d->stroke_dashed_path(d->m_default_shaders.dashed_stroke_shader(),
+                        PainterData(&brush, &stroking_params),
+                        path, stroke_style,
+                        apply_shader_anti_aliasing,
+                        stroking_method, effect, &stroking_params);
+}
+
 void
 fastuidraw::Painter::
 fill_path(const PainterFillShader &shader, const PainterData &draw,
@@ -5504,6 +6100,7 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::fill_path");
   d->fill_path(shader, draw, filled_path, fill_rule,
                apply_shader_anti_aliasing);
 }
@@ -5539,6 +6136,7 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
   PainterPrivate *d;
 
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::fill_path");
   d->fill_path(shader, draw, filled_path, fill_rule,
                apply_shader_anti_aliasing);
 }
@@ -5614,6 +6212,7 @@ draw_glyphs(const PainterGlyphShader &shader, const PainterData &draw,
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::draw_glyphs");
 
   if (!renderer.valid())
     {
@@ -5634,14 +6233,26 @@ draw_glyphs(const PainterGlyphShader &shader, const PainterData &draw,
                                       make_c_array(d->m_work_room.m_glyph.m_subsets));
   d->m_work_room.m_glyph.m_attribs.resize(num);
   d->m_work_room.m_glyph.m_indices.resize(num);
+
+  BoundingBox<float> glyphs_bb;
   for (unsigned int k = 0; k < num; ++k)
     {
       unsigned int I(d->m_work_room.m_glyph.m_subsets[k]);
       GlyphSequence::Subset S(glyph_sequence.subset(I));
+      Rect S_bb;
+
       S.attributes_and_indices(renderer,
                    &d->m_work_room.m_glyph.m_attribs[k],
                    &d->m_work_room.m_glyph.m_indices[k]);
+      if (d->m_compute_draw_bounds && S.bounding_box(&S_bb))
+        {
+          glyphs_bb.union_box(S_bb);
+        }
     }
+
+  DrawBoundsScope draw_bounds(d, (glyphs_bb.empty()) ?
+                              BoundingBox<float>() :
+                              d->compute_draw_bounds(glyphs_bb.as_rect()));
   d->draw_generic(shader.shader(renderer.m_type).get(),
                   draw,
                   make_c_array(d->m_work_room.m_glyph.m_attribs),
@@ -5670,6 +6281,7 @@ draw_glyphs(const PainterGlyphShader &shader, const PainterData &draw,
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::draw_glyphs");
 
   if (!renderer.valid())
     {
@@ -5933,6 +6545,24 @@ curve_flatness(void)
   return d->m_curve_flatness;
 }
 
+void
+fastuidraw::Painter::
+cpu_dashing_duty_cycle(float v)
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  d->m_cpu_dashing_duty_cycle = v;
+}
+
+float
+fastuidraw::Painter::
+cpu_dashing_duty_cycle(void) const
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  return d->m_cpu_dashing_duty_cycle;
+}
+
 void
 fastuidraw::Painter::
 save(void)
@@ -6019,6 +6649,7 @@ begin_layer(const reference_counted_ptr<const PainterEffect> &effect,
   Rect clip_region_rect;
 
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::begin_layer");
 
   clip_region_bounds(&clip_region_rect.m_min_point,
                      &clip_region_rect.m_max_point);
@@ -6111,6 +6742,7 @@ end_layer(void)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::end_layer");
 
   FASTUIDRAWmessaged_assert(!d->m_effects_stack.empty(),
                             "Painter::end_layer() called "
@@ -6166,6 +6798,7 @@ begin_coverage_buffer(void)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::begin_coverage_buffer");
   d->begin_coverage_buffer();
 }
 
@@ -6179,6 +6812,7 @@ begin_coverage_buffer(const Rect &logical_rect,
   PainterPrivate *d;
 
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::begin_coverage_buffer");
   nr = d->compute_clip_intersect_rect(logical_rect,
                                       additional_pixel_slack,
                                       additional_item_slack);
@@ -6194,6 +6828,7 @@ begin_coverage_buffer(const NormalizedCoordRect &normalized_rect,
   PainterPrivate *d;
 
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::begin_coverage_buffer");
   nr = d->compute_clip_intersect_rect(normalized_rect, additional_pixel_slack);
   d->begin_coverage_buffer_normalized_rect(nr.as_rect(), !nr.empty());
 }
@@ -6204,6 +6839,7 @@ end_coverage_buffer(void)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::end_coverage_buffer");
   d->end_coverage_buffer();
 }
 
@@ -6278,6 +6914,7 @@ clip_out_path(const FilledPath &path, enum fill_rule_t fill_rule)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::clip_out_path");
 
   if (d->m_clip_rect_state.m_all_content_culled)
     {
@@ -6316,6 +6953,7 @@ clip_out_path(const FilledPath &path, const CustomFillRuleBase &fill_rule)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::clip_out_path");
 
   if (d->m_clip_rect_state.m_all_content_culled)
     {
@@ -6359,6 +6997,7 @@ clip_out_custom(PainterItemShader *shader,
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::clip_out_custom");
 
   if (d->m_clip_rect_state.m_all_content_culled)
     {
@@ -6411,6 +7050,7 @@ clip_out_rounded_rect(const RoundedRect &R)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::clip_out_rounded_rect");
 
   if (d->m_clip_rect_state.m_all_content_culled)
     {
@@ -6449,6 +7089,7 @@ clip_out_convex_polygon(c_array<const vec2> poly)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::clip_out_convex_polygon");
 
   if (d->m_clip_rect_state.m_all_content_culled)
     {
@@ -6470,6 +7111,7 @@ clip_in_path(const FilledPath &path, enum fill_rule_t fill_rule)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::clip_in_path");
 
   if (d->m_clip_rect_state.m_all_content_culled)
     {
@@ -6488,6 +7130,7 @@ clip_in_path(const FilledPath &path, const CustomFillRuleBase &fill_rule)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::clip_in_path");
 
   if (d->m_clip_rect_state.m_all_content_culled)
     {
@@ -6506,6 +7149,7 @@ clip_in_rounded_rect(const RoundedRect &R)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::clip_in_rounded_rect");
 
   if (d->m_clip_rect_state.m_all_content_culled)
     {
@@ -6560,6 +7204,7 @@ clip_in_rect(const Rect &rect)
 {
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
+  ProfileScope profile_scope(d->m_profiler, "Painter::clip_in_rect");
 
   d->m_clip_rect_state.m_all_content_culled = d->m_clip_rect_state.m_all_content_culled
     || rect.m_min_point.x() >= rect.m_max_point.x()
@@ -6815,6 +7460,25 @@ query_stats(c_array<unsigned int> dst) const
     }
 }
 
+void
+fastuidraw::Painter::
+profiler(const reference_counted_ptr<PainterProfiler> &p)
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  d->m_profiler = p;
+  d->m_backend->profiler(p);
+}
+
+const fastuidraw::reference_counted_ptr<fastuidraw::PainterProfiler>&
+fastuidraw::Painter::
+profiler(void) const
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  return d->m_profiler;
+}
+
 /////////////////////////////////////
 // PainterEnums methods
 fastuidraw::c_string
@@ -6834,6 +7498,7 @@ label(enum query_stats_t st)
       EASY(num_ends);
       EASY(num_layers);
       EASY(num_deferred_coverages);
+      EASY(num_draw_breaks_saved);
     default:
       return "unknown";
     }
@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <fastuidraw/painter/painter_brush.hpp>
 #include <fastuidraw/painter/backend/painter_header.hpp>
+#include <private/util_private_math.hpp>
 
 ////////////////////////////////////
 // fastuidraw::PainterBrush methods
@@ -154,6 +155,64 @@ image(const reference_counted_ptr<const Image> &im,
   return sub_image(im, uvec2(0,0), sz, f, mipmap_filtering);
 }
 
+void
+fastuidraw::PainterBrush::
+request_residency(const Rect &rect, float pixels_per_unit) const
+{
+  uint32_t pfeatures = features();
+  Rect brush_rect(rect);
+
+  if (!(pfeatures & image_mask))
+    {
+      return;
+    }
+
+  if (pfeatures & transformation_matrix_mask)
+    {
+      const float2x2 &m(m_data.m_transformation_matrix);
+      vec2 singular_values;
+
+      /* the brush coordinate is m * p, so the number of
+       * pixels a unit of the brush coordinate covers is
+       * at most pixels_per_unit divided by the smallest
+       * singular value of m.
+       */
+      singular_values = detail::compute_singular_values(m);
+      if (singular_values[1] <= 0.0f)
+        {
+          return;
+        }
+      pixels_per_unit /= singular_values[1];
+
+      brush_rect.m_min_point = brush_rect.m_max_point = m * rect.point(Rect::minx_miny_corner);
+      for (int c = 1; c < 4; ++c)
+        {
+          vec2 q(m * rect.point(static_cast<enum Rect::corner_t>(c)));
+
+          brush_rect.m_min_point.x() = t_min(brush_rect.m_min_point.x(), q.x());
+          brush_rect.m_min_point.y() = t_min(brush_rect.m_min_point.y(), q.y());
+          brush_rect.m_max_point.x() = t_max(brush_rect.m_max_point.x(), q.x());
+          brush_rect.m_max_point.y() = t_max(brush_rect.m_max_point.y(), q.y());
+        }
+    }
+
+  if (pfeatures & transformation_translation_mask)
+    {
+      brush_rect.translate(m_data.m_transformation_p);
+    }
+
+  if (pfeatures & repeat_window_mask)
+    {
+      /* the brush coordinate is wrapped into the window,
+       * so any point of the window may be sampled.
+       */
+      brush_rect.m_min_point = m_data.m_window_position;
+      brush_rect.m_max_point = m_data.m_window_position + m_data.m_window_size;
+    }
+
+  m_data.m_image.request_residency(brush_rect, pixels_per_unit);
+}
+
 uint32_t
 fastuidraw::PainterBrush::
 features(void) const
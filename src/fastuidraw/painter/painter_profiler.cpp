@@ -0,0 +1,383 @@
+/*!
+ * \file painter_profiler.cpp
+ * \brief file painter_profiler.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+
+#include <map>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <fastuidraw/painter/painter_profiler.hpp>
+#include <fastuidraw/util/fastuidraw_memory.hpp>
+#include <private/util_private.hpp>
+
+namespace
+{
+  class ShaderStatsTable
+  {
+  public:
+    fastuidraw::PainterProfiler::ShaderStats&
+    fetch(const fastuidraw::PainterShader *shader)
+    {
+      std::map<const fastuidraw::PainterShader*, unsigned int>::iterator iter;
+
+      iter = m_map.find(shader);
+      if (iter != m_map.end())
+        {
+          return m_values[iter->second];
+        }
+
+      m_map[shader] = m_values.size();
+      m_values.push_back(fastuidraw::PainterProfiler::ShaderStats());
+      m_values.back().m_shader = shader;
+      return m_values.back();
+    }
+
+    void
+    clear(void)
+    {
+      m_map.clear();
+      m_values.clear();
+    }
+
+    std::map<const fastuidraw::PainterShader*, unsigned int> m_map;
+    std::vector<fastuidraw::PainterProfiler::ShaderStats> m_values;
+  };
+
+  class PainterProfilerPrivate
+  {
+  public:
+    typedef fastuidraw::PainterProfiler::Event Event;
+
+    PainterProfilerPrivate(void):
+      m_gpu_timing(false),
+      m_epoch(std::chrono::steady_clock::now())
+    {}
+
+    uint64_t
+    time_now(void) const
+    {
+      std::chrono::nanoseconds d;
+
+      d = std::chrono::steady_clock::now() - m_epoch;
+      return d.count();
+    }
+
+    static
+    void
+    write_json_string(std::ostream &str, fastuidraw::c_string s);
+
+    static
+    void
+    write_json_event(std::ostream &str, const Event &ev);
+
+    bool m_gpu_timing;
+    std::chrono::steady_clock::time_point m_epoch;
+
+    /* CPU events are stored in the order they were
+     * opened, m_open_cpu_events are the indices into
+     * m_cpu_events of the events not yet closed.
+     */
+    std::vector<Event> m_cpu_events;
+    std::vector<unsigned int> m_open_cpu_events;
+    std::vector<Event> m_gpu_events;
+    ShaderStatsTable m_item_shader_stats;
+    ShaderStatsTable m_brush_shader_stats;
+    std::map<uint32_t, unsigned int> m_group_stats_map;
+    std::vector<fastuidraw::PainterProfiler::GroupStats> m_group_stats;
+
+    mutable std::vector<Event> m_events;
+    mutable std::string m_json;
+  };
+}
+
+//////////////////////////////////////////
+// PainterProfilerPrivate methods
+void
+PainterProfilerPrivate::
+write_json_string(std::ostream &str, fastuidraw::c_string s)
+{
+  str << '"';
+  for (; s && *s; ++s)
+    {
+      if (*s == '"' || *s == '\\')
+        {
+          str << '\\' << *s;
+        }
+      else if (static_cast<unsigned char>(*s) >= 0x20)
+        {
+          str << *s;
+        }
+    }
+  str << '"';
+}
+
+void
+PainterProfilerPrivate::
+write_json_event(std::ostream &str, const Event &ev)
+{
+  /* the Chrome trace event format expects
+   * times in microseconds
+   */
+  str << "{\"name\":";
+  write_json_string(str, ev.m_name);
+  str << ",\"cat\":\""
+      << ((ev.m_type == fastuidraw::PainterProfiler::cpu_event) ? "cpu" : "gpu")
+      << "\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+      << ((ev.m_type == fastuidraw::PainterProfiler::cpu_event) ? 0 : 1)
+      << ",\"ts\":" << static_cast<double>(ev.m_begin) / 1000.0
+      << ",\"dur\":" << static_cast<double>(ev.m_duration) / 1000.0
+      << ",\"args\":{\"depth\":" << ev.m_depth
+      << ",\"item_group\":" << ev.m_item_group << "}}";
+}
+
+////////////////////////////////////////////
+// fastuidraw::PainterProfiler methods
+fastuidraw::PainterProfiler::
+PainterProfiler(void)
+{
+  m_d = FASTUIDRAWnew PainterProfilerPrivate();
+}
+
+fastuidraw::PainterProfiler::
+~PainterProfiler()
+{
+  PainterProfilerPrivate *d;
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+bool
+fastuidraw::PainterProfiler::
+gpu_timing(void) const
+{
+  PainterProfilerPrivate *d;
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+  return d->m_gpu_timing;
+}
+
+fastuidraw::PainterProfiler&
+fastuidraw::PainterProfiler::
+gpu_timing(bool v)
+{
+  PainterProfilerPrivate *d;
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+  d->m_gpu_timing = v;
+  return *this;
+}
+
+void
+fastuidraw::PainterProfiler::
+clear(void)
+{
+  PainterProfilerPrivate *d;
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+
+  FASTUIDRAWassert(d->m_open_cpu_events.empty());
+  d->m_epoch = std::chrono::steady_clock::now();
+  d->m_cpu_events.clear();
+  d->m_open_cpu_events.clear();
+  d->m_gpu_events.clear();
+  d->m_item_shader_stats.clear();
+  d->m_brush_shader_stats.clear();
+  d->m_group_stats_map.clear();
+  d->m_group_stats.clear();
+  d->m_events.clear();
+}
+
+uint64_t
+fastuidraw::PainterProfiler::
+time_now(void) const
+{
+  PainterProfilerPrivate *d;
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+  return d->time_now();
+}
+
+void
+fastuidraw::PainterProfiler::
+begin_cpu_event(c_string name)
+{
+  PainterProfilerPrivate *d;
+  Event ev;
+
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+  ev.m_name = name;
+  ev.m_type = cpu_event;
+  ev.m_begin = d->time_now();
+  ev.m_duration = 0;
+  ev.m_depth = d->m_open_cpu_events.size();
+  ev.m_item_group = 0;
+
+  d->m_open_cpu_events.push_back(d->m_cpu_events.size());
+  d->m_cpu_events.push_back(ev);
+}
+
+void
+fastuidraw::PainterProfiler::
+end_cpu_event(void)
+{
+  PainterProfilerPrivate *d;
+  uint64_t t;
+
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+  FASTUIDRAWassert(!d->m_open_cpu_events.empty());
+  if (d->m_open_cpu_events.empty())
+    {
+      return;
+    }
+
+  t = d->time_now();
+  Event &ev(d->m_cpu_events[d->m_open_cpu_events.back()]);
+  ev.m_duration = (t > ev.m_begin) ? t - ev.m_begin : 0u;
+  d->m_open_cpu_events.pop_back();
+}
+
+void
+fastuidraw::PainterProfiler::
+add_gpu_event(c_string name, uint64_t begin,
+              uint64_t duration, uint32_t item_group)
+{
+  PainterProfilerPrivate *d;
+  std::map<uint32_t, unsigned int>::iterator iter;
+  Event ev;
+
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+  ev.m_name = name;
+  ev.m_type = gpu_event;
+  ev.m_begin = begin;
+  ev.m_duration = duration;
+  ev.m_depth = 0;
+  ev.m_item_group = item_group;
+  d->m_gpu_events.push_back(ev);
+
+  iter = d->m_group_stats_map.find(item_group);
+  if (iter == d->m_group_stats_map.end())
+    {
+      iter = d->m_group_stats_map.insert(std::make_pair(item_group, d->m_group_stats.size())).first;
+      d->m_group_stats.push_back(GroupStats());
+      d->m_group_stats.back().m_item_group = item_group;
+    }
+
+  GroupStats &G(d->m_group_stats[iter->second]);
+  ++G.m_number_draw_breaks;
+  G.m_gpu_time += duration;
+}
+
+void
+fastuidraw::PainterProfiler::
+add_pack_sample(const PainterShader *item_shader,
+                uint32_t item_group,
+                const PainterShader *brush_shader,
+                unsigned int number_headers,
+                unsigned int number_indices,
+                uint64_t pack_time)
+{
+  PainterProfilerPrivate *d;
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+
+  if (item_shader)
+    {
+      ShaderStats &S(d->m_item_shader_stats.fetch(item_shader));
+
+      S.m_item_group = item_group;
+      ++S.m_number_draws;
+      S.m_number_headers += number_headers;
+      S.m_number_indices += number_indices;
+      S.m_pack_time += pack_time;
+    }
+
+  if (brush_shader)
+    {
+      ShaderStats &S(d->m_brush_shader_stats.fetch(brush_shader));
+
+      ++S.m_number_draws;
+      S.m_number_headers += number_headers;
+      S.m_number_indices += number_indices;
+      S.m_pack_time += pack_time;
+    }
+}
+
+fastuidraw::c_array<const fastuidraw::PainterProfiler::Event>
+fastuidraw::PainterProfiler::
+events(void) const
+{
+  PainterProfilerPrivate *d;
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+
+  d->m_events.clear();
+  d->m_events.reserve(d->m_cpu_events.size() + d->m_gpu_events.size());
+  d->m_events.insert(d->m_events.end(), d->m_cpu_events.begin(), d->m_cpu_events.end());
+  d->m_events.insert(d->m_events.end(), d->m_gpu_events.begin(), d->m_gpu_events.end());
+  return make_c_array(d->m_events);
+}
+
+fastuidraw::c_array<const fastuidraw::PainterProfiler::ShaderStats>
+fastuidraw::PainterProfiler::
+item_shader_stats(void) const
+{
+  PainterProfilerPrivate *d;
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+  return make_c_array(d->m_item_shader_stats.m_values);
+}
+
+fastuidraw::c_array<const fastuidraw::PainterProfiler::ShaderStats>
+fastuidraw::PainterProfiler::
+brush_shader_stats(void) const
+{
+  PainterProfilerPrivate *d;
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+  return make_c_array(d->m_brush_shader_stats.m_values);
+}
+
+fastuidraw::c_array<const fastuidraw::PainterProfiler::GroupStats>
+fastuidraw::PainterProfiler::
+group_stats(void) const
+{
+  PainterProfilerPrivate *d;
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+  return make_c_array(d->m_group_stats);
+}
+
+fastuidraw::c_string
+fastuidraw::PainterProfiler::
+chrome_trace_json(void) const
+{
+  PainterProfilerPrivate *d;
+  std::ostringstream str;
+  c_array<const Event> evs;
+
+  d = static_cast<PainterProfilerPrivate*>(m_d);
+  evs = events();
+
+  str << std::fixed << std::setprecision(3);
+  str << "{\"traceEvents\":[\n"
+      << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n"
+      << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+  for (const Event &ev : evs)
+    {
+      str << ",\n";
+      PainterProfilerPrivate::write_json_event(str, ev);
+    }
+  str << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+  d->m_json = str.str();
+  return d->m_json.c_str();
+}
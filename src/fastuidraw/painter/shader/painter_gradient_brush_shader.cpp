@@ -16,9 +16,12 @@
  *
  */
 
+#include <vector>
+#include <limits>
 #include <fastuidraw/util/vecN.hpp>
 #include <fastuidraw/painter/shader/painter_gradient_brush_shader.hpp>
 #include <fastuidraw/painter/shader_data/painter_packed_value_pool.hpp>
+#include <private/util_private.hpp>
 
 namespace
 {
@@ -28,7 +31,8 @@ namespace
       number_spread_types = fastuidraw::PainterBrushEnums::number_spread_types,
       number_gradient_types = fastuidraw::PainterBrushEnums::number_gradient_types,
 
-      number_generic_sub_shaders = number_spread_types * number_gradient_types
+      number_specific_sub_shaders = fastuidraw::PainterGradientBrushShader::number_sub_shaders_of_specific_gradient,
+      number_generic_sub_shaders = fastuidraw::PainterGradientBrushShader::number_sub_shaders_of_generic_gradient
     };
 
   class PerGradientType
@@ -36,7 +40,7 @@ namespace
   public:
     PerGradientType(shader_ref parent);
 
-    fastuidraw::vecN<shader_ref, number_spread_types> m_sub_shader;
+    fastuidraw::vecN<shader_ref, number_specific_sub_shaders> m_sub_shader;
   };
 
   class GenericGradientType
@@ -47,6 +51,182 @@ namespace
     fastuidraw::vecN<shader_ref, number_generic_sub_shaders> m_sub_shaders;
   };
 
+  /* The analytic color stops are packed after the gradient data
+   * as the leaves of a 4-ary search tree (root level first) of
+   * the stop places, in the same layout as the dash pattern of
+   * PainterDashedStrokeParams, followed by the colors of the stops
+   * with one uint32_t per color. The tree and colors are derived
+   * from just the number of stops.
+   */
+  unsigned int
+  color_stop_tree_leaf_blocks(unsigned int number_stops)
+  {
+    return (number_stops + 3u) >> 2u;
+  }
+
+  unsigned int
+  color_stop_tree_height(unsigned int number_stops)
+  {
+    unsigned int h(0), num_leaf_blocks(color_stop_tree_leaf_blocks(number_stops));
+    while ((1u << (2u * h)) < num_leaf_blocks)
+      {
+        ++h;
+      }
+    return h;
+  }
+
+  unsigned int
+  color_stop_tree_level_size(unsigned int number_stops, unsigned int height)
+  {
+    unsigned int num_leaf_blocks(color_stop_tree_leaf_blocks(number_stops));
+    return (num_leaf_blocks + (1u << (2u * height)) - 1u) >> (2u * height);
+  }
+
+  unsigned int
+  color_stop_tree_blocks(unsigned int number_stops)
+  {
+    unsigned int return_value(0u);
+    for (unsigned int h = 0, height = color_stop_tree_height(number_stops); h <= height; ++h)
+      {
+        return_value += color_stop_tree_level_size(number_stops, h);
+      }
+    return return_value;
+  }
+
+  unsigned int
+  analytic_color_stop_blocks(unsigned int number_stops)
+  {
+    return color_stop_tree_blocks(number_stops)
+      + FASTUIDRAW_NUMBER_BLOCK4_NEEDED(number_stops);
+  }
+
+  void
+  pack_analytic_color_stops(fastuidraw::c_array<const fastuidraw::ColorStop> stops,
+                            fastuidraw::c_array<uint32_t> dst)
+  {
+    using namespace fastuidraw;
+
+    /* The padding is larger than any stop so that a search
+     * ends at the last stop; as for the dash pattern, the
+     * separator of the last child of a level is also the
+     * padding.
+     */
+    unsigned int number_stops(stops.size());
+    unsigned int height(color_stop_tree_height(number_stops));
+    float pad(std::numeric_limits<float>::max());
+    std::vector<std::vector<float> > levels(height + 1);
+    c_array<uint32_t> colors;
+
+    levels[0].resize(4 * color_stop_tree_level_size(number_stops, 0), pad);
+    for (unsigned int i = 0; i < number_stops; ++i)
+      {
+        levels[0][i] = stops[i].m_place;
+      }
+
+    for (unsigned int h = 1; h <= height; ++h)
+      {
+        unsigned int num_children(color_stop_tree_level_size(number_stops, h - 1));
+
+        levels[h].resize(4 * color_stop_tree_level_size(number_stops, h), pad);
+        for (unsigned int c = 0; c + 1 < num_children; ++c)
+          {
+            levels[h][c] = levels[h - 1][4 * c + 3];
+          }
+      }
+
+    for (unsigned int h = height + 1; h > 0; --h)
+      {
+        for (float f : levels[h - 1])
+          {
+            dst.front() = pack_float(f);
+            dst = dst.sub_array(1);
+          }
+      }
+
+    colors = dst.sub_array(0, number_stops);
+    for (unsigned int i = 0; i < number_stops; ++i)
+      {
+        const u8vec4 &c(stops[i].m_color);
+
+        colors[i] =
+          pack_bits(PainterGradientBrushShaderData::analytic_color_stop_red_bit0, 8u, c.x())
+          | pack_bits(PainterGradientBrushShaderData::analytic_color_stop_green_bit0, 8u, c.y())
+          | pack_bits(PainterGradientBrushShaderData::analytic_color_stop_blue_bit0, 8u, c.z())
+          | pack_bits(PainterGradientBrushShaderData::analytic_color_stop_alpha_bit0, 8u, c.w());
+      }
+  }
+
+  fastuidraw::vec4
+  unpack_analytic_color(uint32_t v)
+  {
+    using namespace fastuidraw;
+
+    vec4 return_value(unpack_bits(PainterGradientBrushShaderData::analytic_color_stop_red_bit0, 8u, v),
+                      unpack_bits(PainterGradientBrushShaderData::analytic_color_stop_green_bit0, 8u, v),
+                      unpack_bits(PainterGradientBrushShaderData::analytic_color_stop_blue_bit0, 8u, v),
+                      unpack_bits(PainterGradientBrushShaderData::analytic_color_stop_alpha_bit0, 8u, v));
+    return return_value / 255.0f;
+  }
+
+  /* Evaluate the analytic color stops packed by
+   * pack_analytic_color_stops() at an interpolate;
+   * mirrors fastuidraw_analytic_color_stop() of the
+   * GLSL shaders.
+   */
+  fastuidraw::vec4
+  evaluate_analytic_color_stops(fastuidraw::c_array<const uint32_t> packed,
+                                unsigned int number_stops, float t)
+  {
+    using namespace fastuidraw;
+
+    c_array<const uint32_t> colors;
+    unsigned int h, level_start, block, c;
+    vecN<float, 4> S;
+    float lower, p0, p1, s;
+    vec4 c0, c1;
+
+    colors = packed.sub_array(4 * color_stop_tree_blocks(number_stops));
+    lower = 0.0f;
+    level_start = 0;
+    block = 0;
+    h = color_stop_tree_height(number_stops);
+    for (;;)
+      {
+        for (unsigned int k = 0; k < 4; ++k)
+          {
+            S[k] = unpack_float(packed[4 * (level_start + block) + k]);
+          }
+        c = (t >= S[0]) + (t >= S[1]) + (t >= S[2]);
+        if (h == 0)
+          {
+            break;
+          }
+        lower = (c > 0) ? S[c - 1] : lower;
+        level_start += color_stop_tree_level_size(number_stops, h);
+        block = 4 * block + c;
+        --h;
+      }
+
+    /* 4 * block + c is the number of stops whose place
+     * is no more than t
+     */
+    c += (t >= S[3]);
+    if (4 * block + c == 0 || 4 * block + c >= number_stops)
+      {
+        return unpack_analytic_color((4 * block + c == 0) ?
+                                     colors[0] :
+                                     colors[number_stops - 1]);
+      }
+
+    FASTUIDRAWassert(c < 4);
+    p0 = (c > 0) ? S[c - 1] : lower;
+    p1 = S[c];
+    c0 = unpack_analytic_color(colors[4 * block + c - 1]);
+    c1 = unpack_analytic_color(colors[4 * block + c]);
+    s = (t - p0) / (p1 - p0);
+    return c0 + s * (c1 - c0);
+  }
+
   class PainterGradientBrushShaderPrivate
   {
   public:
@@ -74,7 +254,7 @@ namespace
 PerGradientType::
 PerGradientType(shader_ref parent)
 {
-  for (unsigned int i = 0; i < number_spread_types; ++i)
+  for (unsigned int i = 0; i < number_specific_sub_shaders; ++i)
     {
       m_sub_shader[i] = FASTUIDRAWnew fastuidraw::PainterBrushShader(parent, i);
     }
@@ -91,14 +271,17 @@ GenericGradientType(const shader_ref &parent)
     {
       for (unsigned int j = 0; j < number_gradient_types; ++j)
         {
-          unsigned int sub_shader_id;
-          enum PainterBrushEnums::spread_type_t spread_type;
-          enum PainterBrushEnums::gradient_type_t gradient_type;
-
-          spread_type = static_cast<enum PainterBrushEnums::spread_type_t>(i);
-          gradient_type = static_cast<enum PainterBrushEnums::gradient_type_t>(j);
-          sub_shader_id = PainterGradientBrushShader::sub_shader_id(spread_type, gradient_type);
-          m_sub_shaders[sub_shader_id] = FASTUIDRAWnew PainterBrushShader(parent, sub_shader_id);
+          for (unsigned int k = 0; k < 2; ++k)
+            {
+              unsigned int sub_shader_id;
+              enum PainterBrushEnums::spread_type_t spread_type;
+              enum PainterBrushEnums::gradient_type_t gradient_type;
+
+              spread_type = static_cast<enum PainterBrushEnums::spread_type_t>(i);
+              gradient_type = static_cast<enum PainterBrushEnums::gradient_type_t>(j);
+              sub_shader_id = PainterGradientBrushShader::sub_shader_id(spread_type, gradient_type, k != 0);
+              m_sub_shaders[sub_shader_id] = FASTUIDRAWnew PainterBrushShader(parent, sub_shader_id);
+            }
         }
     }
 }
@@ -125,38 +308,39 @@ fastuidraw::PainterGradientBrushShader::
 
 const fastuidraw::reference_counted_ptr<fastuidraw::PainterBrushShader>&
 fastuidraw::PainterGradientBrushShader::
-sub_shader(enum spread_type_t sp, enum gradient_type_t gt) const
+sub_shader(enum spread_type_t sp, enum gradient_type_t gt,
+           bool analytic_color_stops) const
 {
   PainterGradientBrushShaderPrivate *d;
   d = static_cast<PainterGradientBrushShaderPrivate*>(m_d);
-  return d->m_generic.m_sub_shaders[sub_shader_id(sp, gt)];
+  return d->m_generic.m_sub_shaders[sub_shader_id(sp, gt, analytic_color_stops)];
 }
 
 const fastuidraw::reference_counted_ptr<fastuidraw::PainterBrushShader>&
 fastuidraw::PainterGradientBrushShader::
-linear_sub_shader(enum spread_type_t sp) const
+linear_sub_shader(enum spread_type_t sp, bool analytic_color_stops) const
 {
   PainterGradientBrushShaderPrivate *d;
   d = static_cast<PainterGradientBrushShaderPrivate*>(m_d);
-  return d->m_linear.m_sub_shader[sub_shader_id(sp)];
+  return d->m_linear.m_sub_shader[sub_shader_id(sp, analytic_color_stops)];
 }
 
 const fastuidraw::reference_counted_ptr<fastuidraw::PainterBrushShader>&
 fastuidraw::PainterGradientBrushShader::
-radial_sub_shader(enum spread_type_t sp) const
+radial_sub_shader(enum spread_type_t sp, bool analytic_color_stops) const
 {
   PainterGradientBrushShaderPrivate *d;
   d = static_cast<PainterGradientBrushShaderPrivate*>(m_d);
-  return d->m_radial.m_sub_shader[sub_shader_id(sp)];
+  return d->m_radial.m_sub_shader[sub_shader_id(sp, analytic_color_stops)];
 }
 
 const fastuidraw::reference_counted_ptr<fastuidraw::PainterBrushShader>&
 fastuidraw::PainterGradientBrushShader::
-sweep_sub_shader(enum spread_type_t sp) const
+sweep_sub_shader(enum spread_type_t sp, bool analytic_color_stops) const
 {
   PainterGradientBrushShaderPrivate *d;
   d = static_cast<PainterGradientBrushShaderPrivate*>(m_d);
-  return d->m_sweep.m_sub_shader[sub_shader_id(sp)];
+  return d->m_sweep.m_sub_shader[sub_shader_id(sp, analytic_color_stops)];
 }
 
 const fastuidraw::reference_counted_ptr<fastuidraw::PainterBrushShader>&
@@ -175,18 +359,19 @@ create_brush(PainterPackedValuePool &pool,
              enum spread_type_t spread) const
 {
   PainterDataValue<PainterBrushShaderData> packed_data;
+  bool analytic(data.analytic_color_stops());
 
   packed_data = pool.create_packed_value(data);
   switch (data.type())
     {
     case gradient_linear:
-      return PainterCustomBrush(linear_sub_shader(spread).get(), packed_data);
+      return PainterCustomBrush(linear_sub_shader(spread, analytic).get(), packed_data);
 
     case gradient_radial:
-      return PainterCustomBrush(radial_sub_shader(spread).get(), packed_data);
+      return PainterCustomBrush(radial_sub_shader(spread, analytic).get(), packed_data);
 
     case gradient_sweep:
-      return PainterCustomBrush(sweep_sub_shader(spread).get(), packed_data);
+      return PainterCustomBrush(sweep_sub_shader(spread, analytic).get(), packed_data);
 
     default:
       return PainterCustomBrush(white_shader().get(), packed_data);
@@ -195,18 +380,23 @@ create_brush(PainterPackedValuePool &pool,
 
 uint32_t
 fastuidraw::PainterGradientBrushShader::
-sub_shader_id(enum spread_type_t sp, enum gradient_type_t gt)
+sub_shader_id(enum spread_type_t sp, enum gradient_type_t gt,
+              bool analytic_color_stops)
 {
   FASTUIDRAWassert(sp >= 0 && sp < number_spread_types);
   FASTUIDRAWassert(gt >= 0 && gt < number_gradient_types);
-  return sp + number_spread_types * gt;
+  return pack_bits(spread_type_bit0, spread_type_num_bits, sp)
+    | pack_bits(analytic_color_stops_bit, 1u, analytic_color_stops ? 1u : 0u)
+    | pack_bits(gradient_type_bit0, gradient_type_num_bits, gt);
 }
 
 uint32_t
 fastuidraw::PainterGradientBrushShader::
-sub_shader_id(enum spread_type_t sp)
+sub_shader_id(enum spread_type_t sp, bool analytic_color_stops)
 {
-  return sp;
+  FASTUIDRAWassert(sp >= 0 && sp < number_spread_types);
+  return pack_bits(spread_type_bit0, spread_type_num_bits, sp)
+    | pack_bits(analytic_color_stops_bit, 1u, analytic_color_stops ? 1u : 0u);
 }
 
 /////////////////////////////////////////////////////
@@ -215,17 +405,28 @@ unsigned int
 fastuidraw::PainterGradientBrushShaderData::
 data_size(void) const
 {
+  unsigned int return_value;
+
   switch (m_data.m_type)
     {
     case gradient_linear:
-      return FASTUIDRAW_NUMBER_BLOCK4_NEEDED(linear_data_size);
+      return_value = FASTUIDRAW_NUMBER_BLOCK4_NEEDED(linear_data_size);
+      break;
     case gradient_sweep:
-      return FASTUIDRAW_NUMBER_BLOCK4_NEEDED(sweep_data_size);
+      return_value = FASTUIDRAW_NUMBER_BLOCK4_NEEDED(sweep_data_size);
+      break;
     case gradient_radial:
-      return FASTUIDRAW_NUMBER_BLOCK4_NEEDED(radial_data_size);
+      return_value = FASTUIDRAW_NUMBER_BLOCK4_NEEDED(radial_data_size);
+      break;
     default:
       return 0;
     }
+
+  if (analytic_color_stops())
+    {
+      return_value += analytic_color_stop_blocks(m_data.m_cs->color_stops().size());
+    }
+  return return_value;
 }
 
 void
@@ -248,7 +449,9 @@ pack_data(c_array<uvec4> dst) const
     pack_bits(color_stop_x_bit0, color_stop_x_num_bits, x)
     | pack_bits(color_stop_y_bit0, color_stop_y_num_bits, y);
 
-  sub_dest[color_stop_length_offset] = m_data.m_cs->width();
+  sub_dest[color_stop_length_offset] = (analytic_color_stops()) ?
+    m_data.m_cs->color_stops().size() :
+    m_data.m_cs->width();
   sub_dest[p0_x_offset] = pack_float(m_data.m_grad_start.x());
   sub_dest[p0_y_offset] = pack_float(m_data.m_grad_start.y());
   sub_dest[p1_x_offset] = pack_float(m_data.m_grad_end.x());
@@ -259,6 +462,33 @@ pack_data(c_array<uvec4> dst) const
       sub_dest[start_radius_offset] = pack_float(m_data.m_grad_start_r);
       sub_dest[end_radius_offset] = pack_float(m_data.m_grad_end_r);
     }
+
+  if (analytic_color_stops())
+    {
+      unsigned int gradient_blocks;
+
+      gradient_blocks = (m_data.m_type == gradient_radial) ?
+        FASTUIDRAW_NUMBER_BLOCK4_NEEDED(radial_data_size) :
+        FASTUIDRAW_NUMBER_BLOCK4_NEEDED(linear_data_size);
+      pack_analytic_color_stops(m_data.m_cs->color_stops(),
+                                dst.sub_array(gradient_blocks).flatten_array());
+    }
+}
+
+fastuidraw::vec4
+fastuidraw::PainterGradientBrushShaderData::
+compute_color(float t) const
+{
+  if (!m_data.m_cs || m_data.m_type == gradient_non)
+    {
+      return vec4(1.0f, 1.0f, 1.0f, 1.0f);
+    }
+
+  c_array<const ColorStop> stops(m_data.m_cs->color_stops());
+  std::vector<uint32_t> packed(4 * analytic_color_stop_blocks(stops.size()));
+
+  pack_analytic_color_stops(stops, make_c_array(packed));
+  return evaluate_analytic_color_stops(make_c_array(packed), stops.size(), t);
 }
 
 void
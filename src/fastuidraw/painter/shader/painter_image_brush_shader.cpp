@@ -174,6 +174,35 @@ bind_images(void) const
   return c_array<const reference_counted_ptr<const Image> >(im, sz);
 }
 
+bool
+fastuidraw::PainterImageBrushShaderData::
+samples_sparse_image(void) const
+{
+  return m_image && m_image->sparse();
+}
+
+void
+fastuidraw::PainterImageBrushShaderData::
+request_residency(const Rect &rect, float pixels_per_unit) const
+{
+  if (m_image && m_image->sparse() && pixels_per_unit > 0.0f)
+    {
+      Rect texel_rect;
+      vec2 wh(m_image_wh);
+
+      /* the brush coordinate is clamped to the sub-image
+       * and then offset by its min-corner
+       */
+      for (int c = 0; c < 2; ++c)
+        {
+          texel_rect.m_min_point[c] = t_max(0.0f, t_min(wh[c], rect.m_min_point[c]));
+          texel_rect.m_max_point[c] = t_max(0.0f, t_min(wh[c], rect.m_max_point[c]));
+        }
+      texel_rect.translate(vec2(m_image_xy));
+      m_image->request_residency(texel_rect, 1.0f / pixels_per_unit);
+    }
+}
+
 void
 fastuidraw::PainterImageBrushShaderData::
 image(const reference_counted_ptr<const Image> &im)
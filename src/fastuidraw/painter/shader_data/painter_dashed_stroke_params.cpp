@@ -27,6 +27,38 @@
 
 namespace
 {
+  /* The cumulative boundaries of the dash pattern are packed as the
+   * leaves of a 4-ary search tree; each block of an internal level
+   * holds, for each of its (up to) 4 children, the largest boundary
+   * of the child's subtree. The levels are packed root first so that
+   * a shader (and compute_interval()) can walk from the root to a
+   * leaf with one fetch per level. The size and height of the tree
+   * are derived from just the number of boundaries.
+   */
+  unsigned int
+  dash_tree_leaf_blocks(unsigned int number_intervals)
+  {
+    return (number_intervals + 3u) >> 2u;
+  }
+
+  unsigned int
+  dash_tree_height(unsigned int number_intervals)
+  {
+    unsigned int h(0), num_leaf_blocks(dash_tree_leaf_blocks(number_intervals));
+    while ((1u << (2u * h)) < num_leaf_blocks)
+      {
+        ++h;
+      }
+    return h;
+  }
+
+  unsigned int
+  dash_tree_level_size(unsigned int number_intervals, unsigned int height)
+  {
+    unsigned int num_leaf_blocks(dash_tree_leaf_blocks(number_intervals));
+    return (num_leaf_blocks + (1u << (2u * height)) - 1u) >> (2u * height);
+  }
+
   class PainterDashedStrokedParamsPrivate
   {
   public:
@@ -207,17 +239,46 @@ dash_pattern(c_array<const DashPatternElement> f)
       d->m_first_interval_start = 0.0f;
     }
 
-  d->m_dash_pattern_packed.resize(d->m_dash_pattern.size() * 2);
-  if (!d->m_dash_pattern_packed.empty())
+  /* Build the search tree bottom-up, the leaves being the
+   * cumulative boundaries of the pattern. Unused slots get a
+   * value larger than the total length; the separator of the
+   * last child of each level also gets that value so that a
+   * search with a distance equal to the total length (from
+   * rounding) never walks past the end of a level.
+   */
+  unsigned int number_intervals(2 * d->m_dash_pattern.size());
+  unsigned int height(dash_tree_height(number_intervals));
+  float pad(d->m_total_length * 2.0f + 1.0f);
+  std::vector<std::vector<float> > levels(height + 1);
+
+  levels[0].resize(4 * dash_tree_level_size(number_intervals, 0), pad);
+  float total_length = 0.0f;
+  for(unsigned int i = 0, j = 0, endi = d->m_dash_pattern.size(); i < endi; ++i, j += 2)
+    {
+      total_length += d->m_dash_pattern[i].m_draw_length;
+      levels[0][j] = total_length;
+
+      total_length += d->m_dash_pattern[i].m_space_length;
+      levels[0][j + 1] = total_length;
+    }
+
+  for (unsigned int h = 1; h <= height; ++h)
     {
-      float total_length = 0.0f;
-      for(unsigned int i = 0, j = 0, endi = d->m_dash_pattern.size(); i < endi; ++i, j += 2)
+      unsigned int num_children(dash_tree_level_size(number_intervals, h - 1));
+
+      levels[h].resize(4 * dash_tree_level_size(number_intervals, h), pad);
+      for (unsigned int c = 0; c + 1 < num_children; ++c)
         {
-          total_length += d->m_dash_pattern[i].m_draw_length;
-          d->m_dash_pattern_packed[j] = pack_float(total_length);
+          levels[h][c] = levels[h - 1][4 * c + 3];
+        }
+    }
 
-          total_length += d->m_dash_pattern[i].m_space_length;
-          d->m_dash_pattern_packed[j + 1] = pack_float(total_length);
+  d->m_dash_pattern_packed.clear();
+  for (unsigned int h = height + 1; h > 0; --h)
+    {
+      for (float f : levels[h - 1])
+        {
+          d->m_dash_pattern_packed.push_back(pack_float(f));
         }
     }
 
@@ -232,7 +293,7 @@ data_size(void) const
   d = static_cast<PainterDashedStrokedParamsPrivate*>(m_d);
 
   return FASTUIDRAW_NUMBER_BLOCK4_NEEDED(stroke_static_data_size)
-    + FASTUIDRAW_NUMBER_BLOCK4_NEEDED(2 * d->m_dash_pattern.size());
+    + d->m_dash_pattern_packed.size() / 4;
 }
 
 void
@@ -250,20 +311,92 @@ pack_data(c_array<uvec4> pdst) const
   dst[stroke_total_length_offset] = pack_float(d->m_total_length);
   dst[stroke_first_interval_start_offset] = pack_float(d->m_first_interval_start);
   dst[stroke_first_interval_start_on_looping_offset] = pack_float(d->m_first_interval_start_on_looping);
-  dst[stroke_number_intervals_offset] = d->m_dash_pattern_packed.size();
+  dst[stroke_number_intervals_offset] = 2 * d->m_dash_pattern.size();
 
   if (!d->m_dash_pattern_packed.empty())
     {
       c_array<uint32_t> dst_pattern;
       dst_pattern = dst.sub_array(FASTUIDRAW_ROUND_UP_MULTIPLE_OF4(stroke_static_data_size));
       std::copy(d->m_dash_pattern_packed.begin(), d->m_dash_pattern_packed.end(), dst_pattern.begin());
-      for(unsigned int i = d->m_dash_pattern_packed.size(), endi = dst_pattern.size(); i < endi; ++i)
+    }
+}
+
+float
+fastuidraw::PainterDashedStrokeParams::
+duty_cycle(void) const
+{
+  PainterDashedStrokedParamsPrivate *d;
+  d = static_cast<PainterDashedStrokedParamsPrivate*>(m_d);
+
+  if (d->m_total_length <= 0.0f)
+    {
+      return 1.0f;
+    }
+
+  float draw_length(0.0f);
+  for (const DashPatternElement &e : d->m_dash_pattern)
+    {
+      draw_length += e.m_draw_length;
+    }
+  return draw_length / d->m_total_length;
+}
+
+bool
+fastuidraw::PainterDashedStrokeParams::
+compute_interval(float distance, range_type<float> *out_interval,
+                 int *out_interval_id) const
+{
+  PainterDashedStrokedParamsPrivate *d;
+  d = static_cast<PainterDashedStrokedParamsPrivate*>(m_d);
+
+  unsigned int number_intervals(2 * d->m_dash_pattern.size());
+  if (number_intervals == 0)
+    {
+      *out_interval = range_type<float>(0.0f, 0.0f);
+      *out_interval_id = -1;
+      return false;
+    }
+
+  /* mirrors fastuidraw_compute_interval() of the GLSL shaders */
+  const uint32_t *tree(&d->m_dash_pattern_packed[0]);
+  float fd, ff, lower;
+  unsigned int h, level_start, block, c;
+  vecN<float, 4> S;
+
+  fd = std::floor(distance / d->m_total_length);
+  ff = d->m_total_length * fd;
+  distance -= ff;
+  if (distance >= d->m_total_length)
+    {
+      fd += 1.0f;
+      ff += d->m_total_length;
+      distance -= d->m_total_length;
+    }
+  lower = d->m_first_interval_start;
+  level_start = 0;
+  block = 0;
+  h = dash_tree_height(number_intervals);
+  for (;;)
+    {
+      for (unsigned int k = 0; k < 4; ++k)
         {
-          //make the last entry larger than the total length so a
-          //shader can use that to know when it has reached the end.
-          dst_pattern[i] = pack_float(d->m_total_length * 2.0f + 1.0f);
+          S[k] = unpack_float(tree[4 * (level_start + block) + k]);
         }
+      c = (distance >= S[0]) + (distance >= S[1]) + (distance >= S[2]);
+      if (h == 0)
+        {
+          break;
+        }
+      lower = (c > 0) ? S[c - 1] : lower;
+      level_start += dash_tree_level_size(number_intervals, h);
+      block = 4 * block + c;
+      --h;
     }
+
+  unsigned int g(4 * block + c);
+  *out_interval = range_type<float>(ff + ((c > 0) ? S[c - 1] : lower), ff + S[c]);
+  *out_interval_id = int(g) + int(fd) * int(number_intervals);
+  return (g & 1u) == 0;
 }
 
 fastuidraw::reference_counted_ptr<const fastuidraw::StrokingDataSelectorBase>
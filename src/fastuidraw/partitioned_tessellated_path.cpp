@@ -17,8 +17,10 @@
  */
 
 #include <vector>
+#include <list>
 #include <complex>
 #include <algorithm>
+#include <mutex>
 
 #include <fastuidraw/tessellated_path.hpp>
 #include <fastuidraw/path.hpp>
@@ -266,6 +268,154 @@ namespace
     fastuidraw::BoundingBox<float> m_join_bounding_box;
   };
 
+  /* The result of applying a PathEffect to a single Subset;
+   * the joins are kept separate from the chains and caps because
+   * a SubsetSelection selects joins from a different set of
+   * Subset objects when miter joins are enlarged.
+   */
+  class CachedSubset:fastuidraw::noncopyable
+  {
+  public:
+    CachedSubset(const fastuidraw::PartitionedTessellatedPath::Subset &S,
+                 const fastuidraw::PathEffect &effect);
+
+    fastuidraw::PathEffect::Storage m_chains_and_caps;
+    fastuidraw::PathEffect::Storage m_joins;
+    size_t m_bytes;
+  };
+
+  class EffectCache;
+
+  class EffectCacheEntry:fastuidraw::noncopyable
+  {
+  public:
+    EffectCacheEntry(EffectCache *owner,
+                     const fastuidraw::PathEffect &effect,
+                     unsigned int number_subsets);
+    ~EffectCacheEntry();
+
+    /* returns the cached results for the named Subset, computing
+     * them if necessary; *bytes_added is incremented by the
+     * memory used by newly computed results.
+     */
+    const CachedSubset&
+    fetch(const fastuidraw::PartitionedTessellatedPath &path,
+          const fastuidraw::PathEffect &effect,
+          unsigned int subset_id, size_t *bytes_added);
+
+    size_t
+    bytes(void) const
+    {
+      return m_bytes;
+    }
+
+    EffectCache *m_owner;
+    unsigned int m_effect_ID, m_effect_version;
+
+    /* location within EffectCacheBudget::m_lru */
+    std::list<EffectCacheEntry*>::iterator m_lru_location;
+
+  private:
+    size_t m_bytes;
+
+    /* lazily created, indexed by Subset::ID() */
+    std::vector<CachedSubset*> m_subsets;
+  };
+
+  /* The memory budget shared by the EffectCache of every
+   * PartitionedTessellatedPath; the entries of all caches
+   * are kept in a single least recently used order so that
+   * the total memory is bounded regardless of the number
+   * of paths. A single mutex protects all of the caches.
+   */
+  class EffectCacheBudget:fastuidraw::noncopyable
+  {
+  public:
+    EffectCacheBudget(void):
+      m_bytes(0),
+      m_max_bytes(32 * 1024 * 1024)
+    {}
+
+    static
+    EffectCacheBudget&
+    singleton(void)
+    {
+      static EffectCacheBudget R;
+      return R;
+    }
+
+    /* makes the entry the most recently used */
+    void
+    touch(EffectCacheEntry *entry);
+
+    /* removes the entry from the LRU, the caller is
+     * to remove the entry from its EffectCache.
+     */
+    void
+    remove(EffectCacheEntry *entry);
+
+    /* drops least recently used entries, never dropping
+     * keep, until the memory used is within budget.
+     */
+    void
+    enforce_budget(EffectCacheEntry *keep);
+
+    std::mutex m_mutex;
+    size_t m_bytes, m_max_bytes;
+
+    /* ordered from most recently used to least recently used */
+    std::list<EffectCacheEntry*> m_lru;
+  };
+
+  class EffectCache:fastuidraw::noncopyable
+  {
+  public:
+    enum
+      {
+        max_number_entries = 8
+      };
+
+    EffectCache(void)
+    {
+      /* make sure the budget is constructed before, and thus
+       * destroyed after, any PartitionedTessellatedPath
+       */
+      EffectCacheBudget::singleton();
+    }
+
+    ~EffectCache();
+
+    /* returns the entry for the ID() and version() of effect,
+     * creating it if necessary and making it the most recently
+     * used; entries of the effect for a different version() are
+     * dropped. The caller must hold EffectCacheBudget::m_mutex.
+     */
+    EffectCacheEntry&
+    fetch(const fastuidraw::PathEffect &effect,
+          unsigned int number_subsets);
+
+    /* returns the results of a Subset from the entry most recently
+     * returned by fetch(), dropping least recently used entries of
+     * all caches if the memory budget is exceeded. The caller must
+     * hold EffectCacheBudget::m_mutex.
+     */
+    const CachedSubset&
+    fetch_subset(EffectCacheEntry &entry,
+                 const fastuidraw::PartitionedTessellatedPath &path,
+                 const fastuidraw::PathEffect &effect,
+                 unsigned int subset_id);
+
+    /* removes the entry from both this cache and the budget and
+     * deletes it. The caller must hold EffectCacheBudget::m_mutex.
+     */
+    void
+    drop(EffectCacheEntry *entry);
+
+  private:
+    /* entries of this cache, the order is not significant */
+    std::vector<EffectCacheEntry*> m_entries;
+  };
+
   class PartitionedTessellatedPathPrivate:fastuidraw::noncopyable
   {
   public:
@@ -281,9 +431,226 @@ namespace
     bool m_has_arcs;
     SubsetPrivate *m_root_subset;
     std::vector<SubsetPrivate*> m_subsets;
+    EffectCache m_effect_cache;
   };
 }
 
+////////////////////////////////
+// CachedSubset methods
+CachedSubset::
+CachedSubset(const fastuidraw::PartitionedTessellatedPath::Subset &S,
+             const fastuidraw::PathEffect &effect)
+{
+  using namespace fastuidraw;
+
+  c_array<const TessellatedPath::segment_chain> chains(S.segment_chains());
+  c_array<const TessellatedPath::cap> caps(S.caps());
+  c_array<const TessellatedPath::join> joins(S.joins());
+
+  effect.process_chains(chains.begin(), chains.end(), m_chains_and_caps);
+  effect.process_caps(caps.begin(), caps.end(), m_chains_and_caps);
+  effect.process_joins(joins.begin(), joins.end(), m_joins);
+
+  m_bytes = sizeof(CachedSubset)
+    + m_chains_and_caps.caps().size() * sizeof(TessellatedPath::cap)
+    + m_joins.joins().size() * sizeof(TessellatedPath::join);
+  for (unsigned int c = 0, endc = m_chains_and_caps.number_chains(); c < endc; ++c)
+    {
+      m_bytes += (m_chains_and_caps.chain(c).m_segments.size() + 1u) * sizeof(TessellatedPath::segment);
+    }
+}
+
+////////////////////////////////
+// EffectCacheEntry methods
+EffectCacheEntry::
+EffectCacheEntry(EffectCache *owner,
+                 const fastuidraw::PathEffect &effect,
+                 unsigned int number_subsets):
+  m_owner(owner),
+  m_effect_ID(effect.ID()),
+  m_effect_version(effect.version()),
+  m_bytes(0),
+  m_subsets(number_subsets, nullptr)
+{
+}
+
+EffectCacheEntry::
+~EffectCacheEntry()
+{
+  for (CachedSubset *p : m_subsets)
+    {
+      if (p)
+        {
+          FASTUIDRAWdelete(p);
+        }
+    }
+}
+
+const CachedSubset&
+EffectCacheEntry::
+fetch(const fastuidraw::PartitionedTessellatedPath &path,
+      const fastuidraw::PathEffect &effect,
+      unsigned int subset_id, size_t *bytes_added)
+{
+  FASTUIDRAWassert(subset_id < m_subsets.size());
+  FASTUIDRAWassert(effect.ID() == m_effect_ID);
+  FASTUIDRAWassert(effect.version() == m_effect_version);
+  if (!m_subsets[subset_id])
+    {
+      m_subsets[subset_id] = FASTUIDRAWnew CachedSubset(path.subset(subset_id), effect);
+      m_bytes += m_subsets[subset_id]->m_bytes;
+      *bytes_added += m_subsets[subset_id]->m_bytes;
+    }
+  return *m_subsets[subset_id];
+}
+
+////////////////////////////////
+// EffectCacheBudget methods
+void
+EffectCacheBudget::
+touch(EffectCacheEntry *entry)
+{
+  m_lru.splice(m_lru.begin(), m_lru, entry->m_lru_location);
+}
+
+void
+EffectCacheBudget::
+remove(EffectCacheEntry *entry)
+{
+  FASTUIDRAWassert(m_bytes >= entry->bytes());
+  m_bytes -= entry->bytes();
+  m_lru.erase(entry->m_lru_location);
+}
+
+void
+EffectCacheBudget::
+enforce_budget(EffectCacheEntry *keep)
+{
+  while (m_bytes > m_max_bytes && !m_lru.empty())
+    {
+      EffectCacheEntry *victim(m_lru.back());
+      if (victim == keep)
+        {
+          /* keep is the most recently used, thus it
+           * is the only entry left.
+           */
+          FASTUIDRAWassert(m_lru.size() == 1);
+          return;
+        }
+      victim->m_owner->drop(victim);
+    }
+}
+
+////////////////////////////////
+// EffectCache methods
+EffectCache::
+~EffectCache()
+{
+  if (m_entries.empty())
+    {
+      return;
+    }
+
+  EffectCacheBudget &budget(EffectCacheBudget::singleton());
+  std::lock_guard<std::mutex> lock(budget.m_mutex);
+  for (EffectCacheEntry *p : m_entries)
+    {
+      budget.remove(p);
+      FASTUIDRAWdelete(p);
+    }
+}
+
+void
+EffectCache::
+drop(EffectCacheEntry *entry)
+{
+  std::vector<EffectCacheEntry*>::iterator iter;
+
+  iter = std::find(m_entries.begin(), m_entries.end(), entry);
+  FASTUIDRAWassert(iter != m_entries.end());
+  m_entries.erase(iter);
+  EffectCacheBudget::singleton().remove(entry);
+  FASTUIDRAWdelete(entry);
+}
+
+EffectCacheEntry&
+EffectCache::
+fetch(const fastuidraw::PathEffect &effect,
+      unsigned int number_subsets)
+{
+  EffectCacheBudget &budget(EffectCacheBudget::singleton());
+  EffectCacheEntry *p(nullptr), *oldest(nullptr);
+
+  for (unsigned int i = 0; i < m_entries.size();)
+    {
+      EffectCacheEntry *e(m_entries[i]);
+      if (e->m_effect_ID == effect.ID() && e->m_effect_version != effect.version())
+        {
+          /* the parameters of the effect changed since the
+           * entry was made, the entry will never be used again.
+           */
+          drop(e);
+          continue;
+        }
+
+      if (e->m_effect_ID == effect.ID())
+        {
+          p = e;
+        }
+      ++i;
+    }
+
+  if (!p)
+    {
+      if (m_entries.size() >= max_number_entries)
+        {
+          /* drop the least recently used entry of this cache */
+          for (std::list<EffectCacheEntry*>::reverse_iterator
+                 iter = budget.m_lru.rbegin(); !oldest; ++iter)
+            {
+              FASTUIDRAWassert(iter != budget.m_lru.rend());
+              if ((*iter)->m_owner == this)
+                {
+                  oldest = *iter;
+                }
+            }
+          drop(oldest);
+        }
+      p = FASTUIDRAWnew EffectCacheEntry(this, effect, number_subsets);
+      m_entries.push_back(p);
+      budget.m_lru.push_front(p);
+      p->m_lru_location = budget.m_lru.begin();
+    }
+  else
+    {
+      budget.touch(p);
+    }
+
+  return *p;
+}
+
+const CachedSubset&
+EffectCache::
+fetch_subset(EffectCacheEntry &entry,
+             const fastuidraw::PartitionedTessellatedPath &path,
+             const fastuidraw::PathEffect &effect,
+             unsigned int subset_id)
+{
+  EffectCacheBudget &budget(EffectCacheBudget::singleton());
+  const CachedSubset *return_value;
+  size_t bytes_added(0);
+
+  FASTUIDRAWassert(entry.m_owner == this);
+  FASTUIDRAWassert(!budget.m_lru.empty() && budget.m_lru.front() == &entry);
+  return_value = &entry.fetch(path, effect, subset_id, &bytes_added);
+  budget.m_bytes += bytes_added;
+
+  /* never drop the entry in use, it is always the most recently used */
+  budget.enforce_budget(&entry);
+
+  return *return_value;
+}
+
 /////////////////////////////////////
 // SubsetPrivate methods
 SubsetPrivate*
@@ -803,6 +1170,34 @@ apply_path_effect(const PathEffect &effect, PathEffect::Storage &dst) const
     }
 }
 
+void
+fastuidraw::PartitionedTessellatedPath::SubsetSelection::
+apply_cached_path_effect(const PathEffect &effect, PathEffect::Storage &dst) const
+{
+  if (!source())
+    {
+      return;
+    }
+
+  const PartitionedTessellatedPath &path(*source());
+  PartitionedTessellatedPathPrivate *path_d;
+  path_d = static_cast<PartitionedTessellatedPathPrivate*>(path.m_d);
+
+  EffectCache &cache(path_d->m_effect_cache);
+  std::lock_guard<std::mutex> lock(EffectCacheBudget::singleton().m_mutex);
+  EffectCacheEntry &entry(cache.fetch(effect, path.number_subsets()));
+
+  for (unsigned int id : subset_ids())
+    {
+      dst.add_storage(cache.fetch_subset(entry, path, effect, id).m_chains_and_caps);
+    }
+
+  for (unsigned int id : join_subset_ids())
+    {
+      dst.add_storage(cache.fetch_subset(entry, path, effect, id).m_joins);
+    }
+}
+
 /////////////////////////////////
 // fastuidraw::PartitionedTessellatedPath::Subset methods
 fastuidraw::PartitionedTessellatedPath::Subset::
@@ -1008,3 +1403,32 @@ select_subsets(c_array<const vec3> clip_equations,
       dst_d->m_join_subset_ids = make_c_array(dst_d->m_subset_ids);
     }
 }
+
+void
+fastuidraw::PartitionedTessellatedPath::
+effect_cache_budget(size_t v)
+{
+  EffectCacheBudget &budget(EffectCacheBudget::singleton());
+  std::lock_guard<std::mutex> lock(budget.m_mutex);
+
+  budget.m_max_bytes = v;
+  budget.enforce_budget(nullptr);
+}
+
+size_t
+fastuidraw::PartitionedTessellatedPath::
+effect_cache_budget(void)
+{
+  EffectCacheBudget &budget(EffectCacheBudget::singleton());
+  std::lock_guard<std::mutex> lock(budget.m_mutex);
+  return budget.m_max_bytes;
+}
+
+size_t
+fastuidraw::PartitionedTessellatedPath::
+effect_cache_bytes(void)
+{
+  EffectCacheBudget &budget(EffectCacheBudget::singleton());
+  std::lock_guard<std::mutex> lock(budget.m_mutex);
+  return budget.m_bytes;
+}
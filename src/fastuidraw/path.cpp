@@ -68,6 +68,55 @@ namespace
       }
   }
 
+  /* Computes the signed sweep of an arc from start_angle to
+   * end_angle as in the W3C canvas arc() method.
+   */
+  inline
+  float
+  compute_canvas_arc_sweep(float start_angle, float end_angle,
+                           bool counter_clockwise)
+  {
+    const float two_pi(2.0f * FASTUIDRAW_PI);
+    float sweep;
+
+    sweep = (counter_clockwise) ?
+      end_angle - start_angle :
+      start_angle - end_angle;
+
+    if (sweep >= two_pi)
+      {
+        sweep = two_pi;
+      }
+    else
+      {
+        sweep = std::fmod(sweep, two_pi);
+        if (sweep < 0.0f)
+          {
+            sweep += two_pi;
+          }
+      }
+    return (counter_clockwise) ? sweep : -sweep;
+  }
+
+  /* Returns true if the angle theta is within the arc
+   * that starts at start_angle with the signed sweep.
+   */
+  inline
+  bool
+  angle_in_sweep(float theta, float start_angle, float sweep)
+  {
+    const float two_pi(2.0f * FASTUIDRAW_PI);
+    float d;
+
+    d = (sweep >= 0.0f) ? theta - start_angle : start_angle - theta;
+    d = std::fmod(d, two_pi);
+    if (d < 0.0f)
+      {
+        d += two_pi;
+      }
+    return d <= fastuidraw::t_abs(sweep);
+  }
+
   class ArcSegment
   {
   public:
@@ -259,12 +308,161 @@ namespace
   class ArcPrivate
   {
   public:
+    void
+    compute_bb(const fastuidraw::vec2 &start_pt,
+               const fastuidraw::vec2 &end_pt);
+
     float m_radius, m_angle_speed;
     float m_start_angle;
     fastuidraw::vec2 m_center;
     fastuidraw::BoundingBox<float> m_bb;
   };
 
+  class EllipseGeometry
+  {
+  public:
+    EllipseGeometry(const fastuidraw::vec2 &center,
+                    const fastuidraw::vec2 &radii,
+                    float x_axis_rotation):
+      m_center(center),
+      m_radii(radii),
+      m_x_axis_rotation(x_axis_rotation),
+      m_cos_rotation(fastuidraw::t_cos(x_axis_rotation)),
+      m_sin_rotation(fastuidraw::t_sin(x_axis_rotation))
+    {}
+
+    /* map a point of the unit circle to the ellipse */
+    fastuidraw::vec2
+    map(const fastuidraw::vec2 &p) const
+    {
+      fastuidraw::vec2 q(m_radii.x() * p.x(), m_radii.y() * p.y());
+      return m_center + fastuidraw::vec2(m_cos_rotation * q.x() - m_sin_rotation * q.y(),
+                                         m_sin_rotation * q.x() + m_cos_rotation * q.y());
+    }
+
+    fastuidraw::vec2
+    point(float theta) const
+    {
+      return map(fastuidraw::vec2(fastuidraw::t_cos(theta), fastuidraw::t_sin(theta)));
+    }
+
+    float
+    max_radius(void) const
+    {
+      return fastuidraw::t_max(fastuidraw::t_abs(m_radii.x()),
+                               fastuidraw::t_abs(m_radii.y()));
+    }
+
+    float
+    min_radius(void) const
+    {
+      return fastuidraw::t_min(fastuidraw::t_abs(m_radii.x()),
+                               fastuidraw::t_abs(m_radii.y()));
+    }
+
+    fastuidraw::vec2 m_center, m_radii;
+    float m_x_axis_rotation, m_cos_rotation, m_sin_rotation;
+  };
+
+  inline
+  fastuidraw::vec2
+  compute_canvas_arc_end(const EllipseGeometry &geometry,
+                         float start_angle, float end_angle,
+                         bool counter_clockwise)
+  {
+    float sweep;
+
+    sweep = compute_canvas_arc_sweep(start_angle, end_angle, counter_clockwise);
+    return geometry.point(start_angle + sweep);
+  }
+
+  class EllipseTessRegion:
+    public fastuidraw::PathContour::interpolator_generic::tessellated_region
+  {
+  public:
+    EllipseTessRegion(const EllipseGeometry &geometry,
+                      const fastuidraw::range_type<float> &angle,
+                      const fastuidraw::vec2 &start_pt,
+                      const fastuidraw::vec2 &end_pt):
+      m_geometry(geometry),
+      m_angle(angle),
+      m_start_pt(start_pt),
+      m_end_pt(end_pt)
+    {}
+
+    virtual
+    float
+    distance_to_line_segment(void) const;
+
+    virtual
+    float
+    distance_to_arc(float arc_radius, fastuidraw::vec2 arc_center,
+                    fastuidraw::vec2 unit_vector_arc_middle,
+                    float cos_arc_angle) const;
+
+    void
+    split(fastuidraw::reference_counted_ptr<tessellated_region> *out_regionA,
+          fastuidraw::reference_counted_ptr<tessellated_region> *out_regionB,
+          fastuidraw::vec2 *out_p) const;
+
+  private:
+    static
+    float
+    sagitta(float k, float half_chord);
+
+    void
+    curvature_range(float *out_min, float *out_max) const;
+
+    EllipseGeometry m_geometry;
+    fastuidraw::range_type<float> m_angle;
+    fastuidraw::vec2 m_start_pt, m_end_pt;
+  };
+
+  class EllipsePrivate
+  {
+  public:
+    EllipsePrivate(const EllipseGeometry &geometry,
+                   float start_angle, float angle_speed):
+      m_geometry(geometry),
+      m_start_angle(start_angle),
+      m_angle_speed(angle_speed)
+    {}
+
+    EllipseGeometry m_geometry;
+    float m_start_angle, m_angle_speed;
+    fastuidraw::BoundingBox<float> m_bb;
+  };
+
+  /* Adapts a ShaderFilledPath::Builder so that the points
+   * fed to it are mapped from the unit circle to an ellipse;
+   * since the map is affine, Bezier curves are mapped exactly.
+   */
+  class EllipseBuilder
+  {
+  public:
+    EllipseBuilder(fastuidraw::ShaderFilledPath::Builder *builder,
+                   const EllipseGeometry &geometry):
+      m_builder(builder),
+      m_geometry(geometry)
+    {}
+
+    void
+    line_to(fastuidraw::vec2 pt)
+    {
+      m_builder->line_to(m_geometry.map(pt));
+    }
+
+    void
+    quadratic_to(fastuidraw::vec2 ct, fastuidraw::vec2 pt)
+    {
+      m_builder->quadratic_to(m_geometry.map(ct), m_geometry.map(pt));
+    }
+
+  private:
+    fastuidraw::ShaderFilledPath::Builder *m_builder;
+    const EllipseGeometry &m_geometry;
+  };
+
   class PathContourPrivate
   {
   public:
@@ -364,6 +562,10 @@ namespace
     void
     start_contour_if_necessary(void);
 
+    const fastuidraw::reference_counted_ptr<fastuidraw::PathContour>&
+    move_or_line_to(const fastuidraw::vec2 &pt,
+                    enum fastuidraw::PathEnums::edge_type_t &etp);
+
     std::vector<fastuidraw::reference_counted_ptr<fastuidraw::PathContour> > m_contours;
     enum fastuidraw::PathEnums::edge_type_t m_next_edge_type;
 
@@ -469,6 +671,38 @@ distance(fastuidraw::vec2 pt) const
     }
 }
 
+///////////////////////////////////
+// ArcPrivate methods
+void
+ArcPrivate::
+compute_bb(const fastuidraw::vec2 &start_pt,
+           const fastuidraw::vec2 &end_pt)
+{
+  m_bb.union_point(start_pt);
+  m_bb.union_point(end_pt);
+
+  /* check for the extreme points of a circle
+   * which are at 0, PI / 2, PI, 3 * PI / 2
+   */
+  const fastuidraw::vec3 criticals[] =
+    {
+      fastuidraw::vec3(+1.0f, +0.0f, 0.0f),
+      fastuidraw::vec3(+0.0f, +1.0f, 0.5f * FASTUIDRAW_PI),
+      fastuidraw::vec3(-1.0f, +0.0f, FASTUIDRAW_PI),
+      fastuidraw::vec3(+0.0f, -1.0f, 1.5f * FASTUIDRAW_PI),
+    };
+
+  for (unsigned int i = 0; i < 4; ++i)
+    {
+      if (angle_in_sweep(criticals[i].z(), m_start_angle, m_angle_speed))
+        {
+          fastuidraw::vec2 p;
+          p = m_center + m_radius * fastuidraw::vec2(criticals[i].x(), criticals[i].y());
+          m_bb.union_point(p);
+        }
+    }
+}
+
 ///////////////////////////////////
 // ArcTessellatorStateNode methods
 ArcTessellatorStateNode::
@@ -865,6 +1099,154 @@ distance_to_arc_raw(unsigned int depth, const ArcSegment &A) const
     }
 }
 
+///////////////////////////////////
+// EllipseTessRegion methods
+float
+EllipseTessRegion::
+distance_to_line_segment(void) const
+{
+  using namespace fastuidraw;
+
+  /* The ellipse is the image of the unit circle under an
+   * affine map whose largest singular value is the largest
+   * radius of the ellipse. For an arc of the unit circle of
+   * angle A with A <= PI, the distance from the arc to the
+   * chord is 1 - cos(A / 2). Hence the ellipse arc is within
+   * max_radius * (1 - cos(A / 2)) of the chord.
+   */
+  float half_angle;
+
+  half_angle = 0.5f * t_abs(m_angle.m_end - m_angle.m_begin);
+  if (half_angle >= 0.5f * FASTUIDRAW_PI)
+    {
+      return 2.0f * m_geometry.max_radius();
+    }
+  return m_geometry.max_radius() * (1.0f - t_cos(half_angle));
+}
+
+float
+EllipseTessRegion::
+distance_to_arc(float arc_radius, fastuidraw::vec2 arc_center,
+                fastuidraw::vec2 unit_vector_arc_middle,
+                float cos_arc_angle) const
+{
+  using namespace fastuidraw;
+
+  FASTUIDRAWunused(arc_center);
+  FASTUIDRAWunused(unit_vector_arc_middle);
+  FASTUIDRAWunused(cos_arc_angle);
+
+  /* Both the arc of the ellipse and the arc of the circle
+   * go through m_start_pt and m_end_pt. A convex curve
+   * turning no more than PI between two points whose
+   * curvature is within [kmin, kmax] lies between the
+   * circular arcs of curvature kmin and kmax through those
+   * points, thus the distance between the two arcs is
+   * bounded by the difference of the sagittas of the
+   * circular arcs over the chord.
+   */
+  float half_chord, k0, kmin, kmax, s0;
+
+  half_chord = 0.5f * (m_end_pt - m_start_pt).magnitude();
+  k0 = 1.0f / arc_radius;
+  s0 = sagitta(k0, half_chord);
+  if (m_geometry.min_radius() <= 0.0f)
+    {
+      return distance_to_line_segment() + s0;
+    }
+
+  curvature_range(&kmin, &kmax);
+  if (kmax * half_chord >= 1.0f)
+    {
+      return distance_to_line_segment() + s0;
+    }
+
+  return t_max(t_abs(sagitta(kmax, half_chord) - s0),
+               t_abs(s0 - sagitta(kmin, half_chord)));
+}
+
+float
+EllipseTessRegion::
+sagitta(float k, float half_chord)
+{
+  using namespace fastuidraw;
+
+  /* the height of the minor arc of a circle of curvature
+   * k over a chord of length 2 * half_chord, written as
+   * (1 - sqrt(1 - (k * h)^2)) / k without cancellation.
+   */
+  float kh(k * half_chord);
+  if (kh >= 1.0f)
+    {
+      return 1.0f / k;
+    }
+  return k * half_chord * half_chord / (1.0f + t_sqrt(1.0f - kh * kh));
+}
+
+void
+EllipseTessRegion::
+curvature_range(float *out_min, float *out_max) const
+{
+  using namespace fastuidraw;
+
+  /* The curvature of the ellipse at the parametric angle t is
+   *   rx * ry / (rx^2 * sin^2(t) + ry^2 * cos^2(t))^(3/2)
+   * which is monotonic in sin^2(t); over the range of angles
+   * sin^2(t) takes its extremes at the end points and where
+   * t is a multiple of PI / 2.
+   */
+  float rx(t_abs(m_geometry.m_radii.x()));
+  float ry(t_abs(m_geometry.m_radii.y()));
+  float begin(m_angle.m_begin), sweep(m_angle.m_end - m_angle.m_begin);
+  float s0(t_sin(m_angle.m_begin)), s1(t_sin(m_angle.m_end));
+  float sin_sq_min, sin_sq_max, gmin, gmax;
+
+  s0 *= s0;
+  s1 *= s1;
+  sin_sq_min = t_min(s0, s1);
+  sin_sq_max = t_max(s0, s1);
+  if (angle_in_sweep(0.0f, begin, sweep)
+      || angle_in_sweep(FASTUIDRAW_PI, begin, sweep))
+    {
+      sin_sq_min = 0.0f;
+    }
+  if (angle_in_sweep(0.5f * FASTUIDRAW_PI, begin, sweep)
+      || angle_in_sweep(1.5f * FASTUIDRAW_PI, begin, sweep))
+    {
+      sin_sq_max = 1.0f;
+    }
+
+  gmin = ry * ry + (rx * rx - ry * ry) * sin_sq_min;
+  gmax = ry * ry + (rx * rx - ry * ry) * sin_sq_max;
+  if (gmin > gmax)
+    {
+      std::swap(gmin, gmax);
+    }
+
+  *out_min = rx * ry / (gmax * t_sqrt(gmax));
+  *out_max = rx * ry / (gmin * t_sqrt(gmin));
+}
+
+void
+EllipseTessRegion::
+split(fastuidraw::reference_counted_ptr<tessellated_region> *out_regionA,
+      fastuidraw::reference_counted_ptr<tessellated_region> *out_regionB,
+      fastuidraw::vec2 *out_p) const
+{
+  using namespace fastuidraw;
+
+  float mid_angle;
+
+  mid_angle = 0.5f * (m_angle.m_begin + m_angle.m_end);
+  *out_p = m_geometry.point(mid_angle);
+  *out_regionA = FASTUIDRAWnew EllipseTessRegion(m_geometry,
+                                                 range_type<float>(m_angle.m_begin, mid_angle),
+                                                 m_start_pt, *out_p);
+  *out_regionB = FASTUIDRAWnew EllipseTessRegion(m_geometry,
+                                                 range_type<float>(mid_angle, m_angle.m_end),
+                                                 *out_p, m_end_pt);
+}
+
 ////////////////////////////////////
 // fastuidraw::PathContour::bezier methods
 fastuidraw::PathContour::bezier::
@@ -1109,33 +1491,28 @@ arc(PathContour &contour,
   d->m_start_angle = start_center.atan();
   d->m_angle_speed = angle_coeff_dir * angle;
 
-  d->m_bb.union_point(start_pt());
-  d->m_bb.union_point(end_pt());
+  d->compute_bb(start_pt(), end_pt());
+}
 
-  /* check for the extreme points of a circle in [-PI, PI]
-   * which are at -PI, -PI / 2, 0, PI / 2, PI
-   */
-  float sa, ea;
-  const fastuidraw::vec3 criticals[] =
-    {
-      fastuidraw::vec3(-1.0f, +0.0f, -FASTUIDRAW_PI),
-      fastuidraw::vec3(+0.0f, -1.0f, -0.5f * FASTUIDRAW_PI),
-      fastuidraw::vec3(+1.0f, +0.0f, 0.0f),
-      fastuidraw::vec3(+0.0f, +1.0f, 0.5f * FASTUIDRAW_PI),
-      fastuidraw::vec3(-1.0f, +0.0f, FASTUIDRAW_PI),
-    };
+fastuidraw::PathContour::arc::
+arc(PathContour &contour,
+    const vec2 &center, float radius,
+    float start_angle, float end_angle,
+    bool counter_clockwise, enum PathEnums::edge_type_t tp):
+  fastuidraw::PathContour::interpolator_base(contour,
+                                             compute_canvas_arc_end(EllipseGeometry(center, vec2(radius, radius), 0.0f),
+                                                                    start_angle, end_angle, counter_clockwise),
+                                             tp)
+{
+  ArcPrivate *d;
+  d = FASTUIDRAWnew ArcPrivate();
+  m_d = d;
 
-  sa = fastuidraw::t_min(d->m_start_angle, d->m_angle_speed + d->m_start_angle);
-  ea = fastuidraw::t_max(d->m_start_angle, d->m_angle_speed + d->m_start_angle);
-  for (unsigned int i = 0; i < 5; ++i)
-    {
-      if (sa <= criticals[i].z() && criticals[i].z() <= ea)
-        {
-          vec2 p;
-          p = d->m_center + d->m_radius * fastuidraw::vec2(criticals[i].x(), criticals[i].y());
-          d->m_bb.union_point(p);
-        }
-    }
+  d->m_center = center;
+  d->m_radius = radius;
+  d->m_start_angle = start_angle;
+  d->m_angle_speed = compute_canvas_arc_sweep(start_angle, end_angle, counter_clockwise);
+  d->compute_bb(start_pt(), end_pt());
 }
 
 fastuidraw::PathContour::arc::
@@ -1226,9 +1603,241 @@ add_to_builder(ShaderFilledPath::Builder *builder, float tol) const
   d = static_cast<ArcPrivate*>(m_d);
 
   const int max_recursion(5);
-  detail::add_arc_as_cubics(max_recursion, builder, tol,
-                            start_pt(), end_pt(), d->m_center,
-                            d->m_radius, d->m_start_angle, d->m_angle_speed);
+  if (t_abs(d->m_angle_speed) > FASTUIDRAW_PI)
+    {
+      /* a full circle has the same start and end point,
+       * which add_arc_as_cubics() cannot handle; split
+       * the arc in half.
+       */
+      float half_speed(0.5f * d->m_angle_speed);
+      float mid_angle(d->m_start_angle + half_speed);
+      vec2 mid_pt(d->m_center + d->m_radius * vec2(t_cos(mid_angle), t_sin(mid_angle)));
+
+      detail::add_arc_as_cubics(max_recursion, builder, tol,
+                                start_pt(), mid_pt, d->m_center,
+                                d->m_radius, d->m_start_angle, half_speed);
+      detail::add_arc_as_cubics(max_recursion, builder, tol,
+                                mid_pt, end_pt(), d->m_center,
+                                d->m_radius, mid_angle, half_speed);
+    }
+  else
+    {
+      detail::add_arc_as_cubics(max_recursion, builder, tol,
+                                start_pt(), end_pt(), d->m_center,
+                                d->m_radius, d->m_start_angle, d->m_angle_speed);
+    }
+  return routine_success;
+}
+
+//////////////////////////////////////
+// fastuidraw::PathContour::ellipse methods
+fastuidraw::PathContour::ellipse::
+ellipse(PathContour &contour,
+        const vec2 &center, const vec2 &radii, float x_axis_rotation,
+        float start_angle, float end_angle,
+        bool counter_clockwise, enum PathEnums::edge_type_t tp):
+  interpolator_generic(contour,
+                       compute_canvas_arc_end(EllipseGeometry(center, radii, x_axis_rotation),
+                                              start_angle, end_angle, counter_clockwise),
+                       tp)
+{
+  EllipsePrivate *d;
+  float sweep;
+
+  sweep = compute_canvas_arc_sweep(start_angle, end_angle, counter_clockwise);
+  d = FASTUIDRAWnew EllipsePrivate(EllipseGeometry(center, radii, x_axis_rotation),
+                                   start_angle, sweep);
+  m_d = d;
+
+  d->m_bb.union_point(start_pt());
+  d->m_bb.union_point(end_pt());
+
+  /* The extremal points of the ellipse in x are where
+   * the derivative of the x-coordinate vanishes, i.e.
+   *   -rx * cos(r) * sin(t) - ry * sin(r) * cos(t) = 0
+   * and in y where
+   *   -rx * sin(r) * sin(t) + ry * cos(r) * cos(t) = 0
+   */
+  const EllipseGeometry &g(d->m_geometry);
+  float tx, ty;
+
+  tx = t_atan2(-g.m_radii.y() * g.m_sin_rotation, g.m_radii.x() * g.m_cos_rotation);
+  ty = t_atan2(g.m_radii.y() * g.m_cos_rotation, g.m_radii.x() * g.m_sin_rotation);
+
+  const float criticals[] =
+    {
+      tx, tx + float(FASTUIDRAW_PI),
+      ty, ty + float(FASTUIDRAW_PI),
+    };
+  for (unsigned int i = 0; i < 4; ++i)
+    {
+      if (angle_in_sweep(criticals[i], start_angle, sweep))
+        {
+          d->m_bb.union_point(g.point(criticals[i]));
+        }
+    }
+}
+
+fastuidraw::PathContour::ellipse::
+ellipse(const ellipse &q, PathContour &contour):
+  interpolator_generic(contour, q.end_pt(), q.edge_type())
+{
+  EllipsePrivate *qd;
+  qd = static_cast<EllipsePrivate*>(q.m_d);
+  m_d = FASTUIDRAWnew EllipsePrivate(*qd);
+}
+
+fastuidraw::PathContour::ellipse::
+~ellipse()
+{
+  EllipsePrivate *d;
+  d = static_cast<EllipsePrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+fastuidraw::vec2
+fastuidraw::PathContour::ellipse::
+center(void) const
+{
+  EllipsePrivate *d;
+  d = static_cast<EllipsePrivate*>(m_d);
+  return d->m_geometry.m_center;
+}
+
+fastuidraw::vec2
+fastuidraw::PathContour::ellipse::
+radii(void) const
+{
+  EllipsePrivate *d;
+  d = static_cast<EllipsePrivate*>(m_d);
+  return d->m_geometry.m_radii;
+}
+
+float
+fastuidraw::PathContour::ellipse::
+x_axis_rotation(void) const
+{
+  EllipsePrivate *d;
+  d = static_cast<EllipsePrivate*>(m_d);
+  return d->m_geometry.m_x_axis_rotation;
+}
+
+fastuidraw::range_type<float>
+fastuidraw::PathContour::ellipse::
+angle(void) const
+{
+  EllipsePrivate *d;
+  d = static_cast<EllipsePrivate*>(m_d);
+  return range_type<float>(d->m_start_angle,
+                           d->m_start_angle + d->m_angle_speed);
+}
+
+bool
+fastuidraw::PathContour::ellipse::
+is_flat(void) const
+{
+  return false;
+}
+
+void
+fastuidraw::PathContour::ellipse::
+tessellate(reference_counted_ptr<tessellated_region> in_region,
+           reference_counted_ptr<tessellated_region> *out_regionA,
+           reference_counted_ptr<tessellated_region> *out_regionB,
+           vec2 *out_p) const
+{
+  EllipsePrivate *d;
+  d = static_cast<EllipsePrivate*>(m_d);
+
+  if (!in_region)
+    {
+      /* use start_pt() and end_pt() for the region of the entire
+       * interpolator so that the tessellation exactly connects to
+       * the neighboring interpolators.
+       */
+      in_region = FASTUIDRAWnew EllipseTessRegion(d->m_geometry, angle(),
+                                                  start_pt(), end_pt());
+    }
+
+  EllipseTessRegion *in_region_casted;
+  FASTUIDRAWassert(dynamic_cast<EllipseTessRegion*>(in_region.get()) != nullptr);
+  in_region_casted = static_cast<EllipseTessRegion*>(in_region.get());
+  in_region_casted->split(out_regionA, out_regionB, out_p);
+}
+
+void
+fastuidraw::PathContour::ellipse::
+approximate_bounding_box(Rect *out_bb) const
+{
+  EllipsePrivate *d;
+  d = static_cast<EllipsePrivate*>(m_d);
+  out_bb->m_min_point = d->m_bb.min_point();
+  out_bb->m_max_point = d->m_bb.max_point();
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::PathContour::interpolator_base>
+fastuidraw::PathContour::ellipse::
+deep_copy(PathContour &contour) const
+{
+  return FASTUIDRAWnew ellipse(*this, contour);
+}
+
+unsigned int
+fastuidraw::PathContour::ellipse::
+minimum_tessellation_recursion(void) const
+{
+  EllipsePrivate *d;
+  d = static_cast<EllipsePrivate*>(m_d);
+
+  /* require that each arc of the tessellation
+   * covers no more than PI / 4 of the ellipse.
+   */
+  unsigned int return_value(1);
+  float arc_angle(t_abs(d->m_angle_speed));
+  while (arc_angle > 0.5f * FASTUIDRAW_PI)
+    {
+      arc_angle *= 0.5f;
+      ++return_value;
+    }
+
+  return return_value;
+}
+
+enum fastuidraw::return_code
+fastuidraw::PathContour::ellipse::
+add_to_builder(ShaderFilledPath::Builder *builder, float tol) const
+{
+  EllipsePrivate *d;
+  d = static_cast<EllipsePrivate*>(m_d);
+
+  float max_r(d->m_geometry.max_radius());
+  if (max_r <= 0.0f)
+    {
+      builder->line_to(end_pt());
+      return routine_success;
+    }
+
+  /* Approximate the arc of the unit circle and map the
+   * resulting curves to the ellipse; the tolerance is
+   * scaled by the largest stretch of the map.
+   */
+  const int max_recursion(5);
+  EllipseBuilder B(builder, d->m_geometry);
+  float half_speed(0.5f * d->m_angle_speed);
+  float mid_angle(d->m_start_angle + half_speed);
+  float end_angle(d->m_start_angle + d->m_angle_speed);
+  vec2 start_unit(t_cos(d->m_start_angle), t_sin(d->m_start_angle));
+  vec2 mid_unit(t_cos(mid_angle), t_sin(mid_angle));
+  vec2 end_unit(t_cos(end_angle), t_sin(end_angle));
+
+  tol /= max_r;
+  detail::add_arc_as_cubics(max_recursion, &B, tol,
+                            start_unit, mid_unit, vec2(0.0f, 0.0f),
+                            1.0f, d->m_start_angle, half_speed);
+  detail::add_arc_as_cubics(max_recursion, &B, tol,
+                            mid_unit, end_unit, vec2(0.0f, 0.0f),
+                            1.0f, mid_angle, half_speed);
   return routine_success;
 }
 
@@ -1652,6 +2261,32 @@ start_contour_if_necessary(void)
   move_common(pt);
 }
 
+const fastuidraw::reference_counted_ptr<fastuidraw::PathContour>&
+PathPrivate::
+move_or_line_to(const fastuidraw::vec2 &pt,
+                enum fastuidraw::PathEnums::edge_type_t &etp)
+{
+  /* As in W3C canvas: if there is no contour to which to
+   * add, start one at pt, otherwise connect the end of the
+   * current contour to pt with a line segment; what is added
+   * after that line segment continues its edge.
+   */
+  if (m_contours.empty() || m_contours.back()->ended())
+    {
+      move_common(pt);
+    }
+  else
+    {
+      const fastuidraw::reference_counted_ptr<fastuidraw::PathContour> &h(current_contour());
+      if (h->point(h->number_points() - 1) != pt)
+        {
+          h->to_point(pt, etp);
+          etp = fastuidraw::PathEnums::continues_edge;
+        }
+    }
+  return current_contour();
+}
+
 /////////////////////////////////////////
 // fastuidraw::Path methods
 fastuidraw::Path::
@@ -1978,6 +2613,180 @@ arc_to(float angle, const vec2 &pt,
   return *this;
 }
 
+fastuidraw::Path&
+fastuidraw::Path::
+arc_to(const vec2 &pt1, const vec2 &pt2, float radius,
+       enum PathEnums::edge_type_t etp)
+{
+  PathPrivate *d;
+  d = static_cast<PathPrivate*>(m_d);
+
+  FASTUIDRAWmessaged_assert(radius >= 0.0f, "Path::arc_to: negative radius");
+  if (radius < 0.0f)
+    {
+      return *this;
+    }
+
+  if (d->m_contours.empty() || d->m_contours.back()->ended())
+    {
+      d->move_common(pt1);
+    }
+
+  const reference_counted_ptr<PathContour> &h(d->current_contour());
+  vec2 p0(h->point(h->number_points() - 1));
+  vec2 v0(p0 - pt1), v1(pt2 - pt1);
+  float mag_v0(v0.magnitude()), mag_v1(v1.magnitude());
+  float cross(v0.x() * v1.y() - v0.y() * v1.x());
+  const float tol(0.00001f);
+
+  if (p0 == pt1)
+    {
+      return *this;
+    }
+
+  if (radius == 0.0f || mag_v1 <= 0.0f
+      || t_abs(cross) <= tol * mag_v0 * mag_v1)
+    {
+      h->to_point(pt1, etp);
+      return *this;
+    }
+
+  /* Let theta be the angle at pt1 between the rays
+   * to p0 and pt2. The circle of radius R tangent to
+   * both rays touches them at distance R / tan(theta / 2)
+   * from pt1 and the arc between the tangent points has
+   * angle PI - theta. The arc goes counter-clockwise
+   * exactly when the path turns left at pt1.
+   */
+  float cos_theta, theta, tangent_distance, angle;
+  vec2 u0(v0 / mag_v0), u1(v1 / mag_v1);
+  vec2 t0, t1;
+
+  cos_theta = t_max(-1.0f, t_min(1.0f, dot(u0, u1)));
+  theta = std::acos(cos_theta);
+  tangent_distance = radius / t_tan(0.5f * theta);
+  t0 = pt1 + tangent_distance * u0;
+  t1 = pt1 + tangent_distance * u1;
+  angle = (cross < 0.0f) ?
+    float(FASTUIDRAW_PI) - theta :
+    theta - float(FASTUIDRAW_PI);
+
+  if (t0 != p0)
+    {
+      h->to_point(t0, etp);
+      etp = PathEnums::continues_edge;
+    }
+  h->to_arc(angle, t1, etp);
+
+  return *this;
+}
+
+fastuidraw::Path&
+fastuidraw::Path::
+arc_centered(const vec2 &center, float radius,
+             float start_angle, float end_angle, bool counter_clockwise,
+             enum PathEnums::edge_type_t etp)
+{
+  PathPrivate *d;
+  float sweep;
+  vec2 start;
+
+  FASTUIDRAWmessaged_assert(radius >= 0.0f, "Path::arc_centered: negative radius");
+  if (radius < 0.0f)
+    {
+      return *this;
+    }
+
+  d = static_cast<PathPrivate*>(m_d);
+  sweep = compute_canvas_arc_sweep(start_angle, end_angle, counter_clockwise);
+  start = center + radius * vec2(t_cos(start_angle), t_sin(start_angle));
+
+  const reference_counted_ptr<PathContour> &h(d->move_or_line_to(start, etp));
+  if (sweep == 0.0f || radius == 0.0f)
+    {
+      return *this;
+    }
+
+  if (t_abs(sweep) > FASTUIDRAW_PI)
+    {
+      /* a single arc would start and end at the same
+       * point for a full circle, so split into halves.
+       */
+      float mid_angle(start_angle + 0.5f * sweep);
+
+      FASTUIDRAWnew PathContour::arc(*h, center, radius, start_angle, mid_angle,
+                                     counter_clockwise, etp);
+      FASTUIDRAWnew PathContour::arc(*h, center, radius, mid_angle, mid_angle + 0.5f * sweep,
+                                     counter_clockwise, PathEnums::continues_edge);
+    }
+  else
+    {
+      FASTUIDRAWnew PathContour::arc(*h, center, radius, start_angle, end_angle,
+                                     counter_clockwise, etp);
+    }
+
+  return *this;
+}
+
+fastuidraw::Path&
+fastuidraw::Path::
+ellipse(const vec2 &center, const vec2 &radii, float x_axis_rotation,
+        float start_angle, float end_angle, bool counter_clockwise,
+        enum PathEnums::edge_type_t etp)
+{
+  FASTUIDRAWmessaged_assert(radii.x() >= 0.0f && radii.y() >= 0.0f,
+                            "Path::ellipse: negative radius");
+  if (radii.x() < 0.0f || radii.y() < 0.0f)
+    {
+      return *this;
+    }
+
+  /* both radii zero (handled by arc_centered()) makes the
+   * ellipse a point, i.e. just a line segment to center.
+   */
+  if (radii.x() == radii.y())
+    {
+      return arc_centered(center, radii.x(),
+                          start_angle + x_axis_rotation,
+                          end_angle + x_axis_rotation,
+                          counter_clockwise, etp);
+    }
+
+  PathPrivate *d;
+  float sweep;
+  vec2 start;
+
+  d = static_cast<PathPrivate*>(m_d);
+  sweep = compute_canvas_arc_sweep(start_angle, end_angle, counter_clockwise);
+  start = EllipseGeometry(center, radii, x_axis_rotation).point(start_angle);
+
+  const reference_counted_ptr<PathContour> &h(d->move_or_line_to(start, etp));
+  if (sweep == 0.0f)
+    {
+      return *this;
+    }
+
+  if (t_abs(sweep) > FASTUIDRAW_PI)
+    {
+      float mid_angle(start_angle + 0.5f * sweep);
+
+      FASTUIDRAWnew PathContour::ellipse(*h, center, radii, x_axis_rotation,
+                                         start_angle, mid_angle,
+                                         counter_clockwise, etp);
+      FASTUIDRAWnew PathContour::ellipse(*h, center, radii, x_axis_rotation,
+                                         mid_angle, mid_angle + 0.5f * sweep,
+                                         counter_clockwise, PathEnums::continues_edge);
+    }
+  else
+    {
+      FASTUIDRAWnew PathContour::ellipse(*h, center, radii, x_axis_rotation,
+                                         start_angle, end_angle,
+                                         counter_clockwise, etp);
+    }
+
+  return *this;
+}
+
 fastuidraw::Path&
 fastuidraw::Path::
 close_contour_arc(float angle,
@@ -160,6 +160,7 @@ namespace
 
     float m_dash_offset;
     std::vector<DashElement> m_lengths;
+    std::vector<fastuidraw::vec2> m_pattern;
   };
 }
 
@@ -347,6 +348,7 @@ dash_offset(float v)
   PathDashEffectPrivate *d;
   d = static_cast<PathDashEffectPrivate*>(m_d);
   d->m_dash_offset = v;
+  increment_version();
   return *this;
 }
 
@@ -357,6 +359,8 @@ clear(void)
   PathDashEffectPrivate *d;
   d = static_cast<PathDashEffectPrivate*>(m_d);
   d->m_lengths.clear();
+  d->m_pattern.clear();
+  increment_version();
   return *this;
 }
 
@@ -379,6 +383,8 @@ add_dash(float draw, float skip)
       d->m_lengths.back().m_draw_length += draw;
       d->m_lengths.back().m_skip_length += skip;
       d->m_lengths.back().m_end_distance += draw + skip;
+      d->m_pattern.back() += fastuidraw::vec2(draw, skip);
+      increment_version();
       return *this;
     }
 
@@ -390,9 +396,29 @@ add_dash(float draw, float skip)
   E.m_end_distance = E.m_start_distance + draw + skip;
 
   d->m_lengths.push_back(E);
+  d->m_pattern.push_back(vec2(draw, skip));
+  increment_version();
   return *this;
 }
 
+float
+fastuidraw::PathDashEffect::
+dash_offset(void) const
+{
+  PathDashEffectPrivate *d;
+  d = static_cast<PathDashEffectPrivate*>(m_d);
+  return d->m_dash_offset;
+}
+
+fastuidraw::c_array<const fastuidraw::vec2>
+fastuidraw::PathDashEffect::
+dash_pattern(void) const
+{
+  PathDashEffectPrivate *d;
+  d = static_cast<PathDashEffectPrivate*>(m_d);
+  return make_c_array(d->m_pattern);
+}
+
 void
 fastuidraw::PathDashEffect::
 process_join(const TessellatedPath::join &join, Storage &dst) const
@@ -17,6 +17,7 @@
  */
 
 #include <vector>
+#include <atomic>
 #include <fastuidraw/path_effect.hpp>
 #include <private/util_private.hpp>
 
@@ -40,6 +41,22 @@ namespace
     std::vector<fastuidraw::PathEffect::cap> m_cap_storage;
     std::vector<Chain> m_chains;
   };
+
+  unsigned int
+  generate_path_effect_id(void)
+  {
+    static std::atomic<unsigned int> counter(0u);
+    return counter.fetch_add(1u, std::memory_order_relaxed);
+  }
+}
+
+//////////////////////////////////
+// fastuidraw::PathEffect methods
+fastuidraw::PathEffect::
+PathEffect(void):
+  m_ID(generate_path_effect_id()),
+  m_version(0u)
+{
 }
 
 ///////////////////////////////////////////////////////
@@ -133,6 +150,34 @@ add_cap(const cap &cap)
   return *this;
 }
 
+fastuidraw::PathEffect::Storage&
+fastuidraw::PathEffect::Storage::
+add_storage(const Storage &src)
+{
+  StoragePrivate *d, *src_d;
+  d = static_cast<StoragePrivate*>(m_d);
+  src_d = static_cast<StoragePrivate*>(src.m_d);
+
+  FASTUIDRAWassert(d != src_d);
+  for (unsigned int c = 0, endc = src.number_chains(); c < endc; ++c)
+    {
+      segment_chain chain(src.chain(c));
+
+      begin_chain(chain.m_prev_to_start);
+      d->m_segment_storage.insert(d->m_segment_storage.end(),
+                                  chain.m_segments.begin(),
+                                  chain.m_segments.end());
+    }
+
+  d->m_join_storage.insert(d->m_join_storage.end(),
+                           src_d->m_join_storage.begin(),
+                           src_d->m_join_storage.end());
+  d->m_cap_storage.insert(d->m_cap_storage.end(),
+                          src_d->m_cap_storage.begin(),
+                          src_d->m_cap_storage.end());
+  return *this;
+}
+
 unsigned int
 fastuidraw::PathEffect::Storage::
 number_chains(void) const
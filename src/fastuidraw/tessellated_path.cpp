@@ -255,6 +255,21 @@ namespace
     fastuidraw::range_type<unsigned int> m_segment_chain_range;
   };
 
+  class StrokingPreparationParamsPrivate
+  {
+  public:
+    StrokingPreparationParamsPrivate(void):
+      m_joins(false),
+      m_caps(false),
+      m_adjustable_caps(false)
+    {}
+
+    fastuidraw::vecN<bool, fastuidraw::PainterEnums::number_join_styles> m_joins;
+    fastuidraw::vecN<bool, fastuidraw::PainterEnums::number_cap_styles> m_caps;
+    bool m_adjustable_caps;
+    std::vector<float> m_thresholds;
+  };
+
   class TessellatedPathPrivate
   {
   public:
@@ -297,6 +312,20 @@ namespace
     fastuidraw::reference_counted_ptr<const fastuidraw::FilledPath> m_filled;
     fastuidraw::reference_counted_ptr<const fastuidraw::PartitionedTessellatedPath> m_partitioned;
     std::vector<fastuidraw::reference_counted_ptr<const fastuidraw::TessellatedPath> > m_linearization;
+
+    /* task from prepare_stroked() that has not yet been
+     * completed via StrokingPreparationTask::complete_pending()
+     */
+    fastuidraw::reference_counted_ptr<fastuidraw::WorkerPool::Task> m_pending_stroking;
+
+    /* the StrokedPath last replaced by the result of a task
+     * of prepare_stroked(), kept so that references returned
+     * by stroked() before the replacement stay valid until
+     * the next replacement; only one is kept so that preparing
+     * the same path again and again does not accumulate the
+     * join and cap data of every replaced StrokedPath.
+     */
+    fastuidraw::reference_counted_ptr<const fastuidraw::StrokedPath> m_retired_stroked;
   };
 
   float
@@ -716,6 +745,41 @@ namespace
 
 }
 
+/* The task is created and its results are consumed by the
+ * thread that owns the TessellatedPath; run() only reads the
+ * (immutable) segment, join and cap data of the TessellatedPath
+ * and constructs objects that are not visible to any other
+ * thread until the task has finished.
+ */
+class fastuidraw::TessellatedPath::StrokingPreparationTask:
+  public fastuidraw::WorkerPool::Task
+{
+public:
+  StrokingPreparationTask(const TessellatedPath &path,
+                          const StrokingPreparationParams &params):
+    m_path(&path),
+    m_params(params)
+  {}
+
+  static
+  void
+  complete_pending(TessellatedPathPrivate *d, bool have_data);
+
+  static
+  void
+  abandon_pending(TessellatedPathPrivate *d);
+
+  const TessellatedPath *m_path;
+  StrokingPreparationParams m_params;
+  reference_counted_ptr<const PartitionedTessellatedPath> m_partitioned;
+  reference_counted_ptr<const StrokedPath> m_stroked;
+
+protected:
+  virtual
+  void
+  run(void);
+};
+
 //////////////////////////////////////////////
 // TessellatedPathPrivate methods
 TessellatedPathPrivate::
@@ -1257,6 +1321,207 @@ refine_tessellation(float max_distance,
     }
 }
 
+////////////////////////////////////////////////////////////////
+// fastuidraw::TessellatedPath::StrokingPreparationParams methods
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+StrokingPreparationParams(void)
+{
+  m_d = FASTUIDRAWnew StrokingPreparationParamsPrivate();
+}
+
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+StrokingPreparationParams(const StrokingPreparationParams &obj)
+{
+  StrokingPreparationParamsPrivate *obj_d;
+  obj_d = static_cast<StrokingPreparationParamsPrivate*>(obj.m_d);
+  m_d = FASTUIDRAWnew StrokingPreparationParamsPrivate(*obj_d);
+}
+
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+~StrokingPreparationParams()
+{
+  StrokingPreparationParamsPrivate *d;
+  d = static_cast<StrokingPreparationParamsPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+assign_swap_implement(fastuidraw::TessellatedPath::StrokingPreparationParams)
+
+bool
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+join_style(enum PainterEnums::join_style js) const
+{
+  StrokingPreparationParamsPrivate *d;
+  d = static_cast<StrokingPreparationParamsPrivate*>(m_d);
+  FASTUIDRAWassert(js < PainterEnums::number_join_styles);
+  return d->m_joins[js];
+}
+
+fastuidraw::TessellatedPath::StrokingPreparationParams&
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+join_style(enum PainterEnums::join_style js, bool v)
+{
+  StrokingPreparationParamsPrivate *d;
+  d = static_cast<StrokingPreparationParamsPrivate*>(m_d);
+  FASTUIDRAWassert(js < PainterEnums::number_join_styles);
+  d->m_joins[js] = v;
+  return *this;
+}
+
+bool
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+cap_style(enum PainterEnums::cap_style cp) const
+{
+  StrokingPreparationParamsPrivate *d;
+  d = static_cast<StrokingPreparationParamsPrivate*>(m_d);
+  FASTUIDRAWassert(cp < PainterEnums::number_cap_styles);
+  return d->m_caps[cp];
+}
+
+fastuidraw::TessellatedPath::StrokingPreparationParams&
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+cap_style(enum PainterEnums::cap_style cp, bool v)
+{
+  StrokingPreparationParamsPrivate *d;
+  d = static_cast<StrokingPreparationParamsPrivate*>(m_d);
+  FASTUIDRAWassert(cp < PainterEnums::number_cap_styles);
+  d->m_caps[cp] = v;
+  return *this;
+}
+
+bool
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+adjustable_caps(void) const
+{
+  StrokingPreparationParamsPrivate *d;
+  d = static_cast<StrokingPreparationParamsPrivate*>(m_d);
+  return d->m_adjustable_caps;
+}
+
+fastuidraw::TessellatedPath::StrokingPreparationParams&
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+adjustable_caps(bool v)
+{
+  StrokingPreparationParamsPrivate *d;
+  d = static_cast<StrokingPreparationParamsPrivate*>(m_d);
+  d->m_adjustable_caps = v;
+  return *this;
+}
+
+fastuidraw::c_array<const float>
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+rounding_thresholds(void) const
+{
+  StrokingPreparationParamsPrivate *d;
+  d = static_cast<StrokingPreparationParamsPrivate*>(m_d);
+  return make_c_array(d->m_thresholds);
+}
+
+fastuidraw::TessellatedPath::StrokingPreparationParams&
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+add_rounding_threshold(float thresh)
+{
+  StrokingPreparationParamsPrivate *d;
+  d = static_cast<StrokingPreparationParamsPrivate*>(m_d);
+  d->m_thresholds.push_back(thresh);
+  return *this;
+}
+
+fastuidraw::TessellatedPath::StrokingPreparationParams&
+fastuidraw::TessellatedPath::StrokingPreparationParams::
+clear_rounding_thresholds(void)
+{
+  StrokingPreparationParamsPrivate *d;
+  d = static_cast<StrokingPreparationParamsPrivate*>(m_d);
+  d->m_thresholds.clear();
+  return *this;
+}
+
+///////////////////////////////////////////////////////////////
+// fastuidraw::TessellatedPath::StrokingPreparationTask methods
+void
+fastuidraw::TessellatedPath::StrokingPreparationTask::
+run(void)
+{
+  if (!m_stroked)
+    {
+      if (!m_partitioned)
+        {
+          m_partitioned = FASTUIDRAWnew PartitionedTessellatedPath(*m_path);
+        }
+      m_stroked = FASTUIDRAWnew StrokedPath(*m_path, *m_partitioned);
+    }
+  m_stroked->prepare(m_params);
+}
+
+void
+fastuidraw::TessellatedPath::StrokingPreparationTask::
+complete_pending(TessellatedPathPrivate *d, bool have_data)
+{
+  StrokingPreparationTask *task;
+
+  if (!d->m_pending_stroking)
+    {
+      return;
+    }
+
+  task = static_cast<StrokingPreparationTask*>(d->m_pending_stroking.get());
+  if (!have_data)
+    {
+      /* the caller has nothing to use in the meantime; if the
+       * task has not started, run it here instead of waiting
+       * for a worker thread to get to it.
+       */
+      task->execute();
+      task->wait();
+    }
+  else if (!task->done())
+    {
+      /* the caller uses the existing data until the
+       * task has finished.
+       */
+      return;
+    }
+
+  if (task->status() == WorkerPool::task_finished)
+    {
+      FASTUIDRAWassert(!d->m_partitioned || d->m_partitioned == task->m_partitioned);
+      d->m_partitioned = task->m_partitioned;
+      d->m_retired_stroked = d->m_stroked;
+      d->m_stroked = task->m_stroked;
+    }
+
+  /* release the references now so that the objects are
+   * not released by whatever thread drops the last
+   * reference to the task.
+   */
+  task->m_partitioned.clear();
+  task->m_stroked.clear();
+  task->m_path = nullptr;
+  d->m_pending_stroking.clear();
+}
+
+void
+fastuidraw::TessellatedPath::StrokingPreparationTask::
+abandon_pending(TessellatedPathPrivate *d)
+{
+  StrokingPreparationTask *task;
+
+  if (!d->m_pending_stroking)
+    {
+      return;
+    }
+
+  task = static_cast<StrokingPreparationTask*>(d->m_pending_stroking.get());
+  task->cancel();
+  task->wait();
+  task->m_partitioned.clear();
+  task->m_stroked.clear();
+  task->m_path = nullptr;
+  d->m_pending_stroking.clear();
+}
+
 //////////////////////////////////////
 // fastuidraw::TessellatedPath methods
 fastuidraw::TessellatedPath::
@@ -1394,6 +1659,7 @@ fastuidraw::TessellatedPath::
 {
   TessellatedPathPrivate *d;
   d = static_cast<TessellatedPathPrivate*>(m_d);
+  StrokingPreparationTask::abandon_pending(d);
   FASTUIDRAWdelete(d);
   m_d = nullptr;
 }
@@ -1615,13 +1881,39 @@ stroked(void) const
 {
   TessellatedPathPrivate *d;
   d = static_cast<TessellatedPathPrivate*>(m_d);
+  StrokingPreparationTask::complete_pending(d, d->m_stroked);
   if (!d->m_stroked)
     {
-      d->m_stroked = FASTUIDRAWnew StrokedPath(*this);
+      d->m_stroked = FASTUIDRAWnew StrokedPath(*this, partitioned());
     }
   return *(d->m_stroked);
 }
 
+fastuidraw::reference_counted_ptr<fastuidraw::WorkerPool::Task>
+fastuidraw::TessellatedPath::
+prepare_stroked(WorkerPool &pool,
+                const StrokingPreparationParams &params) const
+{
+  TessellatedPathPrivate *d;
+  reference_counted_ptr<StrokingPreparationTask> task;
+
+  d = static_cast<TessellatedPathPrivate*>(m_d);
+  StrokingPreparationTask::complete_pending(d, false);
+
+  /* the join and cap data of a StrokedPath is constructed
+   * lazily and is not thread safe, thus the task always
+   * constructs its own StrokedPath; if one is already
+   * visible, it is used by stroked() until the task has
+   * finished.
+   */
+  task = FASTUIDRAWnew StrokingPreparationTask(*this, params);
+  task->m_partitioned = d->m_partitioned;
+  d->m_pending_stroking = task;
+  pool.add_task(task);
+
+  return task;
+}
+
 const fastuidraw::TessellatedPath&
 fastuidraw::TessellatedPath::
 linearization(float thresh) const
@@ -1707,6 +1999,7 @@ partitioned(void) const
 {
   TessellatedPathPrivate *d;
   d = static_cast<TessellatedPathPrivate*>(m_d);
+  StrokingPreparationTask::complete_pending(d, d->m_partitioned);
   if (!d->m_partitioned)
     {
       d->m_partitioned = FASTUIDRAWnew PartitionedTessellatedPath(*this);
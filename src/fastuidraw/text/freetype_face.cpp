@@ -153,7 +153,7 @@ fastuidraw::FreeTypeFace::GeneratorMemory::
 GeneratorMemory(c_string filename, int face_index)
 {
   DataBufferBase *p;
-  p = FASTUIDRAWnew DataBuffer(filename);
+  p = FASTUIDRAWnew MappedDataBuffer(filename, MappedDataBuffer::access_random);
   m_d = FASTUIDRAWnew GeneratorMemoryPrivate(p, face_index);
 }
 
@@ -216,6 +216,28 @@ data_allocated(void)
   return d->m_data_allocated;
 }
 
+unsigned int
+fastuidraw::GlyphAtlas::
+largest_free_data_block(void) const
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> m(d->m_mutex);
+  return d->m_data_allocator.largest_free_interval();
+}
+
+unsigned int
+fastuidraw::GlyphAtlas::
+number_free_data_blocks(void) const
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> m(d->m_mutex);
+  return d->m_data_allocator.number_free_intervals();
+}
+
 void
 fastuidraw::GlyphAtlas::
 clear(void)
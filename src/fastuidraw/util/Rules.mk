@@ -7,8 +7,10 @@ d		:= $(dir)
 FASTUIDRAW_SOURCES += $(call filelist, static_resource.cpp \
 	fastuidraw_memory.cpp util.cpp \
 	reference_count_atomic.cpp \
-	pixel_distance_math.cpp data_buffer.cpp api_callback.cpp \
-	string_array.cpp mutex.cpp blend_mode.cpp)
+	pixel_distance_math.cpp data_buffer.cpp mapped_data_buffer.cpp \
+	api_callback.cpp \
+	string_array.cpp mutex.cpp blend_mode.cpp \
+	worker_pool.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
@@ -0,0 +1,200 @@
+/*!
+ * \file mapped_data_buffer.cpp
+ * \brief file mapped_data_buffer.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <fastuidraw/util/mapped_data_buffer.hpp>
+#include <private/util_private.hpp>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define FASTUIDRAW_HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  class MappedDataBufferBackingStorePrivate
+  {
+  public:
+    MappedDataBufferBackingStorePrivate(fastuidraw::c_string filename,
+                                        enum fastuidraw::MappedDataBufferBackingStore::access_hint_t hint);
+
+    ~MappedDataBufferBackingStorePrivate();
+
+    fastuidraw::c_array<const uint8_t> m_data;
+    bool m_mapped;
+
+  private:
+    bool
+    map_file(fastuidraw::c_string filename,
+             enum fastuidraw::MappedDataBufferBackingStore::access_hint_t hint);
+
+    void
+    read_file(fastuidraw::c_string filename);
+
+    /* holds the contents when the file is not mapped */
+    std::vector<uint8_t> m_read_data;
+  };
+}
+
+///////////////////////////////////////////////
+// MappedDataBufferBackingStorePrivate methods
+MappedDataBufferBackingStorePrivate::
+MappedDataBufferBackingStorePrivate(fastuidraw::c_string filename,
+                                    enum fastuidraw::MappedDataBufferBackingStore::access_hint_t hint):
+  m_mapped(false)
+{
+  if (!map_file(filename, hint))
+    {
+      read_file(filename);
+    }
+}
+
+MappedDataBufferBackingStorePrivate::
+~MappedDataBufferBackingStorePrivate()
+{
+  #ifdef FASTUIDRAW_HAVE_MMAP
+    {
+      if (m_mapped)
+        {
+          munmap(const_cast<uint8_t*>(m_data.c_ptr()), m_data.size());
+        }
+    }
+  #endif
+}
+
+bool
+MappedDataBufferBackingStorePrivate::
+map_file(fastuidraw::c_string filename,
+         enum fastuidraw::MappedDataBufferBackingStore::access_hint_t hint)
+{
+  #ifdef FASTUIDRAW_HAVE_MMAP
+    {
+      int fd;
+      struct stat st;
+      void *p;
+
+      fd = open(filename, O_RDONLY);
+      if (fd == -1)
+        {
+          return false;
+        }
+
+      /* only regular files of non-zero size can be mapped;
+       * others (pipes, devices, empty files) are read.
+       */
+      if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+        {
+          close(fd);
+          return false;
+        }
+
+      p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+      /* the mapping holds its own reference to the file */
+      close(fd);
+
+      if (p == MAP_FAILED)
+        {
+          return false;
+        }
+
+      int madvice;
+      switch (hint)
+        {
+        case fastuidraw::MappedDataBufferBackingStore::access_random:
+          madvice = MADV_RANDOM;
+          break;
+        case fastuidraw::MappedDataBufferBackingStore::access_sequential:
+          madvice = MADV_SEQUENTIAL;
+          break;
+        case fastuidraw::MappedDataBufferBackingStore::access_will_need:
+          madvice = MADV_WILLNEED;
+          break;
+        default:
+          madvice = MADV_NORMAL;
+        }
+      madvise(p, st.st_size, madvice);
+
+      m_data = fastuidraw::c_array<const uint8_t>(static_cast<const uint8_t*>(p), st.st_size);
+      m_mapped = true;
+      return true;
+    }
+  #else
+    {
+      FASTUIDRAWunused(filename);
+      FASTUIDRAWunused(hint);
+      return false;
+    }
+  #endif
+}
+
+void
+MappedDataBufferBackingStorePrivate::
+read_file(fastuidraw::c_string filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+
+  /* read until end of file rather than seeking to the
+   * end, as non-regular files cannot report a size
+   */
+  if (file)
+    {
+      m_read_data.assign(std::istreambuf_iterator<char>(file),
+                         std::istreambuf_iterator<char>());
+    }
+  m_data = fastuidraw::make_c_array(m_read_data);
+}
+
+//////////////////////////////////////////////////
+// fastuidraw::MappedDataBufferBackingStore methods
+fastuidraw::MappedDataBufferBackingStore::
+MappedDataBufferBackingStore(c_string filename, enum access_hint_t hint)
+{
+  m_d = FASTUIDRAWnew MappedDataBufferBackingStorePrivate(filename, hint);
+}
+
+fastuidraw::MappedDataBufferBackingStore::
+~MappedDataBufferBackingStore()
+{
+  MappedDataBufferBackingStorePrivate *d;
+  d = static_cast<MappedDataBufferBackingStorePrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+}
+
+fastuidraw::c_array<const uint8_t>
+fastuidraw::MappedDataBufferBackingStore::
+data(void) const
+{
+  MappedDataBufferBackingStorePrivate *d;
+  d = static_cast<MappedDataBufferBackingStorePrivate*>(m_d);
+  return d->m_data;
+}
+
+bool
+fastuidraw::MappedDataBufferBackingStore::
+mapped(void) const
+{
+  MappedDataBufferBackingStorePrivate *d;
+  d = static_cast<MappedDataBufferBackingStorePrivate*>(m_d);
+  return d->m_mapped;
+}
@@ -0,0 +1,346 @@
+/*!
+ * \file worker_pool.cpp
+ * \brief file worker_pool.cpp
+ *
+ * Copyright 2019 by Intel.
+ *
+ * Contact: kevin.rogovin@gmail.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@gmail.com>
+ *
+ */
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fastuidraw/util/worker_pool.hpp>
+#include <fastuidraw/util/fastuidraw_memory.hpp>
+#include <fastuidraw/util/math.hpp>
+
+namespace
+{
+  class TaskPrivate:fastuidraw::noncopyable
+  {
+  public:
+    TaskPrivate(void):
+      m_status(fastuidraw::WorkerPool::task_queued)
+    {}
+
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_cond;
+    enum fastuidraw::WorkerPool::task_status_t m_status;
+  };
+
+  /* set by worker_main() on each thread of a WorkerPool to a flag
+   * on its stack; the dtor of the WorkerPool, when it runs on one of
+   * the threads of the pool (because a task released the last
+   * reference), raises the flag so that the thread exits without
+   * touching the destroyed WorkerPoolPrivate.
+   */
+  thread_local bool *worker_pool_destroyed = nullptr;
+
+  class WorkerPoolPrivate:fastuidraw::noncopyable
+  {
+  public:
+    explicit
+    WorkerPoolPrivate(unsigned int number_threads);
+    ~WorkerPoolPrivate();
+
+    void
+    add_task(const fastuidraw::reference_counted_ptr<fastuidraw::WorkerPool::Task> &task);
+
+    void
+    wait_all(void);
+
+    unsigned int
+    number_threads(void) const
+    {
+      return m_threads.size();
+    }
+
+  private:
+    void
+    worker_main(void);
+
+    std::mutex m_mutex;
+    std::condition_variable m_task_added;
+    std::condition_variable m_all_done;
+    std::deque<fastuidraw::reference_counted_ptr<fastuidraw::WorkerPool::Task> > m_tasks;
+    std::vector<std::thread> m_threads;
+    unsigned int m_pending;
+    bool m_shutting_down;
+  };
+}
+
+/////////////////////////////////////
+// WorkerPoolPrivate methods
+WorkerPoolPrivate::
+WorkerPoolPrivate(unsigned int number_threads):
+  m_pending(0),
+  m_shutting_down(false)
+{
+  if (number_threads == 0)
+    {
+      number_threads = fastuidraw::t_max(1u, std::thread::hardware_concurrency());
+    }
+
+  m_threads.reserve(number_threads);
+  for (unsigned int i = 0; i < number_threads; ++i)
+    {
+      m_threads.push_back(std::thread(&WorkerPoolPrivate::worker_main, this));
+    }
+}
+
+WorkerPoolPrivate::
+~WorkerPoolPrivate()
+{
+  std::deque<fastuidraw::reference_counted_ptr<fastuidraw::WorkerPool::Task> > tasks;
+
+  m_mutex.lock();
+  m_shutting_down = true;
+  std::swap(tasks, m_tasks);
+  m_mutex.unlock();
+  m_task_added.notify_all();
+
+  for (const auto &task : tasks)
+    {
+      task->cancel();
+    }
+
+  for (std::thread &thread : m_threads)
+    {
+      if (thread.get_id() == std::this_thread::get_id())
+        {
+          /* a thread cannot join itself */
+          FASTUIDRAWassert(worker_pool_destroyed);
+          *worker_pool_destroyed = true;
+          thread.detach();
+        }
+      else
+        {
+          thread.join();
+        }
+    }
+}
+
+void
+WorkerPoolPrivate::
+add_task(const fastuidraw::reference_counted_ptr<fastuidraw::WorkerPool::Task> &task)
+{
+  FASTUIDRAWassert(task);
+  m_mutex.lock();
+  m_tasks.push_back(task);
+  ++m_pending;
+  m_mutex.unlock();
+  m_task_added.notify_one();
+}
+
+void
+WorkerPoolPrivate::
+wait_all(void)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (m_pending > 0 && !m_shutting_down)
+    {
+      m_all_done.wait(lock);
+    }
+}
+
+void
+WorkerPoolPrivate::
+worker_main(void)
+{
+  bool destroyed(false);
+
+  worker_pool_destroyed = &destroyed;
+  for (;;)
+    {
+      fastuidraw::reference_counted_ptr<fastuidraw::WorkerPool::Task> task;
+
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_tasks.empty() && !m_shutting_down)
+          {
+            m_task_added.wait(lock);
+          }
+
+        if (m_shutting_down)
+          {
+            return;
+          }
+
+        task = m_tasks.front();
+        m_tasks.pop_front();
+      }
+
+      /* execute() is a no-op if the task was cancelled
+       * or was stolen by another thread calling execute().
+       */
+      task->execute();
+      task.clear();
+
+      if (destroyed)
+        {
+          /* the task released the last reference to the
+           * WorkerPool, this is no longer valid.
+           */
+          worker_pool_destroyed = nullptr;
+          return;
+        }
+
+      m_mutex.lock();
+      FASTUIDRAWassert(m_pending > 0);
+      --m_pending;
+      m_mutex.unlock();
+      m_all_done.notify_all();
+    }
+}
+
+/////////////////////////////////////////
+// fastuidraw::WorkerPool::Task methods
+fastuidraw::WorkerPool::Task::
+Task(void)
+{
+  m_d = FASTUIDRAWnew TaskPrivate();
+}
+
+fastuidraw::WorkerPool::Task::
+~Task()
+{
+  TaskPrivate *d;
+  d = static_cast<TaskPrivate*>(m_d);
+  FASTUIDRAWassert(d->m_status != task_running);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+enum fastuidraw::WorkerPool::task_status_t
+fastuidraw::WorkerPool::Task::
+status(void) const
+{
+  TaskPrivate *d;
+  d = static_cast<TaskPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> lock(d->m_mutex);
+  return d->m_status;
+}
+
+bool
+fastuidraw::WorkerPool::Task::
+done(void) const
+{
+  enum task_status_t s(status());
+  return s == task_finished || s == task_cancelled;
+}
+
+void
+fastuidraw::WorkerPool::Task::
+wait(void) const
+{
+  TaskPrivate *d;
+  d = static_cast<TaskPrivate*>(m_d);
+
+  std::unique_lock<std::mutex> lock(d->m_mutex);
+  while (d->m_status == task_queued || d->m_status == task_running)
+    {
+      d->m_cond.wait(lock);
+    }
+}
+
+bool
+fastuidraw::WorkerPool::Task::
+execute(void)
+{
+  TaskPrivate *d;
+  d = static_cast<TaskPrivate*>(m_d);
+
+  d->m_mutex.lock();
+  if (d->m_status != task_queued)
+    {
+      d->m_mutex.unlock();
+      return false;
+    }
+  d->m_status = task_running;
+  d->m_mutex.unlock();
+
+  run();
+
+  d->m_mutex.lock();
+  d->m_status = task_finished;
+  d->m_mutex.unlock();
+  d->m_cond.notify_all();
+
+  return true;
+}
+
+bool
+fastuidraw::WorkerPool::Task::
+cancel(void)
+{
+  TaskPrivate *d;
+  d = static_cast<TaskPrivate*>(m_d);
+
+  d->m_mutex.lock();
+  if (d->m_status != task_queued)
+    {
+      d->m_mutex.unlock();
+      return false;
+    }
+  d->m_status = task_cancelled;
+  d->m_mutex.unlock();
+  d->m_cond.notify_all();
+
+  return true;
+}
+
+/////////////////////////////////////
+// fastuidraw::WorkerPool methods
+fastuidraw::WorkerPool::
+WorkerPool(unsigned int number_threads)
+{
+  m_d = FASTUIDRAWnew WorkerPoolPrivate(number_threads);
+}
+
+fastuidraw::WorkerPool::
+~WorkerPool()
+{
+  WorkerPoolPrivate *d;
+  d = static_cast<WorkerPoolPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+unsigned int
+fastuidraw::WorkerPool::
+number_threads(void) const
+{
+  WorkerPoolPrivate *d;
+  d = static_cast<WorkerPoolPrivate*>(m_d);
+  return d->number_threads();
+}
+
+void
+fastuidraw::WorkerPool::
+add_task(const reference_counted_ptr<Task> &task)
+{
+  WorkerPoolPrivate *d;
+  d = static_cast<WorkerPoolPrivate*>(m_d);
+  d->add_task(task);
+}
+
+void
+fastuidraw::WorkerPool::
+wait_all(void)
+{
+  WorkerPoolPrivate *d;
+  d = static_cast<WorkerPoolPrivate*>(m_d);
+  d->wait_all();
+}